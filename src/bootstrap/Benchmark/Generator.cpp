@@ -0,0 +1,266 @@
+#include "Generator.h"
+#include <Ty/Formatter.h>
+#include <Ty/Vector.h>
+
+namespace Benchmark {
+
+namespace {
+
+// NOTE: No single item is larger than this, so a buffer of the
+//       requested size plus this never fills up.
+constexpr u32 max_item_size = 64 * 1024;
+
+// NOTE: xorshift64*, anything seeded the same gives the same
+//       numbers on every machine.
+struct Random {
+    u64 state;
+
+    u32 next()
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return (u32)((state * 0x2545F4914F6CDD1DULL) >> 32);
+    }
+
+    u32 between(u32 min, u32 max)
+    {
+        return min + next() % (max - min + 1);
+    }
+};
+
+struct Generator {
+    StringBuffer& out;
+    Random random;
+
+    // NOTE: Ids of the items of each kind emitted so far, in order,
+    //       so that items only ever name ones that exist.
+    Vector<u32> small_functions;
+    Vector<u32> records;
+    u32 items { 0 };
+
+    ErrorOr<void> item(SourceShape shape);
+
+    ErrorOr<void> nested_function();
+    ErrorOr<void> wide_struct();
+    ErrorOr<void> small_function();
+    ErrorOr<void> inline_c_function();
+    ErrorOr<void> typed_function();
+
+    ErrorOr<void> indent(u32 depth);
+};
+
+ErrorOr<void> Generator::item(SourceShape shape)
+{
+    if (shape == SourceShape::Mixed)
+        shape = (SourceShape)random.between(0,
+            (u32)SourceShape::Mixed - 1);
+    switch (shape) {
+    case SourceShape::DeepNesting: TRY(nested_function()); break;
+    case SourceShape::WideStructs: TRY(wide_struct()); break;
+    case SourceShape::SmallFunctions: TRY(small_function()); break;
+    case SourceShape::InlineC: TRY(inline_c_function()); break;
+    case SourceShape::TypeHeavy: TRY(typed_function()); break;
+    case SourceShape::Mixed: break;
+    }
+    TRY(out.write("\n"sv));
+    items++;
+    return {};
+}
+
+ErrorOr<void> Generator::nested_function()
+{
+    auto id = items;
+    auto depth = random.between(8, 32);
+    TRY(out.writeln("fn nested_"sv, id, "(x: i32) -> i32 {"sv));
+    TRY(out.writeln("    var y = x;"sv));
+    for (u32 level = 1; level <= depth; level++) {
+        TRY(indent(level));
+        auto keyword
+            = level % 2 == 0 ? "while y < "sv : "if y > "sv;
+        TRY(out.writeln(keyword, random.between(0, 1000), " {"sv));
+        TRY(indent(level + 1));
+        TRY(out.writeln("y = y + "sv, random.between(1, 9),
+            " * "sv, random.between(1, 9), " - y / "sv,
+            random.between(2, 9), ";"sv));
+    }
+    TRY(indent(depth + 1));
+    TRY(out.writeln("return y;"sv));
+    for (u32 level = depth; level >= 1; level--) {
+        TRY(indent(level));
+        TRY(out.writeln("}"sv));
+    }
+    TRY(out.writeln("    return y + "sv, depth, ";"sv));
+    TRY(out.writeln("}"sv));
+    return {};
+}
+
+ErrorOr<void> Generator::wide_struct()
+{
+    auto id = items;
+    auto members = random.between(16, 128);
+    TRY(out.writeln("let Wide"sv, id, " = struct {"sv));
+    for (u32 member = 0; member < members; member++)
+        TRY(out.writeln("    m"sv, member, ": i32,"sv));
+    TRY(out.writeln("};"sv));
+    TRY(out.writeln());
+    TRY(out.writeln("fn make_wide_"sv, id, "(x: i32) -> Wide"sv, id,
+        " {"sv));
+    TRY(out.writeln("    return Wide"sv, id, " {"sv));
+    for (u32 member = 0; member < members; member++) {
+        TRY(out.writeln("        .m"sv, member, " = x + "sv,
+            random.between(0, 1000), ","sv));
+    }
+    TRY(out.writeln("    };"sv));
+    TRY(out.writeln("}"sv));
+    return {};
+}
+
+ErrorOr<void> Generator::small_function()
+{
+    auto id = items;
+    auto callee = small_functions.is_empty()
+        ? id
+        : small_functions[random.between(0,
+            small_functions.size() - 1)];
+    TRY(small_functions.append(id));
+    auto specifier = random.between(0, 3) == 0 ? "pub "sv : ""sv;
+    TRY(out.writeln(specifier, "fn small_"sv, id,
+        "(a: i32, b: i32) -> i32 {"sv));
+    TRY(out.writeln("    let c = a * "sv, random.between(1, 100),
+        " + b;"sv));
+    TRY(out.writeln("    if c > "sv, random.between(0, 1000),
+        " {"sv));
+    TRY(out.writeln("        return c - a;"sv));
+    TRY(out.writeln("    }"sv));
+    TRY(out.writeln("    return small_"sv, callee, "(c, b) + "sv,
+        random.between(0, 100), ";"sv));
+    TRY(out.writeln("}"sv));
+    return {};
+}
+
+ErrorOr<void> Generator::inline_c_function()
+{
+    auto id = items;
+    TRY(out.writeln("inline_c {"sv));
+    TRY(out.writeln("static int table_"sv, id, "[4] = { "sv,
+        random.between(0, 9), ", "sv, random.between(0, 9), ", "sv,
+        random.between(0, 9), ", "sv, random.between(0, 9),
+        " };"sv));
+    TRY(out.writeln("static int helper_"sv, id, "(int x) {"sv));
+    TRY(out.writeln("    for (int i = 0; i < 4; i++) {"sv));
+    TRY(out.writeln("        x += table_"sv, id, "[i] * "sv,
+        random.between(1, 9), ";"sv));
+    TRY(out.writeln("    }"sv));
+    TRY(out.writeln("    return x % 1000;"sv));
+    TRY(out.writeln("}"sv));
+    TRY(out.writeln("};"sv));
+    TRY(out.writeln());
+    TRY(out.writeln("fn c_heavy_"sv, id, "(x: i32) -> i32 {"sv));
+    TRY(out.writeln("    inline_c x = helper_"sv, id, "(x);"sv));
+    TRY(out.writeln("    let y = inline_c x * 2 + "sv,
+        random.between(0, 100), ";"sv));
+    TRY(out.writeln("    return y;"sv));
+    TRY(out.writeln("}"sv));
+    return {};
+}
+
+ErrorOr<void> Generator::typed_function()
+{
+    static constexpr StringView builtin_types[] = {
+        "i8"sv, "i16"sv, "i32"sv, "i64"sv, "u8"sv,
+        "u16"sv, "u32"sv, "u64"sv, "f32"sv, "f64"sv,
+    };
+    constexpr u32 builtin_count
+        = sizeof(builtin_types) / sizeof(builtin_types[0]);
+
+    auto id = items;
+    TRY(out.writeln("let Record"sv, id, " = struct {"sv));
+    TRY(out.writeln("    a: i32,"sv));
+    TRY(out.writeln("    b: u64,"sv));
+    TRY(out.writeln("    c: f64,"sv));
+    TRY(out.writeln("};"sv));
+    TRY(out.writeln());
+    TRY(records.append(id));
+
+    // NOTE: Parameters are drawn from the builtins and the last
+    //       few records, so signatures repeat often like they do
+    //       in real code.
+    auto parameters = random.between(1, 6);
+    u32 types[6];
+    for (u32 i = 0; i < parameters; i++)
+        types[i] = random.between(0, builtin_count + 3);
+    auto write_type = [&](u32 type) -> ErrorOr<void> {
+        if (type < builtin_count) {
+            TRY(out.write(builtin_types[type]));
+            return {};
+        }
+        auto back = type - builtin_count;
+        auto record = back < records.size()
+            ? records[records.size() - 1 - back]
+            : id;
+        TRY(out.write("Record"sv, record));
+        return {};
+    };
+
+    TRY(out.write("fn convert_"sv, id, "("sv));
+    for (u32 i = 0; i < parameters; i++) {
+        if (i != 0)
+            TRY(out.write(", "sv));
+        TRY(out.write("p"sv, i, ": "sv));
+        TRY(write_type(types[i]));
+    }
+    TRY(out.write(") -> "sv));
+    TRY(write_type(types[0]));
+    TRY(out.writeln(" {"sv));
+    TRY(out.writeln("    return p0;"sv));
+    TRY(out.writeln("}"sv));
+    return {};
+}
+
+ErrorOr<void> Generator::indent(u32 depth)
+{
+    for (u32 i = 0; i < depth; i++)
+        TRY(out.write("    "sv));
+    return {};
+}
+
+}
+
+StringView source_shape_name(SourceShape shape)
+{
+    switch (shape) {
+#define X(T, name) \
+    case SourceShape::T: return name##sv;
+        SOURCE_SHAPES
+#undef X
+    }
+}
+
+Optional<SourceShape> source_shape_from_name(StringView name)
+{
+#define X(T, shape_name)        \
+    if (name == shape_name##sv) \
+        return SourceShape::T;
+    SOURCE_SHAPES
+#undef X
+    return {};
+}
+
+ErrorOr<StringBuffer> generate_source(SourceShape shape, u32 size,
+    u64 seed)
+{
+    auto out = TRY(StringBuffer::create_saturated(size
+        + max_item_size));
+    auto generator = Generator {
+        .out = out,
+        .random = { seed * 2 + 1 },
+        .small_functions = TRY(Vector<u32>::create()),
+        .records = TRY(Vector<u32>::create()),
+    };
+    while (out.size() < size)
+        TRY(generator.item(shape));
+    return out;
+}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <Ty/Base.h>
+#include <Ty/ErrorOr.h>
+#include <Ty/Optional.h>
+#include <Ty/StringBuffer.h>
+#include <Ty/StringView.h>
+
+namespace Benchmark {
+
+#define SOURCE_SHAPES                    \
+    X(DeepNesting, "deep-nesting")       \
+    X(WideStructs, "wide-structs")       \
+    X(SmallFunctions, "small-functions") \
+    X(InlineC, "inline-c")               \
+    X(TypeHeavy, "type-heavy")           \
+    X(Mixed, "mixed")
+
+enum class SourceShape : u8 {
+#define X(T, ...) T,
+    SOURCE_SHAPES
+#undef X
+};
+
+StringView source_shape_name(SourceShape);
+Optional<SourceShape> source_shape_from_name(StringView);
+
+// NOTE: Generates a valid program of at least `size` bytes made
+//       of items of the given shape. The same shape, size and seed
+//       always give the same source, so runs stay comparable.
+ErrorOr<StringBuffer> generate_source(SourceShape shape, u32 size,
+    u64 seed);
+
+}
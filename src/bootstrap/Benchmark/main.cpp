@@ -0,0 +1,824 @@
+#include "Generator.h"
+#include <CLI/ArgumentParser.h>
+#include <Core/File.h>
+#include <Core/System.h>
+#include <He/Codegen.h>
+#include <He/Context.h>
+#include <He/Lexer.h>
+#include <He/Parser.h>
+#include <He/ScopeTable.h>
+#include <He/TypeTable.h>
+#include <He/Typecheck.h>
+#include <Main/Main.h>
+#include <Ty/Formatter.h>
+#include <Ty/StringBuffer.h>
+#include <Ty/Vector.h>
+
+namespace {
+
+#define STAGES   \
+    X(lex)       \
+    X(parse)     \
+    X(types)     \
+    X(scopes)    \
+    X(typecheck) \
+    X(codegen)   \
+    X(total)
+
+// NOTE: Nanoseconds every round spent in each stage, and in all
+//       of them together.
+struct Timings {
+#define X(name) Vector<u64> name;
+    STAGES
+#undef X
+
+    static ErrorOr<Timings> create(u32 rounds)
+    {
+        return Timings {
+#define X(name) .name = TRY(Vector<u64>::create(rounds)),
+            STAGES
+#undef X
+        };
+    }
+};
+
+// NOTE: What one pass over the source went through, throughput
+//       of every stage is given in terms of the same input.
+struct Counts {
+    u32 bytes { 0 };
+    u32 tokens { 0 };
+    u32 expressions { 0 };
+    u32 type_requests { 0 };
+    u32 types { 0 };
+    u32 resolved { 0 };
+    u32 unresolved { 0 };
+};
+
+struct Options {
+    u32 size;
+    u32 rounds;
+    u64 seed;
+    u32 threads;
+};
+
+ErrorOr<u32> parse_u32(StringView name, c_string argument);
+
+ErrorOr<void> run_benchmark(Benchmark::SourceShape shape,
+    Options const& options);
+
+ErrorOr<void> run_keyword_benchmark(Options const& options);
+
+ErrorOr<void> run_recovery_benchmark(Options const& options);
+
+ErrorOr<Counts> run_round(StringView source, u32 threads,
+    Timings* timings);
+
+u32 expression_count(He::ParsedExpressions const&);
+
+ErrorOr<void> intern_types(He::ParsedExpressions const&,
+    Counts& counts);
+
+ErrorOr<void> resolve_names(He::ParsedExpressions const&,
+    Counts& counts);
+
+ErrorOr<void> show_stage(StringView name, Vector<u64>& timings,
+    Counts counts);
+
+ErrorOr<void> show_lookups(StringView name, Vector<u64>& timings,
+    u32 lookups);
+
+}
+
+ErrorOr<int> Main::main(int argc, c_string argv[])
+{
+    auto argument_parser = CLI::ArgumentParser();
+
+    c_string program_name = argv[0];
+    TRY(argument_parser.add_flag("--help"sv, "-h"sv,
+        "show help message"sv, [&] {
+            argument_parser.print_usage_and_exit(program_name, 0);
+        }));
+
+    c_string shape_argument = nullptr;
+    TRY(argument_parser.add_option("--shape"sv, "-s"sv, "name"sv,
+        "shape of the generated source, all if not given"sv,
+        [&](auto name) {
+            shape_argument = name;
+        }));
+
+    c_string size_argument = "2048";
+    TRY(argument_parser.add_option("--size"sv, "-n"sv,
+        "kilobytes"sv, "size of the generated source"sv,
+        [&](auto size) {
+            size_argument = size;
+        }));
+
+    c_string rounds_argument = "9";
+    TRY(argument_parser.add_option("--rounds"sv, "-r"sv,
+        "count"sv, "timed runs of every stage"sv, [&](auto rounds) {
+            rounds_argument = rounds;
+        }));
+
+    c_string seed_argument = "1";
+    TRY(argument_parser.add_option("--seed"sv, "-sd"sv,
+        "number"sv, "seed of the source generator"sv,
+        [&](auto seed) {
+            seed_argument = seed;
+        }));
+
+    c_string threads_argument = "1";
+    TRY(argument_parser.add_option("--threads"sv, "-t"sv,
+        "count"sv, "lex and parse on this many threads"sv,
+        [&](auto threads) {
+            threads_argument = threads;
+        }));
+
+    c_string emit_path = nullptr;
+    TRY(argument_parser.add_option("--emit-source"sv, "-e"sv,
+        "path"sv, "write the generated source and exit"sv,
+        [&](auto path) {
+            emit_path = path;
+        }));
+
+    auto should_time_keywords = false;
+    TRY(argument_parser.add_flag("--keywords"sv, "-k"sv,
+        "time keyword lookups instead of the stages"sv, [&] {
+            should_time_keywords = true;
+        }));
+
+    auto should_time_recovery = false;
+    TRY(argument_parser.add_flag("--recovery"sv, "-rc"sv,
+        "time parsing a source with broken functions"sv, [&] {
+            should_time_recovery = true;
+        }));
+
+    if (auto result = argument_parser.run(argc, argv);
+        result.is_error()) {
+        TRY(result.error().show());
+        return 1;
+    }
+
+    auto options = Options {
+        .size = TRY(parse_u32("size"sv, size_argument)) * 1024,
+        .rounds = TRY(parse_u32("rounds"sv, rounds_argument)),
+        .seed = TRY(parse_u32("seed"sv, seed_argument)),
+        .threads = TRY(parse_u32("threads"sv, threads_argument)),
+    };
+    if (options.rounds == 0 || options.threads == 0)
+        return Error::from_string_literal(
+            "rounds and threads have to be at least 1");
+
+    auto shape = Optional<Benchmark::SourceShape>();
+    if (shape_argument) {
+        auto name = StringView::from_c_string(shape_argument);
+        auto named = Benchmark::source_shape_from_name(name);
+        if (!named.has_value())
+            return Error::from_string_literal("unknown shape");
+        shape = named.value();
+    }
+
+    if (emit_path) {
+        auto source_shape
+            = shape.has_value() ? shape.value()
+                                : Benchmark::SourceShape::Mixed;
+        auto source = TRY(Benchmark::generate_source(source_shape,
+            options.size, options.seed));
+        auto file = TRY(Core::File::open_for_writing(emit_path));
+        TRY(file.write(source));
+        return 0;
+    }
+
+    if (should_time_keywords) {
+        TRY(run_keyword_benchmark(options));
+        return 0;
+    }
+
+    if (should_time_recovery) {
+        TRY(run_recovery_benchmark(options));
+        return 0;
+    }
+
+    if (shape.has_value()) {
+        TRY(run_benchmark(shape.value(), options));
+        return 0;
+    }
+#define X(T, ...) \
+    TRY(run_benchmark(Benchmark::SourceShape::T, options));
+    SOURCE_SHAPES
+#undef X
+    return 0;
+}
+
+namespace {
+
+ErrorOr<u32> parse_u32(StringView name, c_string argument)
+{
+    auto text = StringView::from_c_string(argument);
+    if (text.is_empty())
+        return Error::from_string_literal("expected a number");
+    u64 number = 0;
+    for (u32 i = 0; i < text.size; i++) {
+        if (text[i] < '0' || text[i] > '9') {
+            TRY(Core::File::stderr().writeln("invalid "sv, name,
+                ": "sv, text));
+            return Error::from_string_literal("expected a number");
+        }
+        number = number * 10 + (u64)(text[i] - '0');
+        if (number > 0xFFFFFFFF)
+            return Error::from_string_literal("number too large");
+    }
+    return (u32)number;
+}
+
+ErrorOr<void> run_benchmark(Benchmark::SourceShape shape,
+    Options const& options)
+{
+    auto source = TRY(Benchmark::generate_source(shape,
+        options.size, options.seed));
+
+    // NOTE: The first round only warms up caches and the
+    //       allocator, it is not timed.
+    auto counts = TRY(run_round(source.view(), options.threads,
+        nullptr));
+    auto timings = TRY(Timings::create(options.rounds));
+    for (u32 round = 0; round < options.rounds; round++)
+        TRY(run_round(source.view(), options.threads, &timings));
+
+    auto& out = Core::File::stdout();
+    TRY(out.writeln(Benchmark::source_shape_name(shape), ": "sv,
+        counts.bytes, " bytes, "sv, counts.tokens, " tokens, "sv,
+        counts.expressions, " expressions, "sv, counts.types,
+        " types of "sv, counts.type_requests, ", "sv,
+        options.rounds, " rounds"sv));
+    TRY(out.writeln("  "sv, counts.resolved, " names resolved, "sv,
+        counts.unresolved, " not found"sv));
+#define X(name)                                        \
+    TRY(show_stage(StringView::from_c_string(#name), \
+        timings.name, counts));
+    STAGES
+#undef X
+    TRY(out.flush());
+    return {};
+}
+
+ErrorOr<u64> now() { return Core::System::monotonic_nanoseconds(); }
+
+// NOTE: Times looking up every word the lexer would look up in
+//       the mixed source, that is every identifier or keyword
+//       starting with a letter, apart from the rest of lexing.
+ErrorOr<void> run_keyword_benchmark(Options const& options)
+{
+    auto source = TRY(Benchmark::generate_source(
+        Benchmark::SourceShape::Mixed, options.size, options.seed));
+    auto lex_result = He::lex(source.view());
+    if (lex_result.is_error())
+        return Error::from_string_literal("could not lex source");
+    auto lexed = lex_result.release_value();
+
+    auto words = TRY(Vector<StringView>::create());
+    u32 keywords = 0;
+    for (auto token : lexed.tokens) {
+        auto text = token.text(source.view());
+        if (text.is_empty() || text[0] < 'a' || text[0] > 'z')
+            continue;
+        if (He::look_up_keyword(text)
+            != He::look_up_keyword_linearly(text))
+            return Error::from_string_literal(
+                "keyword lookups disagree");
+        if (He::look_up_keyword(text) != He::TokenType::Identifier)
+            keywords++;
+        TRY(words.append(text));
+    }
+
+    auto time_lookups
+        = [&](auto look_up, Vector<u64>& timings) -> ErrorOr<u32> {
+        u32 checksum = 0;
+        for (u32 round = 0; round <= options.rounds; round++) {
+            auto start = TRY(now());
+            for (auto word : words)
+                checksum += (u32)look_up(word);
+            auto stop = TRY(now());
+            // NOTE: The first round only warms up caches.
+            if (round != 0)
+                TRY(timings.append(stop - start));
+        }
+        return checksum;
+    };
+    auto hashed = TRY(Vector<u64>::create(options.rounds));
+    auto linear = TRY(Vector<u64>::create(options.rounds));
+    auto hashed_sum
+        = TRY(time_lookups(He::look_up_keyword, hashed));
+    auto linear_sum
+        = TRY(time_lookups(He::look_up_keyword_linearly, linear));
+    if (hashed_sum != linear_sum)
+        return Error::from_string_literal(
+            "keyword lookups disagree");
+
+    TRY(Core::File::stdout().writeln("keywords: "sv, words.size(),
+        " words, "sv, keywords, " keywords, "sv, options.rounds,
+        " rounds"sv));
+    TRY(show_lookups("hashed"sv, hashed, words.size()));
+    TRY(show_lookups("linear"sv, linear, words.size()));
+    TRY(Core::File::stdout().flush());
+    return {};
+}
+
+// NOTE: Broken functions the recovery benchmark spreads over the
+//       mixed source. Parsing gives up once ParseErrors is full,
+//       so there are only as many as leave it short of that.
+constexpr u32 broken_functions = 5;
+constexpr u32 kept_parse_errors = 16;
+
+// NOTE: Statements that fail to parse, unclosed brackets among
+//       them, each followed by the body recovery goes on with.
+constexpr StringView broken_statements[] = {
+    "    return broken(x,;"sv,
+    "    y = [1, 2;"sv,
+    "    if y > {"sv,
+};
+constexpr u32 broken_statement_count
+    = sizeof(broken_statements) / sizeof(broken_statements[0]);
+
+ErrorOr<StringBuffer> with_broken_functions(StringView text)
+{
+    auto out = TRY(StringBuffer::create_saturated(text.size
+        + broken_functions * 4096));
+    u32 written = 0;
+    for (u32 i = 0; i < broken_functions; i++) {
+        auto end = (u32)((u64)text.size * (i + 1)
+            / (broken_functions + 1));
+        while (end + 1 < text.size
+            && !(text[end] == '\n' && text[end + 1] == '\n'))
+            end++;
+        end += 2;
+        TRY(out.write(text.sub_view(written, end - written)));
+        written = end;
+
+        auto broken = broken_statements[i
+            % broken_statement_count];
+        TRY(out.writeln("fn broken_"sv, i, "(x: i32) -> i32 {"sv));
+        TRY(out.writeln("    var y = x;"sv));
+        TRY(out.writeln(broken));
+        for (u32 level = 1; level <= 16; level++) {
+            for (u32 j = 0; j < level; j++)
+                TRY(out.write("    "sv));
+            TRY(out.writeln("if y > "sv, level, " {"sv));
+        }
+        for (u32 level = 16; level >= 1; level--) {
+            for (u32 j = 0; j <= level; j++)
+                TRY(out.write("    "sv));
+            TRY(out.writeln("y = y - 1;"sv));
+            for (u32 j = 0; j < level; j++)
+                TRY(out.write("    "sv));
+            TRY(out.writeln("}"sv));
+        }
+        TRY(out.writeln("    return y;"sv));
+        TRY(out.writeln("}"sv));
+        TRY(out.writeln());
+    }
+    TRY(out.write(text.sub_view(written, text.size - written)));
+    return out;
+}
+
+// NOTE: Lexes and parses `source` once more than there are
+//       rounds, the first one only warming up caches. Parse
+//       errors are counted rather than failing the round, and
+//       leave no expressions to count.
+ErrorOr<Counts> time_parse(StringView source,
+    Options const& options, Vector<u64>& timings, u32& error_count)
+{
+    auto threads = options.threads;
+    auto counts = Counts { .bytes = source.size };
+    for (u32 round = 0; round <= options.rounds; round++) {
+        auto start = TRY(now());
+        auto lex_result = threads == 1
+            ? He::lex(source)
+            : He::lex_in_parallel(source, threads);
+        if (lex_result.is_error()
+            || !lex_result.value().errors.is_empty())
+            return Error::from_string_literal(
+                "could not lex source");
+        auto lexed = lex_result.release_value();
+        counts.tokens = lexed.tokens.size();
+        auto parse_result = He::parse_in_parallel(lexed.tokens,
+            move(lexed.symbols), He::FunctionBodies::Parse,
+            threads);
+        auto stop = TRY(now());
+        if (round != 0)
+            TRY(timings.append(stop - start));
+
+        error_count = 0;
+        if (parse_result.is_error()) {
+            auto const& errors = parse_result.error();
+            if (!errors.basic_error.is_empty())
+                return Error::from_string_literal(
+                    "could not parse source");
+            error_count = errors.parse_errors.size();
+            continue;
+        }
+        counts.expressions
+            = expression_count(parse_result.value());
+    }
+    return counts;
+}
+
+// NOTE: Times lexing and parsing the mixed source as generated
+//       and with broken functions spread over it, which the
+//       parser has to recover from to reach the end.
+ErrorOr<void> run_recovery_benchmark(Options const& options)
+{
+    auto clean = TRY(Benchmark::generate_source(
+        Benchmark::SourceShape::Mixed, options.size, options.seed));
+    auto broken = TRY(with_broken_functions(clean.view()));
+
+    auto clean_timings = TRY(Vector<u64>::create(options.rounds));
+    auto broken_timings = TRY(Vector<u64>::create(options.rounds));
+    u32 error_count = 0;
+    auto clean_counts = TRY(time_parse(clean.view(), options,
+        clean_timings, error_count));
+    if (error_count != 0)
+        return Error::from_string_literal("could not parse source");
+    auto broken_counts = TRY(time_parse(broken.view(), options,
+        broken_timings, error_count));
+    if (error_count == 0)
+        return Error::from_string_literal(
+            "broken functions were not reported");
+    if (error_count == kept_parse_errors)
+        return Error::from_string_literal(
+            "parsing gave up before the end of the source");
+
+    auto& out = Core::File::stdout();
+    TRY(out.writeln("recovery: "sv, broken_counts.bytes,
+        " bytes, "sv, broken_counts.tokens, " tokens, "sv,
+        error_count, " errors in "sv, broken_functions,
+        " functions, "sv, options.rounds, " rounds"sv));
+    TRY(show_stage("clean"sv, clean_timings, clean_counts));
+    TRY(show_stage("broken"sv, broken_timings, broken_counts));
+    TRY(out.flush());
+    return {};
+}
+
+ErrorOr<Counts> run_round(StringView source, u32 threads,
+    Timings* timings)
+{
+    auto start = TRY(now());
+    auto lex_result = threads == 1
+        ? He::lex(source)
+        : He::lex_in_parallel(source, threads);
+    auto lexed_at = TRY(now());
+    if (lex_result.is_error()
+        || !lex_result.value().errors.is_empty())
+        return Error::from_string_literal("could not lex source");
+    auto lexed = lex_result.release_value();
+
+    auto parse_result = He::parse_in_parallel(lexed.tokens,
+        move(lexed.symbols), He::FunctionBodies::Parse, threads);
+    auto parsed_at = TRY(now());
+    if (parse_result.is_error())
+        return Error::from_string_literal("could not parse source");
+    auto expressions = parse_result.release_value();
+
+    auto counts = Counts {
+        .bytes = source.size,
+        .tokens = lexed.tokens.size(),
+        .expressions = expression_count(expressions),
+    };
+    TRY(intern_types(expressions, counts));
+    auto interned_at = TRY(now());
+    TRY(resolve_names(expressions, counts));
+    auto resolved_at = TRY(now());
+
+    auto context = He::Context {
+        source,
+        "benchmark"sv,
+        expressions,
+        expressions.symbols,
+    };
+    auto typecheck_result
+        = He::typecheck_in_parallel(context, threads);
+    auto typechecked_at = TRY(now());
+    if (typecheck_result.is_error())
+        return Error::from_string_literal("could not typecheck");
+    auto typechecked = typecheck_result.release_value();
+
+    auto generated = TRY(He::codegen(context, typechecked));
+    auto generated_at = TRY(now());
+    (void)generated;
+
+    if (timings) {
+        TRY(timings->lex.append(lexed_at - start));
+        TRY(timings->parse.append(parsed_at - lexed_at));
+        TRY(timings->types.append(interned_at - parsed_at));
+        TRY(timings->scopes.append(resolved_at - interned_at));
+        TRY(timings->typecheck.append(
+            typechecked_at - resolved_at));
+        TRY(timings->codegen.append(generated_at - typechecked_at));
+        TRY(timings->total.append(generated_at - start));
+    }
+    return counts;
+}
+
+// NOTE: Parsed types are plain names, so this builds the
+//       structured types a typechecker would derive from them:
+//       every parameter may be passed as `&mut` to a pointer, and
+//       every function may be taken as a function pointer.
+ErrorOr<void> intern_types(He::ParsedExpressions const& expressions,
+    Counts& counts)
+{
+    auto types = TRY(He::TypeTable::create());
+    auto parameter_types = TRY(Vector<He::TypeId>::create());
+    auto previous = He::TypeId::invalid();
+    u32 requests = 0;
+
+    auto intern_function
+        = [&](auto const& function) -> ErrorOr<void> {
+        auto first = parameter_types.size();
+        for (auto parameter : expressions[function.parameters]) {
+            auto type = TRY(types.named(parameter.type.symbol()));
+            auto pointer = TRY(types.pointer(type));
+            auto reference = TRY(types.mutable_reference(type));
+            if (!TRY(types.is_assignable(pointer, reference)))
+                return Error::from_string_literal("not assignable");
+            TRY(parameter_types.append(type));
+            requests += 3;
+        }
+        auto parameters = View<He::TypeId const> {
+            parameter_types.data() + first,
+            parameter_types.size() - first,
+        };
+        auto return_type
+            = TRY(types.named(function.return_type.symbol()));
+        auto signature
+            = TRY(types.function(return_type, parameters));
+        auto pointer = TRY(types.pointer(signature));
+        requests += 3;
+        if (previous.is_valid())
+            TRY(types.is_assignable(pointer, previous));
+        previous = pointer;
+        return {};
+    };
+
+#define X(name)                                     \
+    for (auto const& function : expressions.name) \
+        TRY(intern_function(function));
+    X(private_functions)
+    X(public_functions)
+    X(private_c_functions)
+    X(public_c_functions)
+#undef X
+
+    counts.type_requests = requests;
+    counts.types = types.size();
+    return {};
+}
+
+// NOTE: Walks every function like name resolution in the
+//       typechecker would: globals first, then parameters and
+//       locals in a scope per block.
+struct Resolver {
+    He::ParsedExpressions const& expressions;
+    He::ScopeTable& scopes;
+    u32 resolved { 0 };
+    u32 unresolved { 0 };
+
+    template <typename Function>
+    ErrorOr<void> function(Function const&, He::Expression);
+
+    ErrorOr<void> block(Id<He::Block>);
+    ErrorOr<void> expression(He::Expression);
+    ErrorOr<void> expressions_in(View<He::Expression const>);
+    ErrorOr<void> local(He::Token name, Id<He::Expression> value,
+        He::Expression);
+    void look_up(He::Token name);
+};
+
+ErrorOr<void> resolve_names(
+    He::ParsedExpressions const& expressions, Counts& counts)
+{
+    auto scopes = TRY(He::ScopeTable::create(
+        expressions.declarations.size()));
+    auto resolver = Resolver {
+        .expressions = expressions,
+        .scopes = scopes,
+    };
+    for (auto declaration : expressions.declarations) {
+        auto name = expressions.declaration_name(declaration);
+        TRY(scopes.declare(name.symbol(), { declaration }));
+    }
+    for (auto declaration : expressions.declarations) {
+        switch (declaration.type()) {
+#define X(T, name)                                     \
+    case He::ExpressionType::T: {                      \
+        auto const& function                           \
+            = expressions[declaration.as_##name()];    \
+        TRY(resolver.function(function, declaration)); \
+        break;                                         \
+    }
+            X(PrivateFunction, private_function)
+            X(PublicFunction, public_function)
+            X(PrivateCFunction, private_c_function)
+            X(PublicCFunction, public_c_function)
+#undef X
+        default: break;
+        }
+    }
+    counts.resolved = resolver.resolved;
+    counts.unresolved = resolver.unresolved;
+    return {};
+}
+
+template <typename Function>
+ErrorOr<void> Resolver::function(Function const& function,
+    He::Expression declaration)
+{
+    TRY(scopes.enter_scope());
+    for (auto parameter : expressions[function.parameters])
+        TRY(scopes.declare(parameter.name.symbol(),
+            { declaration }));
+    TRY(block(function.block));
+    scopes.exit_scope();
+    return {};
+}
+
+ErrorOr<void> Resolver::block(Id<He::Block> id)
+{
+    TRY(scopes.enter_scope());
+    TRY(expressions_in(expressions[expressions[id].expressions]));
+    scopes.exit_scope();
+    return {};
+}
+
+ErrorOr<void> Resolver::expressions_in(
+    View<He::Expression const> children)
+{
+    for (auto child : children)
+        TRY(expression(child));
+    return {};
+}
+
+ErrorOr<void> Resolver::local(He::Token name,
+    Id<He::Expression> value, He::Expression declaration)
+{
+    TRY(expression(expressions[value]));
+    TRY(scopes.declare(name.symbol(), { declaration }));
+    return {};
+}
+
+void Resolver::look_up(He::Token name)
+{
+    if (scopes.find(name.symbol()).has_value())
+        resolved++;
+    else
+        unresolved++;
+}
+
+ErrorOr<void> Resolver::expression(He::Expression expression)
+{
+    using He::ExpressionType;
+    switch (expression.type()) {
+    case ExpressionType::Block:
+        return block(expression.as_block());
+#define DECLARATION(T, variant)                                  \
+    case ExpressionType::T: {                                    \
+        auto const& variable                                     \
+            = expressions[expression.as_##variant()];            \
+        return local(variable.name, variable.value, expression); \
+    }
+        DECLARATION(PrivateConstantDeclaration,
+            private_constant_declaration);
+        DECLARATION(PrivateVariableDeclaration,
+            private_variable_declaration);
+        DECLARATION(PublicConstantDeclaration,
+            public_constant_declaration);
+        DECLARATION(PublicVariableDeclaration,
+            public_variable_declaration);
+#undef DECLARATION
+    case ExpressionType::VariableAssignment: {
+        auto const& assignment
+            = expressions[expression.as_variable_assignment()];
+        look_up(assignment.name);
+        auto const& value = expressions[assignment.value];
+        return expressions_in(expressions[value.expressions]);
+    }
+    case ExpressionType::MutableReference: {
+        auto const& reference
+            = expressions[expression.as_mutable_reference()];
+        look_up(expressions[reference.lvalue].token);
+        return {};
+    }
+    case ExpressionType::LValue:
+        look_up(expressions[expression.as_lvalue()].token);
+        return {};
+    case ExpressionType::RValue: {
+        auto const& rvalue = expressions[expression.as_rvalue()];
+        return expressions_in(expressions[rvalue.expressions]);
+    }
+    case ExpressionType::BinaryOperation: {
+        auto const& operation
+            = expressions[expression.as_binary_operation()];
+        auto operands = operation.operand_range();
+        return expressions_in(expressions[operands]);
+    }
+    case ExpressionType::UnaryOperation: {
+        auto const& operation
+            = expressions[expression.as_unary_operation()];
+        auto operands = operation.operand_range();
+        return expressions_in(expressions[operands]);
+    }
+    case ExpressionType::If: {
+        auto const& if_ = expressions[expression.as_if_statement()];
+        auto const& condition = expressions[if_.condition];
+        TRY(expressions_in(expressions[condition.expressions]));
+        return block(if_.block);
+    }
+    case ExpressionType::While: {
+        auto const& while_
+            = expressions[expression.as_while_statement()];
+        auto const& condition = expressions[while_.condition];
+        TRY(expressions_in(expressions[condition.expressions]));
+        return block(while_.block);
+    }
+    case ExpressionType::Return: {
+        auto const& return_
+            = expressions[expression.as_return_statement()];
+        return this->expression(expressions[return_.value]);
+    }
+    case ExpressionType::FunctionCall: {
+        auto const& call
+            = expressions[expression.as_function_call()];
+        look_up(call.name);
+        return expressions_in(expressions[call.arguments]);
+    }
+    default: return {};
+    }
+}
+
+u32 expression_count(He::ParsedExpressions const& expressions)
+{
+    u32 count = 0;
+#define X(T, name, ...) count += expressions.name##s.size();
+    EXPRESSIONS
+#undef X
+    return count;
+}
+
+void sort(Vector<u64>& timings)
+{
+    for (u32 i = 1; i < timings.size(); i++) {
+        auto timing = timings[i];
+        auto j = i;
+        for (; j > 0 && timings[j - 1] > timing; j--)
+            timings[j] = timings[j - 1];
+        timings[j] = timing;
+    }
+}
+
+// NOTE: Sorts `timings` in place.
+ErrorOr<void> show_stage(StringView name, Vector<u64>& timings,
+    Counts counts)
+{
+    sort(timings);
+    auto min = timings[0];
+    auto median = timings[timings.size() / 2];
+    auto max = timings[timings.size() - 1];
+
+    // NOTE: Throughput is taken at the median, which moves the
+    //       least between runs.
+    auto seconds = (double)(median ?: 1) / 1e9;
+    auto buffer = StringBuffer();
+    auto bytes = __builtin_snprintf(buffer.mutable_data(),
+        buffer.capacity(),
+        "  %-9.*s min %8.3f  median %8.3f  max %8.3f ms"
+        " | %8.2f Mtok/s %8.2f Mexpr/s %8.2f MB/s\n",
+        name.size, name.data, (double)min / 1e6,
+        (double)median / 1e6, (double)max / 1e6,
+        counts.tokens / seconds / 1e6,
+        counts.expressions / seconds / 1e6,
+        counts.bytes / seconds / 1e6);
+    TRY(Core::File::stdout().write(
+        StringView { buffer.data(), (u32)bytes }));
+    return {};
+}
+
+// NOTE: Sorts `timings` in place.
+ErrorOr<void> show_lookups(StringView name, Vector<u64>& timings,
+    u32 lookups)
+{
+    sort(timings);
+    auto min = timings[0];
+    auto median = timings[timings.size() / 2];
+    auto max = timings[timings.size() - 1];
+    auto buffer = StringBuffer();
+    auto bytes = __builtin_snprintf(buffer.mutable_data(),
+        buffer.capacity(),
+        "  %-9.*s min %8.3f  median %8.3f  max %8.3f ms"
+        " | %8.2f ns/lookup\n",
+        name.size, name.data, (double)min / 1e6,
+        (double)median / 1e6, (double)max / 1e6,
+        (double)median / (lookups ?: 1));
+    TRY(Core::File::stdout().write(
+        StringView { buffer.data(), (u32)bytes }));
+    return {};
+}
+
+}
@@ -17,7 +17,8 @@ ErrorOr<File> File::open_for_writing(StringView path, mode_t mode)
 
 ErrorOr<File> File::open_for_writing(c_string path, mode_t mode)
 {
-    auto fd = TRY(Core::System::open(path, O_WRONLY, mode));
+    auto fd = TRY(Core::System::open(path, O_WRONLY | O_TRUNC,
+        mode));
     return File(fd, true);
 }
 
@@ -0,0 +1,40 @@
+#include "StreamedFile.h"
+#include "System.h"
+
+namespace Core {
+
+// NOTE: Sources are indexed with u32, and the last byte is kept as
+//       a zero terminator.
+static constexpr usize reserved_size = 4LU * 1024 * 1024 * 1024;
+static constexpr u32 max_read_size = 1024 * 1024;
+
+ErrorOr<StreamedFile> StreamedFile::create(int fd)
+{
+    auto* data = TRY(System::mmap(reserved_size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE));
+    return StreamedFile((char*)data, fd);
+}
+
+StreamedFile::~StreamedFile()
+{
+    if (is_valid()) {
+        System::munmap(m_data, reserved_size).ignore();
+        invalidate();
+    }
+}
+
+ErrorOr<u32> StreamedFile::read_some()
+{
+    usize space_left = reserved_size - 1 - m_size;
+    if (space_left == 0)
+        return Error::from_string_literal("file is too large");
+    usize size = max_read_size;
+    if (size > space_left)
+        size = space_left;
+    u32 read = TRY(System::read(m_fd, &m_data[m_size], size));
+    m_size += read;
+    return read;
+}
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <Ty/ErrorOr.h>
+#include <Ty/StringView.h>
+
+namespace Core {
+
+// NOTE: Reads files that can not be mapped, like pipes, into a
+//       reserved range of address space. Pages only get used once
+//       they are read into and the data never moves, so views of
+//       it stay valid as it grows. The bytes after the ones read so
+//       far are always zero.
+struct StreamedFile {
+    char* m_data;
+    u32 m_size;
+    int m_fd;
+
+    StreamedFile(StreamedFile&& other)
+        : m_data(other.m_data)
+        , m_size(other.m_size)
+        , m_fd(other.m_fd)
+    {
+        other.invalidate();
+    }
+
+    // NOTE: Does not take ownership of `fd`.
+    static ErrorOr<StreamedFile> create(int fd);
+    ~StreamedFile();
+
+    // NOTE: Returns the number of bytes read, zero at end of file.
+    ErrorOr<u32> read_some();
+
+    StringView view() const { return StringView(m_data, m_size); }
+
+    bool is_valid() const { return m_data != nullptr; }
+    void invalidate() { m_data = nullptr; }
+
+private:
+    constexpr StreamedFile(char* data, int fd)
+        : m_data(data)
+        , m_size(0)
+        , m_fd(fd)
+    {
+    }
+};
+
+}
@@ -2,8 +2,11 @@
 #include "Syscall.h"
 #include "Ty/Defer.h"
 #include "Ty/StringBuffer.h"
-#include <stdlib.h> // mkstemps()
-#include <unistd.h> // sysconf()
+#include <stdio.h>    // rename()
+#include <stdlib.h>   // mkstemps(), mkdtemp()
+#include <sys/stat.h> // mkdir()
+#include <time.h>     // clock_gettime()
+#include <unistd.h>   // sysconf()
 
 namespace Core::System {
 
@@ -122,6 +125,14 @@ ErrorOr<Stat> stat(c_string path)
     return Stat(stat);
 }
 
+ErrorOr<usize> read(int fd, void* data, usize size)
+{
+    auto rv = syscall(Syscall::read, fd, data, size);
+    if (rv < 0)
+        return Error::from_syscall(rv);
+    return rv;
+}
+
 ErrorOr<usize> write(int fd, void const* data, usize size)
 {
     auto rv = syscall(Syscall::write, fd, data, size);
@@ -237,6 +248,20 @@ ErrorOr<void> unlink(c_string path)
     return {};
 }
 
+ErrorOr<void> rename(c_string from, c_string to)
+{
+    if (::rename(from, to) < 0)
+        return Error::from_errno();
+    return {};
+}
+
+ErrorOr<void> mkdir(c_string path, mode_t mode)
+{
+    if (::mkdir(path, mode) < 0)
+        return Error::from_errno();
+    return {};
+}
+
 ErrorOr<int> mkstemps(char* template_, int suffixlen)
 {
     int fd = ::mkstemps(template_, suffixlen);
@@ -250,6 +275,13 @@ ErrorOr<int> mkstemps(char* template_)
     return TRY(mkstemps(template_, 0));
 }
 
+ErrorOr<void> mkdtemp(char* template_)
+{
+    if (!::mkdtemp(template_))
+        return Error::from_errno();
+    return {};
+}
+
 ErrorOr<pid_t> posix_spawnp(c_string file, c_string const* argv,
     c_string const* envp,
     posix_spawn_file_actions_t const* file_actions,
@@ -311,6 +343,14 @@ ErrorOr<u32> page_size()
     return size;
 }
 
+ErrorOr<u64> monotonic_nanoseconds()
+{
+    struct timespec time;
+    if (::clock_gettime(CLOCK_MONOTONIC, &time) < 0)
+        return Error::from_errno();
+    return (u64)time.tv_sec * 1000000000 + (u64)time.tv_nsec;
+}
+
 Optional<c_string> getenv(StringView name)
 {
     for (u32 i = 0; environ[i] != nullptr; i++) {
@@ -19,6 +19,9 @@ using off_t = long;
 #    warning "unimplemented"
 #endif
 
+#ifndef STDIN_FILENO
+#    define STDIN_FILENO 0
+#endif
 #ifndef STDOUT_FILENO
 #    define STDOUT_FILENO 1
 #endif
@@ -203,6 +206,7 @@ namespace Core::System {
 #    warning "unimplemented"
 #endif
 
+ErrorOr<usize> read(int fd, void* data, usize size);
 ErrorOr<usize> write(int fd, MappedFile const& file);
 ErrorOr<usize> write(int fd, StringBuffer const& string);
 ErrorOr<usize> write(int fd, StringView string);
@@ -241,11 +245,14 @@ ErrorOr<Stat> fstat(int fd);
 
 ErrorOr<int> mkstemps(char* template_);
 ErrorOr<int> mkstemps(char* template_, int suffixlen);
+ErrorOr<void> mkdtemp(char* template_);
 ErrorOr<int> open(c_string path, int flags);
 ErrorOr<int> open(c_string path, int flags, mode_t mode);
 ErrorOr<void> close(int fd);
 ErrorOr<void> remove(c_string path);
 ErrorOr<void> unlink(c_string path);
+ErrorOr<void> rename(c_string from, c_string to);
+ErrorOr<void> mkdir(c_string path, mode_t mode = 0777);
 
 ErrorOr<pid_t> posix_spawnp(c_string file, c_string const* argv,
     c_string const* envp = environ,
@@ -266,6 +273,8 @@ ErrorOr<long> sysconf(int name);
 
 ErrorOr<u32> page_size();
 
+ErrorOr<u64> monotonic_nanoseconds();
+
 Optional<c_string> getenv(StringView name);
 
 ErrorOr<bool> has_program(StringView name);
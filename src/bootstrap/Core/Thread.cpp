@@ -0,0 +1,44 @@
+#include "Thread.h"
+
+namespace Core {
+
+namespace {
+
+struct Start {
+    void (*function)(void*);
+    void* argument;
+};
+
+void* start_thread(void* argument)
+{
+    auto start = *static_cast<Start*>(argument);
+    free_memory(argument);
+    start.function(start.argument);
+    return nullptr;
+}
+
+}
+
+ErrorOr<Thread> Thread::spawn(void (*function)(void*),
+    void* argument)
+{
+    auto* start = (Start*)TRY(allocate_memory(sizeof(Start)));
+    *start = Start { function, argument };
+    pthread_t handle;
+    auto rv = pthread_create(&handle, nullptr, start_thread, start);
+    if (rv != 0) {
+        free_memory(start);
+        return Error::from_errno(rv);
+    }
+    return Thread(handle);
+}
+
+ErrorOr<void> Thread::join() const
+{
+    auto rv = pthread_join(m_handle, nullptr);
+    if (rv != 0)
+        return Error::from_errno(rv);
+    return {};
+}
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <Ty/ErrorOr.h>
+#include <Ty/Memory.h>
+#include <Ty/Vector.h>
+#include <Ty/View.h>
+#include <pthread.h>
+
+namespace Core {
+
+struct Thread {
+    // NOTE: The callback is borrowed, it has to outlive the
+    //       thread until it has been joined.
+    template <typename Callback>
+    static ErrorOr<Thread> spawn(Callback& callback)
+    {
+        return spawn(
+            [](void* argument) {
+                (*static_cast<Callback*>(argument))();
+            },
+            &callback);
+    }
+
+    static ErrorOr<Thread> spawn(void (*function)(void*),
+        void* argument);
+
+    ErrorOr<void> join() const;
+
+private:
+    constexpr Thread(pthread_t handle)
+        : m_handle(handle)
+    {
+    }
+
+    pthread_t m_handle;
+};
+
+// NOTE: Runs every job, the first one on the calling thread.
+template <typename Job>
+void run_in_parallel(View<Job> jobs)
+{
+    auto created = Vector<Thread>::create(jobs.size());
+    if (created.is_error()) {
+        for (auto& job : jobs)
+            job();
+        return;
+    }
+    auto workers = created.release_value();
+    for (u32 i = 1; i < jobs.size(); i++) {
+        auto worker = Thread::spawn(jobs[i]);
+        if (worker.is_error()) {
+            jobs[i]();
+            continue;
+        }
+        workers.unchecked_append(worker.release_value());
+    }
+    if (jobs.size() != 0)
+        jobs[0]();
+    for (auto const& worker : workers)
+        MUST(worker.join());
+}
+
+}
@@ -0,0 +1,27 @@
+#include "CacheFile.h"
+#include <Core/System.h>
+
+namespace He {
+
+ErrorOr<StringBuffer> cache_path(StringView directory, u64 key,
+    StringView extension)
+{
+    char name[16];
+    for (u32 i = 0; i < 16; i++)
+        name[i] = "0123456789abcdef"[(key >> (60 - i * 4)) & 0xF];
+    return StringBuffer::create_fill(directory, "/"sv,
+        StringView(name, 16), extension);
+}
+
+ErrorOr<void> write_all(int fd, void const* data, usize size)
+{
+    auto const* bytes = (u8 const*)data;
+    while (size != 0) {
+        auto written = TRY(Core::System::write(fd, bytes, size));
+        bytes += written;
+        size -= written;
+    }
+    return {};
+}
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <Ty/Base.h>
+#include <Ty/ErrorOr.h>
+#include <Ty/StringBuffer.h>
+#include <Ty/StringView.h>
+
+namespace He {
+
+// NOTE: Shared by the parse and typecheck caches, and by the
+//       typechecker for the keys it stores in the latter.
+
+constexpr u64 mix(u64 hash, u64 value)
+{
+    hash ^= value;
+    hash *= 0xff51afd7ed558ccd;
+    return hash ^ (hash >> 32);
+}
+
+// NOTE: Four words at a time, mixed into separate lanes so the
+//       multiplies do not wait on each other.
+inline u64 mix_text(u64 hash, StringView text)
+{
+    u64 lanes[4] = { hash, ~hash, hash ^ 0x74786574, text.size };
+    u32 index = 0;
+    for (; index + 32 <= text.size; index += 32) {
+        u64 words[4];
+        __builtin_memcpy(words, &text.data[index], 32);
+        for (u32 lane = 0; lane < 4; lane++)
+            lanes[lane] = mix(lanes[lane], words[lane]);
+    }
+    for (; index + 8 <= text.size; index += 8) {
+        u64 word;
+        __builtin_memcpy(&word, &text.data[index], 8);
+        lanes[0] = mix(lanes[0], word);
+    }
+    u64 tail = 0;
+    __builtin_memcpy(&tail, &text.data[index], text.size - index);
+    hash = mix(lanes[0], tail);
+    for (u32 lane = 1; lane < 4; lane++)
+        hash = mix(hash, lanes[lane]);
+    return hash;
+}
+
+// NOTE: `directory`/<key in hex>`extension`.
+ErrorOr<StringBuffer> cache_path(StringView directory, u64 key,
+    StringView extension);
+
+ErrorOr<void> write_all(int fd, void const* data, usize size);
+
+}
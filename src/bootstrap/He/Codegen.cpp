@@ -1,4 +1,5 @@
 #include "Context.h"
+#include "Evaluate.h"
 #include "Expression.h"
 #include "Mem/Sizes.h"
 #include "Parser.h"
@@ -27,6 +28,17 @@ FORWARD_DECLARE_CODEGEN(Parameters, parameters);
 
 #undef FORWARD_DECLARE_CODEGEN
 
+// NOTE: Identifiers hold their symbol rather than their size, so
+//       their text is looked up instead of found in the source.
+//       This runs for most tokens written out, so it is inlined.
+ALWAYS_INLINE StringView text(Context const& context,
+    Token token)
+{
+    if (token.is(TokenType::Identifier))
+        return context.symbols.text(token.symbol());
+    return token.text(context.source);
+}
+
 ErrorOr<void> forward_declare_structures_short_spelling(
     StringBuffer& out, Context const&);
 
@@ -56,6 +68,12 @@ ErrorOr<void> forward_declare_top_level_public_constants(
 ErrorOr<void> forward_declare_public_functions_long_spelling(
     StringBuffer& out, Context const&);
 
+ErrorOr<void> codegen_assumed_sizes(StringBuffer& out,
+    Context const&);
+
+ErrorOr<void> codegen_constant_value(StringBuffer& out,
+    Context const&, ConstantValue, bool spell_type);
+
 }
 
 ErrorOr<StringBuffer> codegen_header(Context const& context,
@@ -85,6 +103,11 @@ ErrorOr<StringBuffer> codegen_header(Context const& context,
 ErrorOr<StringBuffer> codegen(Context const& context,
     TypecheckedExpressions const&)
 {
+    if (!context.expressions.lazy_bodies.is_empty()) {
+        return Error::from_string_literal(
+            "function bodies have not been parsed");
+    }
+
     auto out = TRY(StringBuffer::create(256 * Mem::MiB));
 
     TRY(codegen_prelude(out));
@@ -95,6 +118,7 @@ ErrorOr<StringBuffer> codegen(Context const& context,
     TRY(forward_declare_functions_short_spelling(out, context));
 
     TRY(codegen_structures(out, context));
+    TRY(codegen_assumed_sizes(out, context));
     TRY(codegen_top_level_variables(out, context));
     TRY(codegen_functions(out, context));
 
@@ -125,8 +149,7 @@ ErrorOr<void> codegen_top_level_inline_cs(StringBuffer& out,
     Context const& context)
 {
     for (auto inline_c : context.expressions.top_level_inline_cs) {
-        TRY(out.writeln(inline_c.literal.text(context.source),
-            ";"sv));
+        TRY(out.writeln(text(context, inline_c.literal), ";"sv));
     }
     return {};
 }
@@ -135,12 +158,11 @@ ErrorOr<void> forward_declare_top_level_public_variables(
     StringBuffer& out, Context const& context)
 {
     auto const& expressions = context.expressions;
-    auto source = context.source;
 
     auto const& variables = expressions.top_level_public_variables;
     for (auto variable : variables) {
-        auto type = variable.type.text(source);
-        auto name = variable.name.text(source);
+        auto type = text(context, variable.type);
+        auto name = text(context, variable.name);
         TRY(out.writeln("extern "sv, type, " "sv, name, ";"sv));
     }
 
@@ -151,12 +173,11 @@ ErrorOr<void> forward_declare_top_level_public_constants(
     StringBuffer& out, Context const& context)
 {
     auto const& expressions = context.expressions;
-    auto source = context.source;
 
     auto const& constants = expressions.top_level_public_constants;
     for (auto constant : constants) {
-        auto type = constant.type.text(source);
-        auto name = constant.name.text(source);
+        auto type = text(context, constant.type);
+        auto name = text(context, constant.name);
         TRY(out.writeln("extern "sv, type, " "sv, name, ";"sv));
     }
 
@@ -261,7 +282,7 @@ ErrorOr<void> forward_declare_structures_short_spelling(
 
     auto const& enum_declarations = expressions.enum_declarations;
     for (auto declaration : enum_declarations) {
-        auto name = declaration.name.text(context.source);
+        auto name = text(context, declaration.name);
         TRY(out.writeln("typedef enum "sv, name, " "sv, name,
             ";"sv));
     }
@@ -269,14 +290,14 @@ ErrorOr<void> forward_declare_structures_short_spelling(
     auto const& struct_declarations
         = expressions.struct_declarations;
     for (auto declaration : struct_declarations) {
-        auto name = declaration.name.text(context.source);
+        auto name = text(context, declaration.name);
         TRY(out.writeln("typedef struct "sv, name, " "sv, name,
             ";"sv));
     }
 
     auto const& union_declarations = expressions.union_declarations;
     for (auto declaration : union_declarations) {
-        auto name = declaration.name.text(context.source);
+        auto name = text(context, declaration.name);
         TRY(out.writeln("typedef union "sv, name, " "sv, name,
             ";"sv));
     }
@@ -284,7 +305,7 @@ ErrorOr<void> forward_declare_structures_short_spelling(
     auto const& variant_declarations
         = expressions.variant_declarations;
     for (auto declaration : variant_declarations) {
-        auto name = declaration.name.text(context.source);
+        auto name = text(context, declaration.name);
         TRY(out.writeln("typedef struct "sv, name, " "sv, name,
             ";"sv));
     }
@@ -300,8 +321,8 @@ ErrorOr<void> forward_declare_public_functions_long_spelling(
 
     auto const& public_functions = expressions.public_functions;
     for (auto function : public_functions) {
-        auto type = function.return_type.text(context.source);
-        auto name = function.name.text(context.source);
+        auto type = text(context, function.return_type);
+        auto name = text(context, function.name);
         TRY(out.write(type, " "sv, namespace_, "$"sv, name));
 
         auto const& parameters = expressions[function.parameters];
@@ -312,8 +333,8 @@ ErrorOr<void> forward_declare_public_functions_long_spelling(
 
     auto const& public_c_functions = expressions.public_c_functions;
     for (auto function : public_c_functions) {
-        auto type = function.return_type.text(context.source);
-        auto name = function.name.text(context.source);
+        auto type = text(context, function.return_type);
+        auto name = text(context, function.name);
         TRY(out.write(type, " "sv, name));
 
         auto const& parameters = expressions[function.parameters];
@@ -332,8 +353,8 @@ ErrorOr<void> forward_declare_functions_short_spelling(
 
     auto const& public_functions = expressions.public_functions;
     for (auto function : public_functions) {
-        auto type = function.return_type.text(context.source);
-        auto name = function.name.text(context.source);
+        auto type = text(context, function.return_type);
+        auto name = text(context, function.name);
         TRY(out.write(type, " "sv, name));
 
         auto const& parameters = expressions[function.parameters];
@@ -344,8 +365,8 @@ ErrorOr<void> forward_declare_functions_short_spelling(
 
     auto const& private_functions = expressions.private_functions;
     for (auto function : private_functions) {
-        auto type = function.return_type.text(context.source);
-        auto name = function.name.text(context.source);
+        auto type = text(context, function.return_type);
+        auto name = text(context, function.name);
         TRY(out.write("static "sv, type, " "sv, name));
 
         auto const& parameters = expressions[function.parameters];
@@ -355,8 +376,8 @@ ErrorOr<void> forward_declare_functions_short_spelling(
 
     auto const& public_c_functions = expressions.public_c_functions;
     for (auto function : public_c_functions) {
-        auto type = function.return_type.text(context.source);
-        auto name = function.name.text(context.source);
+        auto type = text(context, function.return_type);
+        auto name = text(context, function.name);
         TRY(out.write(type, " "sv, name));
 
         auto const& parameters = expressions[function.parameters];
@@ -367,8 +388,8 @@ ErrorOr<void> forward_declare_functions_short_spelling(
     auto const& private_c_functions
         = expressions.private_c_functions;
     for (auto function : private_c_functions) {
-        auto type = function.return_type.text(context.source);
-        auto name = function.name.text(context.source);
+        auto type = text(context, function.return_type);
+        auto name = text(context, function.name);
         TRY(out.write("static "sv, type, " "sv, name));
 
         auto const& parameters = expressions[function.parameters];
@@ -444,7 +465,6 @@ ErrorOr<void> codegen_functions(StringBuffer& out,
 ErrorOr<void> codegen_parameters(StringBuffer& out,
     Context const& context, Parameters const& parameters)
 {
-    auto source = context.source;
     if (parameters.is_empty()) {
         TRY(out.write("(void)"sv));
         return {};
@@ -453,12 +473,12 @@ ErrorOr<void> codegen_parameters(StringBuffer& out,
     auto last_parameter = parameters.size() - 1;
     for (u32 i = 0; i < last_parameter; i++) {
         auto parameter = parameters[i];
-        TRY(out.write(parameter.type.text(source), " "sv,
-            parameter.name.text(source), ", "sv));
+        TRY(out.write(text(context, parameter.type), " "sv,
+            text(context, parameter.name), ", "sv));
     }
     auto parameter = parameters[last_parameter];
-    TRY(out.write(parameter.type.text(source), " "sv,
-        parameter.name.text(source)));
+    TRY(out.write(text(context, parameter.type), " "sv,
+        text(context, parameter.name)));
     TRY(out.write(")"sv));
 
     return {};
@@ -467,14 +487,13 @@ ErrorOr<void> codegen_parameters(StringBuffer& out,
 ErrorOr<void> codegen_member_access(StringBuffer& out,
     Context const& context, MemberAccess const& access)
 {
-    auto source = context.source;
     auto const& members = context.expressions[access.members];
 
     for (u32 i = 0; i < members.size() - 1; i++) {
         auto member = members[i];
-        TRY(out.write(member.text(source), "."sv));
+        TRY(out.write(text(context, member), "."sv));
     }
-    TRY(out.write(members[members.size() - 1].text(source)));
+    TRY(out.write(text(context, members[members.size() - 1])));
 
     return {};
 }
@@ -482,8 +501,7 @@ ErrorOr<void> codegen_member_access(StringBuffer& out,
 ErrorOr<void> codegen_array_access(StringBuffer& out,
     Context const& context, ArrayAccess const& access)
 {
-    auto source = context.source;
-    auto name = access.name.text(source);
+    auto name = text(context, access.name);
     TRY(out.write(name, "["sv));
     auto const& index = context.expressions[access.index];
     TRY(codegen_rvalue(out, context, index));
@@ -551,9 +569,8 @@ ErrorOr<void> codegen_public_variable_declaration(StringBuffer& out,
     Context const& context,
     PublicVariableDeclaration const& variable)
 {
-    auto source = context.source;
-    TRY(out.write(variable.type.text(source), " "sv,
-        variable.name.text(source), " = "sv));
+    TRY(out.write(text(context, variable.type), " "sv,
+        text(context, variable.name), " = "sv));
     auto const& expressions = context.expressions;
     auto const& value = expressions[variable.value];
     TRY(codegen_expression(out, context, value));
@@ -566,9 +583,8 @@ ErrorOr<void> codegen_private_variable_declaration(
     StringBuffer& out, Context const& context,
     PrivateVariableDeclaration const& variable)
 {
-    auto source = context.source;
-    TRY(out.write("static "sv, variable.type.text(source), " "sv,
-        variable.name.text(source), " = "sv));
+    TRY(out.write("static "sv, text(context, variable.type), " "sv,
+        text(context, variable.name), " = "sv));
     auto const& expressions = context.expressions;
     auto const& value = expressions[variable.value];
     TRY(codegen_expression(out, context, value));
@@ -581,10 +597,19 @@ ErrorOr<void> codegen_public_constant_declaration(StringBuffer& out,
     Context const& context,
     PublicConstantDeclaration const& variable)
 {
-    auto source = context.source;
-    TRY(out.write(variable.type.text(source), " const "sv,
-        variable.name.text(source), " = "sv));
+    TRY(out.write(text(context, variable.type), " const "sv,
+        text(context, variable.name), " = "sv));
     auto const& expressions = context.expressions;
+    auto folded = context.constants
+        ? context.constants->find(expressions, variable.name)
+        : Optional<ConstantValue>();
+    if (folded.has_value()) {
+        auto is_typed = variable.type.is(TokenType::Identifier);
+        TRY(codegen_constant_value(out, context, folded.value(),
+            !is_typed));
+        TRY(out.writeln(";"sv));
+        return {};
+    }
     auto const& value = expressions[variable.value];
     TRY(codegen_expression(out, context, value));
     TRY(out.writeln(";"sv));
@@ -596,10 +621,19 @@ ErrorOr<void> codegen_private_constant_declaration(
     StringBuffer& out, Context const& context,
     PrivateConstantDeclaration const& variable)
 {
-    auto source = context.source;
-    TRY(out.write("static "sv, variable.type.text(source),
-        " const "sv, variable.name.text(source), " = "sv));
+    TRY(out.write("static "sv, text(context, variable.type),
+        " const "sv, text(context, variable.name), " = "sv));
     auto const& expressions = context.expressions;
+    auto folded = context.constants
+        ? context.constants->find(expressions, variable.name)
+        : Optional<ConstantValue>();
+    if (folded.has_value()) {
+        auto is_typed = variable.type.is(TokenType::Identifier);
+        TRY(codegen_constant_value(out, context, folded.value(),
+            !is_typed));
+        TRY(out.writeln(";"sv));
+        return {};
+    }
     auto const& value = expressions[variable.value];
     TRY(codegen_expression(out, context, value));
     TRY(out.writeln(";"sv));
@@ -610,8 +644,7 @@ ErrorOr<void> codegen_private_constant_declaration(
 ErrorOr<void> codegen_variable_assignment(StringBuffer& out,
     Context const& context, VariableAssignment const& variable)
 {
-    auto source = context.source;
-    TRY(out.write(variable.name.text(source), " = "sv));
+    TRY(out.write(text(context, variable.name), " = "sv));
     auto const& expressions = context.expressions;
     auto const& value = expressions[variable.value];
     TRY(codegen_rvalue(out, context, value));
@@ -636,11 +669,11 @@ ErrorOr<void> codegen_struct_declaration(StringBuffer& out,
     if (struct_.name.is(TokenType::Invalid))
         return {};
 
-    auto source = context.source;
-    TRY(out.writeln("struct "sv, struct_.name.text(source), "{"sv));
+    TRY(out.writeln("struct "sv, text(context, struct_.name),
+        "{"sv));
     for (auto member : context.expressions[struct_.members]) {
-        auto type = member.type.text(source);
-        auto name = member.name.text(source);
+        auto type = text(context, member.type);
+        auto name = text(context, member.name);
         TRY(out.writeln(type, " "sv, name, ";"sv));
     }
     TRY(out.writeln("};"sv));
@@ -654,16 +687,15 @@ ErrorOr<void> codegen_enum_declaration(StringBuffer& out,
     if (enum_.name.is(TokenType::Invalid))
         return {};
 
-    auto source = context.source;
-    auto enum_name = enum_.name.text(source);
+    auto enum_name = text(context, enum_.name);
     TRY(out.writeln("enum "sv, enum_name));
     if (enum_.underlying_type.type != TokenType::Invalid) {
-        TRY(out.write(" :"sv, enum_.underlying_type.text(source),
+        TRY(out.write(" :"sv, text(context, enum_.underlying_type),
             " "sv));
     }
     TRY(out.write("{"sv));
     for (auto member : context.expressions[enum_.members]) {
-        auto name = member.name.text(source);
+        auto name = text(context, member.name);
         TRY(out.writeln(enum_name, "$"sv, name, ","sv));
     }
     TRY(out.writeln("};"sv));
@@ -677,11 +709,10 @@ ErrorOr<void> codegen_union_declaration(StringBuffer& out,
     if (union_.name.is(TokenType::Invalid))
         return {};
 
-    auto source = context.source;
-    TRY(out.writeln("union "sv, union_.name.text(source), "{"sv));
+    TRY(out.writeln("union "sv, text(context, union_.name), "{"sv));
     for (auto member : context.expressions[union_.members]) {
-        auto type = member.type.text(source);
-        auto name = member.name.text(source);
+        auto type = text(context, member.type);
+        auto name = text(context, member.name);
         TRY(out.writeln(type, " "sv, name, ";"sv));
     }
     TRY(out.writeln("};"sv));
@@ -695,21 +726,20 @@ ErrorOr<void> codegen_variant_declaration(StringBuffer& out,
     if (variant.name.is(TokenType::Invalid))
         return {};
 
-    auto source = context.source;
-    auto variant_name = variant.name.text(source);
+    auto variant_name = text(context, variant.name);
     TRY(out.writeln("struct "sv, variant_name, "{"sv));
 
     TRY(out.writeln("union {"sv));
     for (auto member : context.expressions[variant.members]) {
-        auto type = member.type.text(source);
-        auto name = member.name.text(source);
+        auto type = text(context, member.type);
+        auto name = text(context, member.name);
         TRY(out.writeln(type, " "sv, name, ";"sv));
     }
     TRY(out.writeln("};"sv));
 
     TRY(out.writeln("enum {"sv));
     for (auto member : context.expressions[variant.members]) {
-        auto name = member.name.text(source);
+        auto name = text(context, member.name);
         TRY(out.writeln(variant_name, "$Type$"sv, name, ","sv));
     }
     TRY(out.writeln("} type;"sv));
@@ -722,11 +752,10 @@ ErrorOr<void> codegen_variant_declaration(StringBuffer& out,
 ErrorOr<void> codegen_struct_initializer(StringBuffer& out,
     Context const& context, StructInitializer const& initializer)
 {
-    auto source = context.source;
     auto const& expressions = context.expressions;
-    TRY(out.write("("sv, initializer.type.text(source), ") {"sv));
+    TRY(out.write("("sv, text(context, initializer.type), ") {"sv));
     for (auto member : expressions[initializer.initializers]) {
-        auto name = member.name.text(source);
+        auto name = text(context, member.name);
         TRY(out.writeln("."sv, name, "="sv));
         auto const& irvalue = context.expressions[member.value];
         TRY(codegen_rvalue(out, context, irvalue));
@@ -740,8 +769,15 @@ ErrorOr<void> codegen_struct_initializer(StringBuffer& out,
 ErrorOr<void> codegen_literal(StringBuffer& out,
     Context const& context, Literal const& literal)
 {
-    auto source = context.source;
-    TRY(out.write(literal.token.text(source)));
+    TRY(out.write(text(context, literal.token)));
+
+    return {};
+}
+
+ErrorOr<void> codegen_size_of(StringBuffer& out,
+    Context const& context, SizeOf const& size_of)
+{
+    TRY(out.write("sizeof("sv, text(context, size_of.type), ")"sv));
 
     return {};
 }
@@ -749,8 +785,7 @@ ErrorOr<void> codegen_literal(StringBuffer& out,
 ErrorOr<void> codegen_lvalue(StringBuffer& out,
     Context const& context, LValue const& lvalue)
 {
-    auto source = context.source;
-    TRY(out.write(lvalue.token.text(source)));
+    TRY(out.write(text(context, lvalue.token)));
 
     return {};
 }
@@ -766,6 +801,76 @@ ErrorOr<void> codegen_rvalue(StringBuffer& out,
     return {};
 }
 
+// NOTE: Without the spaces "a - -b" would come out as the
+//       decrement "a--b".
+constexpr StringView spaced_binary_operator(TokenType type)
+{
+    switch (type) {
+    case TokenType::Equals: return " == "sv;
+    case TokenType::LessThan: return " < "sv;
+    case TokenType::LessThanOrEqual: return " <= "sv;
+    case TokenType::GreaterThan: return " > "sv;
+    case TokenType::GreaterThanOrEqual: return " >= "sv;
+    case TokenType::Plus: return " + "sv;
+    case TokenType::Minus: return " - "sv;
+    case TokenType::Star: return " * "sv;
+    case TokenType::Slash: return " / "sv;
+    default: return token_type_spelling(type);
+    }
+}
+
+// NOTE: Operands binding looser than their operator need
+//       parentheses. Trees parsed from source never have any, as
+//       the parser follows C precedence.
+ErrorOr<void> codegen_operand(StringBuffer& out,
+    Context const& context, Expression const& operand,
+    u8 minimum_precedence)
+{
+    auto precedence = unary_precedence;
+    if (operand.type() == ExpressionType::BinaryOperation) {
+        auto id = operand.as_binary_operation();
+        precedence = binary_precedence(context.expressions[id].op);
+    }
+    if (precedence >= minimum_precedence)
+        return codegen_expression_in_rvalue(out, context, operand);
+
+    TRY(out.write("("sv));
+    TRY(codegen_expression_in_rvalue(out, context, operand));
+    TRY(out.write(")"sv));
+    return {};
+}
+
+ErrorOr<void> codegen_binary_operation(StringBuffer& out,
+    Context const& context, BinaryOperation const& operation)
+{
+    auto operands = context.expressions[operation.operand_range()];
+    auto precedence = binary_precedence(operation.op);
+    TRY(codegen_operand(out, context, operands[0], precedence));
+    TRY(out.write(spaced_binary_operator(operation.op)));
+    // NOTE: Binary operators are left associative.
+    TRY(codegen_operand(out, context, operands[1], precedence + 1));
+
+    return {};
+}
+
+ErrorOr<void> codegen_unary_operation(StringBuffer& out,
+    Context const& context, UnaryOperation const& operation)
+{
+    auto operand = context.expressions[operation.operand_range()];
+    TRY(out.write(token_type_spelling(operation.op)));
+    // NOTE: Likewise "- -a" is not the decrement "--a", nor is
+    //       "& &a" the address of a label.
+    if (operand[0].type() == ExpressionType::UnaryOperation) {
+        auto inner = operand[0].as_unary_operation();
+        if (context.expressions[inner].op == operation.op)
+            TRY(out.write(" "sv));
+    }
+    TRY(codegen_operand(out, context, operand[0],
+        unary_precedence));
+
+    return {};
+}
+
 ErrorOr<void> codegen_if_statement(StringBuffer& out,
     Context const& context, If const& if_statement)
 {
@@ -808,10 +913,9 @@ ErrorOr<void> codegen_block(StringBuffer& out,
 ErrorOr<void> codegen_private_function(StringBuffer& out,
     Context const& context, PrivateFunction const& function)
 {
-    auto source = context.source;
     auto const& expressions = context.expressions;
-    TRY(out.write("static "sv, function.return_type.text(source),
-        " "sv, function.name.text(source)));
+    TRY(out.write("static "sv, text(context, function.return_type),
+        " "sv, text(context, function.name)));
     TRY(codegen_parameters(out, context,
         expressions[function.parameters]));
     TRY(codegen_block(out, context,
@@ -823,11 +927,10 @@ ErrorOr<void> codegen_private_function(StringBuffer& out,
 ErrorOr<void> codegen_public_function(StringBuffer& out,
     Context const& context, PublicFunction const& function)
 {
-    auto source = context.source;
     auto const& expressions = context.expressions;
 
-    auto name = function.name.text(source);
-    auto return_type = function.return_type.text(source);
+    auto name = text(context, function.name);
+    auto return_type = text(context, function.return_type);
     auto const& parameters = expressions[function.parameters];
     TRY(out.write(return_type, " "sv, name));
     TRY(codegen_parameters(out, context, parameters));
@@ -839,11 +942,10 @@ ErrorOr<void> codegen_public_function(StringBuffer& out,
 ErrorOr<void> codegen_private_c_function(StringBuffer& out,
     Context const& context, PrivateCFunction const& function)
 {
-    auto source = context.source;
     auto const& expressions = context.expressions;
 
-    TRY(out.write("static "sv, function.return_type.text(source),
-        " "sv, function.name.text(source)));
+    TRY(out.write("static "sv, text(context, function.return_type),
+        " "sv, text(context, function.name)));
     TRY(codegen_parameters(out, context,
         expressions[function.parameters]));
     TRY(codegen_block(out, context,
@@ -855,11 +957,10 @@ ErrorOr<void> codegen_private_c_function(StringBuffer& out,
 ErrorOr<void> codegen_public_c_function(StringBuffer& out,
     Context const& context, PublicCFunction const& function)
 {
-    auto source = context.source;
     auto const& expressions = context.expressions;
 
-    TRY(out.write(function.return_type.text(source), " "sv,
-        function.name.text(source)));
+    TRY(out.write(text(context, function.return_type), " "sv,
+        text(context, function.name)));
     TRY(codegen_parameters(out, context,
         expressions[function.parameters]));
     TRY(codegen_block(out, context,
@@ -871,11 +972,10 @@ ErrorOr<void> codegen_public_c_function(StringBuffer& out,
 ErrorOr<void> codegen_function_call(StringBuffer& out,
     Context const& context, FunctionCall const& function)
 {
-    auto source = context.source;
     auto const& expressions = context.expressions;
     auto const& arguments = expressions[function.arguments];
 
-    TRY(out.write(function.name.text(source), "("sv));
+    TRY(out.write(text(context, function.name), "("sv));
     if (arguments.is_empty()) {
         TRY(out.writeln(")"sv));
         return {};
@@ -915,8 +1015,15 @@ ErrorOr<void> codegen_throw_statement(StringBuffer&, Context const&,
 ErrorOr<void> codegen_import_he(StringBuffer& out,
     Context const& context, Import const& import_he)
 {
-    auto source = context.source;
-    auto quoted_filename = import_he.filename.text(source);
+    auto const& imports = context.expressions.import_hes;
+    if (!context.import_headers.is_empty()) {
+        auto index = &import_he - imports.data();
+        auto header = context.import_headers[index];
+        TRY(out.writeln("#include \""sv, header, "\""sv));
+        return {};
+    }
+
+    auto quoted_filename = text(context, import_he.filename);
     auto filename
         = quoted_filename.sub_view(1, quoted_filename.size - 2);
     TRY(out.writeln("#include \""sv, filename, ".h\""sv));
@@ -927,8 +1034,7 @@ ErrorOr<void> codegen_import_he(StringBuffer& out,
 ErrorOr<void> codegen_import_c(StringBuffer& out,
     Context const& context, ImportC const& import_c)
 {
-    auto source = context.source;
-    auto filename = import_c.filename.text(source);
+    auto filename = text(context, import_c.filename);
     TRY(out.writeln("#include "sv, filename));
 
     return {};
@@ -937,12 +1043,96 @@ ErrorOr<void> codegen_import_c(StringBuffer& out,
 ErrorOr<void> codegen_inline_c(StringBuffer& out,
     Context const& context, InlineC const& inline_c)
 {
-    auto source = context.source;
-    TRY(out.writeln(inline_c.literal.text(source), ";"sv));
+    TRY(out.writeln(text(context, inline_c.literal), ";"sv));
 
     return {};
 }
 
+// NOTE: Folded sizes are only right for targets that lay types
+//       out the way the evaluator did, which the C compiler is
+//       made to check.
+ErrorOr<void> codegen_assumed_sizes(StringBuffer& out,
+    Context const& context)
+{
+    if (!context.constants)
+        return {};
+    auto const& constants = *context.constants;
+    if (constants.assumes_usize) {
+        TRY(out.writeln("_Static_assert(sizeof(usize) == 8, "
+                        "\"usize is assumed to be 64 bits\");"sv));
+    }
+    for (auto assumed : constants.assumed_sizes) {
+        auto type = text(context, assumed.type);
+        TRY(out.writeln("_Static_assert(sizeof("sv, type, ") == "sv,
+            assumed.size, ", \"@size_of("sv, type,
+            ") was folded to "sv, assumed.size, "\");"sv));
+    }
+
+    return {};
+}
+
+// NOTE: C converts the values of typed constants to their type,
+//       so only untyped ones have theirs spelled out. The
+//       smallest value of a signed type has no literal, as its
+//       magnitude does not fit.
+ErrorOr<void> codegen_constant_value(StringBuffer& out,
+    Context const& context, ConstantValue value, bool spell_type)
+{
+    switch (value.kind) {
+    case ConstantKind::Integer: {
+        auto type = value.type;
+        if (spell_type && type != ScalarType::I32)
+            TRY(out.write("("sv, scalar_type_spelling(type),
+                ")"sv));
+        if (!is_signed(type)) {
+            TRY(out.write(value.integer, "u"sv));
+            return {};
+        }
+        auto integer = (i64)value.integer;
+        auto bits = scalar_type_size(type) * 8;
+        if (bits >= 32 && integer == (i64)(~0ULL << (bits - 1))) {
+            TRY(out.write("("sv, integer + 1, " - 1)"sv));
+            return {};
+        }
+        TRY(out.write(integer));
+        return {};
+    }
+    case ConstantKind::Float: {
+        auto type = value.type;
+        if (spell_type && type != ScalarType::F64)
+            TRY(out.write("("sv, scalar_type_spelling(type),
+                ")"sv));
+        // NOTE: Hexadecimal floats are exact.
+        char buffer[32];
+        auto size = __builtin_snprintf(buffer, sizeof(buffer),
+            "%a", value.floating);
+        TRY(out.write(StringView(buffer, size)));
+        return {};
+    }
+    case ConstantKind::Text:
+        TRY(out.write(text(context, value.token)));
+        return {};
+    case ConstantKind::Struct: {
+        if (spell_type)
+            TRY(out.write("("sv, text(context, value.token),
+                ") "sv));
+        TRY(out.write("{"sv));
+        for (auto member : context.constants->members_of(value)) {
+            TRY(out.write("."sv, text(context, member.name),
+                "="sv));
+            TRY(codegen_constant_value(out, context, member.value,
+                false));
+            TRY(out.write(","sv));
+        }
+        TRY(out.write("}"sv));
+        return {};
+    }
+    case ConstantKind::Unknown: break;
+    }
+    return Error::from_string_literal(
+        "trying to codegen unknown constant");
+}
+
 ErrorOr<void> codegen_uninitialized(StringBuffer& out,
     Context const&, Uninitialized const&)
 {
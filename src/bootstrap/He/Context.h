@@ -1,4 +1,6 @@
 #pragma once
+#include "Evaluate.h"
+#include "Interner.h"
 #include "Parser.h"
 #include "SourceFile.h"
 
@@ -8,6 +10,24 @@ struct Context {
     StringView source;
     StringView namespace_;
     ParsedExpressions const& expressions;
+    Interner const& symbols;
+
+    // NOTE: Header to include for every @import, in order. Left
+    //       empty, the imported file name is used with ".h"
+    //       appended.
+    View<StringView const> import_headers { nullptr, 0 };
+
+    // NOTE: Only used to point at errors.
+    StringView file_name {};
+
+    // NOTE: Tokens the expressions were parsed from. Only needed
+    //       by typecheck_incrementally().
+    View<Token const> tokens { nullptr, 0 };
+
+    // NOTE: Values codegen writes in place of the initializers of
+    //       top level constants. Left unset, every initializer is
+    //       written as it was.
+    ConstantValues const* constants { nullptr };
 };
 
 }
@@ -0,0 +1,835 @@
+#include "Evaluate.h"
+#include "Context.h"
+#include "Expression.h"
+#include "Typecheck.h"
+#include <Core/File.h>
+#include <Ty/Defer.h>
+#include <stdlib.h> // strtod()
+
+namespace He {
+
+namespace {
+
+// NOTE: Deeper expressions and longer chains of constants naming
+//       each other than this are left unknown, which keeps the
+//       evaluator from running out of stack.
+constexpr u32 max_depth = 128;
+
+enum class Evaluation : u8 {
+    NotStarted,
+    InProgress,
+    InCycle,
+    Done,
+};
+
+struct Layout {
+    u32 size { 0 };
+    u32 alignment { 1 };
+};
+
+constexpr ConstantValue integer(ScalarType type, u64 bits)
+{
+    auto size = scalar_type_size(type);
+    if (size < 8) {
+        auto shift = 64 - size * 8;
+        bits <<= shift;
+        if (is_signed(type))
+            bits = (u64)((i64)bits >> shift);
+        else
+            bits >>= shift;
+    }
+    return {
+        .kind = ConstantKind::Integer,
+        .type = type,
+        .integer = bits,
+    };
+}
+
+constexpr ConstantValue floating(ScalarType type, f64 value)
+{
+    if (!__builtin_isfinite(value))
+        return {};
+    return {
+        .kind = ConstantKind::Float,
+        .type = type,
+        .floating = value,
+    };
+}
+
+constexpr bool is_scalar(ConstantValue value)
+{
+    return value.kind == ConstantKind::Integer
+        || value.kind == ConstantKind::Float;
+}
+
+constexpr i128 as_i128(ConstantValue value)
+{
+    if (is_signed(value.type))
+        return (i64)value.integer;
+    return value.integer;
+}
+
+// NOTE: Unsigned types wrap around, signed ones have no value out
+//       of their range.
+constexpr ConstantValue from_i128(ScalarType type, i128 value)
+{
+    if (!is_signed(type))
+        return integer(type, (u64)value);
+    auto bits = scalar_type_size(type) * 8;
+    auto max = ((i128)1 << (bits - 1)) - 1;
+    if (value > max || value < -max - 1)
+        return {};
+    return integer(type, (u64)value);
+}
+
+constexpr ConstantValue convert(ConstantValue value, ScalarType to)
+{
+    if (!is_scalar(value))
+        return {};
+    if (value.kind == ConstantKind::Integer) {
+        auto is_from_signed = is_signed(value.type);
+        auto as_signed = (i64)value.integer;
+        switch (to) {
+        case ScalarType::F32:
+            if (is_from_signed)
+                return floating(to, (f32)as_signed);
+            return floating(to, (f32)value.integer);
+        case ScalarType::F64:
+            if (is_from_signed)
+                return floating(to, (f64)as_signed);
+            return floating(to, (f64)value.integer);
+        default: return from_i128(to, as_i128(value));
+        }
+    }
+
+    auto value_of = value.floating;
+    if (to == ScalarType::F32)
+        return floating(to, (f32)value_of);
+    if (to == ScalarType::F64)
+        return floating(to, value_of);
+
+    // NOTE: Floats convert to integers by truncation, and have no
+    //       value when the truncated one is out of range.
+    auto truncated = __builtin_trunc(value_of);
+    auto limit = (f64)((u64)1 << (scalar_type_size(to) * 8 - 1));
+    if (is_signed(to)) {
+        if (!(truncated >= -limit && truncated < limit))
+            return {};
+        return integer(to, (u64)(i64)truncated);
+    }
+    if (!(truncated >= 0 && truncated < limit * 2))
+        return {};
+    return integer(to, (u64)truncated);
+}
+
+constexpr ScalarType promoted(ScalarType type)
+{
+    if (is_floating(type) || scalar_type_size(type) >= 4)
+        return type;
+    return ScalarType::I32;
+}
+
+// NOTE: The usual arithmetic conversions of C, for operands that
+//       have been promoted already.
+constexpr ScalarType common_type(ScalarType left, ScalarType right)
+{
+    if (is_floating(left) || is_floating(right)) {
+        if (left == ScalarType::F64 || right == ScalarType::F64)
+            return ScalarType::F64;
+        return ScalarType::F32;
+    }
+    if (left == right)
+        return left;
+    auto left_size = scalar_type_size(left);
+    auto right_size = scalar_type_size(right);
+    if (is_signed(left) == is_signed(right))
+        return left_size >= right_size ? left : right;
+    auto unsigned_type = is_signed(left) ? right : left;
+    auto signed_type = is_signed(left) ? left : right;
+    if (scalar_type_size(unsigned_type)
+        >= scalar_type_size(signed_type))
+        return unsigned_type;
+    return signed_type;
+}
+
+constexpr ConstantValue truth(bool value)
+{
+    return integer(ScalarType::I32, value ? 1 : 0);
+}
+
+template <typename T>
+constexpr ConstantValue compare(TokenType op, T left, T right)
+{
+    switch (op) {
+    case TokenType::Equals: return truth(left == right);
+    case TokenType::LessThan: return truth(left < right);
+    case TokenType::LessThanOrEqual: return truth(left <= right);
+    case TokenType::GreaterThan: return truth(left > right);
+    case TokenType::GreaterThanOrEqual:
+        return truth(left >= right);
+    default: return {};
+    }
+}
+
+constexpr bool is_comparison(TokenType op)
+{
+    switch (op) {
+    case TokenType::Equals:
+    case TokenType::LessThan:
+    case TokenType::LessThanOrEqual:
+    case TokenType::GreaterThan:
+    case TokenType::GreaterThanOrEqual:
+        return true;
+    default:
+        return false;
+    }
+}
+
+template <typename T>
+constexpr ConstantValue floating_arithmetic(TokenType op,
+    ScalarType type, T left, T right)
+{
+    switch (op) {
+    case TokenType::Plus: return floating(type, left + right);
+    case TokenType::Minus: return floating(type, left - right);
+    case TokenType::Star: return floating(type, left * right);
+    case TokenType::Slash:
+        if (right == 0)
+            return {};
+        return floating(type, left / right);
+    default: return {};
+    }
+}
+
+constexpr ConstantValue arithmetic(TokenType op,
+    ConstantValue left, ConstantValue right)
+{
+    if (!is_scalar(left) || !is_scalar(right))
+        return {};
+    auto type
+        = common_type(promoted(left.type), promoted(right.type));
+    left = convert(left, type);
+    right = convert(right, type);
+    if (!left.is_known() || !right.is_known())
+        return {};
+
+    if (type == ScalarType::F32) {
+        auto left_value = (f32)left.floating;
+        auto right_value = (f32)right.floating;
+        if (is_comparison(op))
+            return compare(op, left_value, right_value);
+        return floating_arithmetic(op, type, left_value,
+            right_value);
+    }
+    if (type == ScalarType::F64) {
+        if (is_comparison(op))
+            return compare(op, left.floating, right.floating);
+        return floating_arithmetic(op, type, left.floating,
+            right.floating);
+    }
+
+    if (!is_signed(type)) {
+        auto left_value = left.integer;
+        auto right_value = right.integer;
+        if (is_comparison(op))
+            return compare(op, left_value, right_value);
+        switch (op) {
+        case TokenType::Plus:
+            return integer(type, left_value + right_value);
+        case TokenType::Minus:
+            return integer(type, left_value - right_value);
+        case TokenType::Star:
+            return integer(type, left_value * right_value);
+        case TokenType::Slash:
+            if (right_value == 0)
+                return {};
+            return integer(type, left_value / right_value);
+        default: return {};
+        }
+    }
+
+    auto left_value = as_i128(left);
+    auto right_value = as_i128(right);
+    if (is_comparison(op))
+        return compare(op, left_value, right_value);
+    switch (op) {
+    case TokenType::Plus:
+        return from_i128(type, left_value + right_value);
+    case TokenType::Minus:
+        return from_i128(type, left_value - right_value);
+    case TokenType::Star:
+        return from_i128(type, left_value * right_value);
+    case TokenType::Slash:
+        if (right_value == 0)
+            return {};
+        return from_i128(type, left_value / right_value);
+    default: return {};
+    }
+}
+
+// NOTE: Decimal literals are ints if they fit and longs if not,
+//       while octal ones may be unsigned as well, as in C.
+constexpr ConstantValue integer_literal(StringView text)
+{
+    auto base = 10;
+    if (text.size > 1 && text[0] == '0')
+        base = 8;
+    u64 value = 0;
+    for (u32 i = 0; i < text.size; i++) {
+        auto digit = (u64)(text[i] - '0');
+        if (digit >= (u64)base)
+            return {};
+        if (value > (~(u64)0 - digit) / base)
+            return {};
+        value = value * base + digit;
+    }
+    if (value <= 0x7FFFFFFF)
+        return integer(ScalarType::I32, value);
+    if (base == 8 && value <= 0xFFFFFFFF)
+        return integer(ScalarType::U32, value);
+    if (value <= 0x7FFFFFFFFFFFFFFF)
+        return integer(ScalarType::I64, value);
+    if (base == 8)
+        return integer(ScalarType::U64, value);
+    return {};
+}
+
+ConstantValue floating_literal(StringView text)
+{
+    u32 dots = 0;
+    for (u32 i = 0; i < text.size; i++)
+        dots += text[i] == '.';
+    char buffer[128];
+    if (dots != 1 || text.size >= sizeof(buffer))
+        return {};
+    text.unchecked_copy_to(buffer);
+    buffer[text.size] = '\0';
+    return floating(ScalarType::F64, strtod(buffer, nullptr));
+}
+
+struct Evaluator {
+    ParsedExpressions const& expressions;
+    StringView source;
+    ConstantValues& output;
+    Vector<Evaluation> states;
+    u32 steps_left { 0 };
+    u32 depth { 0 };
+
+    ErrorOr<ConstantValue> constant(u32 declaration);
+    ErrorOr<ConstantValue> expression(Expression);
+    ErrorOr<ConstantValue> rvalue(RValue const&);
+    ErrorOr<ConstantValue> name(Token);
+    ErrorOr<ConstantValue> member_access(MemberAccess const&);
+    ErrorOr<ConstantValue> struct_initializer(
+        StructInitializer const&);
+    ErrorOr<ConstantValue> size_of(Token type);
+
+    ConstantValue literal(Token) const;
+    ConstantValue enum_value(Token) const;
+    ConstantValue converted(Token type, ConstantValue);
+    Optional<Layout> layout(Token type, u32 depth);
+
+    Optional<Expression> declaration_of(Token) const;
+    Optional<Id<Members>> struct_members(Token type) const;
+    Optional<ScalarType> enum_type(Token type) const;
+    Optional<ScalarType> scalar_type_of(Token type) const;
+};
+
+}
+
+Optional<ScalarType> scalar_type(StringView name)
+{
+    struct Alias {
+        StringView name;
+        ScalarType type;
+    };
+    static constexpr Alias aliases[] = {
+#define X(T, spelling, ...) { spelling##sv, ScalarType::T },
+        SCALAR_TYPES
+#undef X
+        { "c_short"sv, ScalarType::I16 },
+        { "c_int"sv, ScalarType::I32 },
+        { "c_longlong"sv, ScalarType::I64 },
+        { "c_uchar"sv, ScalarType::U8 },
+        { "c_ushort"sv, ScalarType::U16 },
+        { "c_uint"sv, ScalarType::U32 },
+        { "c_ulonglong"sv, ScalarType::U64 },
+        { "c_float"sv, ScalarType::F32 },
+        { "c_double"sv, ScalarType::F64 },
+    };
+    for (auto alias : aliases) {
+        if (alias.name == name)
+            return alias.type;
+    }
+    return {};
+}
+
+ErrorOr<ConstantValues> ConstantValues::create()
+{
+    return ConstantValues {
+        .values = TRY(Vector<ConstantValue>::create()),
+        .members = TRY(Vector<ConstantMember>::create()),
+        .assumed_sizes = TRY(Vector<AssumedSize>::create()),
+    };
+}
+
+Optional<ConstantValue> ConstantValues::find(
+    ParsedExpressions const& expressions, Token name) const
+{
+    if (name.is_not(TokenType::Identifier))
+        return {};
+    auto symbol = name.symbol().raw();
+    if (symbol >= expressions.declaration_slots.size())
+        return {};
+    auto slot = expressions.declaration_slots[symbol];
+    if (slot == ParsedExpressions::no_declaration)
+        return {};
+    if (slot >= values.size() || !values[slot].is_known())
+        return {};
+
+    // NOTE: Only the first of several declarations of a name is
+    //       found by it.
+    auto declaration = expressions.declarations[slot];
+    auto declared = expressions.declaration_name(declaration);
+    if (declared.start_index != name.start_index)
+        return {};
+    return values[slot];
+}
+
+bool ConstantValues::has_errors() const
+{
+    return !cycles.is_empty();
+}
+
+ErrorOr<void> ConstantValues::show_errors(
+    Context const& context) const
+{
+    for (auto name : cycles) {
+        auto error = TypecheckError {
+            .message = "constant defined in terms of itself"sv,
+            .offending_token = name,
+        };
+        TRY(error.show(context));
+        TRY(Core::File::stderr().write("\n"sv));
+    }
+    return {};
+}
+
+ErrorOr<ConstantValues> evaluate_constants(Context const& context,
+    u32 step_budget)
+{
+    auto const& expressions = context.expressions;
+    auto output = TRY(ConstantValues::create());
+    auto declaration_count = expressions.declarations.size();
+    TRY(output.values.ensure_capacity(declaration_count));
+    auto states
+        = TRY(Vector<Evaluation>::create(declaration_count));
+    for (u32 i = 0; i < declaration_count; i++) {
+        output.values.unchecked_append({});
+        states.unchecked_append(Evaluation::NotStarted);
+    }
+
+    auto evaluator = Evaluator {
+        .expressions = expressions,
+        .source = context.source,
+        .output = output,
+        .states = move(states),
+        .steps_left = step_budget,
+    };
+    for (u32 i = 0; i < declaration_count; i++)
+        TRY(evaluator.constant(i));
+    return output;
+}
+
+namespace {
+
+ErrorOr<ConstantValue> Evaluator::constant(u32 declaration)
+{
+    auto expression = expressions.declarations[declaration];
+    Token type {};
+    Id<Expression> value {};
+    switch (expression.type()) {
+    case ExpressionType::PrivateConstantDeclaration: {
+        auto const& constant = expressions
+            [expression.as_private_constant_declaration()];
+        type = constant.type;
+        value = constant.value;
+    } break;
+    case ExpressionType::PublicConstantDeclaration: {
+        auto const& constant = expressions
+            [expression.as_public_constant_declaration()];
+        type = constant.type;
+        value = constant.value;
+    } break;
+    default: return ConstantValue {};
+    }
+
+    switch (states[declaration]) {
+    case Evaluation::Done: return output.values[declaration];
+    // NOTE: Constants defined in terms of themselves are reported
+    //       once, however often the cycle is reached, and have no
+    //       value. Names past the capacity are dropped.
+    case Evaluation::InProgress:
+        output.cycles
+            .append(expressions.declaration_name(expression))
+            .ignore();
+        states[declaration] = Evaluation::InCycle;
+        return ConstantValue {};
+    case Evaluation::InCycle: return ConstantValue {};
+    case Evaluation::NotStarted: break;
+    }
+
+    states[declaration] = Evaluation::InProgress;
+    auto folded = TRY(this->expression(expressions[value]));
+    auto result = converted(type, folded);
+    output.values[declaration] = result;
+    states[declaration] = Evaluation::Done;
+    return result;
+}
+
+ErrorOr<ConstantValue> Evaluator::expression(Expression expression)
+{
+    if (steps_left == 0 || depth == max_depth)
+        return ConstantValue {};
+    steps_left--;
+    output.steps++;
+    depth++;
+    Defer leave = [&] {
+        depth--;
+    };
+
+    switch (expression.type()) {
+    case ExpressionType::Literal:
+        return literal(expressions[expression.as_literal()].token);
+    case ExpressionType::SizeOf:
+        return size_of(expressions[expression.as_size_of()].type);
+    case ExpressionType::LValue:
+        return name(expressions[expression.as_lvalue()].token);
+    case ExpressionType::RValue:
+        return rvalue(expressions[expression.as_rvalue()]);
+    case ExpressionType::BinaryOperation: {
+        auto const& operation
+            = expressions[expression.as_binary_operation()];
+        auto operands = expressions[operation.operand_range()];
+        auto left = TRY(this->expression(operands[0]));
+        if (!left.is_known())
+            return ConstantValue {};
+        auto right = TRY(this->expression(operands[1]));
+        return arithmetic(operation.op, left, right);
+    }
+    case ExpressionType::UnaryOperation: {
+        auto const& operation
+            = expressions[expression.as_unary_operation()];
+        auto operand = TRY(this->expression(
+            expressions[operation.operand_range()][0]));
+        if (!is_scalar(operand))
+            return ConstantValue {};
+        auto zero = integer(ScalarType::I32, 0);
+        switch (operation.op) {
+        case TokenType::Plus:
+            return convert(operand, promoted(operand.type));
+        case TokenType::Minus:
+            return arithmetic(TokenType::Minus, zero, operand);
+        default: return ConstantValue {};
+        }
+    }
+    case ExpressionType::StructInitializer:
+        return struct_initializer(
+            expressions[expression.as_struct_initializer()]);
+    case ExpressionType::MemberAccess:
+        return member_access(
+            expressions[expression.as_member_access()]);
+    default: return ConstantValue {};
+    }
+}
+
+ErrorOr<ConstantValue> Evaluator::rvalue(RValue const& rvalue)
+{
+    if (rvalue.expressions.count != 1)
+        return ConstantValue {};
+    return expression(expressions[rvalue.expressions][0]);
+}
+
+ConstantValue Evaluator::literal(Token token) const
+{
+    if (token.is(TokenType::Quoted)) {
+        return {
+            .kind = ConstantKind::Text,
+            .token = token,
+        };
+    }
+    if (token.is_not(TokenType::Number))
+        return {};
+    auto text = token.text(source);
+    for (u32 i = 0; i < text.size; i++) {
+        if (text[i] == '.')
+            return floating_literal(text);
+    }
+    return integer_literal(text);
+}
+
+ErrorOr<ConstantValue> Evaluator::name(Token token)
+{
+    if (token.is_not(TokenType::Identifier))
+        return ConstantValue {};
+    auto symbol = token.symbol().raw();
+    if (symbol < expressions.declaration_slots.size()) {
+        auto slot = expressions.declaration_slots[symbol];
+        if (slot != ParsedExpressions::no_declaration)
+            return constant(slot);
+    }
+    return enum_value(token);
+}
+
+// NOTE: Enum values are named Enum$Member, and are the index of
+//       the member, of the underlying type of the enum if it has
+//       one and int if not.
+ConstantValue Evaluator::enum_value(Token token) const
+{
+    auto text = token.text(source);
+    u32 dollar = 0;
+    while (dollar < text.size && text[dollar] != '$')
+        dollar++;
+    if (dollar == text.size)
+        return {};
+    auto enum_name = text.part(0, dollar);
+    auto member_name = text.part(dollar + 1, text.size);
+
+    auto declaration = expressions.find_declaration(enum_name);
+    if (!declaration.has_value())
+        return {};
+    if (declaration->type() != ExpressionType::EnumDeclaration)
+        return {};
+    auto const& enum_
+        = expressions[declaration->as_enum_declaration()];
+    auto type = enum_type(enum_.name);
+    if (!type.has_value())
+        return {};
+    auto const& members = expressions[enum_.members];
+    for (u32 i = 0; i < members.size(); i++) {
+        if (members[i].name.text(source) == member_name)
+            return integer(type.value(), i);
+    }
+    return {};
+}
+
+ErrorOr<ConstantValue> Evaluator::member_access(
+    MemberAccess const& access)
+{
+    auto const& names = expressions[access.members];
+    auto value = TRY(name(names[0]));
+    for (u32 i = 1; i < names.size(); i++) {
+        if (value.kind != ConstantKind::Struct)
+            return ConstantValue {};
+
+        // NOTE: Members are read as their declared type, so the
+        //       value of a struct C knows the layout of is not.
+        auto members = struct_members(value.token);
+        if (!members.has_value())
+            return ConstantValue {};
+        Optional<Token> type {};
+        for (auto member : expressions[members.value()]) {
+            if (member.name.symbol() == names[i].symbol())
+                type = member.type;
+        }
+        if (!type.has_value())
+            return ConstantValue {};
+
+        // NOTE: Members left out of an initializer are zero.
+        auto member_value = integer(ScalarType::I32, 0);
+        for (auto member : output.members_of(value)) {
+            if (member.name.symbol() == names[i].symbol())
+                member_value = member.value;
+        }
+        value = converted(type.value(), member_value);
+    }
+    return value;
+}
+
+ErrorOr<ConstantValue> Evaluator::struct_initializer(
+    StructInitializer const& initializer)
+{
+    auto const& initializers
+        = expressions[initializer.initializers];
+    auto declared_members = struct_members(initializer.type);
+
+    auto members = TRY(
+        Vector<ConstantMember>::create(initializers.size()));
+    for (auto member : initializers) {
+        auto value = TRY(rvalue(expressions[member.value]));
+        if (!value.is_known())
+            return ConstantValue {};
+        if (declared_members.has_value()) {
+            Optional<Token> type {};
+            auto const& declared_list
+                = expressions[declared_members.value()];
+            for (auto declared : declared_list) {
+                if (declared.name.symbol() == member.name.symbol())
+                    type = declared.type;
+            }
+            if (!type.has_value())
+                return ConstantValue {};
+            value = converted(type.value(), value);
+            if (!value.is_known())
+                return ConstantValue {};
+        }
+        TRY(members.append(ConstantMember { member.name, value }));
+    }
+
+    auto first_member = output.members.size();
+    TRY(output.members.extend(members.view()));
+    return ConstantValue {
+        .kind = ConstantKind::Struct,
+        .token = initializer.type,
+        .first_member = first_member,
+        .member_count = members.size(),
+    };
+}
+
+ErrorOr<ConstantValue> Evaluator::size_of(Token type)
+{
+    auto type_layout = layout(type, 0);
+    if (!type_layout.has_value())
+        return ConstantValue {};
+    output.assumes_usize = true;
+    auto size = type_layout->size;
+    if (!scalar_type(type.text(source)).has_value()) {
+        auto is_assumed = false;
+        for (auto assumed : output.assumed_sizes)
+            is_assumed |= assumed.type.symbol() == type.symbol();
+        if (!is_assumed)
+            TRY(output.assumed_sizes.append({ type, size }));
+    }
+    return integer(ScalarType::Usize, size);
+}
+
+// NOTE: Untyped constants keep the type of their value. Typed
+//       ones are converted to their type, which has to be one
+//       the value can be converted to here: a scalar, an enum,
+//       a struct of the same name, or anything for text.
+ConstantValue Evaluator::converted(Token type, ConstantValue value)
+{
+    if (!value.is_known() || type.is_not(TokenType::Identifier))
+        return value;
+    auto scalar = scalar_type_of(type);
+    if (scalar.has_value()) {
+        if (scalar.value() == ScalarType::Usize)
+            output.assumes_usize = true;
+        return convert(value, scalar.value());
+    }
+    if (value.kind == ConstantKind::Text)
+        return value;
+    if (value.kind == ConstantKind::Struct
+        && value.token.symbol() == type.symbol())
+        return value;
+    return {};
+}
+
+// NOTE: Structs are laid out the way C compilers for the targets
+//       of the generated code do, with every member aligned to
+//       its size. Codegen asserts the sizes folded from this.
+Optional<Layout> Evaluator::layout(Token type, u32 depth)
+{
+    if (depth == max_depth)
+        return {};
+    auto scalar = scalar_type_of(type);
+    if (scalar.has_value()) {
+        if (scalar.value() == ScalarType::Usize)
+            output.assumes_usize = true;
+        auto size = scalar_type_size(scalar.value());
+        return Layout { size, size };
+    }
+
+    auto declaration = declaration_of(type);
+    if (!declaration.has_value())
+        return {};
+    auto is_union = false;
+    Id<Members> members_id {};
+    auto kind = declaration->type();
+    if (kind == ExpressionType::StructDeclaration) {
+        auto id = declaration->as_struct_declaration();
+        members_id = expressions[id].members;
+    } else if (kind == ExpressionType::UnionDeclaration) {
+        auto id = declaration->as_union_declaration();
+        members_id = expressions[id].members;
+        is_union = true;
+    } else {
+        return {};
+    }
+
+    auto const& members = expressions[members_id];
+    if (members.is_empty())
+        return {};
+    auto result = Layout {};
+    for (auto member : members) {
+        auto member_layout = layout(member.type, depth + 1);
+        if (!member_layout.has_value())
+            return {};
+        auto alignment = member_layout->alignment;
+        if (alignment > result.alignment)
+            result.alignment = alignment;
+        if (is_union) {
+            if (member_layout->size > result.size)
+                result.size = member_layout->size;
+            continue;
+        }
+        result.size = (result.size + alignment - 1) / alignment
+                * alignment
+            + member_layout->size;
+    }
+    auto alignment = result.alignment;
+    result.size
+        = (result.size + alignment - 1) / alignment * alignment;
+    return result;
+}
+
+Optional<Expression> Evaluator::declaration_of(Token name) const
+{
+    if (name.is_not(TokenType::Identifier))
+        return {};
+    return expressions.find_declaration(name.symbol());
+}
+
+Optional<Id<Members>> Evaluator::struct_members(Token type) const
+{
+    auto declaration = declaration_of(type);
+    if (!declaration.has_value())
+        return {};
+    if (declaration->type() != ExpressionType::StructDeclaration)
+        return {};
+    auto id = declaration->as_struct_declaration();
+    return expressions[id].members;
+}
+
+// NOTE: Type of the values of the enum named `type`. C leaves the
+//       size of enums without an underlying type to the target,
+//       but their values are ints.
+Optional<ScalarType> Evaluator::enum_type(Token type) const
+{
+    auto declaration = declaration_of(type);
+    if (!declaration.has_value())
+        return {};
+    if (declaration->type() != ExpressionType::EnumDeclaration)
+        return {};
+    auto const& enum_
+        = expressions[declaration->as_enum_declaration()];
+    if (enum_.underlying_type.is(TokenType::Invalid))
+        return ScalarType::I32;
+    auto type_name = enum_.underlying_type.text(source);
+    auto scalar = scalar_type(type_name);
+    if (!scalar.has_value() || is_floating(scalar.value()))
+        return {};
+    return scalar;
+}
+
+Optional<ScalarType> Evaluator::scalar_type_of(Token type) const
+{
+    auto scalar = scalar_type(type.text(source));
+    if (scalar.has_value())
+        return scalar;
+    return enum_type(type);
+}
+
+}
+
+}
@@ -0,0 +1,171 @@
+#pragma once
+#include "Expression.h"
+#include "Token.h"
+#include <Ty/ErrorOr.h>
+#include <Ty/Optional.h>
+#include <Ty/SmallVector.h>
+#include <Ty/Vector.h>
+
+namespace He {
+
+struct Context;
+
+// NOTE: Arithmetic types constants are folded in. Their sizes are
+//       what every target of the generated code agrees on, except
+//       for usize, which codegen asserts when it is used.
+#define SCALAR_TYPES                   \
+    X(I8, "i8", 1, true, false)        \
+    X(I16, "i16", 2, true, false)      \
+    X(I32, "i32", 4, true, false)      \
+    X(I64, "i64", 8, true, false)      \
+    X(U8, "u8", 1, false, false)       \
+    X(U16, "u16", 2, false, false)     \
+    X(U32, "u32", 4, false, false)     \
+    X(U64, "u64", 8, false, false)     \
+    X(Usize, "usize", 8, false, false) \
+    X(F32, "f32", 4, true, true)       \
+    X(F64, "f64", 8, true, true)
+
+enum class ScalarType : u8 {
+#define X(T, ...) T,
+    SCALAR_TYPES
+#undef X
+};
+
+constexpr StringView scalar_type_spelling(ScalarType type)
+{
+    switch (type) {
+#define X(T, spelling, ...) \
+    case ScalarType::T: return spelling##sv;
+        SCALAR_TYPES
+#undef X
+    }
+}
+
+constexpr u32 scalar_type_size(ScalarType type)
+{
+    switch (type) {
+#define X(T, spelling, size, ...) \
+    case ScalarType::T: return size;
+        SCALAR_TYPES
+#undef X
+    }
+}
+
+constexpr bool is_signed(ScalarType type)
+{
+    switch (type) {
+#define X(T, spelling, size, is_signed, ...) \
+    case ScalarType::T: return is_signed;
+        SCALAR_TYPES
+#undef X
+    }
+}
+
+constexpr bool is_floating(ScalarType type)
+{
+    switch (type) {
+#define X(T, spelling, size, is_signed, is_floating) \
+    case ScalarType::T: return is_floating;
+        SCALAR_TYPES
+#undef X
+    }
+}
+
+// NOTE: Scalar type spelled `name`, counting the C types the
+//       prelude defines with a size every target agrees on.
+Optional<ScalarType> scalar_type(StringView name);
+
+enum class ConstantKind : u8 {
+    Unknown,
+    Integer,
+    Float,
+    Text,
+    Struct,
+};
+
+// NOTE: Integers keep all 64 bits of their value, sign extended
+//       for signed types, so values of the same type compare
+//       equal exactly when their bits do. Text is a quoted
+//       literal kept as written, and `token` of a struct is the
+//       name of its type. Members of a struct are the
+//       `member_count` entries of ConstantValues::members from
+//       `first_member` on.
+struct ConstantValue {
+    ConstantKind kind { ConstantKind::Unknown };
+    ScalarType type { ScalarType::I32 };
+    Token token {};
+    u64 integer { 0 };
+    f64 floating { 0 };
+    u32 first_member { 0 };
+    u32 member_count { 0 };
+
+    constexpr bool is_known() const
+    {
+        return kind != ConstantKind::Unknown;
+    }
+};
+
+struct ConstantMember {
+    Token name {};
+    ConstantValue value {};
+};
+
+// NOTE: Size @size_of() was folded to, for a type C lays out as
+//       the target sees fit.
+struct AssumedSize {
+    Token type {};
+    u32 size { 0 };
+};
+
+struct ConstantValues {
+    static ErrorOr<ConstantValues> create();
+
+    // NOTE: Value of the top level constant declared with `name`,
+    //       if it could be folded.
+    Optional<ConstantValue> find(ParsedExpressions const&,
+        Token name) const;
+
+    constexpr View<ConstantMember const> members_of(
+        ConstantValue value) const
+    {
+        return {
+            members.data() + value.first_member,
+            value.member_count,
+        };
+    }
+
+    // NOTE: One per ParsedExpressions::declarations, unknown for
+    //       anything but the constants that could be folded.
+    Vector<ConstantValue> values;
+    Vector<ConstantMember> members;
+    Vector<AssumedSize> assumed_sizes;
+
+    // NOTE: Names of constants whose value leads back to them,
+    //       which C would refuse.
+    SmallVector<Token> cycles {};
+
+    // NOTE: Whether some folded value depends on usize being 64
+    //       bits.
+    bool assumes_usize { false };
+
+    bool has_errors() const;
+    ErrorOr<void> show_errors(Context const&) const;
+
+    u32 steps { 0 };
+};
+
+// NOTE: Each expression looked at takes a step. Once a file has
+//       taken this many, the constants left are emitted as
+//       written.
+constexpr u32 default_step_budget = 1 << 20;
+
+// NOTE: Folds the top level constants of `context` that C could
+//       compute from literals, enum values, @size_of() and other
+//       such constants. Anything whose value C leaves to the
+//       target, like signed overflow, is left unknown rather than
+//       guessed.
+ErrorOr<ConstantValues> evaluate_constants(Context const&,
+    u32 step_budget = default_step_budget);
+
+}
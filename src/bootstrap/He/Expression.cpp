@@ -189,6 +189,13 @@ void Literal::dump(ParsedExpressions const&, StringView source,
     out.write("Literal("sv, token.text(source), ")"sv).ignore();
 }
 
+void SizeOf::dump(ParsedExpressions const&, StringView source,
+    u32) const
+{
+    auto& out = Core::File::stderr();
+    out.write("SizeOf("sv, type.text(source), ")"sv).ignore();
+}
+
 void LValue::dump(ParsedExpressions const&, StringView source,
     u32) const
 {
@@ -208,6 +215,31 @@ void RValue::dump(ParsedExpressions const& parsed_expressions,
     out.write("\b)"sv).ignore();
 }
 
+void BinaryOperation::dump(ParsedExpressions const& expressions,
+    StringView source, u32 indent) const
+{
+    auto& out = Core::File::stderr();
+    auto operands = expressions[operand_range()];
+    out.write("BinaryOperation('"sv, token_type_spelling(op),
+           "' "sv)
+        .ignore();
+    operands[0].dump(expressions, source, indent);
+    out.write(" "sv).ignore();
+    operands[1].dump(expressions, source, indent);
+    out.write(")"sv).ignore();
+}
+
+void UnaryOperation::dump(ParsedExpressions const& expressions,
+    StringView source, u32 indent) const
+{
+    auto& out = Core::File::stderr();
+    out.write("UnaryOperation('"sv, token_type_spelling(op), "' "sv)
+        .ignore();
+    expressions[operand_range()][0].dump(expressions, source,
+        indent);
+    out.write(")"sv).ignore();
+}
+
 void If::dump(ParsedExpressions const& expressions,
     StringView source, u32 indent) const
 {
@@ -481,4 +513,71 @@ void ParsedExpressions::dump(StringView source) const
     }
 }
 
+Optional<Expression> ParsedExpressions::find_declaration(
+    SymbolId symbol) const
+{
+    if (symbol.raw() >= declaration_slots.size())
+        return {};
+    auto slot = declaration_slots[symbol.raw()];
+    if (slot == no_declaration)
+        return {};
+    return declarations[slot];
+}
+
+Optional<Expression> ParsedExpressions::find_declaration(
+    StringView name) const
+{
+    auto symbol = symbols.find(name);
+    if (!symbol.has_value())
+        return {};
+    return find_declaration(symbol.value());
+}
+
+Token ParsedExpressions::declaration_name(
+    Expression declaration) const
+{
+    switch (declaration.type()) {
+#define DECLARATION(T, variant)                       \
+    case ExpressionType::T:                          \
+        return (*this)[declaration.as_##variant()].name
+        DECLARATION(PrivateConstantDeclaration,
+            private_constant_declaration);
+        DECLARATION(PrivateVariableDeclaration,
+            private_variable_declaration);
+        DECLARATION(PublicConstantDeclaration,
+            public_constant_declaration);
+        DECLARATION(PublicVariableDeclaration,
+            public_variable_declaration);
+        DECLARATION(StructDeclaration, struct_declaration);
+        DECLARATION(EnumDeclaration, enum_declaration);
+        DECLARATION(UnionDeclaration, union_declaration);
+        DECLARATION(VariantDeclaration, variant_declaration);
+        DECLARATION(PrivateCFunction, private_c_function);
+        DECLARATION(PrivateFunction, private_function);
+        DECLARATION(PublicCFunction, public_c_function);
+        DECLARATION(PublicFunction, public_function);
+#undef DECLARATION
+    default: return {};
+    }
+}
+
+ErrorOr<void> ParsedExpressions::index_declarations()
+{
+    auto slots = TRY(Vector<u32>::create(symbols.size()));
+    for (u32 i = 0; i < symbols.size(); i++)
+        slots.unchecked_append(no_declaration);
+    for (u32 i = 0; i < declarations.size(); i++) {
+        auto name = declaration_name(declarations[i]);
+        if (name.is_not(TokenType::Identifier))
+            continue;
+        auto symbol = name.symbol().raw();
+        if (symbol >= slots.size())
+            continue;
+        if (slots[symbol] == no_declaration)
+            slots[symbol] = i;
+    }
+    declaration_slots = move(slots);
+    return {};
+}
+
 }
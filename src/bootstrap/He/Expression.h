@@ -1,6 +1,8 @@
 #pragma once
+#include "Interner.h"
 #include "Token.h"
 #include <Ty/Move.h>
+#include <Ty/Optional.h>
 #include <Ty/Traits.h>
 #include <Ty/Vector.h>
 
@@ -8,9 +10,12 @@ namespace He {
 
 struct ParsedExpressions;
 
+// NOTE: Expressions marked _operator are built from rvalues by the
+//       parser's operator scope, they have no parser of their own.
 #define EXPRESSIONS                                             \
     X(Uninitialized, uninitialized)                             \
     X(Literal, literal)                                         \
+    X(SizeOf, size_of)                                          \
                                                                 \
     X(PrivateConstantDeclaration, private_constant_declaration) \
     X(PrivateVariableDeclaration, private_variable_declaration) \
@@ -32,6 +37,8 @@ struct ParsedExpressions;
                                                                 \
     X(LValue, lvalue)                                           \
     X(RValue, rvalue)                                           \
+    X(BinaryOperation, binary_operation, _operator)             \
+    X(UnaryOperation, unary_operation, _operator)               \
                                                                 \
     X(If, if_statement)                                         \
     X(Return, return_statement)                                 \
@@ -78,6 +85,13 @@ constexpr StringView expression_type_string(ExpressionType type)
 struct Expression;
 using Expressions = Vector<Expression>;
 
+// NOTE: Children of a block, rvalue or function call, stored as
+//       a contiguous run in ParsedExpressions::children.
+struct ExpressionRange {
+    u32 first { 0 };
+    u32 count { 0 };
+};
+
 struct Literal {
     Token token {};
 
@@ -85,13 +99,40 @@ struct Literal {
         u32 indent) const;
 };
 
+// NOTE: @size_of(type).
+struct SizeOf {
+    Token type {};
+
+    void dump(ParsedExpressions const&, StringView source,
+        u32 indent) const;
+};
+
 struct Block {
-    Id<Expressions> expressions;
+    ExpressionRange expressions {};
 
     void dump(ParsedExpressions const&, StringView source,
         u32 indent) const;
 };
 
+struct PendingOperator {
+    TokenType op { TokenType::Invalid };
+    u8 precedence { 0 };
+    bool is_unary { false };
+};
+
+enum class FunctionBodies : u8 {
+    Parse,
+    Skip,
+};
+
+// NOTE: A function body skipped by the parser. Its block stays
+//       empty until parse_lazy_bodies() parses the tokens from
+//       `open_curly` to its partner into it.
+struct LazyBody {
+    Id<Block> block;
+    u32 open_curly { 0 };
+};
+
 struct Uninitialized {
     static void dump(ParsedExpressions const&, StringView source,
         u32 indent);
@@ -231,8 +272,73 @@ struct LValue {
         u32 indent) const;
 };
 
+// NOTE: An rvalue holds one operator tree per value written in
+//       it, usually just one.
 struct RValue {
-    Id<Expressions> expressions;
+    ExpressionRange expressions {};
+
+    void dump(ParsedExpressions const&, StringView source,
+        u32 indent) const;
+};
+
+// NOTE: How tightly binary operators bind, the same as in C, or
+//       zero for tokens that are not binary operators.
+constexpr u8 binary_precedence(TokenType type)
+{
+    switch (type) {
+    case TokenType::Equals: return 1;
+    case TokenType::LessThan: return 2;
+    case TokenType::LessThanOrEqual: return 2;
+    case TokenType::GreaterThan: return 2;
+    case TokenType::GreaterThanOrEqual: return 2;
+    case TokenType::Plus: return 3;
+    case TokenType::Minus: return 3;
+    case TokenType::Star: return 4;
+    case TokenType::Slash: return 4;
+    default: return 0;
+    }
+}
+
+// NOTE: Prefix operators bind tighter than any binary operator.
+constexpr u8 unary_precedence = 5;
+
+constexpr bool is_prefix_operator(TokenType type)
+{
+    switch (type) {
+    case TokenType::Ampersand:
+    case TokenType::Minus:
+    case TokenType::Plus:
+    case TokenType::Star:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// NOTE: The operands are the two children from `operands` on,
+//       left one first.
+struct BinaryOperation {
+    u32 operands { 0 };
+    TokenType op { TokenType::Invalid };
+
+    constexpr ExpressionRange operand_range() const
+    {
+        return { operands, 2 };
+    }
+
+    void dump(ParsedExpressions const&, StringView source,
+        u32 indent) const;
+};
+
+// NOTE: The operand is the child at `operand`.
+struct UnaryOperation {
+    u32 operand { 0 };
+    TokenType op { TokenType::Invalid };
+
+    constexpr ExpressionRange operand_range() const
+    {
+        return { operand, 1 };
+    }
 
     void dump(ParsedExpressions const&, StringView source,
         u32 indent) const;
@@ -314,7 +420,7 @@ struct Throw {
 
 struct FunctionCall {
     Token name {};
-    Id<Expressions> arguments;
+    ExpressionRange arguments {};
 
     void dump(ParsedExpressions const&, StringView source,
         u32 indent) const;
@@ -349,22 +455,38 @@ struct Invalid {
     static void dump(ParsedExpressions const&, StringView, u32);
 };
 
+// NOTE: Tokens [start, end) an expression was parsed from.
+struct TokenRange {
+    u32 start { 0 };
+    u32 end { 0 };
+};
+
+// NOTE: Expressions are packed into two words: the type shares
+//       one with the id of the node, the other holds the index of
+//       the token after it. Only declarations keep where they
+//       start, see ParsedExpressions::declaration_starts.
 struct Expression {
-#define VARIANT(T, name)                                      \
-    constexpr Expression(Id<T> value, u32 start_index,        \
-        u32 end_index)                                        \
-        : name(value)                                         \
-        , start_token_index(start_index)                      \
-        , end_token_offset(end_index - start_index)           \
-        , m_type(ExpressionType::T)                           \
-    {                                                         \
-    }                                                         \
-    constexpr Id<T> const& as_##name() const { return name; } \
-    constexpr Id<T> release_as_##name()                       \
-    {                                                         \
-        auto value = name;                                    \
-        m_type = ExpressionType::Moved;                       \
-        return value;                                         \
+    static constexpr u32 type_bits = 6;
+    static constexpr u32 id_bits = 32 - type_bits;
+    static constexpr u32 invalid_id = (1 << id_bits) - 1;
+
+    // NOTE: Ids from here on do not fit.
+    static constexpr u32 max_ids = invalid_id;
+
+#define VARIANT(T, name)                                        \
+    constexpr Expression(Id<T> value, u32 end_token)            \
+        : Expression(ExpressionType::T, value.raw(), end_token) \
+    {                                                           \
+    }                                                           \
+    constexpr Id<T> as_##name() const                           \
+    {                                                           \
+        return Id<T>(raw_id());                                 \
+    }                                                           \
+    constexpr Id<T> release_as_##name()                         \
+    {                                                           \
+        auto value = as_##name();                               \
+        m_type_and_id = pack(ExpressionType::Moved, raw_id());  \
+        return value;                                           \
     }
 
 #define X(T, name, ...) VARIANT(T, name);
@@ -375,56 +497,72 @@ struct Expression {
     void dump(ParsedExpressions const&, StringView source,
         u32 indent = 0) const;
 
-private:
-    union {
-#define X(T, name, ...) Id<T> name;
-        EXPRESSIONS
-#undef X
-    };
+    u32 end_token { 0 };
 
-public:
-    u32 start_token_index { 0 };
-    u32 end_token_offset : 24 { 0 };
-
-    constexpr u32 end_token_index() const
+    constexpr ExpressionType type() const
     {
-        return start_token_index + end_token_offset;
+        return (ExpressionType)(m_type_and_id & type_mask);
     }
 
-    constexpr ExpressionType type() const { return m_type; }
+    // NOTE: Moves the id this refers to by `offset`, for when the
+    //       expressions it was parsed into are appended to others.
+    constexpr void rebase(u32 offset)
+    {
+        if (m_type_and_id >> type_bits != invalid_id)
+            m_type_and_id += offset << type_bits;
+    }
 
-    constexpr static Expression garbage(u32 start, u32 end)
+    constexpr static Expression garbage(u32 end_token)
     {
         return Expression {
             ExpressionType::Invalid,
-            start,
-            end + 1,
+            invalid_id,
+            end_token,
         };
     }
 
 private:
-    constexpr Expression(ExpressionType type, u32 start, u32 end)
-        : start_token_index(start)
-        , end_token_offset(end - start)
-        , m_type(type)
+    static constexpr u32 type_mask = (1 << type_bits) - 1;
+
+    constexpr Expression(ExpressionType type, u32 id,
+        u32 end_token)
+        : end_token(end_token)
+        , m_type_and_id(pack(type, id))
     {
     }
 
-    ExpressionType m_type { ExpressionType::Invalid };
+    static constexpr u32 pack(ExpressionType type, u32 id)
+    {
+        return (id << type_bits) | (u32)type;
+    }
+
+    constexpr u32 raw_id() const
+    {
+        auto id = m_type_and_id >> type_bits;
+        if (id == invalid_id)
+            return Id<Invalid>::invalid().raw();
+        return id;
+    }
+
+    u32 m_type_and_id { pack(ExpressionType::Invalid, invalid_id) };
 };
+static_assert(sizeof(Expression) == 8);
+#define X(...) +1
+static_assert(0 EXPRESSIONS <= (1 << Expression::type_bits));
+#undef X
 
 struct ParsedExpressions {
 public:
-    static ErrorOr<ParsedExpressions> create()
+    static ErrorOr<ParsedExpressions> create(Interner&& symbols)
     {
 #define X(T, name, ...) .name##s = TRY(Vector<T>::create()),
         // clang-format off
-        using BlockData = Vector<Expressions>;
         using Initializerss = Vector<Initializers>;
         using Memberss = Vector<Members>;
         using Parameterss = Vector<Parameters>;
         using MemberAccessData = Vector<Tokens>;
         using InlineCS = Vector<InlineC>;
+        using PendingOperators = Vector<PendingOperator>;
         using PrivateVariableDeclarations = Vector<PrivateVariableDeclaration>;
         using PublicVariableDeclarations = Vector<PublicVariableDeclaration>;
         using PrivateConstantDeclarations = Vector<PrivateConstantDeclaration>;
@@ -432,16 +570,23 @@ public:
         return ParsedExpressions {
             EXPRESSIONS
             .late_expressions = TRY(Expressions::create()),
-            .block_data = TRY(BlockData::create()),
             .initializerss = TRY(Initializerss::create()),
             .memberss = TRY(Memberss::create()),
             .parameterss = TRY(Parameterss::create()),
             .member_access_data = TRY(MemberAccessData::create()),
+            .children = TRY(Expressions::create()),
+            .child_stack = TRY(Expressions::create()),
+            .operator_stack = TRY(PendingOperators::create()),
             .top_level_inline_cs = TRY(InlineCS::create()),
             .top_level_private_variables = TRY(PrivateVariableDeclarations::create()),
             .top_level_public_variables = TRY(PublicVariableDeclarations::create()),
             .top_level_private_constants = TRY(PrivateConstantDeclarations::create()),
             .top_level_public_constants = TRY(PublicConstantDeclarations::create()),
+            .declarations = TRY(Expressions::create()),
+            .declaration_starts = TRY(Vector<u32>::create()),
+            .declaration_slots = TRY(Vector<u32>::create()),
+            .lazy_bodies = TRY(Vector<LazyBody>::create()),
+            .symbols = move(symbols),
         };
         // clang-format on
 #undef X
@@ -478,20 +623,52 @@ public:
 #undef X
 
     SOA_MEMBER(Expression, late_expressions);
-    NONTRIVIAL_SOA_MEMBER(Expressions, block_data);
     NONTRIVIAL_SOA_MEMBER(Initializers, initializerss);
     NONTRIVIAL_SOA_MEMBER(Members, memberss);
     NONTRIVIAL_SOA_MEMBER(Parameters, parameterss);
     NONTRIVIAL_SOA_MEMBER(Tokens, member_access_data);
 
-    ErrorOr<Block> create_block()
+    constexpr View<Expression const> operator[](
+        ExpressionRange range) const
+    {
+        return { children.data() + range.first, range.count };
+    }
+
+    template <typename T>
+    ErrorOr<Expression> create_expression(Id<T> id, u32 end)
+    {
+        if (id.raw() >= Expression::max_ids)
+            return Error::from_string_literal(
+                "too many expressions");
+        return Expression(id, end);
+    }
+
+    // NOTE: Unlike other expressions, garbage ends at `end`
+    //       inclusive.
+    ErrorOr<Expression> create_garbage(u32 end)
+    {
+        return Expression::garbage(end + 1);
+    }
+
+    constexpr u32 end_token_index(Expression expression) const
     {
-        return Block { TRY(append(TRY(Expressions::create(8)))) };
+        return expression.end_token;
     }
 
-    ErrorOr<RValue> create_rvalue()
+    ErrorOr<void> append_declaration(Expression declaration,
+        u32 start)
     {
-        return RValue { TRY(append(TRY(Expressions::create(8)))) };
+        TRY(declarations.append(declaration));
+        TRY(declaration_starts.append(start));
+        return {};
+    }
+
+    constexpr TokenRange declaration_tokens(u32 declaration) const
+    {
+        return {
+            declaration_starts[declaration],
+            end_token_index(declarations[declaration]),
+        };
     }
 
     ErrorOr<MemberAccess> create_member_access()
@@ -509,6 +686,32 @@ public:
 
     void dump(StringView source) const;
 
+    // NOTE: Top level declaration named `symbol`, or the first of
+    //       them if there are several. Only valid once
+    //       index_declarations() has been run.
+    Optional<Expression> find_declaration(SymbolId symbol) const;
+    Optional<Expression> find_declaration(StringView name) const;
+
+    Token declaration_name(Expression declaration) const;
+
+    // NOTE: Builds `declaration_slots` from `declarations` and
+    //       `symbols`, which have to be complete.
+    ErrorOr<void> index_declarations();
+
+    static constexpr u32 no_declaration = 0xFFFFFFFF;
+
+    Expressions children;
+
+    // NOTE: Children of the blocks, rvalues and function calls
+    //       being parsed, innermost last. They are moved to
+    //       `children` in one piece once their parent closes, so
+    //       siblings stay contiguous even when they nest.
+    Expressions child_stack;
+
+    // NOTE: Operators of the rvalues being parsed that still wait
+    //       for their right operand, innermost last.
+    Vector<PendingOperator> operator_stack;
+
     Vector<InlineC> top_level_inline_cs;
 
     Vector<PrivateVariableDeclaration> top_level_private_variables;
@@ -516,6 +719,24 @@ public:
 
     Vector<PrivateConstantDeclaration> top_level_private_constants;
     Vector<PublicConstantDeclaration> top_level_public_constants;
+
+    // NOTE: Named top level items in source order. They refer to
+    //       their nodes rather than copying them.
+    Expressions declarations;
+
+    // NOTE: Token each of `declarations` starts at. Other
+    //       expressions only know where they end, which is all the
+    //       parser needs once they are parsed.
+    Vector<u32> declaration_starts;
+
+    // NOTE: Index into `declarations` of the first declaration
+    //       of every symbol, or no_declaration.
+    Vector<u32> declaration_slots;
+
+    FunctionBodies function_bodies { FunctionBodies::Parse };
+    Vector<LazyBody> lazy_bodies;
+
+    Interner symbols;
 };
 
 }
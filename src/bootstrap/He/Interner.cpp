@@ -0,0 +1,85 @@
+#include "Interner.h"
+
+namespace He {
+
+namespace {
+
+constexpr u32 hash_of(StringView text)
+{
+    u32 hash = 2166136261;
+    for (u32 i = 0; i < text.size; i++) {
+        hash ^= (u8)text[i];
+        hash *= 16777619;
+    }
+    return hash;
+}
+
+ErrorOr<Vector<SymbolId>> create_slots(u32 count)
+{
+    auto slots = TRY(Vector<SymbolId>::create(count));
+    for (u32 i = 0; i < count; i++)
+        slots.unchecked_append(SymbolId::invalid());
+    return slots;
+}
+
+}
+
+ErrorOr<Interner> Interner::create(u32 expected_symbols)
+{
+    u32 slot_count = 64;
+    while (slot_count < expected_symbols * 2)
+        slot_count *= 2;
+    return Interner {
+        TRY(Vector<Symbol>::create(expected_symbols)),
+        TRY(create_slots(slot_count)),
+    };
+}
+
+ErrorOr<SymbolId> Interner::intern(StringView text)
+{
+    auto hash = hash_of(text);
+    auto mask = m_slots.size() - 1;
+    for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+        auto id = m_slots[slot];
+        if (!id.is_valid()) {
+            id = TRY(m_symbols.append({ text, hash }));
+            m_slots[slot] = id;
+            if (m_symbols.size() * 2 > m_slots.size())
+                TRY(grow());
+            return id;
+        }
+        auto const& symbol = m_symbols[id];
+        if (symbol.hash == hash && symbol.text == text)
+            return id;
+    }
+}
+
+Optional<SymbolId> Interner::find(StringView text) const
+{
+    auto hash = hash_of(text);
+    auto mask = m_slots.size() - 1;
+    for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+        auto id = m_slots[slot];
+        if (!id.is_valid())
+            return {};
+        auto const& symbol = m_symbols[id];
+        if (symbol.hash == hash && symbol.text == text)
+            return id;
+    }
+}
+
+ErrorOr<void> Interner::grow()
+{
+    auto slots = TRY(create_slots(m_slots.size() * 2));
+    auto mask = slots.size() - 1;
+    for (u32 i = 0; i < m_symbols.size(); i++) {
+        auto slot = m_symbols[i].hash & mask;
+        while (slots[slot].is_valid())
+            slot = (slot + 1) & mask;
+        slots[slot] = SymbolId(i);
+    }
+    m_slots = move(slots);
+    return {};
+}
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <Ty/ErrorOr.h>
+#include <Ty/Id.h>
+#include <Ty/Optional.h>
+#include <Ty/StringView.h>
+#include <Ty/Vector.h>
+
+namespace He {
+
+struct Symbol {
+    StringView text;
+    u32 hash;
+};
+using SymbolId = Id<Symbol>;
+
+// NOTE: Maps every distinct identifier to a dense id, so later
+//       stages can compare names with a single integer compare and
+//       index arrays by name.
+struct Interner {
+    static ErrorOr<Interner> create(u32 expected_symbols = 0);
+
+    // NOTE: Takes over the tables of an interner, as returned by
+    //       symbols() and slots(), e.g. when read back from a file.
+    static Interner adopt(Vector<Symbol>&& symbols,
+        Vector<SymbolId>&& slots)
+    {
+        return Interner(move(symbols), move(slots));
+    }
+
+    ErrorOr<SymbolId> intern(StringView text);
+    Optional<SymbolId> find(StringView text) const;
+
+    constexpr StringView text(SymbolId id) const
+    {
+        return m_symbols[id].text;
+    }
+
+    constexpr u32 size() const { return m_symbols.size(); }
+
+    View<Symbol const> symbols() const { return m_symbols.view(); }
+    View<SymbolId const> slots() const { return m_slots.view(); }
+
+private:
+    Interner(Vector<Symbol>&& symbols, Vector<SymbolId>&& slots)
+        : m_symbols(move(symbols))
+        , m_slots(move(slots))
+    {
+    }
+
+    ErrorOr<void> grow();
+
+    Vector<Symbol> m_symbols;
+    Vector<SymbolId> m_slots;
+};
+
+}
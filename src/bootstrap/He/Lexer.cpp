@@ -2,26 +2,55 @@
 #include "Token.h"
 #include "Util.h"
 #include <Core/File.h>
+#include <Core/Thread.h>
 #include <Mem/Locality.h>
 #include <Ty/Error.h>
 #include <Ty/StringBuffer.h>
 #include <Ty/Try.h>
 
+#if __AVX2__
+#    include <immintrin.h>
+#elif __SSE2__
+#    include <emmintrin.h>
+#endif
+
 namespace He {
 
+static ErrorOr<void> show_lex_error(LexError const& error,
+    SourceFile source);
+
 ErrorOr<void> LexError::show(SourceFile source) const
 {
-    auto maybe_line_and_column
-        = Util::line_and_column_for(source.text, source_index);
+    // NOTE: Lexing stopped before producing any line starts, so
+    //       find them here instead.
+    auto line_starts = TRY(lex_line_starts(source.text));
+    source.line_starts = line_starts.view();
+    return show_lex_error(*this, source);
+}
+
+ErrorOr<void> LexErrors::show(SourceFile source) const
+{
+    for (auto const& error : errors)
+        TRY(show_lex_error(error, source));
+    return {};
+}
+
+static ErrorOr<void> show_lex_error(LexError const& error,
+    SourceFile source)
+{
+    auto source_index = error.source_index;
+    auto maybe_line_and_column = Util::line_and_column_for(
+        source.text, source.line_starts, source_index);
     if (!maybe_line_and_column)
         return Error::from_string_literal("could not fetch line");
 
     auto line_number = maybe_line_and_column->line;
     auto column_number = maybe_line_and_column->column;
-    auto line = Util::fetch_line(source.text, line_number);
+    auto line = Util::fetch_line(source.text, source.line_starts,
+        line_number);
 
     auto& out = Core::File::stderr();
-    TRY(out.writeln("Lex error: "sv, message, " ["sv,
+    TRY(out.writeln("Lex error: "sv, error.message, " ["sv,
         source.file_name, ":"sv, line_number + 1, ":"sv,
         column_number + 1, "]\n"sv, line));
     for (u32 column = 0; column < column_number; column++)
@@ -33,6 +62,46 @@ ErrorOr<void> LexError::show(SourceFile source) const
 
 namespace {
 
+#if __AVX2__
+struct Chunk {
+    static constexpr u32 size = 32;
+    static constexpr u32 all_set = 0xFFFFFFFF;
+
+    static Chunk load(char const* data)
+    {
+        return { _mm256_loadu_si256((__m256i const*)data) };
+    }
+
+    u32 mask_of(char character) const
+    {
+        auto needle = _mm256_set1_epi8(character);
+        auto matches = _mm256_cmpeq_epi8(value, needle);
+        return (u32)_mm256_movemask_epi8(matches);
+    }
+
+    __m256i value;
+};
+#elif __SSE2__
+struct Chunk {
+    static constexpr u32 size = 16;
+    static constexpr u32 all_set = 0xFFFF;
+
+    static Chunk load(char const* data)
+    {
+        return { _mm_loadu_si128((__m128i const*)data) };
+    }
+
+    u32 mask_of(char character) const
+    {
+        auto needle = _mm_set1_epi8(character);
+        auto matches = _mm_cmpeq_epi8(value, needle);
+        return (u32)_mm_movemask_epi8(matches);
+    }
+
+    __m128i value;
+};
+#endif
+
 struct [[gnu::packed]] FatToken {
     constexpr FatToken(TokenType type, u32 start, u32 end)
         : start_index(start)
@@ -53,7 +122,7 @@ struct [[gnu::packed]] FatToken {
 
     constexpr Token thin_token() const
     {
-        return Token { type, start_index };
+        return Token { type, start_index, size() };
     }
 
     constexpr u32 size() const { return end_index - start_index; }
@@ -82,95 +151,861 @@ constexpr FatToken lex_assign_or_equals(StringView source,
 constexpr FatToken lex_ampersand_or_ref_mut(StringView source,
     u32 start);
 constexpr FatToken lex_inline_c(StringView source, u32 start);
+constexpr FatToken lex_inline_c_block(StringView source, u32 start);
 
-constexpr FatToken relex_inline_c(StringView source, u32 start);
-constexpr FatToken relex_inline_c_block(StringView source,
+u32 skip_whitespace(StringView source, u32 start);
+u32 skip_until_new_line(StringView source, u32 start);
+u32 skip_whitespace_and_comments(StringView source, u32 start);
+u32 skip_whitespace_and_comments_scalar(StringView source,
     u32 start);
 
+struct Keyword {
+    StringView spelling {};
+    TokenType type { TokenType::Identifier };
+
+    // NOTE: Keywords and builtins are the tokens in TOKEN_TYPES
+    //       spelled with a letter or '@' (followed by the builtin
+    //       name).
+    constexpr bool is_valid() const
+    {
+        if (spelling.is_empty())
+            return false;
+        auto first = spelling[0];
+        return first == '@' || (first >= 'a' && first <= 'z');
+    }
+};
+
+constexpr Keyword keywords[] = {
+#define X(name, snake_name, spelling) \
+    { spelling##sv, TokenType::name },
+    TOKEN_TYPES
+#undef X
+};
+
+// Perfect hash over the length, first and last character of each
+// keyword. The seed is searched for at compile time, so adding a
+// keyword to TOKEN_TYPES needs no further edits here.
+struct KeywordTable {
+    static constexpr u32 size_bits = 6;
+    static constexpr u32 size = 1 << size_bits;
+
+    static constexpr u32 hash(u32 seed, StringView text)
+    {
+        auto first = (u32)(u8)text[0];
+        auto last = (u32)(u8)text[text.size - 1];
+        auto key = text.size << 16 | first << 8 | last;
+        return (key * seed) >> (32 - size_bits);
+    }
+
+    static constexpr KeywordTable create()
+    {
+        // Multiplicative hashing needs the high bits of the seed
+        // set, so start the search at the golden ratio.
+        for (u32 i = 0; i < 0x1000; i++) {
+            auto table = KeywordTable { 0x9E3779B1 + i * 2 };
+            if (table.try_fill())
+                return table;
+        }
+        return KeywordTable { 0 };
+    }
+
+    constexpr TokenType find(StringView text) const
+    {
+        auto const& entry = entries[hash(seed, text)];
+        if (entry.spelling == text)
+            return entry.type;
+        return TokenType::Identifier;
+    }
+
+    u32 seed { 0 };
+    Keyword entries[size] {};
+
+private:
+    constexpr bool try_fill()
+    {
+        for (auto keyword : keywords) {
+            if (!keyword.is_valid())
+                continue;
+            auto& entry = entries[hash(seed, keyword.spelling)];
+            if (entry.is_valid())
+                return false;
+            entry = keyword;
+        }
+        return true;
+    }
+};
+constexpr auto keyword_table = KeywordTable::create();
+static_assert(keyword_table.seed != 0,
+    "keywords collide, try increasing KeywordTable::size_bits");
+
+constexpr TokenType find_keyword_linearly(StringView text)
+{
+    for (auto keyword : keywords) {
+        if (keyword.is_valid() && keyword.spelling == text)
+            return keyword.type;
+    }
+    return TokenType::Identifier;
+}
+
+struct FastScanner {
+    static u32 skip(StringView source, u32 start)
+    {
+        return skip_whitespace_and_comments(source, start);
+    }
+
+    static constexpr TokenType keyword(StringView text)
+    {
+        return keyword_table.find(text);
+    }
+};
+
+struct ScalarScanner {
+    static u32 skip(StringView source, u32 start)
+    {
+        return skip_whitespace_and_comments_scalar(source, start);
+    }
+
+    static constexpr TokenType keyword(StringView text)
+    {
+        return find_keyword_linearly(text);
+    }
+};
+
+template <typename Scanner>
+LexResult lex_with(StringView source);
+
+// NOTE: Lexes tokens starting in [start, end) by assuming start is
+//       a token boundary. It might not be, so the tokens are only
+//       trusted from the first one the serial lexer agrees on.
+struct ChunkLexer {
+    StringView source;
+    u32 start;
+    u32 end;
+    Tokens tokens {};
+    LexErrors errors {};
+
+    void operator()();
+};
+
+Optional<u32> find_token_starting_at(View<Token const> tokens,
+    u32 start);
+
+// NOTE: Builtins leave out their '@' and inline C leaves out the
+//       inline_c keyword, so lexing from where those tokens start
+//       produces something else. Large invalid regions are split
+//       into several tokens.
+constexpr bool is_lexed_from_start(Token token)
+{
+    switch (token.type) {
+    case TokenType::Invalid:
+    case TokenType::Embed:
+    case TokenType::Import:
+    case TokenType::ImportC:
+    case TokenType::SizeOf:
+    case TokenType::Uninitialized:
+    case TokenType::InlineC:
+    case TokenType::InlineCBlock:
+    case TokenType::InvalidInlineC:
+    case TokenType::InvalidInlineCBlock:
+        return false;
+    default:
+        return true;
+    }
+}
+
+ErrorOr<Interner> intern_identifiers(StringView source,
+    View<Token> tokens);
+LexErrors find_lex_errors(StringView source,
+    View<Token const> tokens);
+
+u32 first_token_ending_at_or_after(StringView source,
+    View<Token const> tokens, u32 index);
+u32 first_line_starting_after(View<u32 const> line_starts,
+    u32 index);
+u32 inline_c_block_read_end(StringView source, u32 end);
+u32 first_at_or_after(View<u32 const> values, u32 value);
+ErrorOr<Vector<u32>> find_inline_c_blocks(View<Token const> tokens,
+    u32 offset = 0);
+ErrorOr<void> match_brackets(View<Token> tokens);
+
 using LexItemResult = ErrorOr<FatToken, LexError>;
+template <typename Scanner>
 LexItemResult lex_single_item(StringView source, u32 start);
 
+[[gnu::cold]] ErrorOr<u32> lex_invalid(StringView source,
+    u32 start, Tokens& tokens, LexErrors& errors);
+
+// NOTE: Lexes one token, or invalid tokens covering whatever could
+//       not be lexed, and returns where lexing continues.
+template <typename Scanner>
+ALWAYS_INLINE ErrorOr<u32> lex_step(StringView source, u32 start,
+    Tokens& tokens, LexErrors& errors)
+{
+    auto result = lex_single_item<Scanner>(source, start);
+    if (result.is_error()) [[unlikely]]
+        return TRY(lex_invalid(source, start, tokens, errors));
+    auto token = result.release_value();
+    TRY(tokens.append(token.thin_token()));
+    return token.end_index;
 }
 
-u32 relex_size(StringView source, Token token)
+}
+
+LexResult lex(StringView source)
 {
-    switch (token.type) {
-    case TokenType::OpenBracket: return "["sv.size;
-    case TokenType::CloseBracket: return "]"sv.size;
-    case TokenType::OpenParen: return "("sv.size;
-    case TokenType::CloseParen: return ")"sv.size;
-    case TokenType::OpenCurly: return "{"sv.size;
-    case TokenType::CloseCurly: return "}"sv.size;
-    case TokenType::Ampersand: return "&"sv.size;
-    case TokenType::Comma: return ","sv.size;
-    case TokenType::Assign: return "="sv.size;
-    case TokenType::NewLine: return "\n"sv.size;
-    case TokenType::Number:
-        return lex_number(source, token.start_index).size();
-    case TokenType::Colon: return ":"sv.size;
-    case TokenType::Semicolon: return ";"sv.size;
-    case TokenType::Space: return " "sv.size;
-    case TokenType::Hash: return "#"sv.size;
-    case TokenType::Underscore: return "_"sv.size;
-    case TokenType::QuestionMark: return "?"sv.size;
-    case TokenType::Minus: return "-"sv.size;
-    case TokenType::Plus: return "+"sv.size;
-    case TokenType::Slash: return "/"sv.size;
-    case TokenType::Star: return "*"sv.size;
-    case TokenType::Equals: return "=="sv.size;
-    case TokenType::GreaterThan: return ">"sv.size;
-    case TokenType::GreaterThanOrEqual: return ">="sv.size;
-    case TokenType::LessThan: return "<"sv.size;
-    case TokenType::LessThanOrEqual: return "<="sv.size;
-
-    case TokenType::Dot: return "."sv.size;
-    case TokenType::Arrow: return "->"sv.size;
-
-    case TokenType::Quoted:
-        return lex_quoted(source, token.start_index).size();
-    case TokenType::Identifier:
-        return lex_string(source, token.start_index).size();
-
-    case TokenType::CFn: return "c_fn"sv.size;
-    case TokenType::Fn: return "fn"sv.size;
-    case TokenType::If: return "if"sv.size;
+    return lex_with<FastScanner>(source);
+}
+
+LexResult lex_scalar(StringView source)
+{
+    return lex_with<ScalarScanner>(source);
+}
+
+TokenType look_up_keyword(StringView text)
+{
+    return FastScanner::keyword(text);
+}
+
+TokenType look_up_keyword_linearly(StringView text)
+{
+    return ScalarScanner::keyword(text);
+}
+
+u32 identifier_size(StringView source, u32 start)
+{
+    if (is_letter(source[start]))
+        return lex_string(source, start).size();
+    return lex_identifier(source, start).size();
+}
+
+u32 wide_token_size(StringView source, u32 start, TokenType type)
+{
+    switch (type) {
+    case TokenType::Number: return lex_number(source, start).size();
+    case TokenType::Quoted: return lex_quoted(source, start).size();
     case TokenType::InlineC:
     case TokenType::InvalidInlineC:
-        return relex_inline_c(source, token.start_index).size();
+        return lex_inline_c(source, start).size();
     case TokenType::InlineCBlock:
     case TokenType::InvalidInlineCBlock:
-        return relex_inline_c_block(source, token.start_index)
-            .size();
-    case TokenType::Let: return "let"sv.size;
-    case TokenType::Pub: return "pub"sv.size;
-    case TokenType::RefMut: return "&mut"sv.size;
-    case TokenType::Return: return "return"sv.size;
-    case TokenType::Throw: return "throw"sv.size;
-    case TokenType::Var: return "var"sv.size;
-    case TokenType::While: return "while"sv.size;
-
-    case TokenType::Enum: return "enum"sv.size;
-    case TokenType::Struct: return "struct"sv.size;
-    case TokenType::Union: return "union"sv.size;
-    case TokenType::Variant: return "variant"sv.size;
-
-    case TokenType::Embed: return "embed"sv.size;
-    case TokenType::Import: return "import"sv.size;
-    case TokenType::ImportC: return "import_c"sv.size;
-    case TokenType::SizeOf: return "size_of"sv.size;
-    case TokenType::Uninitialized: return "uninitialized"sv.size;
-    case TokenType::Invalid: return ""sv.size;
+        return lex_inline_c_block(source, start).size();
+    default: return Token::wide;
     }
 }
 
-LexResult lex(StringView source)
+LexResult lex_in_parallel(StringView source, u32 threads)
+{
+    constexpr u32 min_chunk_size = 256 * 1024;
+    auto chunk_count = source.size / min_chunk_size;
+    if (threads < chunk_count)
+        chunk_count = threads;
+    if (chunk_count <= 1)
+        return lex(source);
+
+    auto chunks = TRY(Vector<ChunkLexer>::create(chunk_count));
+    for (u32 i = 0, start = 0; i < chunk_count; i++) {
+        u32 end = source.size;
+        if (i + 1 != chunk_count) {
+            auto guess = (u32)((u64)source.size * (i + 1)
+                / chunk_count);
+            if (guess < start)
+                guess = start;
+            end = skip_until_new_line(source, guess);
+            if (end < source.size)
+                end++;
+        }
+        chunks.unchecked_append(ChunkLexer {
+            .source = source,
+            .start = start,
+            .end = end,
+        });
+        start = end;
+    }
+
+    auto workers = TRY(Vector<Core::Thread>::create(chunk_count));
+    for (auto& chunk : chunks) {
+        auto worker = Core::Thread::spawn(chunk);
+        if (worker.is_error()) {
+            chunk();
+            continue;
+        }
+        workers.unchecked_append(worker.release_value());
+    }
+    auto line_starts = lex_line_starts(source);
+    for (auto const& worker : workers)
+        MUST(worker.join());
+
+    u32 token_count = 0;
+    for (auto const& chunk : chunks)
+        token_count += chunk.tokens.size();
+    auto tokens = TRY(Tokens::create(token_count));
+
+    // NOTE: Lexing is a pure function of the position in the
+    //       source, so once the serial cursor lands on a token a
+    //       chunk also produced, the rest of that chunk is exactly
+    //       what the serial lexer would have produced.
+    auto errors = LexErrors();
+    u32 position = 0;
+    for (auto const& chunk : chunks) {
+        for (u32 start = FastScanner::skip(source, position);
+             start < chunk.end;
+             start = FastScanner::skip(source, position)) {
+            auto chunk_tokens = chunk.tokens.view();
+            auto found = find_token_starting_at(chunk_tokens,
+                start);
+            auto in_sync = found.has_value()
+                && is_lexed_from_start(chunk_tokens[*found]);
+            if (in_sync) {
+                for (u32 i = *found; i < chunk_tokens.size(); i++)
+                    TRY(tokens.append(chunk_tokens[i]));
+                // NOTE: The token at `start` is never invalid, so
+                //       the errors of the tokens taken from here on
+                //       all point past it.
+                for (auto error : chunk.errors.errors) {
+                    if (error.source_index > start)
+                        errors.append(error);
+                }
+                position = tokens.last().end_index(source);
+                continue;
+            }
+            position = TRY(lex_step<FastScanner>(source, start,
+                tokens, errors));
+        }
+    }
+
+    auto symbols = TRY(intern_identifiers(source, tokens.view()));
+    auto inline_c_blocks
+        = TRY(find_inline_c_blocks(tokens.view()));
+    TRY(match_brackets(tokens.view()));
+    return LexedSource {
+        .tokens = move(tokens),
+        .line_starts = TRY(move(line_starts)),
+        .symbols = move(symbols),
+        .inline_c_blocks = move(inline_c_blocks),
+        .errors = move(errors),
+    };
+}
+
+ErrorOr<void, LexError> relex(LexedSource& lexed,
+    StringView old_source, StringView new_source, SourceEdit edit)
+{
+    auto removed = edit.old_end - edit.start;
+    auto inserted = edit.new_end - edit.start;
+    if (old_source.size - removed + inserted != new_source.size) {
+        return LexError {
+            "edit does not match source"sv,
+            edit.start,
+        };
+    }
+
+    // NOTE: Unsigned wrap around makes this work for removals too.
+    u32 delta = edit.new_end - edit.old_end;
+
+    auto& tokens = lexed.tokens;
+    auto first = first_token_ending_at_or_after(old_source,
+        tokens.view(), edit.start);
+
+    // NOTE: '&' looks four bytes ahead for "mut", so it may have
+    //       seen the edit even if it ends before it.
+    for (u32 i = first; i != 0; i--) {
+        auto token = tokens[i - 1];
+        if (token.start_index + 4 < edit.start)
+            break;
+        if (token.is(TokenType::Ampersand))
+            first = i - 1;
+    }
+
+    // NOTE: Inline C blocks end at their closing brace, but the
+    //       lexer reads on to the semicolon after it, so the
+    //       nearest block before the edit may have seen the edit.
+    auto& blocks = lexed.inline_c_blocks;
+    auto first_block = first_at_or_after(blocks.view(), first);
+    if (first_block != 0) {
+        auto block = blocks[first_block - 1];
+        auto read_end = inline_c_block_read_end(old_source,
+            tokens[block].end_index(old_source));
+        if (read_end >= edit.start) {
+            first = block;
+            first_block--;
+        }
+    }
+    // NOTE: Errors point at or just past their invalid token, so
+    //       start before the invalid tokens next to the edit to
+    //       keep the errors before it apart from the relexed ones.
+    while (first != 0 && tokens[first - 1].is(TokenType::Invalid))
+        first--;
+    u32 position = first == 0
+        ? 0
+        : tokens[first - 1].end_index(old_source);
+    auto old_tail = View<Token const> {
+        tokens.data() + first,
+        tokens.size() - first,
+    };
+
+    auto relexed = TRY(Tokens::create());
+    auto relexed_errors = LexErrors();
+    u32 relexed_from = position;
+    u32 resume = tokens.size();
+    for (u32 start = FastScanner::skip(new_source, position);
+         start < new_source.size;
+         start = FastScanner::skip(new_source, position)) {
+        if (start >= edit.new_end) {
+            auto found = find_token_starting_at(old_tail,
+                start - delta);
+            auto in_sync = found.has_value()
+                && is_lexed_from_start(old_tail[*found]);
+            if (in_sync) {
+                resume = first + *found;
+                break;
+            }
+        }
+        position = TRY(lex_step<FastScanner>(new_source, start,
+            relexed, relexed_errors));
+        auto& token = relexed.last();
+        if (token.is(TokenType::Identifier)) {
+            auto symbol = TRY(lexed.symbols.intern(
+                new_source.sub_view(token.start_index,
+                    token.uninterned_size(new_source))));
+            if (symbol.raw() >= Token::wide) {
+                return LexError {
+                    "too many distinct identifiers"sv,
+                    start,
+                };
+            }
+            token.set_symbol(symbol);
+        }
+    }
+    u32 relexed_until = old_source.size;
+    if (resume != tokens.size())
+        relexed_until = tokens[resume].start_index;
+
+    // NOTE: Errors past the capacity were never kept, so if some
+    //       might have been dropped, find them all again.
+    auto errors = LexErrors();
+    if (!lexed.errors.is_full()) {
+        for (auto error : lexed.errors.errors) {
+            if (error.source_index < relexed_from)
+                errors.append(error);
+        }
+        for (auto error : relexed_errors.errors)
+            errors.append(error);
+        // NOTE: The token at `relexed_until` is never invalid,
+        //       so the errors of the tokens after it all point
+        //       past it.
+        for (auto error : lexed.errors.errors) {
+            if (error.source_index > relexed_until) {
+                error.source_index += delta;
+                errors.append(error);
+            }
+        }
+    }
+
+    for (u32 i = resume; i < tokens.size(); i++)
+        tokens[i].start_index += delta;
+    TRY(tokens.replace(first, resume - first, relexed.view()));
+    if (lexed.errors.is_full())
+        errors = find_lex_errors(new_source, tokens.view());
+    lexed.errors = move(errors);
+
+    auto last_block = first_at_or_after(blocks.view(), resume);
+    auto new_blocks = TRY(find_inline_c_blocks(relexed.view(),
+        first));
+    u32 shift = relexed.size() - (resume - first);
+    for (u32 i = last_block; i < blocks.size(); i++)
+        blocks[i] += shift;
+    TRY(blocks.replace(first_block, last_block - first_block,
+        new_blocks.view()));
+
+    // NOTE: One bracket more or less changes the partners of all
+    //       the brackets after it, and of the ones around it.
+    TRY(match_brackets(tokens.view()));
+
+    auto& line_starts = lexed.line_starts;
+    auto first_line = first_line_starting_after(line_starts.view(),
+        edit.start);
+    auto last_line = first_line_starting_after(line_starts.view(),
+        edit.old_end);
+    auto new_line_starts = TRY(Vector<u32>::create());
+    for (u32 i = edit.start; i < edit.new_end; i++) {
+        if (new_source[i] == '\n')
+            TRY(new_line_starts.append(i + 1));
+    }
+    for (u32 i = last_line; i < line_starts.size(); i++)
+        line_starts[i] += delta;
+    TRY(line_starts.replace(first_line, last_line - first_line,
+        new_line_starts.view()));
+
+    return {};
+}
+
+ErrorOr<StreamLexer> StreamLexer::create()
+{
+    return StreamLexer(TRY(Tokens::create()));
+}
+
+ErrorOr<void> StreamLexer::lex_available(StringView source)
+{
+    // NOTE: A token can still grow until the lexer has seen the
+    //       byte after it, '&' can still become "&mut" until it
+    //       has seen the four bytes after it, and an inline C
+    //       block until it has seen the semicolon after it. More
+    //       input may also make errors go away, so those are left
+    //       for the next call.
+    for (u32 start = FastScanner::skip(source, m_position);
+         start < source.size;
+         start = FastScanner::skip(source, m_position)) {
+        auto result = lex_single_item<FastScanner>(source, start);
+        if (result.is_error())
+            break;
+        auto token = result.release_value();
+        if (token.end_index >= source.size)
+            break;
+        auto is_ampersand = token.type == TokenType::Ampersand;
+        if (is_ampersand && token.start_index + 4 >= source.size)
+            break;
+        if (token.type == TokenType::InlineCBlock) {
+            auto read_end
+                = inline_c_block_read_end(source, token.end_index);
+            if (read_end >= source.size)
+                break;
+        }
+        TRY(m_tokens.append(token.thin_token()));
+        m_position = token.end_index;
+    }
+    return {};
+}
+
+LexResult StreamLexer::finish(StringView source)
+{
+    auto errors = LexErrors();
+    for (u32 start = FastScanner::skip(source, m_position);
+         start < source.size;
+         start = FastScanner::skip(source, start)) {
+        start = TRY(lex_step<FastScanner>(source, start, m_tokens,
+            errors));
+    }
+    m_position = source.size;
+
+    auto symbols = TRY(intern_identifiers(source, m_tokens.view()));
+    auto inline_c_blocks
+        = TRY(find_inline_c_blocks(m_tokens.view()));
+    TRY(match_brackets(m_tokens.view()));
+    return LexedSource {
+        .tokens = move(m_tokens),
+        .line_starts = TRY(lex_line_starts(source)),
+        .symbols = move(symbols),
+        .inline_c_blocks = move(inline_c_blocks),
+        .errors = move(errors),
+    };
+}
+
+ErrorOr<Vector<u32>> lex_line_starts(StringView source)
+{
+    auto line_starts = TRY(Vector<u32>::create());
+
+    auto const guesstimated_size = source.size / 32;
+    TRY(line_starts.reserve(guesstimated_size));
+
+    TRY(line_starts.append(0));
+    u32 start = 0;
+#if __AVX2__ || __SSE2__
+    for (; start + Chunk::size <= source.size;
+         start += Chunk::size) {
+        auto new_lines = Chunk::load(&source[start]).mask_of('\n');
+        for (; new_lines != 0; new_lines &= new_lines - 1) {
+            auto index = start + __builtin_ctz(new_lines);
+            TRY(line_starts.append(index + 1));
+        }
+    }
+#endif
+    for (; start < source.size; start++) {
+        if (source[start] == '\n')
+            TRY(line_starts.append(start + 1));
+    }
+
+    return line_starts;
+}
+
+namespace {
+
+template <typename Scanner>
+LexResult lex_with(StringView source)
 {
     auto tokens = TRY(Tokens::create());
 
     auto const guesstimated_size = source.size / 20;
     TRY(tokens.reserve(guesstimated_size));
 
-    for (u32 start = 0; start < source.size;) {
+    auto errors = LexErrors();
+    for (u32 start = Scanner::skip(source, 0); start < source.size;
+         start = Scanner::skip(source, start)) {
+        start = TRY(
+            lex_step<Scanner>(source, start, tokens, errors));
+    }
+
+    auto symbols = TRY(intern_identifiers(source, tokens.view()));
+    auto inline_c_blocks
+        = TRY(find_inline_c_blocks(tokens.view()));
+    TRY(match_brackets(tokens.view()));
+    return LexedSource {
+        .tokens = move(tokens),
+        .line_starts = TRY(lex_line_starts(source)),
+        .symbols = move(symbols),
+        .inline_c_blocks = move(inline_c_blocks),
+        .errors = move(errors),
+    };
+}
+
+void ChunkLexer::operator()()
+{
+    for (u32 index = FastScanner::skip(source, start); index < end;
+         index = FastScanner::skip(source, index)) {
+        auto result
+            = lex_step<FastScanner>(source, index, tokens, errors);
+        if (result.is_error())
+            return;
+        index = result.release_value();
+    }
+}
+
+Optional<u32> find_token_starting_at(View<Token const> tokens,
+    u32 start)
+{
+    u32 low = 0;
+    u32 high = tokens.size();
+    while (low < high) {
+        auto middle = low + (high - low) / 2;
+        if (tokens[middle].start_index < start)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if (low == tokens.size() || tokens[low].start_index != start)
+        return {};
+    return low;
+}
+
+u32 first_token_ending_at_or_after(StringView source,
+    View<Token const> tokens, u32 index)
+{
+    u32 low = 0;
+    u32 high = tokens.size();
+    while (low < high) {
+        auto middle = low + (high - low) / 2;
+        if (tokens[middle].end_index(source) < index)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+u32 first_line_starting_after(View<u32 const> line_starts,
+    u32 index)
+{
+    u32 low = 0;
+    u32 high = line_starts.size();
+    while (low < high) {
+        auto middle = low + (high - low) / 2;
+        if (line_starts[middle] <= index)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+u32 inline_c_block_read_end(StringView source, u32 end)
+{
+    i32 brace_level = 1;
+    for (; end < source.size; end++) {
+        auto character = source[end];
+        if (character == '{')
+            brace_level++;
+        if (character == '}')
+            brace_level--;
+        if (brace_level == 0 && character == ';')
+            break;
+        if (brace_level < 0)
+            break;
+    }
+    return end;
+}
+
+u32 first_at_or_after(View<u32 const> values, u32 value)
+{
+    u32 low = 0;
+    u32 high = values.size();
+    while (low < high) {
+        auto middle = low + (high - low) / 2;
+        if (values[middle] < value)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+ErrorOr<Vector<u32>> find_inline_c_blocks(View<Token const> tokens,
+    u32 offset)
+{
+    auto blocks = TRY(Vector<u32>::create());
+    for (u32 i = 0; i < tokens.size(); i++) {
+        if (tokens[i].is(TokenType::InlineCBlock))
+            TRY(blocks.append(offset + i));
+    }
+    return blocks;
+}
+
+// NOTE: A closer that does not match the innermost opener closes
+//       the nearest one it does match, if any, and the openers in
+//       between are left without a partner.
+ErrorOr<void> match_brackets(View<Token> tokens)
+{
+    auto openers = TRY(Vector<u32>::create());
+    u32 open_parens = 0;
+    u32 open_brackets = 0;
+    u32 open_curlies = 0;
+    auto open_count = [&](TokenType closing_type) -> u32& {
+        if (closing_type == TokenType::CloseParen)
+            return open_parens;
+        if (closing_type == TokenType::CloseBracket)
+            return open_brackets;
+        return open_curlies;
+    };
+    for (u32 i = 0; i < tokens.size(); i++) {
+        auto& token = tokens[i];
+        switch (token.type) {
+        case TokenType::OpenParen:
+        case TokenType::OpenBracket:
+        case TokenType::OpenCurly:
+            token.set_partner_distance(0);
+            [[fallthrough]];
+        case TokenType::InlineCBlock:
+            TRY(openers.append(i));
+            open_count(token.closing_type())++;
+            continue;
+        case TokenType::CloseParen:
+        case TokenType::CloseBracket:
+        case TokenType::CloseCurly:
+            break;
+        default:
+            continue;
+        }
+        token.set_partner_distance(0);
+        if (open_count(token.type) == 0)
+            continue;
+        for (;;) {
+            auto opener = openers.last();
+            openers.truncate(openers.size() - 1);
+            open_count(tokens[opener].closing_type())--;
+            if (tokens[opener].closing_type() == token.type) {
+                // NOTE: Inline C blocks find their '}' without
+                //       being told, see partner_of().
+                if (tokens[opener].is_not(TokenType::InlineCBlock))
+                    tokens[opener].set_partner_distance(i - opener);
+                token.set_partner_distance(i - opener);
+                break;
+            }
+        }
+    }
+    return {};
+}
+
+LexErrors find_lex_errors(StringView source,
+    View<Token const> tokens)
+{
+    auto errors = LexErrors();
+    for (u32 i = 0; i < tokens.size() && !errors.is_full(); i++) {
+        auto token = tokens[i];
+        if (token.is_not(TokenType::Invalid))
+            continue;
+        // NOTE: Skip the pieces of large invalid regions.
+        auto previous = i == 0 ? Token() : tokens[i - 1];
+        auto is_piece = previous.is(TokenType::Invalid)
+            && previous.size(source) == Token::wide - 1
+            && previous.end_index(source) == token.start_index;
+        if (is_piece)
+            continue;
+        auto result = lex_single_item<FastScanner>(source,
+            token.start_index);
+        errors.append(result.error());
+    }
+    return errors;
+}
+
+ErrorOr<Interner> intern_identifiers(StringView source,
+    View<Token> tokens)
+{
+    auto const guesstimated_size = source.size / 256;
+    auto symbols = TRY(Interner::create(guesstimated_size));
+    for (auto& token : tokens) {
+        if (token.is_not(TokenType::Identifier))
+            continue;
+        auto symbol = TRY(symbols.intern(source.sub_view(
+            token.start_index, token.uninterned_size(source))));
+        if (symbol.raw() >= Token::wide) [[unlikely]]
+            return Error::from_string_literal(
+                "too many distinct identifiers");
+        token.set_symbol(symbol);
+    }
+    return symbols;
+}
+
+u32 skip_whitespace(StringView source, u32 start)
+{
+#if __AVX2__ || __SSE2__
+    for (; start + Chunk::size <= source.size;
+         start += Chunk::size) {
+        auto chunk = Chunk::load(&source[start]);
+        auto whitespace = chunk.mask_of(' ') | chunk.mask_of('\t')
+            | chunk.mask_of('\r') | chunk.mask_of('\n');
+        auto other = ~whitespace & Chunk::all_set;
+        if (other != 0)
+            return start + __builtin_ctz(other);
+    }
+#endif
+    for (; start < source.size; start++) {
+        if (!is_whitespace(source[start]))
+            break;
+    }
+    return start;
+}
+
+u32 skip_until_new_line(StringView source, u32 start)
+{
+#if __AVX2__ || __SSE2__
+    for (; start + Chunk::size <= source.size;
+         start += Chunk::size) {
+        auto chunk = Chunk::load(&source[start]);
+        auto new_lines = chunk.mask_of('\n');
+        if (new_lines != 0)
+            return start + __builtin_ctz(new_lines);
+    }
+#endif
+    for (; start < source.size; start++) {
+        if (source[start] == '\n')
+            break;
+    }
+    return start;
+}
+
+u32 skip_whitespace_and_comments(StringView source, u32 start)
+{
+    while (true) {
+        start = skip_whitespace(source, start);
+        if (start + 1 >= source.size)
+            return start;
+        if (source[start] != '/' || source[start + 1] != '/')
+            return start;
+        start = skip_until_new_line(source, start + 2);
+    }
+}
+
+u32 skip_whitespace_and_comments_scalar(StringView source,
+    u32 start)
+{
+    for (; start < source.size;) {
         Mem::mark_read_once(&source[start]);
         auto character = source[start];
         if (is_whitespace(character)) {
@@ -186,17 +1021,12 @@ LexResult lex(StringView source)
             }
             continue;
         }
-
-        auto token = TRY(lex_single_item(source, start));
-        TRY(tokens.append(token.thin_token()));
-        start = token.end_index;
+        break;
     }
-
-    return tokens;
+    return start;
 }
 
-namespace {
-
+template <typename Scanner>
 LexItemResult lex_single_item(StringView source, u32 start)
 {
     Mem::mark_read_once(&source[start]);
@@ -276,35 +1106,15 @@ LexItemResult lex_single_item(StringView source, u32 start)
 
     if (character == '@') {
         auto token = lex_string(source, start + 1);
-        auto value = token.text(source);
-
-        if (value == "embed"sv) {
-            token.type = TokenType::Embed;
-            return token;
-        }
-
-        if (value == "uninitialized"sv) {
-            token.type = TokenType::Uninitialized;
-            return token;
-        }
-
-        if (value == "import"sv) {
-            token.type = TokenType::Import;
-            return token;
-        }
-
-        if (value == "import_c"sv) {
-            token.type = TokenType::ImportC;
-            return token;
-        }
-
-        if (value == "size_of"sv) {
-            token.type = TokenType::SizeOf;
-            return token;
+        auto spelling = source.sub_view(start, token.size() + 1);
+        token.type = Scanner::keyword(spelling);
+        if (token.type == TokenType::Identifier) [[unlikely]] {
+            return LexError {
+                "invalid builtin function"sv,
+                start + 1,
+            };
         }
-
-        [[unlikely]] return LexError { "invalid builtin function"sv,
-            start + 1 };
+        return token;
     }
 
     if (character == '&')
@@ -312,60 +1122,8 @@ LexItemResult lex_single_item(StringView source, u32 start)
 
     if (is_letter(character)) {
         auto token = lex_string(source, start);
-        auto value = token.text(source);
-        if (value == "c_fn"sv) {
-            token.type = TokenType::CFn;
-            return token;
-        }
-        if (value == "fn"sv) {
-            token.type = TokenType::Fn;
-            return token;
-        }
-        if (value == "pub"sv) {
-            token.type = TokenType::Pub;
-            return token;
-        }
-        if (value == "return"sv) {
-            token.type = TokenType::Return;
-            return token;
-        }
-        if (value == "throw"sv) {
-            token.type = TokenType::Throw;
-            return token;
-        }
-        if (value == "let"sv) {
-            token.type = TokenType::Let;
-            return token;
-        }
-        if (value == "var"sv) {
-            token.type = TokenType::Var;
-            return token;
-        }
-        if (value == "if"sv) {
-            token.type = TokenType::If;
-            return token;
-        }
-        if (value == "while"sv) {
-            token.type = TokenType::While;
-            return token;
-        }
-        if (value == "struct"sv) {
-            token.type = TokenType::Struct;
-            return token;
-        }
-        if (value == "union"sv) {
-            token.type = TokenType::Union;
-            return token;
-        }
-        if (value == "variant"sv) {
-            token.type = TokenType::Variant;
-            return token;
-        }
-        if (value == "enum"sv) {
-            token.type = TokenType::Enum;
-            return token;
-        }
-        if (value == "inline_c"sv)
+        token.type = Scanner::keyword(token.text(source));
+        if (token.type == TokenType::InlineC)
             return lex_inline_c(source, start + token.size());
         return token;
     }
@@ -376,56 +1134,34 @@ LexItemResult lex_single_item(StringView source, u32 start)
     return LexError { "unknown token"sv, start };
 }
 
-constexpr FatToken relex_inline_c_block(StringView source,
-    u32 start)
+// NOTE: Lexes `start` again rather than taking the failed result,
+//       so lex_step() does not have to keep it around.
+ErrorOr<u32> lex_invalid(StringView source, u32 start,
+    Tokens& tokens, LexErrors& errors)
 {
-    u32 end = start;
-    u32 last_brace_index = end;
-    for (i32 brace_level = 1; end < source.size; end++) {
-        auto character = source[end];
-        if (character == '{')
-            brace_level++;
-        if (character == '}') {
-            last_brace_index = end;
-            brace_level--;
-        }
-        if (brace_level == 0 && character == ';')
-            break;
-        if (brace_level < 0) {
-            return {
-                TokenType::InvalidInlineCBlock,
-                start,
-                last_brace_index,
-            };
-        }
-    }
-    return { TokenType::InlineCBlock, start, end - 1 };
-}
-
-constexpr FatToken relex_inline_c(StringView source, u32 start)
-{
-    auto end = start;
-    auto last_brace_index = end;
-    for (i32 brace_level = 0; end < source.size; end++) {
-        auto character = source[end];
-        if (character == '{')
-            brace_level++;
-        if (character == '}') {
-            last_brace_index = end;
-            brace_level--;
-        }
-        if (brace_level == 0 && character == ';')
-            break;
-        if (brace_level < 0) {
-            return {
-                TokenType::InvalidInlineC,
-                start,
-                last_brace_index,
-            };
-        }
+    auto result = lex_single_item<FastScanner>(source, start);
+    errors.append(result.error());
+    u32 end = start + 1;
+    if (source[start] == '@')
+        end = lex_string(source, start + 1).end_index;
+    // NOTE: Report multi byte characters once, not per byte.
+    while (end < source.size && (source[end] & 0xC0) == 0x80)
+        end++;
+
+    // NOTE: Invalid tokens have no way to find their size again, so
+    //       they are kept small enough to remember it.
+    u32 constexpr piece_size = Token::wide - 1;
+    for (u32 index = start; index < end; index += piece_size) {
+        auto size = end - index;
+        if (size > piece_size)
+            size = piece_size;
+        TRY(tokens.append(Token {
+            TokenType::Invalid,
+            index,
+            size,
+        }));
     }
-
-    return FatToken { TokenType::InlineC, start, end };
+    return end;
 }
 
 constexpr FatToken lex_inline_c_block(StringView source, u32 start)
@@ -467,7 +1203,7 @@ constexpr FatToken lex_inline_c_block(StringView source, u32 start)
     return {
         TokenType::InlineCBlock,
         start,
-        ending_brace_index - 1,
+        ending_brace_index,
     };
 }
 
@@ -1,8 +1,11 @@
 #pragma once
+#include "Interner.h"
 #include "SourceFile.h"
 #include "Token.h"
 #include <Ty/ErrorOr.h>
+#include <Ty/SmallVector.h>
 #include <Ty/StringView.h>
+#include <Ty/Threads.h>
 
 namespace He {
 
@@ -24,8 +27,89 @@ struct LexError {
     ErrorOr<void> show(SourceFile source) const;
 };
 
-using LexResult = ErrorOr<Tokens, LexError>;
+struct LexErrors {
+    // NOTE: Errors past the capacity are dropped, the source they
+    //       point at is still lexed as invalid tokens.
+    void append(LexError error) { errors.append(error).ignore(); }
+
+    constexpr bool is_empty() const { return errors.is_empty(); }
+    constexpr bool is_full() const { return !errors.is_valid(); }
+
+    ErrorOr<void> show(SourceFile source) const;
+
+    SmallVector<LexError> errors {};
+};
+
+struct LexedSource {
+    Tokens tokens;
+    Vector<u32> line_starts;
+    Interner symbols;
+
+    // NOTE: Indices of inline C block tokens, kept so relex can
+    //       find the nearest one without walking the token list.
+    Vector<u32> inline_c_blocks;
+
+    // NOTE: Whatever could not be lexed is covered by invalid
+    //       tokens, and the reason ends up here.
+    LexErrors errors {};
+};
+
+using LexResult = ErrorOr<LexedSource, LexError>;
 LexResult lex(StringView source);
-u32 relex_size(StringView source, Token token);
+
+// NOTE: Same as lex(), but skips whitespace and comments one byte
+//       at a time and compares identifiers against every keyword in
+//       turn. Only kept around for benchmarking.
+LexResult lex_scalar(StringView source);
+
+// NOTE: Keyword or builtin (counting its '@') spelled `text`, or
+//       TokenType::Identifier if there is none. lex() looks it up
+//       in a perfect hash table and lex_scalar() compares against
+//       every keyword in turn. Only exported for benchmarking.
+TokenType look_up_keyword(StringView text);
+TokenType look_up_keyword_linearly(StringView text);
+
+// NOTE: Same as lex(), but splits large sources at new lines and
+//       lexes the pieces on separate threads.
+LexResult lex_in_parallel(StringView source,
+    u32 threads = Threads::in_machine());
+
+ErrorOr<Vector<u32>> lex_line_starts(StringView source);
+
+// NOTE: Bytes [start, old_end) of the old source were replaced by
+//       bytes [start, new_end) of the new source.
+struct SourceEdit {
+    u32 start;
+    u32 old_end;
+    u32 new_end;
+};
+
+// NOTE: Updates `lexed` from `old_source` to `new_source` by only
+//       lexing from the edit until the tokens line up with the old
+//       ones again. Symbols interned before keep pointing into
+//       `old_source`, so it has to outlive `lexed.symbols`.
+ErrorOr<void, LexError> relex(LexedSource& lexed,
+    StringView old_source, StringView new_source, SourceEdit edit);
+
+// NOTE: Lexes a source while it is still being read. Every call to
+//       lex_available() lexes the tokens that more input can no
+//       longer change, finish() lexes the rest once all of it has
+//       been read. The bytes after the ones read so far have to be
+//       zero.
+struct StreamLexer {
+    static ErrorOr<StreamLexer> create();
+
+    ErrorOr<void> lex_available(StringView source);
+    LexResult finish(StringView source);
+
+private:
+    StreamLexer(Tokens&& tokens)
+        : m_tokens(move(tokens))
+    {
+    }
+
+    Tokens m_tokens;
+    u32 m_position { 0 };
+};
 
 }
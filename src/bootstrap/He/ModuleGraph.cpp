@@ -0,0 +1,227 @@
+#include "ModuleGraph.h"
+#include <Core/File.h>
+#include <Core/System.h>
+#include <Core/Thread.h>
+#include <Ty/Defer.h>
+
+namespace He {
+
+namespace {
+
+struct ModuleParse {
+    Module& module;
+    u32 threads;
+
+    void operator()();
+};
+
+void ModuleParse::operator()()
+{
+    auto source = module.file.view();
+    auto lex_result = lex_in_parallel(source, threads);
+    if (lex_result.is_error()) {
+        module.lex_error = lex_result.release_error();
+        return;
+    }
+    module.lexed = lex_result.release_value();
+
+    auto& lexed = module.lexed.value();
+    auto parse_result = parse_in_parallel(lexed.tokens,
+        move(lexed.symbols), FunctionBodies::Parse, threads);
+    if (parse_result.is_error()) {
+        module.parse_errors = parse_result.release_error();
+        return;
+    }
+    module.expressions = parse_result.release_value();
+}
+
+ErrorOr<StringBuffer> import_path(StringView importer_path,
+    StringView quoted_filename)
+{
+    auto filename
+        = quoted_filename.sub_view(1, quoted_filename.size - 2);
+    auto directory_size = importer_path.size;
+    while (directory_size != 0
+        && importer_path[directory_size - 1] != '/')
+        directory_size--;
+    // NOTE: Saturated, as modules are moved around in memory
+    //       without their move constructor when they grow.
+    return StringBuffer::create_saturated_fill(
+        importer_path.sub_view(0, directory_size), filename);
+}
+
+ErrorOr<void> show_import_errors(
+    SmallVector<ParseError> const& errors, SourceFile source)
+{
+    for (auto const& error : errors) {
+        TRY(error.show(source));
+        TRY(Core::File::stderr().write("\n"sv));
+    }
+    return {};
+}
+
+}
+
+SourceFile Module::source_file() const
+{
+    auto source = SourceFile {
+        .file_name = path.view(),
+        .text = file.view(),
+    };
+    if (lexed.has_value())
+        source.line_starts = lexed->line_starts.view();
+    return source;
+}
+
+bool Module::has_errors() const
+{
+    if (lex_error.has_value() || parse_errors.has_value())
+        return true;
+    if (lexed.has_value() && !lexed->errors.is_empty())
+        return true;
+    return !import_errors.is_empty();
+}
+
+ErrorOr<void> Module::show_errors() const
+{
+    auto source = source_file();
+    if (lex_error.has_value())
+        TRY(lex_error->show(source));
+    if (lexed.has_value())
+        TRY(lexed->errors.show(source));
+    if (parse_errors.has_value())
+        TRY(parse_errors->show(source));
+    TRY(show_import_errors(import_errors, source));
+    return {};
+}
+
+ErrorOr<ModuleGraph> ModuleGraph::load(SourceFile root,
+    ParsedExpressions const& root_expressions, u32 threads)
+{
+    auto root_path = TRY(StringBuffer::create_fill(root.file_name,
+        "\0"sv));
+    auto root_id = TRY(file_id(root_path.data()));
+    auto graph = ModuleGraph(root, TRY(Vector<u32>::create()),
+        TRY(Vector<Module>::create()), root_id,
+        TRY(Vector<FileId>::create()));
+    TRY(graph.resolve_imports(root.file_name, root.text,
+        root_expressions, graph.root_imports,
+        graph.root_import_errors));
+
+    // NOTE: Every module appended while resolving the imports of
+    //       one wave is parsed in the next, so the modules being
+    //       parsed never move.
+    for (u32 start = 0; start < graph.modules.size();) {
+        u32 end = graph.modules.size();
+        u32 threads_per_module = threads / (end - start) ?: 1;
+        auto jobs = TRY(Vector<ModuleParse>::create(end - start));
+        for (u32 i = start; i < end; i++) {
+            jobs.unchecked_append(ModuleParse {
+                graph.modules[i],
+                threads_per_module,
+            });
+        }
+        Core::run_in_parallel(jobs.view());
+
+        for (u32 i = start; i < end; i++) {
+            auto& module = graph.modules[i];
+            if (!module.expressions.has_value())
+                continue;
+            auto path = module.path.view();
+            auto source = module.file.view();
+            auto const& expressions = module.expressions.value();
+            auto imports = TRY(Vector<u32>::create());
+            auto errors = SmallVector<ParseError>();
+            TRY(graph.resolve_imports(path, source, expressions,
+                imports, errors));
+            graph.modules[i].imports = move(imports);
+            graph.modules[i].import_errors = move(errors);
+        }
+        start = end;
+    }
+
+    return graph;
+}
+
+ErrorOr<void> ModuleGraph::resolve_imports(StringView importer_path,
+    StringView importer_source, ParsedExpressions const& importer,
+    Vector<u32>& imports, SmallVector<ParseError>& errors)
+{
+    for (auto const& import_he : importer.import_hes) {
+        auto quoted_filename
+            = import_he.filename.text(importer_source);
+        auto path
+            = TRY(import_path(importer_path, quoted_filename));
+        auto c_path = TRY(StringBuffer::create_fill(path.view(),
+            "\0"sv));
+
+        auto maybe_id = file_id(c_path.data());
+        if (maybe_id.is_error()) {
+            // NOTE: Errors past the capacity are dropped, there is
+            //       no point in reporting every missing file.
+            errors
+                .append(ParseError("could not open import",
+                    "imports are relative to the importing file",
+                    import_he.filename))
+                .ignore();
+            // NOTE: Keeps the indices in step with the imports,
+            //       nothing is generated from a graph with errors.
+            TRY(imports.append(root_module));
+            continue;
+        }
+        auto id = maybe_id.release_value();
+
+        if (id == m_root_id) {
+            TRY(imports.append(root_module));
+            continue;
+        }
+        if (auto known = m_file_ids.find(id); known.has_value()) {
+            TRY(imports.append(known->raw()));
+            continue;
+        }
+
+        auto file = TRY(Core::MappedFile::open(c_path.data()));
+        TRY(imports.append(modules.size()));
+        TRY(m_file_ids.append(id));
+        TRY(modules.append(Module {
+            .path = move(path),
+            .file = move(file),
+            .imports = TRY(Vector<u32>::create()),
+        }));
+    }
+    return {};
+}
+
+ErrorOr<ModuleGraph::FileId> ModuleGraph::file_id(c_string path)
+{
+    auto fd = TRY(Core::System::open(path, O_RDONLY));
+    Defer close_file = [&] {
+        Core::System::close(fd).ignore();
+    };
+    auto stat = TRY(Core::System::fstat(fd));
+    return FileId {
+        .device = stat.raw.st_dev,
+        .inode = stat.raw.st_ino,
+    };
+}
+
+bool ModuleGraph::has_errors() const
+{
+    if (!root_import_errors.is_empty())
+        return true;
+    for (auto const& module : modules) {
+        if (module.has_errors())
+            return true;
+    }
+    return false;
+}
+
+ErrorOr<void> ModuleGraph::show_errors() const
+{
+    TRY(show_import_errors(root_import_errors, root));
+    for (auto const& module : modules)
+        TRY(module.show_errors());
+    return {};
+}
+
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include "Expression.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "SourceFile.h"
+#include <Core/MappedFile.h>
+#include <Ty/ErrorOr.h>
+#include <Ty/Optional.h>
+#include <Ty/SmallVector.h>
+#include <Ty/StringBuffer.h>
+#include <Ty/Threads.h>
+#include <Ty/Vector.h>
+
+namespace He {
+
+// NOTE: A source file reached through @import from the root file,
+//       directly or through other modules.
+struct Module {
+    StringBuffer path;
+    Core::MappedFile file;
+
+    // NOTE: Left empty if lexing or parsing failed, the reason is
+    //       kept in `lex_error` or `parse_errors` instead.
+    Optional<LexedSource> lexed {};
+    Optional<ParsedExpressions> expressions {};
+
+    // NOTE: Module index of every @import in
+    //       `expressions->import_hes`, in the same order.
+    Vector<u32> imports;
+
+    Optional<LexError> lex_error {};
+    Optional<ParseErrors> parse_errors {};
+    SmallVector<ParseError> import_errors {};
+
+    SourceFile source_file() const;
+    bool has_errors() const;
+    ErrorOr<void> show_errors() const;
+};
+
+struct ModuleGraph {
+    // NOTE: Imports of the root file that lead back to it.
+    static constexpr u32 root_module = 0xFFFFFFFF;
+
+    // NOTE: Loads every module `root` imports, directly or not.
+    //       Files are told apart by device and inode, so each is
+    //       parsed once however often and however it is imported.
+    //       Modules found at the same depth are lexed and parsed in
+    //       parallel. Files that can not be lexed, parsed or opened
+    //       do not fail loading, see has_errors().
+    static ErrorOr<ModuleGraph> load(SourceFile root,
+        ParsedExpressions const& root_expressions,
+        u32 threads = Threads::in_machine());
+
+    bool has_errors() const;
+    ErrorOr<void> show_errors() const;
+
+    SourceFile root;
+
+    // NOTE: Module index of every @import of the root file.
+    Vector<u32> root_imports;
+    SmallVector<ParseError> root_import_errors {};
+
+    Vector<Module> modules;
+
+private:
+    struct FileId {
+        u64 device;
+        u64 inode;
+
+        constexpr bool operator==(FileId other) const
+        {
+            return device == other.device && inode == other.inode;
+        }
+    };
+
+    ModuleGraph(SourceFile root, Vector<u32>&& root_imports,
+        Vector<Module>&& modules, FileId root_id,
+        Vector<FileId>&& file_ids)
+        : root(root)
+        , root_imports(move(root_imports))
+        , modules(move(modules))
+        , m_root_id(root_id)
+        , m_file_ids(move(file_ids))
+    {
+    }
+
+    static ErrorOr<FileId> file_id(c_string path);
+
+    ErrorOr<void> resolve_imports(StringView importer_path,
+        StringView importer_source,
+        ParsedExpressions const& importer, Vector<u32>& imports,
+        SmallVector<ParseError>& errors);
+
+    FileId m_root_id;
+    Vector<FileId> m_file_ids;
+};
+
+}
@@ -0,0 +1,400 @@
+#include "ParseCache.h"
+#include "BuildId.h"
+#include "CacheFile.h"
+#include <Core/System.h>
+#include <Ty/Defer.h>
+#include <Ty/StringBuffer.h>
+
+namespace He {
+
+namespace {
+
+constexpr u64 cache_magic = 0x65737261702d6568; // "he-parse"
+
+// NOTE: Bump whenever anything stored changes meaning without
+//       changing size, cache_fingerprint() catches the rest.
+constexpr u64 cache_version = 4;
+
+constexpr u32 section_alignment = 16;
+
+struct CacheHeader {
+    u64 magic;
+    u64 fingerprint;
+    u64 source_hash;
+    u32 source_size;
+    u32 section_count;
+};
+
+struct CacheSection {
+    u32 offset;
+    u32 count;
+};
+
+// NOTE: Symbols point into the source, so they are stored as
+//       offsets into it.
+struct CachedSymbol {
+    u32 start;
+    u32 size;
+    u32 hash;
+};
+
+// NOTE: Parser changes that keep the layout of what is stored are
+//       told apart by the revision the compiler is built from, and
+//       by when this file was compiled.
+constexpr StringView build_id
+    = HE_BUILD_REVISION " " __DATE__ " " __TIME__ ""sv;
+
+constexpr u64 cache_fingerprint()
+{
+    auto hash = mix(cache_magic, cache_version);
+    for (u32 i = 0; i < build_id.size; i++)
+        hash = mix(hash, build_id[i]);
+#define X(T, ...) hash = mix(hash, sizeof(T));
+    EXPRESSIONS
+#undef X
+#define X(...) hash = mix(hash, 1);
+    TOKEN_TYPES
+#undef X
+    hash = mix(hash, sizeof(Token));
+    hash = mix(hash, sizeof(Expression));
+    hash = mix(hash, sizeof(Initializer));
+    hash = mix(hash, sizeof(Member));
+    hash = mix(hash, sizeof(Parameter));
+    return hash;
+}
+
+u64 hash_source(StringView source)
+{
+    return mix_text(cache_fingerprint(), source);
+}
+
+struct CacheReader {
+    template <typename T>
+    ErrorOr<View<T>> next()
+    {
+        if (m_next == m_sections.size())
+            return Error::from_string_literal("truncated cache");
+        auto section = m_sections[m_next++];
+        auto end = section.offset + (u64)section.count * sizeof(T);
+        if (section.offset % alignof(T) != 0 || end > m_file.size)
+            return Error::from_string_literal("corrupt cache");
+        // NOTE: Cache files are mapped private and writable, so
+        //       the vectors borrowing from them can be changed.
+        auto* data = (T*)&m_file.data[section.offset];
+        return View<T>(data, section.count);
+    }
+
+    template <typename T>
+    ErrorOr<Vector<T>> vector()
+    {
+        return Vector<T>::borrow(TRY(next<T>()));
+    }
+
+    template <typename T>
+    ErrorOr<Vector<Vector<T>>> nested_vector()
+    {
+        auto elements = TRY(next<T>());
+        auto sizes = TRY(next<u32>());
+        auto vectors = TRY(Vector<Vector<T>>::create(sizes.size()));
+        u32 offset = 0;
+        for (auto size : sizes) {
+            if (size > elements.size() - offset)
+                return Error::from_string_literal("corrupt cache");
+            auto view = View(&elements[offset], size);
+            vectors.unchecked_append(Vector<T>::borrow(view));
+            offset += size;
+        }
+        return vectors;
+    }
+
+    ErrorOr<Interner> interner(StringView source)
+    {
+        auto cached_symbols = TRY(next<CachedSymbol>());
+        auto symbols = TRY(Vector<Symbol>::create(
+            cached_symbols.size()));
+        for (auto symbol : cached_symbols) {
+            if (symbol.start > source.size
+                || symbol.size > source.size - symbol.start)
+                return Error::from_string_literal("corrupt cache");
+            auto text = source.sub_view(symbol.start, symbol.size);
+            symbols.unchecked_append({ text, symbol.hash });
+        }
+        auto slots = TRY(vector<SymbolId>());
+        return Interner::adopt(move(symbols), move(slots));
+    }
+
+    StringView m_file;
+    View<CacheSection const> m_sections;
+    u32 m_next { 0 };
+};
+
+template <typename T>
+struct FlatVectors {
+    static ErrorOr<FlatVectors> create(
+        Vector<Vector<T>> const& from)
+    {
+        auto flat = FlatVectors {
+            TRY(Vector<T>::create()),
+            TRY(Vector<u32>::create(from.size())),
+        };
+        for (auto const& vector : from) {
+            TRY(flat.elements.extend(vector.view()));
+            flat.sizes.unchecked_append(vector.size());
+        }
+        return flat;
+    }
+
+    Vector<T> elements;
+    Vector<u32> sizes;
+};
+
+struct CacheWriter {
+    static ErrorOr<CacheWriter> create()
+    {
+        return CacheWriter {
+            TRY(Vector<CacheSection>::create(64)),
+            TRY(Vector<IOVec>::create(64)),
+        };
+    }
+
+    template <typename T>
+    ErrorOr<void> add(View<T> elements)
+    {
+        TRY(m_sections.append({ 0, (u32)elements.size() }));
+        TRY(m_pieces.append({
+            elements.data(),
+            elements.size() * sizeof(T),
+        }));
+        return {};
+    }
+
+    template <typename T>
+    ErrorOr<void> add(FlatVectors<T> const& vectors)
+    {
+        TRY(add(vectors.elements.view()));
+        TRY(add(vectors.sizes.view()));
+        return {};
+    }
+
+    ErrorOr<void> write(int fd, u64 source_hash, u32 source_size)
+    {
+        u64 offset = sizeof(CacheHeader)
+            + m_sections.size() * sizeof(CacheSection);
+        for (u32 i = 0; i < m_sections.size(); i++) {
+            offset = align(offset);
+            if (offset + m_pieces[i].size > 0xFFFFFFFF)
+                return Error::from_string_literal("cache too big");
+            m_sections[i].offset = offset;
+            offset += m_pieces[i].size;
+        }
+
+        auto header = CacheHeader {
+            .magic = cache_magic,
+            .fingerprint = cache_fingerprint(),
+            .source_hash = source_hash,
+            .source_size = source_size,
+            .section_count = m_sections.size(),
+        };
+        TRY(write_all(fd, &header, sizeof(header)));
+        TRY(write_all(fd, m_sections.data(),
+            m_sections.size() * sizeof(CacheSection)));
+        offset = sizeof(CacheHeader)
+            + m_sections.size() * sizeof(CacheSection);
+        for (u32 i = 0; i < m_sections.size(); i++) {
+            u8 const padding[section_alignment] {};
+            TRY(write_all(fd, padding, align(offset) - offset));
+            TRY(write_all(fd, m_pieces[i].data, m_pieces[i].size));
+            offset = align(offset) + m_pieces[i].size;
+        }
+        return {};
+    }
+
+    static constexpr u64 align(u64 offset)
+    {
+        auto mask = section_alignment - 1;
+        return (offset + mask) & ~(u64)mask;
+    }
+
+    Vector<CacheSection> m_sections;
+    Vector<IOVec> m_pieces;
+};
+
+ErrorOr<CachedParse> read_cached_parse(Core::MappedFile&& file,
+    StringView source)
+{
+    auto contents = file.view();
+    auto const* header = (CacheHeader const*)contents.data;
+    auto* sections = (CacheSection const*)&header[1];
+    auto sections_end = sizeof(CacheHeader)
+        + (u64)header->section_count * sizeof(CacheSection);
+    if (sections_end > contents.size)
+        return Error::from_string_literal("corrupt cache");
+    auto reader = CacheReader {
+        contents,
+        { sections, header->section_count },
+    };
+
+    // NOTE: Sections are read back in the order they are written
+    //       in, which is the order of the members they are for.
+    //       Only their bounds are checked, the cache directory is
+    //       trusted as much as the compiler itself.
+    auto tokens = TRY(reader.vector<Token>());
+    auto line_starts = TRY(reader.vector<u32>());
+    auto inline_c_blocks = TRY(reader.vector<u32>());
+    auto symbols = TRY(reader.interner(source));
+    using PendingOperators = Vector<PendingOperator>;
+    auto expressions = ParsedExpressions {
+#define X(T, name, ...) .name##s = TRY(reader.vector<T>()),
+        EXPRESSIONS
+#undef X
+        .late_expressions = TRY(reader.vector<Expression>()),
+        .initializerss = TRY(reader.nested_vector<Initializer>()),
+        .memberss = TRY(reader.nested_vector<Member>()),
+        .parameterss = TRY(reader.nested_vector<Parameter>()),
+        .member_access_data = TRY(reader.nested_vector<Token>()),
+        .children = TRY(reader.vector<Expression>()),
+        .child_stack = TRY(Expressions::create()),
+        .operator_stack = TRY(PendingOperators::create()),
+        .top_level_inline_cs = TRY(reader.vector<InlineC>()),
+        .top_level_private_variables
+        = TRY(reader.vector<PrivateVariableDeclaration>()),
+        .top_level_public_variables
+        = TRY(reader.vector<PublicVariableDeclaration>()),
+        .top_level_private_constants
+        = TRY(reader.vector<PrivateConstantDeclaration>()),
+        .top_level_public_constants
+        = TRY(reader.vector<PublicConstantDeclaration>()),
+        .declarations = TRY(reader.vector<Expression>()),
+        .declaration_starts = TRY(reader.vector<u32>()),
+        .declaration_slots = TRY(reader.vector<u32>()),
+        .lazy_bodies = TRY(Vector<LazyBody>::create()),
+        .symbols = move(symbols),
+    };
+    if (reader.m_next != reader.m_sections.size())
+        return Error::from_string_literal("corrupt cache");
+
+    auto lexed = LexedSource {
+        .tokens = move(tokens),
+        .line_starts = move(line_starts),
+        .symbols = TRY(Interner::create()),
+        .inline_c_blocks = move(inline_c_blocks),
+    };
+    return CachedParse {
+        move(file),
+        move(lexed),
+        move(expressions),
+    };
+}
+
+}
+
+ErrorOr<StringBuffer> cached_parse_path(StringView directory,
+    StringView source)
+{
+    return cache_path(directory, hash_source(source), ".heparse"sv);
+}
+
+ErrorOr<CachedParse> load_cached_parse(StringView directory,
+    StringView source)
+{
+    auto source_hash = hash_source(source);
+    auto path = TRY(cache_path(directory, source_hash,
+        ".heparse"sv));
+    auto file = TRY(Core::MappedFile::open(path.view()));
+
+    auto contents = file.view();
+    if (contents.size < sizeof(CacheHeader))
+        return Error::from_string_literal("truncated cache");
+    auto const* header = (CacheHeader const*)contents.data;
+    if (header->magic != cache_magic
+        || header->fingerprint != cache_fingerprint())
+        return Error::from_string_literal("incompatible cache");
+    if (header->source_hash != source_hash
+        || header->source_size != source.size)
+        return Error::from_string_literal("stale cache");
+
+    return TRY(read_cached_parse(move(file), source));
+}
+
+ErrorOr<void> store_cached_parse(StringView directory,
+    StringView source, LexedSource const& lexed,
+    ParsedExpressions const& expressions)
+{
+    auto source_symbols = expressions.symbols.symbols();
+    auto symbols = TRY(Vector<CachedSymbol>::create(
+        source_symbols.size()));
+    for (auto symbol : source_symbols) {
+        auto start = symbol.text.data - source.data;
+        if (start < 0 || start + symbol.text.size > source.size) {
+            return Error::from_string_literal(
+                "symbol is not in the source");
+        }
+        symbols.unchecked_append({
+            (u32)start,
+            (u32)symbol.text.size,
+            symbol.hash,
+        });
+    }
+    using FlatInitializers = FlatVectors<Initializer>;
+    auto initializers
+        = TRY(FlatInitializers::create(expressions.initializerss));
+    auto members
+        = TRY(FlatVectors<Member>::create(expressions.memberss));
+    auto parameters = TRY(
+        FlatVectors<Parameter>::create(expressions.parameterss));
+    auto member_access_data = TRY(
+        FlatVectors<Token>::create(expressions.member_access_data));
+
+    auto writer = TRY(CacheWriter::create());
+    TRY(writer.add(lexed.tokens.view()));
+    TRY(writer.add(lexed.line_starts.view()));
+    TRY(writer.add(lexed.inline_c_blocks.view()));
+    TRY(writer.add(symbols.view()));
+    TRY(writer.add(expressions.symbols.slots()));
+#define X(T, name, ...) TRY(writer.add(expressions.name##s.view()));
+    EXPRESSIONS
+#undef X
+    TRY(writer.add(expressions.late_expressions.view()));
+    TRY(writer.add(initializers));
+    TRY(writer.add(members));
+    TRY(writer.add(parameters));
+    TRY(writer.add(member_access_data));
+    TRY(writer.add(expressions.children.view()));
+    TRY(writer.add(expressions.top_level_inline_cs.view()));
+    TRY(writer.add(expressions.top_level_private_variables.view()));
+    TRY(writer.add(expressions.top_level_public_variables.view()));
+    TRY(writer.add(expressions.top_level_private_constants.view()));
+    TRY(writer.add(expressions.top_level_public_constants.view()));
+    TRY(writer.add(expressions.declarations.view()));
+    TRY(writer.add(expressions.declaration_starts.view()));
+    TRY(writer.add(expressions.declaration_slots.view()));
+
+    // NOTE: Written next to where it belongs and renamed into
+    //       place, so other compilers never see a half written
+    //       cache.
+    auto directory_path
+        = TRY(StringBuffer::create_fill(directory, "\0"sv));
+    Core::System::mkdir(directory_path.data()).ignore();
+    auto source_hash = hash_source(source);
+    auto path = TRY(cache_path(directory, source_hash,
+        ".heparse"sv));
+    auto final_path = TRY(StringBuffer::create_fill(path.view(),
+        "\0"sv));
+    auto temporary_path = TRY(StringBuffer::create_fill(path.view(),
+        "XXXXXX\0"sv));
+    auto* temporary = temporary_path.mutable_data();
+    auto fd = TRY(Core::System::mkstemps(temporary));
+    auto should_remove = true;
+    Defer remove_temporary = [&] {
+        if (should_remove)
+            Core::System::unlink(temporary).ignore();
+    };
+    auto write_result = writer.write(fd, source_hash, source.size);
+    TRY(Core::System::close(fd));
+    TRY(write_result);
+    TRY(Core::System::rename(temporary, final_path.data()));
+    should_remove = false;
+    return {};
+}
+
+}
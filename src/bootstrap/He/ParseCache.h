@@ -0,0 +1,41 @@
+#pragma once
+#include "Expression.h"
+#include "Lexer.h"
+#include "Token.h"
+#include <Core/MappedFile.h>
+#include <Ty/ErrorOr.h>
+#include <Ty/StringBuffer.h>
+#include <Ty/StringView.h>
+#include <Ty/Vector.h>
+
+namespace He {
+
+// NOTE: Lex and parse results of a source file read back from the
+//       parse cache. The vectors point into `file`, so it is
+//       declared first and goes away last. Symbols are only kept
+//       in `expressions`, as parsing takes them from the lexer.
+struct CachedParse {
+    Core::MappedFile file;
+    LexedSource lexed;
+    ParsedExpressions expressions;
+};
+
+// NOTE: Entries in `directory` are keyed by a hash of the source
+//       and of the cache format. Anything but an entry made from
+//       the same source by a compatible compiler is an error, which
+//       callers should treat as a miss.
+ErrorOr<CachedParse> load_cached_parse(StringView directory,
+    StringView source);
+
+// NOTE: Where the entry for `source` is kept in `directory`.
+ErrorOr<StringBuffer> cached_parse_path(StringView directory,
+    StringView source);
+
+// NOTE: Only complete parses of sources without lex errors should
+//       be stored, as loading skips both stages entirely. The
+//       symbols are taken from `expressions`, not from `lexed`.
+ErrorOr<void> store_cached_parse(StringView directory,
+    StringView source, LexedSource const& lexed,
+    ParsedExpressions const& expressions);
+
+}
@@ -5,6 +5,7 @@
 #include "Token.h"
 #include "Ty/Error.h"
 #include "Util.h"
+#include <Core/Thread.h>
 #include <Ty/ErrorOr.h>
 #include <Ty/StringBuffer.h>
 #include <Ty/Try.h>
@@ -15,14 +16,189 @@ namespace {
 
 using ParseSingleItemResult = ErrorOr<Expression, ParseErrors>;
 
+// NOTE: Collects the children of one block, rvalue or function
+//       call on ParsedExpressions::child_stack. Scopes nest like
+//       the parse functions owning them, so the closing scope's
+//       children are always on top of the stack.
+struct ChildScope {
+    explicit ChildScope(ParsedExpressions& expressions)
+        : m_expressions(expressions)
+        , m_mark(expressions.child_stack.size())
+    {
+    }
+
+    // NOTE: Scopes left on error drop their children here.
+    ~ChildScope() { m_expressions.child_stack.truncate(m_mark); }
+
+    ErrorOr<void> append(Expression child)
+    {
+        TRY(m_expressions.child_stack.append(child));
+        return {};
+    }
+
+    bool is_empty() const
+    {
+        return m_expressions.child_stack.size() == m_mark;
+    }
+
+    ErrorOr<ExpressionRange> close()
+    {
+        auto& stack = m_expressions.child_stack;
+        auto& children = m_expressions.children;
+        auto range = ExpressionRange {
+            children.size(),
+            stack.size() - m_mark,
+        };
+        auto top = View(stack.data() + m_mark, range.count);
+        TRY(children.extend(top));
+        stack.truncate(m_mark);
+        return range;
+    }
+
+private:
+    ParsedExpressions& m_expressions;
+    u32 m_mark { 0 };
+};
+
+// NOTE: Turns the operands and operators of one rvalue into
+//       operator trees by precedence climbing. Operands wait on
+//       ParsedExpressions::child_stack and operators on
+//       ParsedExpressions::operator_stack, so no precedence level
+//       needs a call of its own. An operand right after another
+//       one starts the next tree of the rvalue.
+struct OperatorScope {
+    explicit OperatorScope(ParsedExpressions& expressions)
+        : m_expressions(expressions)
+        , m_operands(expressions)
+        , m_mark(expressions.operator_stack.size())
+    {
+    }
+
+    ~OperatorScope()
+    {
+        m_expressions.operator_stack.truncate(m_mark);
+    }
+
+    ErrorOr<void> append(Expression operand)
+    {
+        if (m_expects_operator)
+            TRY(reduce(0));
+        TRY(m_operands.append(operand));
+        m_expects_operator = true;
+        return {};
+    }
+
+    // NOTE: Returns false if the token at `index` can't be an
+    //       operator here.
+    ErrorOr<bool> append_operator(Tokens const& tokens, u32 index)
+    {
+        auto op = tokens[index].type;
+        if (m_expects_operator) {
+            if (auto precedence = binary_precedence(op)) {
+                TRY(reduce(precedence));
+                TRY(push({ op, precedence, false }));
+                m_expects_operator = false;
+                return true;
+            }
+        }
+        if (!is_prefix_operator(op))
+            return false;
+        if (m_expects_operator)
+            TRY(reduce(0));
+        TRY(push({ op, unary_precedence, true }));
+        m_expects_operator = false;
+        return true;
+    }
+
+    bool is_empty() const
+    {
+        return m_operands.is_empty() && !has_pending_operators();
+    }
+
+    // NOTE: False if an operator still waits for its operand.
+    bool is_complete() const
+    {
+        return m_expects_operator || is_empty();
+    }
+
+    ErrorOr<ExpressionRange> close()
+    {
+        TRY(reduce(0));
+        return m_operands.close();
+    }
+
+private:
+    bool has_pending_operators() const
+    {
+        return m_expressions.operator_stack.size() != m_mark;
+    }
+
+    ErrorOr<void> push(PendingOperator op)
+    {
+        TRY(m_expressions.operator_stack.append(op));
+        return {};
+    }
+
+    // NOTE: Applies the pending operators binding at least as
+    //       tightly as `precedence`, which keeps binary operators
+    //       left associative.
+    ErrorOr<void> reduce(u8 precedence)
+    {
+        auto& operators = m_expressions.operator_stack;
+        auto& operands = m_expressions.child_stack;
+        auto& children = m_expressions.children;
+        while (has_pending_operators()) {
+            auto op = operators.last();
+            if (op.precedence < precedence)
+                break;
+            operators.truncate(operators.size() - 1);
+
+            auto first = children.size();
+            u32 count = op.is_unary ? 1 : 2;
+            auto top_start = operands.size() - count;
+            TRY(children.extend(View(&operands[top_start], count)));
+            operands.truncate(top_start);
+
+            auto end
+                = m_expressions.end_token_index(children.last());
+            if (op.is_unary) {
+                auto id = TRY(m_expressions.append(UnaryOperation {
+                    first,
+                    op.op,
+                }));
+                TRY(operands.append(TRY(
+                    m_expressions.create_expression(id, end))));
+                continue;
+            }
+            auto id = TRY(m_expressions.append(BinaryOperation {
+                first,
+                op.op,
+            }));
+            TRY(operands.append(TRY(
+                m_expressions.create_expression(id, end))));
+        }
+        return {};
+    }
+
+    ParsedExpressions& m_expressions;
+    ChildScope m_operands;
+    u32 m_mark { 0 };
+    bool m_expects_operator { false };
+};
+
 #define FORWARD_DECLARE_PARSER(name)                          \
     ParseSingleItemResult parse_##name(ParseErrors& errors,   \
         ParsedExpressions& expressions, Tokens const& tokens, \
         u32 start)
 
-#define X(T, name, ...) FORWARD_DECLARE_PARSER(name);
+#define DECLARE_EXPRESSION_PARSER(name) \
+    FORWARD_DECLARE_PARSER(name);
+#define DECLARE_EXPRESSION_PARSER_operator(name)
+#define X(T, name, ...) DECLARE_EXPRESSION_PARSER##__VA_ARGS__(name)
 EXPRESSIONS
 #undef X
+#undef DECLARE_EXPRESSION_PARSER_operator
+#undef DECLARE_EXPRESSION_PARSER
 
 FORWARD_DECLARE_PARSER(top_level_constant_or_struct);
 FORWARD_DECLARE_PARSER(if_rvalue);
@@ -33,15 +209,511 @@ FORWARD_DECLARE_PARSER(pub_specifier);
 
 #undef FORWARD_DECLARE_PARSER
 
+// NOTE: Parses the top level items in tokens [start, end) and
+//       returns where the last of them ended.
+ErrorOr<u32, ParseErrors> parse_top_level_items(ParseErrors& errors,
+    ParsedExpressions& expressions, Tokens const& tokens, u32 start,
+    u32 end);
+
+u32 token_starting_at(View<Token const> tokens, u32 start_index)
+{
+    u32 low = 0;
+    u32 high = tokens.size();
+    while (low < high) {
+        auto middle = low + (high - low) / 2;
+        if (tokens[middle].start_index < start_index)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+// NOTE: Whatever the parser trips over after an invalid token in
+//       the same statement is most likely caused by it, and the
+//       lexer has already reported that one.
+void mark_errors_following_invalid_tokens(ParseErrors& errors,
+    View<Token const> tokens)
+{
+    TokenType statement_ends[] {
+        TokenType::Semicolon,
+        TokenType::OpenCurly,
+        TokenType::CloseCurly,
+    };
+    for (auto& error : errors.parse_errors) {
+        auto token = error.m_offending_token;
+        if (token.is(TokenType::Invalid))
+            continue;
+        auto index = token_starting_at(tokens, token.start_index);
+        for (u32 i = index; i != 0; i--) {
+            auto previous = tokens[i - 1];
+            if (previous.is_any_of(statement_ends))
+                break;
+            if (previous.is(TokenType::Invalid)) {
+                error.m_follows_invalid_token = true;
+                break;
+            }
+        }
+    }
+}
+
+}
+
+ParseResult parse(Tokens const& tokens, Interner&& symbols,
+    FunctionBodies function_bodies)
+{
+    auto errors = ParseErrors();
+
+    auto expressions
+        = TRY(ParsedExpressions::create(move(symbols)));
+    expressions.function_bodies = function_bodies;
+    TRY(parse_top_level_items(errors, expressions, tokens, 0,
+        tokens.size()));
+    if (errors.has_error()) {
+        mark_errors_following_invalid_tokens(errors, tokens.view());
+        return errors;
+    }
+    TRY(expressions.index_declarations());
+    return expressions;
+}
+
+ErrorOr<void, ParseErrors> parse_lazy_bodies(
+    ParsedExpressions& expressions, Tokens const& tokens)
+{
+    auto errors = ParseErrors();
+    for (auto body : expressions.lazy_bodies) {
+        auto block = TRY(parse_block(errors, expressions, tokens,
+            body.open_curly));
+        if (block.type() == ExpressionType::Invalid)
+            continue;
+        expressions[body.block]
+            = expressions[block.release_as_block()];
+    }
+    if (errors.has_error()) {
+        mark_errors_following_invalid_tokens(errors, tokens.view());
+        return errors;
+    }
+    expressions.lazy_bodies.truncate(0);
+    return {};
+}
+
+namespace {
+
+// NOTE: Vectors of ParsedExpressions, other than the ones holding
+//       expression nodes, that the parser appends to.
+#define SHARDED_VECTORS            \
+    X(late_expressions)            \
+    X(children)                    \
+    X(initializerss)               \
+    X(memberss)                    \
+    X(parameterss)                 \
+    X(member_access_data)          \
+    X(top_level_inline_cs)         \
+    X(top_level_private_variables) \
+    X(top_level_public_variables)  \
+    X(top_level_private_constants) \
+    X(top_level_public_constants)  \
+    X(declarations)                \
+    X(declaration_starts)          \
+    X(lazy_bodies)
+
+// NOTE: Where the nodes of a shard end up once the shards are
+//       merged.
+struct ShardOffsets {
+#define X(T, name, ...) u32 name##s;
+    EXPRESSIONS
+#undef X
+#define X(name) u32 name;
+    SHARDED_VECTORS
+#undef X
+};
+
+struct ParseShard {
+    Tokens const& tokens;
+    u32 start;
+    u32 end;
+    FunctionBodies function_bodies;
+    Optional<ParsedExpressions> expressions {};
+    ShardOffsets offsets {};
+
+    void operator()();
+};
+
+struct ShardMerge {
+    ParsedExpressions& into;
+    ParseShard& shard;
+
+    void operator()();
+};
+
+ErrorOr<Vector<u32>> find_shard_starts(View<Token const> tokens,
+    u32 shard_count);
+ErrorOr<void> make_room_for_shards(View<ParseShard> shards);
+
 }
 
-ParseResult parse(Tokens const& tokens)
+ParseResult parse_in_parallel(Tokens const& tokens,
+    Interner&& symbols, FunctionBodies function_bodies, u32 threads)
 {
+    constexpr u32 min_shard_tokens = 64 * 1024;
+    auto shard_count = tokens.size() / min_shard_tokens;
+    if (threads < shard_count)
+        shard_count = threads;
+    if (shard_count <= 1)
+        return parse(tokens, move(symbols), function_bodies);
+
+    auto starts
+        = TRY(find_shard_starts(tokens.view(), shard_count));
+    if (starts.size() <= 1)
+        return parse(tokens, move(symbols), function_bodies);
+
+    auto shards = TRY(Vector<ParseShard>::create(starts.size()));
+    for (u32 i = 0; i < starts.size(); i++) {
+        auto end = i + 1 < starts.size() ? starts[i + 1]
+                                         : tokens.size();
+        TRY(shards.append(ParseShard {
+            .tokens = tokens,
+            .start = starts[i],
+            .end = end,
+            .function_bodies = function_bodies,
+        }));
+    }
+
+    Core::run_in_parallel(shards.view());
+
+    // NOTE: A shard that did not parse cleanly, or whose last item
+    //       ran past its end, was split somewhere the serial parser
+    //       would not have been. Parsing everything again reports
+    //       errors exactly as the serial parser does.
+    for (auto const& shard : shards) {
+        if (!shard.expressions.has_value())
+            return parse(tokens, move(symbols), function_bodies);
+    }
+
+    // NOTE: Every shard starts where the serial parser would start
+    //       a top level item, so appending them in order gives the
+    //       same expressions in the same order.
+    auto& expressions = shards[0].expressions.value();
+    auto merges = TRY(Vector<ShardMerge>::create(shards.size()));
+    for (u32 i = 1; i < shards.size(); i++) {
+        merges.unchecked_append(ShardMerge {
+            .into = expressions,
+            .shard = shards[i],
+        });
+    }
+    TRY(make_room_for_shards(shards.view()));
+    Core::run_in_parallel(merges.view());
+    expressions.symbols = move(symbols);
+    TRY(expressions.index_declarations());
+    return shards[0].expressions.release_value();
+}
+
+namespace {
+
+void ParseShard::operator()()
+{
+    auto symbols = Interner::create();
+    if (symbols.is_error())
+        return;
+    auto created
+        = ParsedExpressions::create(symbols.release_value());
+    if (created.is_error())
+        return;
+    auto shard = created.release_value();
+    shard.function_bodies = function_bodies;
     auto errors = ParseErrors();
+    auto items_end = parse_top_level_items(errors, shard, tokens,
+        start, end);
+    if (items_end.is_error() || errors.has_error())
+        return;
+    if (items_end.value() != end)
+        return;
+    expressions = move(shard);
+}
 
-    auto expressions = TRY(ParsedExpressions::create());
+// NOTE: Splits before the first fn, c_fn or pub outside of any
+//       brackets at or after each even split of the tokens.
+ErrorOr<Vector<u32>> find_shard_starts(View<Token const> tokens,
+    u32 shard_count)
+{
+    auto starts = TRY(Vector<u32>::create(shard_count));
+    starts.unchecked_append(0);
+    for (u32 i = 0; i < tokens.size(); i++) {
+        auto token = tokens[i];
+        if (token.is_opening()) {
+            auto partner = partner_of(tokens, i);
+            if (partner == Token::no_partner)
+                break;
+            i = partner;
+            continue;
+        }
+        TokenType item_starts[] = {
+            TokenType::Fn,
+            TokenType::CFn,
+            TokenType::Pub,
+        };
+        if (!token.is_any_of(item_starts))
+            continue;
+        auto split
+            = (u64)tokens.size() * starts.size() / shard_count;
+        if (i < split)
+            continue;
+        starts.unchecked_append(i);
+        if (starts.size() == shard_count)
+            break;
+    }
+    return starts;
+}
+
+template <typename T>
+void rebase_id(Id<T>& id, u32 offset)
+{
+    if (id.is_valid())
+        id = Id<T>(id.raw() + offset);
+}
+
+u32 offset_of(ShardOffsets const& offsets, ExpressionType type)
+{
+    switch (type) {
+#define X(T, name, ...) \
+    case ExpressionType::T: return offsets.name##s;
+        EXPRESSIONS
+#undef X
+    }
+}
+
+template <typename T>
+void rebase(T&, ShardOffsets const&)
+{
+}
+
+void rebase(Expression& expression, ShardOffsets const& offsets)
+{
+    expression.rebase(offset_of(offsets, expression.type()));
+}
+
+void rebase(Block& block, ShardOffsets const& offsets)
+{
+    block.expressions.first += offsets.children;
+}
+
+void rebase(RValue& rvalue, ShardOffsets const& offsets)
+{
+    rvalue.expressions.first += offsets.children;
+}
+
+void rebase(FunctionCall& call, ShardOffsets const& offsets)
+{
+    call.arguments.first += offsets.children;
+}
+
+void rebase(BinaryOperation& operation, ShardOffsets const& offsets)
+{
+    operation.operands += offsets.children;
+}
+
+void rebase(UnaryOperation& operation, ShardOffsets const& offsets)
+{
+    operation.operand += offsets.children;
+}
+
+void rebase(MutableReference& reference,
+    ShardOffsets const& offsets)
+{
+    rebase_id(reference.lvalue, offsets.lvalues);
+}
+
+template <typename T>
+requires requires(T declaration) { declaration.members; }
+void rebase(T& declaration, ShardOffsets const& offsets)
+{
+    rebase_id(declaration.members, offsets.memberss);
+}
+
+void rebase(MemberAccess& access, ShardOffsets const& offsets)
+{
+    rebase_id(access.members, offsets.member_access_data);
+}
+
+void rebase(StructInitializer& initializer,
+    ShardOffsets const& offsets)
+{
+    rebase_id(initializer.initializers, offsets.initializerss);
+}
+
+void rebase(Initializers& initializers, ShardOffsets const& offsets)
+{
+    for (auto& initializer : initializers)
+        rebase_id(initializer.value, offsets.rvalues);
+}
+
+void rebase(ArrayAccess& access, ShardOffsets const& offsets)
+{
+    rebase_id(access.index, offsets.rvalues);
+}
+
+template <typename T>
+requires requires(T function) { function.parameters; }
+void rebase(T& function, ShardOffsets const& offsets)
+{
+    rebase_id(function.parameters, offsets.parameterss);
+    rebase_id(function.block, offsets.blocks);
+}
+
+template <typename T>
+requires requires(T statement) { statement.condition; }
+void rebase(T& statement, ShardOffsets const& offsets)
+{
+    rebase_id(statement.condition, offsets.rvalues);
+    rebase_id(statement.block, offsets.blocks);
+}
+
+void rebase(LazyBody& body, ShardOffsets const& offsets)
+{
+    rebase_id(body.block, offsets.blocks);
+}
+
+void rebase(VariableAssignment& assignment,
+    ShardOffsets const& offsets)
+{
+    rebase_id(assignment.value, offsets.rvalues);
+}
+
+template <typename T>
+requires requires(T value) { value.value.raw(); }
+void rebase(T& value, ShardOffsets const& offsets)
+{
+    rebase_id(value.value, offsets.late_expressions);
+}
+
+ErrorOr<void> make_room_for_shards(View<ParseShard> shards)
+{
+    auto& expressions = shards[0].expressions.value();
+    auto offsets = ShardOffsets {
+#define X(T, name, ...) .name##s = expressions.name##s.size(),
+        EXPRESSIONS
+#undef X
+#define X(name) .name = expressions.name.size(),
+        SHARDED_VECTORS
+#undef X
+    };
+    for (u32 i = 1; i < shards.size(); i++) {
+        auto const& shard = shards[i].expressions.value();
+        shards[i].offsets = offsets;
+#define X(T, name, ...) offsets.name##s += shard.name##s.size();
+        EXPRESSIONS
+#undef X
+#define X(name) offsets.name += shard.name.size();
+        SHARDED_VECTORS
+#undef X
+    }
+#define X(T, name, ...)                         \
+    if (offsets.name##s > Expression::max_ids)  \
+        return Error::from_string_literal(      \
+            "too many expressions");
+    EXPRESSIONS
+#undef X
+
+    // NOTE: Reserve everything first, so nothing can fail once the
+    //       uninitialized slots exist. They must not be destroyed
+    //       before the shards have been moved into them.
+#define X(T, name, ...) \
+    TRY(expressions.name##s.ensure_capacity(offsets.name##s));
+    EXPRESSIONS
+#undef X
+#define X(name) TRY(expressions.name.ensure_capacity(offsets.name));
+    SHARDED_VECTORS
+#undef X
+
+#define X(T, name, ...)                            \
+    MUST(expressions.name##s.append_uninitialized( \
+        offsets.name##s - expressions.name##s.size()));
+    EXPRESSIONS
+#undef X
+#define X(name)                                 \
+    MUST(expressions.name.append_uninitialized( \
+        offsets.name - expressions.name.size()));
+    SHARDED_VECTORS
+#undef X
+
+    return {};
+}
+
+template <typename T>
+void move_rebased(Vector<T>& into, u32 offset, Vector<T>& from,
+    ShardOffsets const& offsets)
+{
+    auto* slots = &into[offset];
+    for (u32 i = 0; i < from.size(); i++) {
+        new (&slots[i]) T(move(from[i]));
+        rebase(slots[i], offsets);
+    }
+}
+
+void ShardMerge::operator()()
+{
+    auto& from = shard.expressions.value();
+    auto const& offsets = shard.offsets;
+#define X(T, name, ...)                                        \
+    move_rebased(into.name##s, offsets.name##s, from.name##s, \
+        offsets);
+    EXPRESSIONS
+#undef X
+#define X(name) \
+    move_rebased(into.name, offsets.name, from.name, offsets);
+    SHARDED_VECTORS
+#undef X
+}
+
+// NOTE: Where to carry on after the top level item at `start`
+//       failed to parse at `error`. Skipping past the outermost
+//       brackets around the error keeps the rest of a broken body
+//       from being parsed as top level items.
+u32 recovery_point(Tokens const& tokens, u32 start, u32 error)
+{
+    for (u32 i = start; i < error; i++) {
+        auto token = tokens[i];
+        if (!token.is_opening())
+            continue;
+        auto partner = partner_of(tokens.view(), i);
+        if (partner == Token::no_partner)
+            break;
+        if (partner >= error)
+            return partner + 1;
+        i = partner;
+    }
+    return error + 1;
+}
+
+// NOTE: Where a statement that failed to parse before `end` goes
+//       on: past its ';', or at the '}' closing its block if it
+//       has none. The error it reported would otherwise cascade
+//       into an "expected ';'" on whatever follows.
+u32 statement_recovery_point(Tokens const& tokens, u32 end)
+{
+    if (end != 0 && tokens[end - 1].is(TokenType::Semicolon))
+        return end;
+    for (u32 i = end; i < tokens.size(); i++) {
+        auto token = tokens[i];
+        if (token.is(TokenType::Semicolon))
+            return i + 1;
+        if (token.is(TokenType::CloseCurly))
+            return i;
+        if (!token.is_opening())
+            continue;
+        auto partner = partner_of(tokens.view(), i);
+        if (partner != Token::no_partner)
+            i = partner;
+    }
+    return tokens.size();
+}
+
+ErrorOr<u32, ParseErrors> parse_top_level_items(ParseErrors& errors,
+    ParsedExpressions& expressions, Tokens const& tokens, u32 start,
+    u32 end)
+{
     u32 last_error_index = 0;
-    for (u32 start = 0; start < tokens.size();) {
+    for (; start < end;) {
         if (tokens[start].is(TokenType::NewLine))
             continue; // Ignore leading and trailing new lines.
         auto token = tokens[start];
@@ -49,18 +721,26 @@ ParseResult parse(Tokens const& tokens)
         if (token.is(TokenType::Import)) {
             auto import_he = TRY(parse_import_he(errors,
                 expressions, tokens, start));
-            if (import_he.type() == ExpressionType::Invalid)
-                last_error_index = import_he.end_token_index() - 1;
-            start = import_he.end_token_index();
+            if (import_he.type() == ExpressionType::Invalid) {
+                start = recovery_point(tokens, start,
+                    expressions.end_token_index(import_he) - 1);
+                last_error_index = start - 1;
+                continue;
+            }
+            start = expressions.end_token_index(import_he);
             continue;
         }
 
         if (token.is(TokenType::ImportC)) {
             auto import_c = TRY(
                 parse_import_c(errors, expressions, tokens, start));
-            if (import_c.type() == ExpressionType::Invalid)
-                last_error_index = import_c.end_token_index() - 1;
-            start = import_c.end_token_index();
+            if (import_c.type() == ExpressionType::Invalid) {
+                start = recovery_point(tokens, start,
+                    expressions.end_token_index(import_c) - 1);
+                last_error_index = start - 1;
+                continue;
+            }
+            start = expressions.end_token_index(import_c);
             continue;
         }
 
@@ -71,9 +751,13 @@ ParseResult parse(Tokens const& tokens)
         if (token.is_any_of(inline_cs)) {
             auto inline_c = TRY(
                 parse_inline_c(errors, expressions, tokens, start));
-            if (inline_c.type() == ExpressionType::Invalid)
-                last_error_index = inline_c.end_token_index() - 1;
-            start = inline_c.end_token_index();
+            if (inline_c.type() == ExpressionType::Invalid) {
+                start = recovery_point(tokens, start,
+                    expressions.end_token_index(inline_c) - 1);
+                last_error_index = start - 1;
+                continue;
+            }
+            start = expressions.end_token_index(inline_c);
             TRY(expressions.top_level_inline_cs.append(
                 expressions[inline_c.as_inline_c()]));
             continue;
@@ -82,27 +766,42 @@ ParseResult parse(Tokens const& tokens)
         if (token.is(TokenType::Fn)) {
             auto expression = TRY(parse_private_function(errors,
                 expressions, tokens, start));
-            if (expression.type() == ExpressionType::Invalid)
-                last_error_index = expression.end_token_index() - 1;
-            start = expression.end_token_index();
+            if (expression.type() == ExpressionType::Invalid) {
+                start = recovery_point(tokens, start,
+                    expressions.end_token_index(expression) - 1);
+                last_error_index = start - 1;
+                continue;
+            }
+            TRY(expressions.append_declaration(expression, start));
+            start = expressions.end_token_index(expression);
             continue;
         }
 
         if (token.is(TokenType::CFn)) {
             auto expression = TRY(parse_private_c_function(errors,
                 expressions, tokens, start));
-            if (expression.type() == ExpressionType::Invalid)
-                last_error_index = expression.end_token_index() - 1;
-            start = expression.end_token_index();
+            if (expression.type() == ExpressionType::Invalid) {
+                start = recovery_point(tokens, start,
+                    expressions.end_token_index(expression) - 1);
+                last_error_index = start - 1;
+                continue;
+            }
+            TRY(expressions.append_declaration(expression, start));
+            start = expressions.end_token_index(expression);
             continue;
         }
 
         if (token.is(TokenType::Pub)) {
             auto pub = TRY(parse_pub_specifier(errors, expressions,
                 tokens, start));
-            if (pub.type() == ExpressionType::Invalid)
-                last_error_index = pub.end_token_index() - 1;
-            start = pub.end_token_index();
+            if (pub.type() == ExpressionType::Invalid) {
+                start = recovery_point(tokens, start,
+                    expressions.end_token_index(pub) - 1);
+                last_error_index = start - 1;
+                continue;
+            }
+            TRY(expressions.append_declaration(pub, start));
+            start = expressions.end_token_index(pub);
             if (pub.type()
                 == ExpressionType::PublicConstantDeclaration) {
                 auto constant = expressions
@@ -124,9 +823,14 @@ ParseResult parse(Tokens const& tokens)
             auto expression
                 = TRY(parse_top_level_constant_or_struct(errors,
                     expressions, tokens, start));
-            if (expression.type() == ExpressionType::Invalid)
-                last_error_index = expression.end_token_index() - 1;
-            start = expression.end_token_index();
+            if (expression.type() == ExpressionType::Invalid) {
+                start = recovery_point(tokens, start,
+                    expressions.end_token_index(expression) - 1);
+                last_error_index = start - 1;
+                continue;
+            }
+            TRY(expressions.append_declaration(expression, start));
+            start = expressions.end_token_index(expression);
             if (expression.type()
                 == ExpressionType::PrivateConstantDeclaration) {
                 auto constant = expressions
@@ -141,9 +845,14 @@ ParseResult parse(Tokens const& tokens)
             auto expression
                 = TRY(parse_private_variable_declaration(errors,
                     expressions, tokens, start));
-            if (expression.type() == ExpressionType::Invalid)
-                last_error_index = expression.end_token_index() - 1;
-            start = expression.end_token_index();
+            if (expression.type() == ExpressionType::Invalid) {
+                start = recovery_point(tokens, start,
+                    expressions.end_token_index(expression) - 1);
+                last_error_index = start - 1;
+                continue;
+            }
+            TRY(expressions.append_declaration(expression, start));
+            start = expressions.end_token_index(expression);
             auto variable = expressions
                 [expression.as_private_variable_declaration()];
             TRY(expressions.top_level_private_variables.append(
@@ -160,20 +869,20 @@ ParseResult parse(Tokens const& tokens)
                 token,
             }));
         }
+        // NOTE: Skip stray bracketed code as a whole.
+        auto partner = partner_of(tokens.view(), start);
+        if (token.is_opening() && partner != Token::no_partner)
+            start = partner;
         last_error_index = start;
         start++;
     }
 
-    if (errors.has_error())
-        return errors;
-    return expressions;
+    return start;
 }
 
-namespace {
-
 [[maybe_unused]] ParseSingleItemResult parse_uninitialized(
-    ParseErrors& errors, ParsedExpressions&, Tokens const& tokens,
-    u32 start)
+    ParseErrors& errors, ParsedExpressions& expressions,
+    Tokens const& tokens, u32 start)
 {
     auto uninitialized_index = start;
     auto uninitialized = tokens[uninitialized_index];
@@ -183,7 +892,7 @@ namespace {
             "this is probably a parser error",
             tokens[start],
         }));
-        return Expression::garbage(start, uninitialized_index);
+        return TRY(expressions.create_garbage(uninitialized_index));
     }
 
     auto open_paren_index = uninitialized_index + 1;
@@ -194,7 +903,7 @@ namespace {
             "function call need parenthesis",
             open_paren,
         }));
-        return Expression::garbage(start, open_paren_index);
+        return TRY(expressions.create_garbage(open_paren_index));
     }
 
     auto close_paren_index = open_paren_index + 1;
@@ -205,15 +914,53 @@ namespace {
             "did you forget a closing parenthesis?",
             close_paren,
         }));
-        return Expression::garbage(start, close_paren_index);
+        return TRY(expressions.create_garbage(close_paren_index));
     }
 
     auto end = close_paren_index;
-    return Expression {
-        ParsedExpressions::uninitialized_expression(),
-        start,
-        end + 1,
-    };
+    auto id = ParsedExpressions::uninitialized_expression();
+    return TRY(expressions.create_expression(id, end + 1));
+}
+
+ParseSingleItemResult parse_size_of(ParseErrors& errors,
+    ParsedExpressions& expressions, Tokens const& tokens, u32 start)
+{
+    auto open_paren_index = start + 1;
+    auto open_paren = tokens[open_paren_index];
+    if (open_paren.is_not(TokenType::OpenParen)) {
+        TRY(errors.append_or_short({
+            "expected '('",
+            "function call need parenthesis",
+            open_paren,
+        }));
+        return TRY(expressions.create_garbage(open_paren_index));
+    }
+
+    auto type_index = open_paren_index + 1;
+    auto type = tokens[type_index];
+    if (type.is_not(TokenType::Identifier)) {
+        TRY(errors.append_or_short({
+            "expected type name",
+            nullptr,
+            type,
+        }));
+        return TRY(expressions.create_garbage(type_index));
+    }
+
+    auto close_paren_index = type_index + 1;
+    auto close_paren = tokens[close_paren_index];
+    if (close_paren.is_not(TokenType::CloseParen)) {
+        TRY(errors.append_or_short({
+            "expected ')'",
+            "did you forget a closing parenthesis?",
+            close_paren,
+        }));
+        return TRY(expressions.create_garbage(close_paren_index));
+    }
+
+    auto size_of = TRY(expressions.append(SizeOf { type }));
+    return TRY(expressions.create_expression(size_of,
+        close_paren_index + 1));
 }
 
 ParseSingleItemResult parse_literal(ParseErrors&,
@@ -222,11 +969,7 @@ ParseSingleItemResult parse_literal(ParseErrors&,
     auto literal = TRY(expressions.append(Literal {
         tokens[start],
     }));
-    return Expression {
-        literal,
-        start,
-        start + 1,
-    };
+    return TRY(expressions.create_expression(literal, start + 1));
 }
 
 ParseSingleItemResult parse_lvalue(ParseErrors&,
@@ -236,11 +979,7 @@ ParseSingleItemResult parse_lvalue(ParseErrors&,
         tokens[start],
     }));
 
-    return Expression {
-        lvalue,
-        start,
-        start + 1,
-    };
+    return TRY(expressions.create_expression(lvalue, start + 1));
 }
 
 ParseSingleItemResult parse_struct_initializer(ParseErrors& errors,
@@ -256,7 +995,7 @@ ParseSingleItemResult parse_struct_initializer(ParseErrors& errors,
             nullptr,
             open_curly,
         }));
-        return Expression::garbage(start, open_curly_index);
+        return TRY(expressions.create_garbage(open_curly_index));
     }
 
     auto initializers_id
@@ -275,7 +1014,7 @@ ParseSingleItemResult parse_struct_initializer(ParseErrors& errors,
                 "did you forget a dot before member name?",
                 dot,
             }));
-            return Expression::garbage(start, dot_index);
+            return TRY(expressions.create_garbage(dot_index));
         }
 
         auto name_index = dot_index + 1;
@@ -286,7 +1025,7 @@ ParseSingleItemResult parse_struct_initializer(ParseErrors& errors,
                 nullptr,
                 name,
             }));
-            return Expression::garbage(start, name_index);
+            return TRY(expressions.create_garbage(name_index));
         }
 
         auto assign_index = name_index + 1;
@@ -297,14 +1036,14 @@ ParseSingleItemResult parse_struct_initializer(ParseErrors& errors,
                 nullptr,
                 assign,
             }));
-            return Expression::garbage(start, assign_index);
+            return TRY(expressions.create_garbage(assign_index));
         }
 
         auto value_index = assign_index + 1;
         auto value = TRY(parse_irvalue(errors, expressions, tokens,
             value_index));
 
-        auto comma_index = value.end_token_index();
+        auto comma_index = expressions.end_token_index(value);
         auto comma = tokens[comma_index];
         if (comma.is_not(TokenType::Comma)) {
             TRY(errors.append_or_short({
@@ -312,7 +1051,7 @@ ParseSingleItemResult parse_struct_initializer(ParseErrors& errors,
                 nullptr,
                 comma,
             }));
-            return Expression::garbage(start, comma_index);
+            return TRY(expressions.create_garbage(comma_index));
         }
         end = comma_index + 1; // NOTE: Consume comma.
 
@@ -328,7 +1067,7 @@ ParseSingleItemResult parse_struct_initializer(ParseErrors& errors,
             nullptr,
             tokens[end],
         }));
-        return Expression::garbage(start, end);
+        return TRY(expressions.create_garbage(end));
     }
 
     auto struct_initializer_id
@@ -338,11 +1077,8 @@ ParseSingleItemResult parse_struct_initializer(ParseErrors& errors,
         }));
 
     // NOTE: Consume close curly.
-    return Expression {
-        struct_initializer_id,
-        start,
-        end + 1,
-    };
+    return TRY(expressions.create_expression(struct_initializer_id,
+        end + 1));
 }
 
 ParseSingleItemResult parse_if_statement(ParseErrors& errors,
@@ -350,7 +1086,7 @@ ParseSingleItemResult parse_if_statement(ParseErrors& errors,
 {
     auto condition = TRY(
         parse_if_rvalue(errors, expressions, tokens, start + 1));
-    auto block_start_index = condition.end_token_index();
+    auto block_start_index = expressions.end_token_index(condition);
     auto block_start = tokens[block_start_index];
     if (block_start.is_not(TokenType::OpenCurly)) {
         TRY(errors.append_or_short({
@@ -358,17 +1094,17 @@ ParseSingleItemResult parse_if_statement(ParseErrors& errors,
             "helium requires '{' after condition for if statements",
             block_start,
         }));
-        return Expression::garbage(start, block_start_index);
+        return TRY(expressions.create_garbage(block_start_index));
     }
     auto block = TRY(parse_block(errors, expressions, tokens,
         block_start_index));
 
-    auto end = block.end_token_index();
+    auto end = expressions.end_token_index(block);
     auto if_statement = TRY(expressions.append(If {
         condition.release_as_rvalue(),
         block.release_as_block(),
     }));
-    return Expression(if_statement, start, end);
+    return TRY(expressions.create_expression(if_statement, end));
 }
 
 ParseSingleItemResult parse_while_statement(ParseErrors& errors,
@@ -376,7 +1112,7 @@ ParseSingleItemResult parse_while_statement(ParseErrors& errors,
 {
     auto condition = TRY(
         parse_if_rvalue(errors, expressions, tokens, start + 1));
-    auto block_start_index = condition.end_token_index();
+    auto block_start_index = expressions.end_token_index(condition);
     auto block_start = tokens[block_start_index];
     if (block_start.is_not(TokenType::OpenCurly)) {
         TRY(errors.append_or_short({
@@ -384,18 +1120,18 @@ ParseSingleItemResult parse_while_statement(ParseErrors& errors,
             "helium requires '{' after condition for loops",
             block_start,
         }));
-        return Expression::garbage(start, block_start_index);
+        return TRY(expressions.create_garbage(block_start_index));
     }
     auto block = TRY(parse_block(errors, expressions, tokens,
         block_start_index));
 
-    auto end = block.end_token_index();
+    auto end = expressions.end_token_index(block);
 
     auto while_ = TRY(expressions.append(While {
         condition.release_as_rvalue(),
         block.release_as_block(),
     }));
-    return Expression(while_, start, end);
+    return TRY(expressions.create_expression(while_, end));
 }
 
 ParseSingleItemResult parse_import_he(ParseErrors& errors,
@@ -409,7 +1145,7 @@ ParseSingleItemResult parse_import_he(ParseErrors& errors,
             "did you forget a opening parenthesis?",
             left_paren,
         }));
-        return Expression::garbage(start, left_paren_index);
+        return TRY(expressions.create_garbage(left_paren_index));
     }
 
     auto header_index = left_paren_index + 1;
@@ -420,7 +1156,7 @@ ParseSingleItemResult parse_import_he(ParseErrors& errors,
             "did you forget the quotes around the module name?",
             header,
         }));
-        return Expression::garbage(start, header_index);
+        return TRY(expressions.create_garbage(header_index));
     }
 
     auto right_paren_index = header_index + 1;
@@ -431,7 +1167,7 @@ ParseSingleItemResult parse_import_he(ParseErrors& errors,
             "did you forget a closing parenthesis?",
             left_paren,
         }));
-        return Expression::garbage(start, right_paren_index);
+        return TRY(expressions.create_garbage(right_paren_index));
     }
 
     auto semicolon_index = right_paren_index + 1;
@@ -442,7 +1178,7 @@ ParseSingleItemResult parse_import_he(ParseErrors& errors,
             "did you forget a semicolon?",
             header,
         }));
-        return Expression::garbage(start, semicolon_index);
+        return TRY(expressions.create_garbage(semicolon_index));
     }
 
     auto import_he = TRY(expressions.append(Import {
@@ -450,7 +1186,8 @@ ParseSingleItemResult parse_import_he(ParseErrors& errors,
     }));
 
     // NOTE: Swallow semicolon.
-    return Expression(import_he, start, semicolon_index + 1);
+    return TRY(expressions.create_expression(import_he,
+        semicolon_index + 1));
 }
 
 ParseSingleItemResult parse_import_c(ParseErrors& errors,
@@ -464,7 +1201,7 @@ ParseSingleItemResult parse_import_c(ParseErrors& errors,
             "did you forget a opening parenthesis?",
             left_paren,
         }));
-        return Expression::garbage(start, left_paren_index);
+        return TRY(expressions.create_garbage(left_paren_index));
     }
 
     auto header_index = left_paren_index + 1;
@@ -475,7 +1212,7 @@ ParseSingleItemResult parse_import_c(ParseErrors& errors,
             "system headers are also imported with quotes",
             header,
         }));
-        return Expression::garbage(start, header_index);
+        return TRY(expressions.create_garbage(header_index));
     }
 
     auto right_paren_index = header_index + 1;
@@ -486,7 +1223,7 @@ ParseSingleItemResult parse_import_c(ParseErrors& errors,
             "did you forget a closing parenthesis?",
             left_paren,
         }));
-        return Expression::garbage(start, right_paren_index);
+        return TRY(expressions.create_garbage(right_paren_index));
     }
 
     auto semicolon_index = right_paren_index + 1;
@@ -497,7 +1234,7 @@ ParseSingleItemResult parse_import_c(ParseErrors& errors,
             "did you forget a semicolon?",
             header,
         }));
-        return Expression::garbage(start, semicolon_index);
+        return TRY(expressions.create_garbage(semicolon_index));
     }
 
     auto import_c = TRY(expressions.append(ImportC {
@@ -505,7 +1242,8 @@ ParseSingleItemResult parse_import_c(ParseErrors& errors,
     }));
 
     // NOTE: Swallow semicolon.
-    return Expression(import_c, start, semicolon_index + 1);
+    return TRY(expressions.create_expression(import_c,
+        semicolon_index + 1));
 }
 
 ParseSingleItemResult parse_pub_specifier(ParseErrors& errors,
@@ -533,7 +1271,7 @@ ParseSingleItemResult parse_pub_specifier(ParseErrors& errors,
         nullptr,
         fn,
     }));
-    return Expression::garbage(start, fn_index);
+    return TRY(expressions.create_garbage(fn_index));
 }
 
 struct Function {
@@ -552,8 +1290,8 @@ struct Function {
     static constexpr Function garbage(u32 start, u32 end)
     {
         return {
-            .name = { TokenType::Invalid, 0 },
-            .return_type = { TokenType::Invalid, 0 },
+            .name = { TokenType::Invalid, 0, 0 },
+            .return_type = { TokenType::Invalid, 0, 0 },
             .parameters = Id<Parameters>::invalid(),
             .block = Id<Block>::invalid(),
             .start_token_index = start,
@@ -686,9 +1424,33 @@ ErrorOr<Function, ParseErrors> parse_function(ParseErrors& errors,
         return Function::garbage(start, block_start_index);
     }
 
+    // NOTE: Bodies without a closing '}' are parsed anyway, to
+    //       report where they go wrong.
+    auto block_end = partner_of(tokens.view(), block_start_index);
+    auto skip_body
+        = expressions.function_bodies == FunctionBodies::Skip
+        && block_end != Token::no_partner;
+    if (skip_body) {
+        auto block_id = TRY(expressions.append(Block {}));
+        TRY(expressions.lazy_bodies.append(LazyBody {
+            block_id,
+            block_start_index,
+        }));
+        return Function {
+            name,
+            return_type,
+            parameters_id,
+            block_id,
+            start,
+            block_end + 1,
+        };
+    }
+
     auto block = TRY(parse_block(errors, expressions, tokens,
         block_start_index));
-    auto block_end_index = block.end_token_index();
+    auto block_end_index = expressions.end_token_index(block);
+    if (block.type() == ExpressionType::Invalid)
+        return Function::garbage(start, block_end_index - 1);
 
     return Function {
         name,
@@ -706,8 +1468,8 @@ ParseSingleItemResult parse_public_function(ParseErrors& errors,
     auto function
         = TRY(parse_function(errors, expressions, tokens, start));
     if (function.is_garbage()) {
-        return Expression::garbage(function.start_token_index,
-            function.end_token_index - 1);
+        return TRY(expressions.create_garbage(
+            function.end_token_index - 1));
     }
 
     auto function_id = TRY(expressions.append(PublicFunction {
@@ -716,11 +1478,8 @@ ParseSingleItemResult parse_public_function(ParseErrors& errors,
         .parameters = function.parameters,
         .block = function.block,
     }));
-    return Expression {
-        function_id,
-        function.start_token_index,
-        function.end_token_index,
-    };
+    return TRY(expressions.create_expression(function_id,
+        function.end_token_index));
 }
 
 ParseSingleItemResult parse_public_c_function(ParseErrors& errors,
@@ -729,8 +1488,8 @@ ParseSingleItemResult parse_public_c_function(ParseErrors& errors,
     auto function
         = TRY(parse_function(errors, expressions, tokens, start));
     if (function.is_garbage()) {
-        return Expression::garbage(function.start_token_index,
-            function.end_token_index - 1);
+        return TRY(expressions.create_garbage(
+            function.end_token_index - 1));
     }
     auto function_id = TRY(expressions.append(PublicCFunction {
         .name = function.name,
@@ -738,11 +1497,8 @@ ParseSingleItemResult parse_public_c_function(ParseErrors& errors,
         .parameters = function.parameters,
         .block = function.block,
     }));
-    return Expression {
-        function_id,
-        function.start_token_index,
-        function.end_token_index,
-    };
+    return TRY(expressions.create_expression(function_id,
+        function.end_token_index));
 }
 
 ParseSingleItemResult parse_private_function(ParseErrors& errors,
@@ -751,8 +1507,8 @@ ParseSingleItemResult parse_private_function(ParseErrors& errors,
     auto function
         = TRY(parse_function(errors, expressions, tokens, start));
     if (function.is_garbage()) {
-        return Expression::garbage(function.start_token_index,
-            function.end_token_index - 1);
+        return TRY(expressions.create_garbage(
+            function.end_token_index - 1));
     }
     auto function_id = TRY(expressions.append(PrivateFunction {
         .name = function.name,
@@ -760,11 +1516,8 @@ ParseSingleItemResult parse_private_function(ParseErrors& errors,
         .parameters = function.parameters,
         .block = function.block,
     }));
-    return Expression {
-        function_id,
-        function.start_token_index,
-        function.end_token_index,
-    };
+    return TRY(expressions.create_expression(function_id,
+        function.end_token_index));
 }
 
 ParseSingleItemResult parse_private_c_function(ParseErrors& errors,
@@ -773,8 +1526,8 @@ ParseSingleItemResult parse_private_c_function(ParseErrors& errors,
     auto function
         = TRY(parse_function(errors, expressions, tokens, start));
     if (function.is_garbage()) {
-        return Expression::garbage(function.start_token_index,
-            function.end_token_index - 1);
+        return TRY(expressions.create_garbage(
+            function.end_token_index - 1));
     }
     auto function_id = TRY(expressions.append(PrivateCFunction {
         .name = function.name,
@@ -782,11 +1535,8 @@ ParseSingleItemResult parse_private_c_function(ParseErrors& errors,
         .parameters = function.parameters,
         .block = function.block,
     }));
-    return Expression {
-        function_id,
-        function.start_token_index,
-        function.end_token_index,
-    };
+    return TRY(expressions.create_expression(function_id,
+        function.end_token_index));
 }
 
 ParseSingleItemResult parse_function_call(ParseErrors& errors,
@@ -802,20 +1552,18 @@ ParseSingleItemResult parse_function_call(ParseErrors& errors,
             "did you mean to do a function call?",
             left_paren,
         }));
-        return Expression::garbage(start, left_paren_index);
+        return TRY(expressions.create_garbage(left_paren_index));
     }
 
-    auto arguments_id
-        = TRY(expressions.append(TRY(Expressions::create(8))));
-    auto call_id = TRY(expressions.append(FunctionCall {
-        .name = function_name,
-        .arguments = arguments_id,
-    }));
-    auto& call = expressions[call_id];
+    auto arguments = ChildScope(expressions);
     auto right_paren_index = left_paren_index + 1;
     if (tokens[right_paren_index].is(TokenType::CloseParen)) {
+        auto call_id = TRY(expressions.append(FunctionCall {
+            .name = function_name,
+        }));
         // NOTE: Swallow right parenthesis
-        return Expression(call_id, start, right_paren_index + 1);
+        return TRY(expressions.create_expression(call_id,
+            right_paren_index + 1));
     }
 
     right_paren_index = left_paren_index;
@@ -825,8 +1573,18 @@ ParseSingleItemResult parse_function_call(ParseErrors& errors,
         auto argument_index = right_paren_index + 1;
         auto argument = TRY(parse_prvalue(errors, expressions,
             tokens, argument_index));
-        right_paren_index = argument.end_token_index();
-        TRY(expressions[call.arguments].append(argument));
+        right_paren_index = expressions.end_token_index(argument);
+        if (argument.type() == ExpressionType::Invalid) {
+            // NOTE: The argument has reported its error, parsing
+            //       the rest of them would only cascade from it.
+            auto end = right_paren_index - 1;
+            auto close
+                = partner_of(tokens.view(), left_paren_index);
+            if (close != Token::no_partner && close > end)
+                end = close;
+            return TRY(expressions.create_garbage(end));
+        }
+        TRY(arguments.append(argument));
     }
 
     auto right_paren = tokens[right_paren_index];
@@ -836,11 +1594,16 @@ ParseSingleItemResult parse_function_call(ParseErrors& errors,
             "did you mean to do a function call?",
             right_paren,
         }));
-        return Expression::garbage(start, right_paren_index);
+        return TRY(expressions.create_garbage(right_paren_index));
     }
 
+    auto call_id = TRY(expressions.append(FunctionCall {
+        .name = function_name,
+        .arguments = TRY(arguments.close()),
+    }));
     // NOTE: Swallow right parenthesis
-    return Expression(call_id, start, right_paren_index + 1);
+    return TRY(expressions.create_expression(call_id,
+        right_paren_index + 1));
 }
 
 ParseSingleItemResult parse_return_statement(ParseErrors& errors,
@@ -858,27 +1621,20 @@ ParseSingleItemResult parse_return_statement(ParseErrors& errors,
             auto return_id = TRY(expressions.append(Return {
                 value_id,
             }));
-            return Expression {
-                return_id,
-                name_index,
-                value.end_token_index(),
-            };
+            return TRY(expressions.create_expression(return_id,
+                expressions.end_token_index(value)));
         }
     }
 
     auto value
         = TRY(parse_rvalue(errors, expressions, tokens, start + 1));
     auto value_id = TRY(expressions.append(value));
-    auto end = value.end_token_index();
+    auto end = expressions.end_token_index(value);
 
     auto return_id = TRY(expressions.append(Return {
         value_id,
     }));
-    return Expression {
-        return_id,
-        start,
-        end,
-    };
+    return TRY(expressions.create_expression(return_id, end));
 }
 
 ParseSingleItemResult parse_throw_statement(ParseErrors& errors,
@@ -896,27 +1652,20 @@ ParseSingleItemResult parse_throw_statement(ParseErrors& errors,
             auto return_id = TRY(expressions.append(Return {
                 value_id,
             }));
-            return Expression {
-                return_id,
-                name_index,
-                value.end_token_index(),
-            };
+            return TRY(expressions.create_expression(return_id,
+                expressions.end_token_index(value)));
         }
     }
 
     auto value
         = TRY(parse_rvalue(errors, expressions, tokens, start + 1));
     auto value_id = TRY(expressions.append(value));
-    auto end = value.end_token_index();
+    auto end = expressions.end_token_index(value);
 
     auto return_id = TRY(expressions.append(Throw {
         value_id,
     }));
-    return Expression {
-        return_id,
-        start,
-        end,
-    };
+    return TRY(expressions.create_expression(return_id, end));
 }
 
 ParseSingleItemResult parse_inline_c(ParseErrors& errors,
@@ -935,16 +1684,16 @@ ParseSingleItemResult parse_inline_c(ParseErrors& errors,
             "did you forget a semicolon?",
             tokens[end],
         }));
-        return Expression::garbage(start, end);
+        return TRY(expressions.create_garbage(end));
     }
     // NOTE: Swallow semicolon.
-    return Expression(inline_c, start, end + 1);
+    return TRY(expressions.create_expression(inline_c, end + 1));
 }
 
 ParseSingleItemResult parse_block(ParseErrors& errors,
     ParsedExpressions& expressions, Tokens const& tokens, u32 start)
 {
-    auto block = TRY(expressions.create_block());
+    auto children = ChildScope(expressions);
     auto end = start + 1;
     for (; end < tokens.size();) {
         if (tokens[end].is(TokenType::CloseCurly))
@@ -953,39 +1702,45 @@ ParseSingleItemResult parse_block(ParseErrors& errors,
         if (tokens[end].is(TokenType::InlineC)) {
             auto inline_c = TRY(
                 parse_inline_c(errors, expressions, tokens, end));
-            end = inline_c.end_token_index();
-            TRY(expressions[block.expressions].append(inline_c));
+            end = expressions.end_token_index(inline_c);
+            TRY(children.append(inline_c));
             continue;
         }
 
         if (tokens[end].is(TokenType::OpenCurly)) {
             auto sub_block = TRY(
                 parse_block(errors, expressions, tokens, end));
-            end = sub_block.end_token_index();
-            TRY(expressions[block.expressions].append(sub_block));
+            end = expressions.end_token_index(sub_block);
+            TRY(children.append(sub_block));
             continue;
         }
 
         if (tokens[end].is(TokenType::Let)) {
             auto variable = TRY(parse_public_constant_declaration(
                 errors, expressions, tokens, end));
-            end = variable.end_token_index();
-            TRY(expressions[block.expressions].append(variable));
+            end = expressions.end_token_index(variable);
+            TRY(children.append(variable));
             continue;
         }
 
         if (tokens[end].is(TokenType::Var)) {
             auto variable = TRY(parse_public_variable_declaration(
                 errors, expressions, tokens, end));
-            end = variable.end_token_index();
-            TRY(expressions[block.expressions].append(variable));
+            end = expressions.end_token_index(variable);
+            TRY(children.append(variable));
             continue;
         }
 
         if (tokens[end].is(TokenType::Return)) {
+            auto error_count = errors.parse_errors.size();
             auto return_expression = TRY(parse_return_statement(
                 errors, expressions, tokens, end));
-            end = return_expression.end_token_index();
+            end = expressions.end_token_index(return_expression);
+            if (errors.parse_errors.size() != error_count) {
+                end = statement_recovery_point(tokens, end);
+                TRY(children.append(return_expression));
+                continue;
+            }
 
             if (tokens[end].is_not(TokenType::Semicolon)) {
                 TRY(errors.append_or_short({
@@ -993,19 +1748,24 @@ ParseSingleItemResult parse_block(ParseErrors& errors,
                     "did you forget a semicolon?",
                     tokens[end],
                 }));
-                return Expression::garbage(start, end);
+                return TRY(expressions.create_garbage(end));
             }
             end++; // NOTE: Swallow semicolon.
 
-            TRY(expressions[block.expressions].append(
-                return_expression));
+            TRY(children.append(return_expression));
             continue;
         }
 
         if (tokens[end].is(TokenType::Throw)) {
+            auto error_count = errors.parse_errors.size();
             auto return_expression = TRY(parse_throw_statement(
                 errors, expressions, tokens, end));
-            end = return_expression.end_token_index();
+            end = expressions.end_token_index(return_expression);
+            if (errors.parse_errors.size() != error_count) {
+                end = statement_recovery_point(tokens, end);
+                TRY(children.append(return_expression));
+                continue;
+            }
 
             if (tokens[end].is_not(TokenType::Semicolon)) {
                 TRY(errors.append_or_short({
@@ -1013,12 +1773,11 @@ ParseSingleItemResult parse_block(ParseErrors& errors,
                     "did you forget a semicolon?",
                     tokens[end],
                 }));
-                return Expression::garbage(start, end);
+                return TRY(expressions.create_garbage(end));
             }
             end++; // NOTE: Swallow semicolon.
 
-            TRY(expressions[block.expressions].append(
-                return_expression));
+            TRY(children.append(return_expression));
             continue;
         }
 
@@ -1026,16 +1785,20 @@ ParseSingleItemResult parse_block(ParseErrors& errors,
             if (tokens[end + 1].is(TokenType::Assign)) {
                 auto assignment = TRY(parse_variable_assignment(
                     errors, expressions, tokens, end));
-                TRY(expressions[block.expressions].append(
-                    assignment));
-                end = assignment.end_token_index();
+                TRY(children.append(assignment));
+                end = expressions.end_token_index(assignment);
                 continue;
             }
 
+            auto error_count = errors.parse_errors.size();
             auto call = TRY(parse_function_call(errors, expressions,
                 tokens, end));
-            end = call.end_token_index();
-            TRY(expressions[block.expressions].append(call));
+            end = expressions.end_token_index(call);
+            TRY(children.append(call));
+            if (errors.parse_errors.size() != error_count) {
+                end = statement_recovery_point(tokens, end);
+                continue;
+            }
 
             if (tokens[end].is_not(TokenType::Semicolon)) {
                 TRY(errors.append_or_short({
@@ -1043,7 +1806,7 @@ ParseSingleItemResult parse_block(ParseErrors& errors,
                     "did you forget a semicolon?",
                     tokens[end],
                 }));
-                return Expression::garbage(start, end);
+                return TRY(expressions.create_garbage(end));
             }
             end++; // NOTE: Swallow semicolon.
             continue;
@@ -1052,16 +1815,16 @@ ParseSingleItemResult parse_block(ParseErrors& errors,
         if (tokens[end].is(TokenType::If)) {
             auto if_ = TRY(parse_if_statement(errors, expressions,
                 tokens, end));
-            end = if_.end_token_index();
-            TRY(expressions[block.expressions].append(if_));
+            end = expressions.end_token_index(if_);
+            TRY(children.append(if_));
             continue;
         }
 
         if (tokens[end].is(TokenType::While)) {
             auto while_ = TRY(parse_while_statement(errors,
                 expressions, tokens, end));
-            end = while_.end_token_index();
-            TRY(expressions[block.expressions].append(while_));
+            end = expressions.end_token_index(while_);
+            TRY(children.append(while_));
             continue;
         }
 
@@ -1070,17 +1833,19 @@ ParseSingleItemResult parse_block(ParseErrors& errors,
             nullptr,
             tokens[end],
         }));
-        return Expression::garbage(start, end);
+        return TRY(expressions.create_garbage(end));
     }
-    auto block_id = TRY(expressions.append(block));
+    auto block_id = TRY(expressions.append(Block {
+        TRY(children.close()),
+    }));
     // NOTE: Swallow close curly
-    return Expression(block_id, start, end + 1);
+    return TRY(expressions.create_expression(block_id, end + 1));
 }
 
 ParseSingleItemResult parse_irvalue(ParseErrors& errors,
     ParsedExpressions& expressions, Tokens const& tokens, u32 start)
 {
-    auto rvalue = TRY(expressions.create_rvalue());
+    auto values = OperatorScope(expressions);
 
     auto end = start;
     for (; end < tokens.size();) {
@@ -1093,9 +1858,8 @@ ParseSingleItemResult parse_irvalue(ParseErrors& errors,
             if (tokens[end + 1].is(TokenType::OpenCurly)) {
                 auto initializer = TRY(parse_struct_initializer(
                     errors, expressions, tokens, end));
-                end = initializer.end_token_index();
-                TRY(expressions[rvalue.expressions].append(
-                    initializer));
+                end = expressions.end_token_index(initializer);
+                TRY(values.append(initializer));
                 continue;
             }
         }
@@ -1103,63 +1867,50 @@ ParseSingleItemResult parse_irvalue(ParseErrors& errors,
         if (tokens[end].is(TokenType::InlineC)) {
             auto inline_c = TRY(
                 parse_inline_c(errors, expressions, tokens, end));
-            end = inline_c.end_token_index();
-            TRY(expressions[rvalue.expressions].append(inline_c));
-            auto rvalue_id = TRY(expressions.append(rvalue));
+            end = expressions.end_token_index(inline_c);
+            TRY(values.append(inline_c));
+            auto rvalue_id = TRY(expressions.append(RValue {
+                TRY(values.close()),
+            }));
             // NOTE: Unconsume ';'
-            return Expression {
-                rvalue_id,
-                start,
-                end - 1,
-            };
+            return TRY(expressions.create_expression(rvalue_id,
+                end - 1));
         }
 
         if (tokens[end].is(TokenType::Uninitialized)) {
             auto uninitialized = TRY(parse_uninitialized(errors,
                 expressions, tokens, end));
-            auto start = end;
-            end = uninitialized.end_token_index();
-            TRY(expressions[rvalue.expressions].append({
-                uninitialized.as_uninitialized(),
-                start,
-                end,
-            }));
+            end = expressions.end_token_index(uninitialized);
+            TRY(values.append(uninitialized));
+            continue;
+        }
+
+        if (tokens[end].is(TokenType::SizeOf)) {
+            auto size_of = TRY(
+                parse_size_of(errors, expressions, tokens, end));
+            end = expressions.end_token_index(size_of);
+            TRY(values.append(size_of));
             continue;
         }
 
         if (tokens[end].is(TokenType::Number)) {
             auto literal = TRY(
                 parse_literal(errors, expressions, tokens, end));
-            TRY(expressions[rvalue.expressions].append(literal));
-            end = literal.end_token_index();
+            TRY(values.append(literal));
+            end = expressions.end_token_index(literal);
             continue;
         }
 
-        TokenType binary_operators[] = {
-            TokenType::Plus,
-            TokenType::Minus,
-            TokenType::Star,
-
-            TokenType::Equals,
-            TokenType::LessThan,
-            TokenType::LessThanOrEqual,
-            TokenType::GreaterThan,
-            TokenType::GreaterThanOrEqual,
-        };
-        if (tokens[end].is_any_of(binary_operators)) {
-            // FIXME: Create parse_binary_operator.
-            auto literal = TRY(
-                parse_literal(errors, expressions, tokens, end));
-            TRY(expressions[rvalue.expressions].append(literal));
-            end = literal.end_token_index();
+        if (TRY(values.append_operator(tokens, end))) {
+            end++;
             continue;
         }
 
         if (tokens[end].is(TokenType::Quoted)) {
             auto literal = TRY(
                 parse_literal(errors, expressions, tokens, end));
-            TRY(expressions[rvalue.expressions].append(literal));
-            end = literal.end_token_index();
+            TRY(values.append(literal));
+            end = expressions.end_token_index(literal);
             continue;
         }
 
@@ -1167,31 +1918,29 @@ ParseSingleItemResult parse_irvalue(ParseErrors& errors,
             if (tokens[end + 1].is(TokenType::OpenParen)) {
                 auto call = TRY(parse_function_call(errors,
                     expressions, tokens, end));
-                end = call.end_token_index();
-                TRY(expressions[rvalue.expressions].append(call));
+                end = expressions.end_token_index(call);
+                TRY(values.append(call));
                 continue;
             }
             if (tokens[end + 1].is(TokenType::OpenCurly)) {
                 auto initializer = TRY(parse_struct_initializer(
                     errors, expressions, tokens, start));
-                end = initializer.end_token_index() + 1;
-                TRY(expressions[rvalue.expressions].append(
-                    initializer));
+                end = expressions.end_token_index(initializer) + 1;
+                TRY(values.append(initializer));
                 continue;
             }
             if (tokens[end + 1].is(TokenType::Dot)) {
                 auto member_access = TRY(parse_member_access(errors,
                     expressions, tokens, end));
-                end = member_access.end_token_index();
-                TRY(expressions[rvalue.expressions].append(
-                    member_access));
+                end = expressions.end_token_index(member_access);
+                TRY(values.append(member_access));
                 continue;
             }
 
             auto lvalue = TRY(
                 parse_lvalue(errors, expressions, tokens, end));
-            end = lvalue.end_token_index();
-            TRY(expressions[rvalue.expressions].append(lvalue));
+            end = expressions.end_token_index(lvalue);
+            TRY(values.append(lvalue));
             continue;
         }
 
@@ -1200,25 +1949,30 @@ ParseSingleItemResult parse_irvalue(ParseErrors& errors,
             "did you forget a comma?",
             tokens[end],
         }));
-        return Expression::garbage(start, end);
+        return TRY(expressions.create_garbage(end));
+    }
+
+    if (!values.is_complete()) {
+        TRY(errors.append_or_short({
+            "expected a value",
+            nullptr,
+            tokens[end],
+        }));
+        return TRY(expressions.create_garbage(end));
     }
 
     if (tokens[end].is(TokenType::Comma)) {
-        auto rvalue_id = TRY(expressions.append(rvalue));
-        return Expression {
-            rvalue_id,
-            start,
-            end,
-        };
+        auto rvalue_id = TRY(expressions.append(RValue {
+            TRY(values.close()),
+        }));
+        return TRY(expressions.create_expression(rvalue_id, end));
     }
 
     if (tokens[end].is(TokenType::OpenCurly)) {
-        auto rvalue_id = TRY(expressions.append(rvalue));
-        return Expression {
-            rvalue_id,
-            start,
-            end,
-        };
+        auto rvalue_id = TRY(expressions.append(RValue {
+            TRY(values.close()),
+        }));
+        return TRY(expressions.create_expression(rvalue_id, end));
     }
 
     TRY(errors.append_or_short({
@@ -1226,13 +1980,13 @@ ParseSingleItemResult parse_irvalue(ParseErrors& errors,
         "did you forget a comma?",
         tokens[end],
     }));
-    return Expression::garbage(start, end);
+    return TRY(expressions.create_garbage(end));
 }
 
 ParseSingleItemResult parse_if_rvalue(ParseErrors& errors,
     ParsedExpressions& expressions, Tokens const& tokens, u32 start)
 {
-    auto rvalue = TRY(expressions.create_rvalue());
+    auto values = OperatorScope(expressions);
 
     auto end = start;
     for (; end < tokens.size();) {
@@ -1244,63 +1998,50 @@ ParseSingleItemResult parse_if_rvalue(ParseErrors& errors,
         if (tokens[end].is(TokenType::InlineC)) {
             auto inline_c = TRY(
                 parse_inline_c(errors, expressions, tokens, end));
-            end = inline_c.end_token_index();
-            TRY(expressions[rvalue.expressions].append(inline_c));
-            auto rvalue_id = TRY(expressions.append(rvalue));
+            end = expressions.end_token_index(inline_c);
+            TRY(values.append(inline_c));
+            auto rvalue_id = TRY(expressions.append(RValue {
+                TRY(values.close()),
+            }));
             // NOTE: Unconsume ';'
-            return Expression {
-                rvalue_id,
-                start,
-                end - 1,
-            };
+            return TRY(expressions.create_expression(rvalue_id,
+                end - 1));
         }
 
         if (tokens[end].is(TokenType::Uninitialized)) {
             auto uninitialized = TRY(parse_uninitialized(errors,
                 expressions, tokens, end));
-            auto start = end;
-            end = uninitialized.end_token_index();
-            TRY(expressions[rvalue.expressions].append({
-                uninitialized.as_uninitialized(),
-                start,
-                end,
-            }));
+            end = expressions.end_token_index(uninitialized);
+            TRY(values.append(uninitialized));
+            continue;
+        }
+
+        if (tokens[end].is(TokenType::SizeOf)) {
+            auto size_of = TRY(
+                parse_size_of(errors, expressions, tokens, end));
+            end = expressions.end_token_index(size_of);
+            TRY(values.append(size_of));
             continue;
         }
 
         if (tokens[end].is(TokenType::Number)) {
             auto literal = TRY(
                 parse_literal(errors, expressions, tokens, end));
-            TRY(expressions[rvalue.expressions].append(literal));
-            end = literal.end_token_index();
+            TRY(values.append(literal));
+            end = expressions.end_token_index(literal);
             continue;
         }
 
-        TokenType binary_operators[] = {
-            TokenType::Plus,
-            TokenType::Minus,
-            TokenType::Star,
-
-            TokenType::Equals,
-            TokenType::LessThan,
-            TokenType::LessThanOrEqual,
-            TokenType::GreaterThan,
-            TokenType::GreaterThanOrEqual,
-        };
-        if (tokens[end].is_any_of(binary_operators)) {
-            // FIXME: Create parse_binary_operator.
-            auto literal = TRY(
-                parse_literal(errors, expressions, tokens, end));
-            TRY(expressions[rvalue.expressions].append(literal));
-            end = literal.end_token_index();
+        if (TRY(values.append_operator(tokens, end))) {
+            end++;
             continue;
         }
 
         if (tokens[end].is(TokenType::Quoted)) {
             auto literal = TRY(
                 parse_literal(errors, expressions, tokens, end));
-            TRY(expressions[rvalue.expressions].append(literal));
-            end = literal.end_token_index();
+            TRY(values.append(literal));
+            end = expressions.end_token_index(literal);
             continue;
         }
 
@@ -1308,23 +2049,22 @@ ParseSingleItemResult parse_if_rvalue(ParseErrors& errors,
             if (tokens[end + 1].is(TokenType::OpenParen)) {
                 auto call = TRY(parse_function_call(errors,
                     expressions, tokens, end));
-                end = call.end_token_index();
-                TRY(expressions[rvalue.expressions].append(call));
+                end = expressions.end_token_index(call);
+                TRY(values.append(call));
                 continue;
             }
             if (tokens[end + 1].is(TokenType::Dot)) {
                 auto member_access = TRY(parse_member_access(errors,
                     expressions, tokens, end));
-                end = member_access.end_token_index();
-                TRY(expressions[rvalue.expressions].append(
-                    member_access));
+                end = expressions.end_token_index(member_access);
+                TRY(values.append(member_access));
                 continue;
             }
 
             auto lvalue = TRY(
                 parse_lvalue(errors, expressions, tokens, end));
-            end = lvalue.end_token_index();
-            TRY(expressions[rvalue.expressions].append(lvalue));
+            end = expressions.end_token_index(lvalue);
+            TRY(values.append(lvalue));
             continue;
         }
 
@@ -1333,25 +2073,30 @@ ParseSingleItemResult parse_if_rvalue(ParseErrors& errors,
             "did you forget a semicolon?",
             tokens[end],
         }));
-        return Expression::garbage(start, end);
+        return TRY(expressions.create_garbage(end));
+    }
+
+    if (!values.is_complete()) {
+        TRY(errors.append_or_short({
+            "expected a value",
+            nullptr,
+            tokens[end],
+        }));
+        return TRY(expressions.create_garbage(end));
     }
 
     if (tokens[end].is(TokenType::Semicolon)) {
-        auto rvalue_id = TRY(expressions.append(rvalue));
-        return Expression {
-            rvalue_id,
-            start,
-            end,
-        };
+        auto rvalue_id = TRY(expressions.append(RValue {
+            TRY(values.close()),
+        }));
+        return TRY(expressions.create_expression(rvalue_id, end));
     }
 
     if (tokens[end].is(TokenType::OpenCurly)) {
-        auto rvalue_id = TRY(expressions.append(rvalue));
-        return Expression {
-            rvalue_id,
-            start,
-            end,
-        };
+        auto rvalue_id = TRY(expressions.append(RValue {
+            TRY(values.close()),
+        }));
+        return TRY(expressions.create_expression(rvalue_id, end));
     }
 
     TRY(errors.append_or_short({
@@ -1359,13 +2104,13 @@ ParseSingleItemResult parse_if_rvalue(ParseErrors& errors,
         "did you forget a semicolon?",
         tokens[end],
     }));
-    return Expression::garbage(start, end);
+    return TRY(expressions.create_garbage(end));
 }
 
 ParseSingleItemResult parse_rvalue(ParseErrors& errors,
     ParsedExpressions& expressions, Tokens const& tokens, u32 start)
 {
-    auto rvalue = TRY(expressions.create_rvalue());
+    auto values = OperatorScope(expressions);
 
     auto end = start;
     for (; end < tokens.size();) {
@@ -1375,63 +2120,50 @@ ParseSingleItemResult parse_rvalue(ParseErrors& errors,
         if (tokens[end].is(TokenType::InlineC)) {
             auto inline_c = TRY(
                 parse_inline_c(errors, expressions, tokens, end));
-            end = inline_c.end_token_index();
-            TRY(expressions[rvalue.expressions].append(inline_c));
-            auto rvalue_id = TRY(expressions.append(rvalue));
+            end = expressions.end_token_index(inline_c);
+            TRY(values.append(inline_c));
+            auto rvalue_id = TRY(expressions.append(RValue {
+                TRY(values.close()),
+            }));
             // NOTE: Unconsume ';'
-            return Expression {
-                rvalue_id,
-                start,
-                end - 1,
-            };
+            return TRY(expressions.create_expression(rvalue_id,
+                end - 1));
         }
 
         if (tokens[end].is(TokenType::Uninitialized)) {
             auto uninitialized = TRY(parse_uninitialized(errors,
                 expressions, tokens, end));
-            auto start = end;
-            end = uninitialized.end_token_index();
-            TRY(expressions[rvalue.expressions].append({
-                uninitialized.as_uninitialized(),
-                start,
-                end,
-            }));
+            end = expressions.end_token_index(uninitialized);
+            TRY(values.append(uninitialized));
+            continue;
+        }
+
+        if (tokens[end].is(TokenType::SizeOf)) {
+            auto size_of = TRY(
+                parse_size_of(errors, expressions, tokens, end));
+            end = expressions.end_token_index(size_of);
+            TRY(values.append(size_of));
             continue;
         }
 
         if (tokens[end].is(TokenType::Number)) {
             auto literal = TRY(
                 parse_literal(errors, expressions, tokens, end));
-            TRY(expressions[rvalue.expressions].append(literal));
-            end = literal.end_token_index();
+            TRY(values.append(literal));
+            end = expressions.end_token_index(literal);
             continue;
         }
 
-        TokenType binary_operators[] = {
-            TokenType::Plus,
-            TokenType::Minus,
-            TokenType::Star,
-
-            TokenType::Equals,
-            TokenType::LessThan,
-            TokenType::LessThanOrEqual,
-            TokenType::GreaterThan,
-            TokenType::GreaterThanOrEqual,
-        };
-        if (tokens[end].is_any_of(binary_operators)) {
-            // FIXME: Create parse_binary_operator.
-            auto literal = TRY(
-                parse_literal(errors, expressions, tokens, end));
-            TRY(expressions[rvalue.expressions].append(literal));
-            end = literal.end_token_index();
+        if (TRY(values.append_operator(tokens, end))) {
+            end++;
             continue;
         }
 
         if (tokens[end].is(TokenType::Quoted)) {
             auto literal = TRY(
                 parse_literal(errors, expressions, tokens, end));
-            TRY(expressions[rvalue.expressions].append(literal));
-            end = literal.end_token_index();
+            TRY(values.append(literal));
+            end = expressions.end_token_index(literal);
             continue;
         }
 
@@ -1439,75 +2171,77 @@ ParseSingleItemResult parse_rvalue(ParseErrors& errors,
             if (tokens[end + 1].is(TokenType::OpenParen)) {
                 auto call = TRY(parse_function_call(errors,
                     expressions, tokens, end));
-                end = call.end_token_index();
-                TRY(expressions[rvalue.expressions].append(call));
+                end = expressions.end_token_index(call);
+                TRY(values.append(call));
                 continue;
             }
             if (tokens[end + 1].is(TokenType::OpenCurly)) {
                 auto initializer = TRY(parse_struct_initializer(
                     errors, expressions, tokens, end));
-                end = initializer.end_token_index();
-                TRY(expressions[rvalue.expressions].append(
-                    initializer));
+                end = expressions.end_token_index(initializer);
+                TRY(values.append(initializer));
                 continue;
             }
             if (tokens[end + 1].is(TokenType::Dot)) {
                 auto member_access = TRY(parse_member_access(errors,
                     expressions, tokens, end));
-                end = member_access.end_token_index();
-                TRY(expressions[rvalue.expressions].append(
-                    member_access));
+                end = expressions.end_token_index(member_access);
+                TRY(values.append(member_access));
                 continue;
             }
 
             if (tokens[end + 1].is(TokenType::OpenBracket)) {
                 auto array_access = TRY(parse_array_access(errors,
                     expressions, tokens, end));
-                end = array_access.end_token_index();
-                TRY(expressions[rvalue.expressions].append(
-                    array_access));
+                end = expressions.end_token_index(array_access);
+                TRY(values.append(array_access));
                 continue;
             }
 
             auto lvalue = TRY(
                 parse_lvalue(errors, expressions, tokens, end));
-            end = lvalue.end_token_index();
-            TRY(expressions[rvalue.expressions].append(lvalue));
+            end = expressions.end_token_index(lvalue);
+            TRY(values.append(lvalue));
             continue;
         }
 
-        if (expressions[rvalue.expressions].is_empty()) {
+        if (values.is_empty()) {
             TRY(errors.append_or_short({
                 "expected a value",
                 nullptr,
                 tokens[end],
             }));
-            return Expression::garbage(start, end);
+            return TRY(expressions.create_garbage(end));
         }
         TRY(errors.append_or_short({
             "expected ';'",
             "did you forget a semicolon?",
             tokens[end],
         }));
-        return Expression::garbage(start, end);
+        return TRY(expressions.create_garbage(end));
+    }
+
+    if (!values.is_complete()) {
+        TRY(errors.append_or_short({
+            "expected a value",
+            nullptr,
+            tokens[end],
+        }));
+        return TRY(expressions.create_garbage(end));
     }
 
     if (tokens[end].is(TokenType::Semicolon)) {
-        auto rvalue_id = TRY(expressions.append(rvalue));
-        return Expression {
-            rvalue_id,
-            start,
-            end,
-        };
+        auto rvalue_id = TRY(expressions.append(RValue {
+            TRY(values.close()),
+        }));
+        return TRY(expressions.create_expression(rvalue_id, end));
     }
 
     if (tokens[end].is(TokenType::OpenCurly)) {
-        auto rvalue_id = TRY(expressions.append(rvalue));
-        return Expression {
-            rvalue_id,
-            start,
-            end,
-        };
+        auto rvalue_id = TRY(expressions.append(RValue {
+            TRY(values.close()),
+        }));
+        return TRY(expressions.create_expression(rvalue_id, end));
     }
 
     TRY(errors.append_or_short({
@@ -1515,52 +2249,45 @@ ParseSingleItemResult parse_rvalue(ParseErrors& errors,
         "did you forget a semicolon?",
         tokens[end],
     }));
-    return Expression::garbage(start, end);
+    return TRY(expressions.create_garbage(end));
 }
 
 ParseSingleItemResult parse_array_access_rvalue(ParseErrors& errors,
     ParsedExpressions& expressions, Tokens const& tokens, u32 start)
 {
-    auto rvalue = TRY(expressions.create_rvalue());
+    auto values = OperatorScope(expressions);
 
     auto end = start;
     for (; end < tokens.size();) {
         if (tokens[end].is(TokenType::CloseBracket))
             break;
 
+        if (tokens[end].is(TokenType::SizeOf)) {
+            auto size_of = TRY(
+                parse_size_of(errors, expressions, tokens, end));
+            end = expressions.end_token_index(size_of);
+            TRY(values.append(size_of));
+            continue;
+        }
+
         if (tokens[end].is(TokenType::Number)) {
             auto literal = TRY(
                 parse_literal(errors, expressions, tokens, end));
-            TRY(expressions[rvalue.expressions].append(literal));
-            end = literal.end_token_index();
+            TRY(values.append(literal));
+            end = expressions.end_token_index(literal);
             continue;
         }
 
-        TokenType binary_operators[] = {
-            TokenType::Plus,
-            TokenType::Minus,
-            TokenType::Star,
-
-            TokenType::Equals,
-            TokenType::LessThan,
-            TokenType::LessThanOrEqual,
-            TokenType::GreaterThan,
-            TokenType::GreaterThanOrEqual,
-        };
-        if (tokens[end].is_any_of(binary_operators)) {
-            // FIXME: Create parse_binary_operator.
-            auto literal = TRY(
-                parse_literal(errors, expressions, tokens, end));
-            TRY(expressions[rvalue.expressions].append(literal));
-            end = literal.end_token_index();
+        if (TRY(values.append_operator(tokens, end))) {
+            end++;
             continue;
         }
 
         if (tokens[end].is(TokenType::Quoted)) {
             auto literal = TRY(
                 parse_literal(errors, expressions, tokens, end));
-            TRY(expressions[rvalue.expressions].append(literal));
-            end = literal.end_token_index();
+            TRY(values.append(literal));
+            end = expressions.end_token_index(literal);
             continue;
         }
 
@@ -1568,40 +2295,37 @@ ParseSingleItemResult parse_array_access_rvalue(ParseErrors& errors,
             if (tokens[end + 1].is(TokenType::OpenParen)) {
                 auto call = TRY(parse_function_call(errors,
                     expressions, tokens, end));
-                end = call.end_token_index();
-                TRY(expressions[rvalue.expressions].append(call));
+                end = expressions.end_token_index(call);
+                TRY(values.append(call));
                 continue;
             }
             if (tokens[end + 1].is(TokenType::OpenCurly)) {
                 auto initializer = TRY(parse_struct_initializer(
                     errors, expressions, tokens, end));
-                end = initializer.end_token_index();
-                TRY(expressions[rvalue.expressions].append(
-                    initializer));
+                end = expressions.end_token_index(initializer);
+                TRY(values.append(initializer));
                 continue;
             }
             if (tokens[end + 1].is(TokenType::Dot)) {
                 auto member_access = TRY(parse_member_access(errors,
                     expressions, tokens, end));
-                end = member_access.end_token_index();
-                TRY(expressions[rvalue.expressions].append(
-                    member_access));
+                end = expressions.end_token_index(member_access);
+                TRY(values.append(member_access));
                 continue;
             }
 
             if (tokens[end + 1].is(TokenType::OpenBracket)) {
                 auto array_access = TRY(parse_array_access(errors,
                     expressions, tokens, start));
-                end = array_access.end_token_index();
-                TRY(expressions[rvalue.expressions].append(
-                    array_access));
+                end = expressions.end_token_index(array_access);
+                TRY(values.append(array_access));
                 continue;
             }
 
             auto lvalue = TRY(
                 parse_lvalue(errors, expressions, tokens, end));
-            end = lvalue.end_token_index();
-            TRY(expressions[rvalue.expressions].append(lvalue));
+            end = expressions.end_token_index(lvalue);
+            TRY(values.append(lvalue));
             continue;
         }
 
@@ -1610,7 +2334,16 @@ ParseSingleItemResult parse_array_access_rvalue(ParseErrors& errors,
             nullptr,
             tokens[end],
         }));
-        return Expression::garbage(start, end);
+        return TRY(expressions.create_garbage(end));
+    }
+
+    if (!values.is_complete()) {
+        TRY(errors.append_or_short({
+            "expected a value",
+            nullptr,
+            tokens[end],
+        }));
+        return TRY(expressions.create_garbage(end));
     }
 
     if (tokens[end].is_not(TokenType::CloseBracket)) {
@@ -1619,21 +2352,19 @@ ParseSingleItemResult parse_array_access_rvalue(ParseErrors& errors,
             nullptr,
             tokens[end],
         }));
-        return Expression::garbage(start, end);
+        return TRY(expressions.create_garbage(end));
     }
 
-    auto rvalue_id = TRY(expressions.append(rvalue));
-    return Expression {
-        rvalue_id,
-        start,
-        end,
-    };
+    auto rvalue_id = TRY(expressions.append(RValue {
+        TRY(values.close()),
+    }));
+    return TRY(expressions.create_expression(rvalue_id, end));
 }
 
 ParseSingleItemResult parse_prvalue(ParseErrors& errors,
     ParsedExpressions& expressions, Tokens const& tokens, u32 start)
 {
-    auto rvalue = TRY(expressions.create_rvalue());
+    auto values = OperatorScope(expressions);
 
     auto end = start;
     for (; end < tokens.size();) {
@@ -1642,61 +2373,40 @@ ParseSingleItemResult parse_prvalue(ParseErrors& errors,
         if (tokens[end].is(TokenType::CloseParen))
             break;
 
+        if (tokens[end].is(TokenType::SizeOf)) {
+            auto size_of = TRY(
+                parse_size_of(errors, expressions, tokens, end));
+            end = expressions.end_token_index(size_of);
+            TRY(values.append(size_of));
+            continue;
+        }
+
         if (tokens[end].is(TokenType::Number)) {
             auto literal = TRY(
                 parse_literal(errors, expressions, tokens, end));
-            TRY(expressions[rvalue.expressions].append(literal));
-            end = literal.end_token_index();
+            TRY(values.append(literal));
+            end = expressions.end_token_index(literal);
             continue;
         }
 
         if (tokens[end].is(TokenType::RefMut)) {
             auto refmut = TRY(parse_mutable_reference(errors,
                 expressions, tokens, end + 1));
-            TRY(expressions[rvalue.expressions].append(refmut));
-            end = refmut.end_token_index();
+            TRY(values.append(refmut));
+            end = expressions.end_token_index(refmut);
             continue;
         }
 
-        if (tokens[end].is(TokenType::Ampersand)) {
-            auto token = tokens[end];
-            auto literal = TRY(expressions.append(Literal {
-                token,
-            }));
-            TRY(expressions[rvalue.expressions].append({
-                literal,
-                end,
-                end + 1,
-            }));
-            end = end + 1;
-            continue;
-        }
-
-        TokenType binary_operators[] = {
-            TokenType::Plus,
-            TokenType::Minus,
-            TokenType::Star,
-
-            TokenType::Equals,
-            TokenType::LessThan,
-            TokenType::LessThanOrEqual,
-            TokenType::GreaterThan,
-            TokenType::GreaterThanOrEqual,
-        };
-        if (tokens[end].is_any_of(binary_operators)) {
-            // FIXME: Create parse_binary_operator.
-            auto literal = TRY(
-                parse_literal(errors, expressions, tokens, end));
-            TRY(expressions[rvalue.expressions].append(literal));
-            end = literal.end_token_index();
+        if (TRY(values.append_operator(tokens, end))) {
+            end++;
             continue;
         }
 
         if (tokens[end].is(TokenType::Quoted)) {
             auto literal = TRY(
                 parse_literal(errors, expressions, tokens, end));
-            TRY(expressions[rvalue.expressions].append(literal));
-            end = literal.end_token_index();
+            TRY(values.append(literal));
+            end = expressions.end_token_index(literal);
             continue;
         }
 
@@ -1704,32 +2414,29 @@ ParseSingleItemResult parse_prvalue(ParseErrors& errors,
             if (tokens[end + 1].is(TokenType::OpenParen)) {
                 auto function_call = TRY(parse_function_call(errors,
                     expressions, tokens, end));
-                end = function_call.end_token_index();
-                TRY(expressions[rvalue.expressions].append(
-                    function_call));
+                end = expressions.end_token_index(function_call);
+                TRY(values.append(function_call));
                 continue;
             }
             if (tokens[end + 1].is(TokenType::Dot)) {
                 auto member_access = TRY(parse_member_access(errors,
                     expressions, tokens, end));
-                end = member_access.end_token_index();
-                TRY(expressions[rvalue.expressions].append(
-                    member_access));
+                end = expressions.end_token_index(member_access);
+                TRY(values.append(member_access));
                 continue;
             }
             if (tokens[end + 1].is(TokenType::OpenBracket)) {
                 auto array_access = TRY(parse_array_access(errors,
                     expressions, tokens, end));
-                end = array_access.end_token_index();
-                TRY(expressions[rvalue.expressions].append(
-                    array_access));
+                end = expressions.end_token_index(array_access);
+                TRY(values.append(array_access));
                 continue;
             }
 
             auto lvalue = TRY(
                 parse_lvalue(errors, expressions, tokens, end));
-            end = lvalue.end_token_index();
-            TRY(expressions[rvalue.expressions].append(lvalue));
+            end = expressions.end_token_index(lvalue);
+            TRY(values.append(lvalue));
             continue;
         }
 
@@ -1738,24 +2445,29 @@ ParseSingleItemResult parse_prvalue(ParseErrors& errors,
             "did you forget a comma?",
             tokens[end],
         }));
-        return Expression::garbage(start, end);
+        return TRY(expressions.create_garbage(end));
+    }
+
+    if (!values.is_complete()) {
+        TRY(errors.append_or_short({
+            "expected a value",
+            nullptr,
+            tokens[end],
+        }));
+        return TRY(expressions.create_garbage(end));
     }
 
     if (tokens[end].is(TokenType::Comma)) {
-        auto rvalue_id = TRY(expressions.append(rvalue));
-        return Expression {
-            rvalue_id,
-            start,
-            end,
-        };
+        auto rvalue_id = TRY(expressions.append(RValue {
+            TRY(values.close()),
+        }));
+        return TRY(expressions.create_expression(rvalue_id, end));
     }
     if (tokens[end].is(TokenType::CloseParen)) {
-        auto rvalue_id = TRY(expressions.append(rvalue));
-        return Expression {
-            rvalue_id,
-            start,
-            end,
-        };
+        auto rvalue_id = TRY(expressions.append(RValue {
+            TRY(values.close()),
+        }));
+        return TRY(expressions.create_expression(rvalue_id, end));
     }
 
     TRY(errors.append_or_short({
@@ -1763,7 +2475,7 @@ ParseSingleItemResult parse_prvalue(ParseErrors& errors,
         "did you forget a comma?",
         tokens[end],
     }));
-    return Expression::garbage(start, end);
+    return TRY(expressions.create_garbage(end));
 }
 
 ParseSingleItemResult parse_mutable_reference(ParseErrors& errors,
@@ -1774,7 +2486,8 @@ ParseSingleItemResult parse_mutable_reference(ParseErrors& errors,
     auto ref_id = TRY(expressions.append(MutableReference {
         lvalue.as_lvalue(),
     }));
-    return Expression(ref_id, start, lvalue.end_token_index());
+    return TRY(expressions.create_expression(ref_id,
+        expressions.end_token_index(lvalue)));
 }
 
 ParseSingleItemResult parse_struct_declaration(ParseErrors& errors,
@@ -1794,7 +2507,7 @@ ParseSingleItemResult parse_struct_declaration(ParseErrors& errors,
             hint,
             assign,
         }));
-        return Expression::garbage(start, assign_index);
+        return TRY(expressions.create_garbage(assign_index));
     }
 
     auto struct_token_index = assign_index + 1;
@@ -1805,7 +2518,7 @@ ParseSingleItemResult parse_struct_declaration(ParseErrors& errors,
             nullptr,
             struct_token,
         }));
-        return Expression::garbage(start, struct_token_index);
+        return TRY(expressions.create_garbage(struct_token_index));
     }
 
     auto block_start_index = struct_token_index + 1;
@@ -1816,7 +2529,7 @@ ParseSingleItemResult parse_struct_declaration(ParseErrors& errors,
             nullptr,
             block_start,
         }));
-        return Expression::garbage(start, block_start_index);
+        return TRY(expressions.create_garbage(block_start_index));
     }
 
     auto members_id
@@ -1837,7 +2550,8 @@ ParseSingleItemResult parse_struct_declaration(ParseErrors& errors,
                 nullptr,
                 member_name,
             }));
-            return Expression::garbage(start, member_name_index);
+            return TRY(expressions.create_garbage(
+                member_name_index));
         }
 
         auto colon_index = member_name_index + 1;
@@ -1848,7 +2562,7 @@ ParseSingleItemResult parse_struct_declaration(ParseErrors& errors,
                 nullptr,
                 colon,
             }));
-            return Expression::garbage(start, colon_index);
+            return TRY(expressions.create_garbage(colon_index));
         }
 
         auto type_index = colon_index + 1;
@@ -1859,7 +2573,7 @@ ParseSingleItemResult parse_struct_declaration(ParseErrors& errors,
                 nullptr,
                 type_token,
             }));
-            return Expression::garbage(start, type_index);
+            return TRY(expressions.create_garbage(type_index));
         }
 
         auto comma_index = type_index + 1;
@@ -1870,7 +2584,7 @@ ParseSingleItemResult parse_struct_declaration(ParseErrors& errors,
                 "did you forget a comma?",
                 comma,
             }));
-            return Expression::garbage(start, comma_index);
+            return TRY(expressions.create_garbage(comma_index));
         }
 
         auto member = Member {
@@ -1888,7 +2602,7 @@ ParseSingleItemResult parse_struct_declaration(ParseErrors& errors,
             nullptr,
             block_end,
         }));
-        return Expression::garbage(start, block_end_index);
+        return TRY(expressions.create_garbage(block_end_index));
     }
 
     auto semicolon_index = block_end_index + 1;
@@ -1899,7 +2613,7 @@ ParseSingleItemResult parse_struct_declaration(ParseErrors& errors,
             "did you forget a semicolon?",
             semicolon,
         }));
-        return Expression::garbage(start, semicolon_index);
+        return TRY(expressions.create_garbage(semicolon_index));
     }
 
     auto struct_declaration = StructDeclaration {
@@ -1909,7 +2623,7 @@ ParseSingleItemResult parse_struct_declaration(ParseErrors& errors,
     // NOTE: Swallow semicolon.
     auto end = semicolon_index + 1;
     auto struct_id = TRY(expressions.append(struct_declaration));
-    return Expression(struct_id, start, end);
+    return TRY(expressions.create_expression(struct_id, end));
 }
 
 ParseSingleItemResult parse_enum_declaration(ParseErrors& errors,
@@ -1929,7 +2643,7 @@ ParseSingleItemResult parse_enum_declaration(ParseErrors& errors,
             hint,
             assign,
         }));
-        return Expression::garbage(start, assign_index);
+        return TRY(expressions.create_garbage(assign_index));
     }
 
     auto enum_token_index = assign_index + 1;
@@ -1940,7 +2654,7 @@ ParseSingleItemResult parse_enum_declaration(ParseErrors& errors,
             nullptr,
             enum_token,
         }));
-        return Expression::garbage(start, enum_token_index);
+        return TRY(expressions.create_garbage(enum_token_index));
     }
 
     auto block_start_index = enum_token_index + 1;
@@ -1951,7 +2665,7 @@ ParseSingleItemResult parse_enum_declaration(ParseErrors& errors,
             nullptr,
             block_start,
         }));
-        return Expression::garbage(start, block_start_index);
+        return TRY(expressions.create_garbage(block_start_index));
     }
 
     auto members_id
@@ -1972,7 +2686,8 @@ ParseSingleItemResult parse_enum_declaration(ParseErrors& errors,
                 nullptr,
                 member_name,
             }));
-            return Expression::garbage(start, member_name_index);
+            return TRY(expressions.create_garbage(
+                member_name_index));
         }
 
         auto comma_index = member_name_index + 1;
@@ -1983,7 +2698,7 @@ ParseSingleItemResult parse_enum_declaration(ParseErrors& errors,
                 "did you forget a comma?",
                 comma,
             }));
-            return Expression::garbage(start, comma_index);
+            return TRY(expressions.create_garbage(comma_index));
         }
 
         auto member = Member {
@@ -2001,7 +2716,7 @@ ParseSingleItemResult parse_enum_declaration(ParseErrors& errors,
             nullptr,
             block_end,
         }));
-        return Expression::garbage(start, block_end_index);
+        return TRY(expressions.create_garbage(block_end_index));
     }
 
     auto semicolon_index = block_end_index + 1;
@@ -2012,7 +2727,7 @@ ParseSingleItemResult parse_enum_declaration(ParseErrors& errors,
             "did you forget a semicolon?",
             semicolon,
         }));
-        return Expression::garbage(start, semicolon_index);
+        return TRY(expressions.create_garbage(semicolon_index));
     }
 
     auto enum_declaration = EnumDeclaration {
@@ -2023,7 +2738,7 @@ ParseSingleItemResult parse_enum_declaration(ParseErrors& errors,
     // NOTE: Swallow semicolon.
     auto end = semicolon_index + 1;
     auto enum_id = TRY(expressions.append(enum_declaration));
-    return Expression(enum_id, start, end);
+    return TRY(expressions.create_expression(enum_id, end));
 }
 
 ParseSingleItemResult parse_union_declaration(ParseErrors& errors,
@@ -2043,7 +2758,7 @@ ParseSingleItemResult parse_union_declaration(ParseErrors& errors,
             hint,
             assign,
         }));
-        return Expression::garbage(start, assign_index);
+        return TRY(expressions.create_garbage(assign_index));
     }
 
     auto union_token_index = assign_index + 1;
@@ -2054,7 +2769,7 @@ ParseSingleItemResult parse_union_declaration(ParseErrors& errors,
             nullptr,
             union_token,
         }));
-        return Expression::garbage(start, union_token_index);
+        return TRY(expressions.create_garbage(union_token_index));
     }
 
     auto block_start_index = union_token_index + 1;
@@ -2065,7 +2780,7 @@ ParseSingleItemResult parse_union_declaration(ParseErrors& errors,
             nullptr,
             block_start,
         }));
-        return Expression::garbage(start, block_start_index);
+        return TRY(expressions.create_garbage(block_start_index));
     }
 
     auto members_id
@@ -2086,7 +2801,8 @@ ParseSingleItemResult parse_union_declaration(ParseErrors& errors,
                 nullptr,
                 member_name,
             }));
-            return Expression::garbage(start, member_name_index);
+            return TRY(expressions.create_garbage(
+                member_name_index));
         }
 
         auto colon_index = member_name_index + 1;
@@ -2097,7 +2813,7 @@ ParseSingleItemResult parse_union_declaration(ParseErrors& errors,
                 nullptr,
                 colon,
             }));
-            return Expression::garbage(start, colon_index);
+            return TRY(expressions.create_garbage(colon_index));
         }
 
         auto type_index = colon_index + 1;
@@ -2108,7 +2824,7 @@ ParseSingleItemResult parse_union_declaration(ParseErrors& errors,
                 nullptr,
                 type_token,
             }));
-            return Expression::garbage(start, type_index);
+            return TRY(expressions.create_garbage(type_index));
         }
 
         auto comma_index = type_index + 1;
@@ -2119,7 +2835,7 @@ ParseSingleItemResult parse_union_declaration(ParseErrors& errors,
                 "did you forget a comma?",
                 comma,
             }));
-            return Expression::garbage(start, comma_index);
+            return TRY(expressions.create_garbage(comma_index));
         }
 
         auto member = Member {
@@ -2137,7 +2853,7 @@ ParseSingleItemResult parse_union_declaration(ParseErrors& errors,
             nullptr,
             block_end,
         }));
-        return Expression::garbage(start, block_end_index);
+        return TRY(expressions.create_garbage(block_end_index));
     }
 
     auto semicolon_index = block_end_index + 1;
@@ -2148,7 +2864,7 @@ ParseSingleItemResult parse_union_declaration(ParseErrors& errors,
             "did you forget a semicolon?",
             semicolon,
         }));
-        return Expression::garbage(start, semicolon_index);
+        return TRY(expressions.create_garbage(semicolon_index));
     }
 
     auto union_declaration = UnionDeclaration {
@@ -2158,7 +2874,7 @@ ParseSingleItemResult parse_union_declaration(ParseErrors& errors,
     // NOTE: Swallow semicolon.
     auto end = semicolon_index + 1;
     auto union_id = TRY(expressions.append(union_declaration));
-    return Expression(union_id, start, end);
+    return TRY(expressions.create_expression(union_id, end));
 }
 
 ParseSingleItemResult parse_variant_declaration(ParseErrors& errors,
@@ -2178,7 +2894,7 @@ ParseSingleItemResult parse_variant_declaration(ParseErrors& errors,
             hint,
             assign,
         }));
-        return Expression::garbage(start, assign_index);
+        return TRY(expressions.create_garbage(assign_index));
     }
 
     auto variant_token_index = assign_index + 1;
@@ -2189,7 +2905,7 @@ ParseSingleItemResult parse_variant_declaration(ParseErrors& errors,
             nullptr,
             variant_token,
         }));
-        return Expression::garbage(start, variant_token_index);
+        return TRY(expressions.create_garbage(variant_token_index));
     }
 
     auto block_start_index = variant_token_index + 1;
@@ -2200,7 +2916,7 @@ ParseSingleItemResult parse_variant_declaration(ParseErrors& errors,
             nullptr,
             block_start,
         }));
-        return Expression::garbage(start, block_start_index);
+        return TRY(expressions.create_garbage(block_start_index));
     }
 
     auto members_id
@@ -2221,7 +2937,8 @@ ParseSingleItemResult parse_variant_declaration(ParseErrors& errors,
                 nullptr,
                 member_name,
             }));
-            return Expression::garbage(start, member_name_index);
+            return TRY(expressions.create_garbage(
+                member_name_index));
         }
 
         auto colon_index = member_name_index + 1;
@@ -2232,7 +2949,7 @@ ParseSingleItemResult parse_variant_declaration(ParseErrors& errors,
                 nullptr,
                 colon,
             }));
-            return Expression::garbage(start, colon_index);
+            return TRY(expressions.create_garbage(colon_index));
         }
 
         auto type_index = colon_index + 1;
@@ -2243,7 +2960,7 @@ ParseSingleItemResult parse_variant_declaration(ParseErrors& errors,
                 nullptr,
                 type_token,
             }));
-            return Expression::garbage(start, type_index);
+            return TRY(expressions.create_garbage(type_index));
         }
 
         auto comma_index = type_index + 1;
@@ -2254,7 +2971,7 @@ ParseSingleItemResult parse_variant_declaration(ParseErrors& errors,
                 "did you forget a comma?",
                 comma,
             }));
-            return Expression::garbage(start, comma_index);
+            return TRY(expressions.create_garbage(comma_index));
         }
 
         auto member = Member {
@@ -2272,7 +2989,7 @@ ParseSingleItemResult parse_variant_declaration(ParseErrors& errors,
             nullptr,
             block_end,
         }));
-        return Expression::garbage(start, block_end_index);
+        return TRY(expressions.create_garbage(block_end_index));
     }
 
     auto semicolon_index = block_end_index + 1;
@@ -2283,7 +3000,7 @@ ParseSingleItemResult parse_variant_declaration(ParseErrors& errors,
             "did you forget a semicolon?",
             semicolon,
         }));
-        return Expression::garbage(start, semicolon_index);
+        return TRY(expressions.create_garbage(semicolon_index));
     }
 
     auto variant_declaration = VariantDeclaration {
@@ -2293,7 +3010,7 @@ ParseSingleItemResult parse_variant_declaration(ParseErrors& errors,
     // NOTE: Swallow semicolon.
     auto end = semicolon_index + 1;
     auto variant_id = TRY(expressions.append(variant_declaration));
-    return Expression(variant_id, start, end);
+    return TRY(expressions.create_expression(variant_id, end));
 }
 
 ParseSingleItemResult parse_private_variable_declaration(
@@ -2309,7 +3026,7 @@ ParseSingleItemResult parse_private_variable_declaration(
             "did you forget to name your variable?",
             name,
         }));
-        return Expression::garbage(start, name_index);
+        return TRY(expressions.create_garbage(name_index));
     }
 
     auto colon_or_assign_index = name_index + 1;
@@ -2324,7 +3041,7 @@ ParseSingleItemResult parse_private_variable_declaration(
                 nullptr,
                 type_token,
             }));
-            return Expression::garbage(start, type_index);
+            return TRY(expressions.create_garbage(type_index));
         }
         type = type_token;
 
@@ -2336,7 +3053,7 @@ ParseSingleItemResult parse_private_variable_declaration(
                 nullptr,
                 assign,
             }));
-            return Expression::garbage(start, assign_index);
+            return TRY(expressions.create_garbage(assign_index));
         }
         rvalue_start_index = assign_index + 1;
     } else if (colon_or_assign.is_not(TokenType::Assign)) {
@@ -2345,7 +3062,8 @@ ParseSingleItemResult parse_private_variable_declaration(
             nullptr,
             colon_or_assign,
         }));
-        return Expression::garbage(start, colon_or_assign_index);
+        return TRY(expressions.create_garbage(
+            colon_or_assign_index));
     }
 
     auto struct_name_index = rvalue_start_index;
@@ -2357,7 +3075,8 @@ ParseSingleItemResult parse_private_variable_declaration(
             auto value = TRY(parse_struct_initializer(errors,
                 expressions, tokens, struct_name_index));
 
-            auto semicolon_index = value.end_token_index();
+            auto semicolon_index
+                = expressions.end_token_index(value);
             auto semicolon = tokens[semicolon_index];
             if (semicolon.is_not(TokenType::Semicolon)) {
                 TRY(errors.append_or_short({
@@ -2365,7 +3084,8 @@ ParseSingleItemResult parse_private_variable_declaration(
                     "did you forget a semicolon?",
                     semicolon,
                 }));
-                return Expression::garbage(start, semicolon_index);
+                return TRY(expressions.create_garbage(
+                    semicolon_index));
             }
             // NOTE: Swallow semicolon;
             auto end = semicolon_index + 1;
@@ -2378,13 +3098,14 @@ ParseSingleItemResult parse_private_variable_declaration(
                     .value = value_id,
                 }));
 
-            return Expression(variable, start, end);
+            return TRY(expressions.create_expression(variable,
+                end));
         }
     }
 
     auto value = TRY(parse_rvalue(errors, expressions, tokens,
         rvalue_start_index));
-    auto rvalue_end_index = value.end_token_index();
+    auto rvalue_end_index = expressions.end_token_index(value);
     auto value_id = TRY(expressions.append(value));
 
     auto semicolon_index = rvalue_end_index;
@@ -2396,7 +3117,7 @@ ParseSingleItemResult parse_private_variable_declaration(
             "did you forget a semicolon?",
             rvalue,
         }));
-        return Expression::garbage(start, semicolon_index);
+        return TRY(expressions.create_garbage(semicolon_index));
     }
     // NOTE: Swallow semicolon;
     auto end = semicolon_index + 1;
@@ -2407,7 +3128,7 @@ ParseSingleItemResult parse_private_variable_declaration(
             .type = type,
             .value = value_id,
         }));
-    return Expression(variable, start, end);
+    return TRY(expressions.create_expression(variable, end));
 }
 
 ParseSingleItemResult parse_variable_assignment(ParseErrors& errors,
@@ -2424,14 +3145,14 @@ ParseSingleItemResult parse_variable_assignment(ParseErrors& errors,
             nullptr,
             assign,
         }));
-        return Expression::garbage(start, assign_index);
+        return TRY(expressions.create_garbage(assign_index));
     }
 
     auto rvalue_index = assign_index + 1;
     auto rvalue = TRY(
         parse_rvalue(errors, expressions, tokens, rvalue_index));
 
-    auto semicolon_index = rvalue.end_token_index();
+    auto semicolon_index = expressions.end_token_index(rvalue);
     auto semicolon = tokens[semicolon_index];
     if (semicolon.is_not(TokenType::Semicolon)) {
         TRY(errors.append_or_short({
@@ -2439,7 +3160,7 @@ ParseSingleItemResult parse_variable_assignment(ParseErrors& errors,
             "did you forget a semicolon?",
             semicolon,
         }));
-        return Expression::garbage(start, semicolon_index);
+        return TRY(expressions.create_garbage(semicolon_index));
     }
     auto end = semicolon_index;
 
@@ -2449,11 +3170,8 @@ ParseSingleItemResult parse_variable_assignment(ParseErrors& errors,
             .value = rvalue.as_rvalue(),
         }));
 
-    return Expression {
-        variable_assignment,
-        start,
-        end + 1,
-    };
+    return TRY(expressions.create_expression(variable_assignment,
+        end + 1));
 }
 
 ParseSingleItemResult parse_member_access(ParseErrors& errors,
@@ -2472,7 +3190,7 @@ ParseSingleItemResult parse_member_access(ParseErrors& errors,
                 nullptr,
                 name,
             }));
-            return Expression::garbage(start, name_index);
+            return TRY(expressions.create_garbage(name_index));
         }
 
         TRY(access_expressions.append(name));
@@ -2486,11 +3204,8 @@ ParseSingleItemResult parse_member_access(ParseErrors& errors,
     }
 
     auto member_access_id = TRY(expressions.append(member_access));
-    return Expression {
-        member_access_id,
-        start,
-        end + 1,
-    };
+    return TRY(expressions.create_expression(member_access_id,
+        end + 1));
 }
 
 ParseSingleItemResult parse_array_access(ParseErrors& errors,
@@ -2504,7 +3219,7 @@ ParseSingleItemResult parse_array_access(ParseErrors& errors,
             nullptr,
             name,
         }));
-        return Expression::garbage(start, name_index);
+        return TRY(expressions.create_garbage(name_index));
     }
 
     auto open_bracket_index = name_index + 1;
@@ -2515,14 +3230,14 @@ ParseSingleItemResult parse_array_access(ParseErrors& errors,
             nullptr,
             open_bracket,
         }));
-        return Expression::garbage(start, open_bracket_index);
+        return TRY(expressions.create_garbage(open_bracket_index));
     }
 
     auto index_start = open_bracket_index + 1;
     auto index = TRY(parse_array_access_rvalue(errors, expressions,
         tokens, index_start));
 
-    auto close_bracket_index = index.end_token_index();
+    auto close_bracket_index = expressions.end_token_index(index);
     auto close_bracket = tokens[close_bracket_index];
     if (close_bracket.is_not(TokenType::CloseBracket)) {
         TRY(errors.append_or_short({
@@ -2530,7 +3245,7 @@ ParseSingleItemResult parse_array_access(ParseErrors& errors,
             nullptr,
             close_bracket,
         }));
-        return Expression::garbage(start, close_bracket_index);
+        return TRY(expressions.create_garbage(close_bracket_index));
     }
 
     auto array_access = TRY(expressions.append(ArrayAccess {
@@ -2539,11 +3254,8 @@ ParseSingleItemResult parse_array_access(ParseErrors& errors,
     }));
 
     auto end = close_bracket_index;
-    return Expression {
-        array_access,
-        start,
-        end + 1,
-    };
+    return TRY(expressions.create_expression(array_access,
+        end + 1));
 }
 
 ParseSingleItemResult parse_public_variable_declaration(
@@ -2559,7 +3271,7 @@ ParseSingleItemResult parse_public_variable_declaration(
             "did you forget to name your variable?",
             name,
         }));
-        return Expression::garbage(start, name_index);
+        return TRY(expressions.create_garbage(name_index));
     }
 
     auto colon_or_assign_index = name_index + 1;
@@ -2574,7 +3286,7 @@ ParseSingleItemResult parse_public_variable_declaration(
                 nullptr,
                 type_token,
             }));
-            return Expression::garbage(start, type_index);
+            return TRY(expressions.create_garbage(type_index));
         }
         type = type_token;
 
@@ -2586,7 +3298,7 @@ ParseSingleItemResult parse_public_variable_declaration(
                 nullptr,
                 assign,
             }));
-            return Expression::garbage(start, assign_index);
+            return TRY(expressions.create_garbage(assign_index));
         }
         rvalue_start_index = assign_index + 1;
     } else if (colon_or_assign.is_not(TokenType::Assign)) {
@@ -2595,7 +3307,8 @@ ParseSingleItemResult parse_public_variable_declaration(
             nullptr,
             colon_or_assign,
         }));
-        return Expression::garbage(start, colon_or_assign_index);
+        return TRY(expressions.create_garbage(
+            colon_or_assign_index));
     }
 
     auto struct_name_index = rvalue_start_index;
@@ -2607,7 +3320,8 @@ ParseSingleItemResult parse_public_variable_declaration(
             auto value = TRY(parse_struct_initializer(errors,
                 expressions, tokens, struct_name_index));
 
-            auto semicolon_index = value.end_token_index();
+            auto semicolon_index
+                = expressions.end_token_index(value);
             auto semicolon = tokens[semicolon_index];
             if (semicolon.is_not(TokenType::Semicolon)) {
                 TRY(errors.append_or_short({
@@ -2615,7 +3329,8 @@ ParseSingleItemResult parse_public_variable_declaration(
                     "did you forget a semicolon?",
                     semicolon,
                 }));
-                return Expression::garbage(start, semicolon_index);
+                return TRY(expressions.create_garbage(
+                    semicolon_index));
             }
             // NOTE: Swallow semicolon;
             auto end = semicolon_index + 1;
@@ -2628,13 +3343,14 @@ ParseSingleItemResult parse_public_variable_declaration(
                     .value = value_id,
                 }));
 
-            return Expression(variable_id, start, end);
+            return TRY(expressions.create_expression(variable_id,
+                end));
         }
     }
 
     auto value = TRY(parse_rvalue(errors, expressions, tokens,
         rvalue_start_index));
-    auto rvalue_end_index = value.end_token_index();
+    auto rvalue_end_index = expressions.end_token_index(value);
     auto value_id = TRY(expressions.append(value));
 
     auto semicolon_index = rvalue_end_index;
@@ -2646,7 +3362,7 @@ ParseSingleItemResult parse_public_variable_declaration(
             "did you forget a semicolon?",
             rvalue,
         }));
-        return Expression::garbage(start, semicolon_index);
+        return TRY(expressions.create_garbage(semicolon_index));
     }
     // NOTE: Swallow semicolon;
     auto end = semicolon_index + 1;
@@ -2657,7 +3373,7 @@ ParseSingleItemResult parse_public_variable_declaration(
             .type = type,
             .value = value_id,
         }));
-    return Expression(variable, start, end);
+    return TRY(expressions.create_expression(variable, end));
 }
 
 [[maybe_unused]] ParseSingleItemResult
@@ -2673,7 +3389,7 @@ parse_private_constant_declaration(ParseErrors& errors,
             "did you forget to name your variable?",
             name,
         }));
-        return Expression::garbage(start, name_index);
+        return TRY(expressions.create_garbage(name_index));
     }
 
     auto colon_or_assign_index = name_index + 1;
@@ -2688,7 +3404,7 @@ parse_private_constant_declaration(ParseErrors& errors,
                 nullptr,
                 type_token,
             }));
-            return Expression::garbage(start, type_index);
+            return TRY(expressions.create_garbage(type_index));
         }
         type = type_token;
 
@@ -2700,7 +3416,7 @@ parse_private_constant_declaration(ParseErrors& errors,
                 nullptr,
                 assign,
             }));
-            return Expression::garbage(start, assign_index);
+            return TRY(expressions.create_garbage(assign_index));
         }
         rvalue_start_index = assign_index + 1;
     } else if (colon_or_assign.is_not(TokenType::Assign)) {
@@ -2709,7 +3425,8 @@ parse_private_constant_declaration(ParseErrors& errors,
             nullptr,
             colon_or_assign,
         }));
-        return Expression::garbage(start, colon_or_assign_index);
+        return TRY(expressions.create_garbage(
+            colon_or_assign_index));
     }
 
     auto struct_name_index = rvalue_start_index;
@@ -2721,7 +3438,8 @@ parse_private_constant_declaration(ParseErrors& errors,
             auto value = TRY(parse_struct_initializer(errors,
                 expressions, tokens, struct_name_index));
 
-            auto semicolon_index = value.end_token_index();
+            auto semicolon_index
+                = expressions.end_token_index(value);
             auto semicolon = tokens[semicolon_index];
             if (semicolon.is_not(TokenType::Semicolon)) {
                 TRY(errors.append_or_short({
@@ -2729,7 +3447,8 @@ parse_private_constant_declaration(ParseErrors& errors,
                     "did you forget a semicolon?",
                     semicolon,
                 }));
-                return Expression::garbage(start, semicolon_index);
+                return TRY(expressions.create_garbage(
+                    semicolon_index));
             }
             // NOTE: Swallow semicolon;
             auto end = semicolon_index + 1;
@@ -2742,13 +3461,14 @@ parse_private_constant_declaration(ParseErrors& errors,
                     .value = value_id,
                 }));
 
-            return Expression(constant, start, end);
+            return TRY(expressions.create_expression(constant,
+                end));
         }
     }
 
     auto value = TRY(parse_rvalue(errors, expressions, tokens,
         rvalue_start_index));
-    auto rvalue_end_index = value.end_token_index();
+    auto rvalue_end_index = expressions.end_token_index(value);
     auto value_id = TRY(expressions.append(value));
 
     auto semicolon_index = rvalue_end_index;
@@ -2760,7 +3480,7 @@ parse_private_constant_declaration(ParseErrors& errors,
             "did you forget a semicolon?",
             rvalue,
         }));
-        return Expression::garbage(start, semicolon_index);
+        return TRY(expressions.create_garbage(semicolon_index));
     }
     // NOTE: Swallow semicolon;
     auto end = semicolon_index + 1;
@@ -2771,7 +3491,7 @@ parse_private_constant_declaration(ParseErrors& errors,
             .type = type,
             .value = value_id,
         }));
-    return Expression(constant, start, end);
+    return TRY(expressions.create_expression(constant, end));
 }
 
 ParseSingleItemResult parse_public_constant_declaration(
@@ -2787,7 +3507,7 @@ ParseSingleItemResult parse_public_constant_declaration(
             "did you forget to name your variable?",
             name,
         }));
-        return Expression::garbage(start, name_index);
+        return TRY(expressions.create_garbage(name_index));
     }
 
     auto colon_or_assign_index = name_index + 1;
@@ -2802,7 +3522,7 @@ ParseSingleItemResult parse_public_constant_declaration(
                 nullptr,
                 type_token,
             }));
-            return Expression::garbage(start, type_index);
+            return TRY(expressions.create_garbage(type_index));
         }
         type = type_token;
 
@@ -2814,7 +3534,7 @@ ParseSingleItemResult parse_public_constant_declaration(
                 nullptr,
                 assign,
             }));
-            return Expression::garbage(start, assign_index);
+            return TRY(expressions.create_garbage(assign_index));
         }
         rvalue_start_index = assign_index + 1;
     } else if (colon_or_assign.is_not(TokenType::Assign)) {
@@ -2823,7 +3543,8 @@ ParseSingleItemResult parse_public_constant_declaration(
             nullptr,
             colon_or_assign,
         }));
-        return Expression::garbage(start, colon_or_assign_index);
+        return TRY(expressions.create_garbage(
+            colon_or_assign_index));
     }
 
     auto struct_name_index = rvalue_start_index;
@@ -2835,7 +3556,8 @@ ParseSingleItemResult parse_public_constant_declaration(
             auto value = TRY(parse_struct_initializer(errors,
                 expressions, tokens, struct_name_index));
 
-            auto semicolon_index = value.end_token_index();
+            auto semicolon_index
+                = expressions.end_token_index(value);
             auto semicolon = tokens[semicolon_index];
             if (semicolon.is_not(TokenType::Semicolon)) {
                 TRY(errors.append_or_short({
@@ -2843,7 +3565,8 @@ ParseSingleItemResult parse_public_constant_declaration(
                     "did you forget a semicolon?",
                     semicolon,
                 }));
-                return Expression::garbage(start, semicolon_index);
+                return TRY(expressions.create_garbage(
+                    semicolon_index));
             }
             // NOTE: Swallow semicolon;
             auto end = semicolon_index + 1;
@@ -2856,13 +3579,14 @@ ParseSingleItemResult parse_public_constant_declaration(
                     .value = value_id,
                 }));
 
-            return Expression(constant, start, end);
+            return TRY(expressions.create_expression(constant,
+                end));
         }
     }
 
     auto value = TRY(parse_rvalue(errors, expressions, tokens,
         rvalue_start_index));
-    auto rvalue_end_index = value.end_token_index();
+    auto rvalue_end_index = expressions.end_token_index(value);
 
     auto semicolon_index = rvalue_end_index;
     auto semicolon = tokens[semicolon_index];
@@ -2873,7 +3597,7 @@ ParseSingleItemResult parse_public_constant_declaration(
             "did you forget a semicolon?",
             rvalue,
         }));
-        return Expression::garbage(start, semicolon_index);
+        return TRY(expressions.create_garbage(semicolon_index));
     }
     // NOTE: Swallow semicolon;
     auto end = semicolon_index + 1;
@@ -2885,7 +3609,7 @@ ParseSingleItemResult parse_public_constant_declaration(
             .type = type,
             .value = value_id,
         }));
-    return Expression(constant, start, end);
+    return TRY(expressions.create_expression(constant, end));
 }
 
 ParseSingleItemResult parse_top_level_constant_or_struct(
@@ -2901,7 +3625,7 @@ ParseSingleItemResult parse_top_level_constant_or_struct(
             "did you forget to name your variable or struct?",
             name,
         }));
-        return Expression::garbage(start, name_index);
+        return TRY(expressions.create_garbage(name_index));
     }
 
     auto colon_or_assign_index = name_index + 1;
@@ -2916,7 +3640,7 @@ ParseSingleItemResult parse_top_level_constant_or_struct(
                 nullptr,
                 type_token,
             }));
-            return Expression::garbage(start, type_index);
+            return TRY(expressions.create_garbage(type_index));
         }
         type = type_token;
 
@@ -2928,7 +3652,7 @@ ParseSingleItemResult parse_top_level_constant_or_struct(
                 nullptr,
                 assign,
             }));
-            return Expression::garbage(start, assign_index);
+            return TRY(expressions.create_garbage(assign_index));
         }
         rvalue_start_index = assign_index + 1;
     } else if (colon_or_assign.is_not(TokenType::Assign)) {
@@ -2937,7 +3661,8 @@ ParseSingleItemResult parse_top_level_constant_or_struct(
             nullptr,
             colon_or_assign,
         }));
-        return Expression::garbage(start, colon_or_assign_index);
+        return TRY(expressions.create_garbage(
+            colon_or_assign_index));
     }
 
     auto struct_name_index = rvalue_start_index;
@@ -2949,7 +3674,8 @@ ParseSingleItemResult parse_top_level_constant_or_struct(
             auto value = TRY(parse_struct_initializer(errors,
                 expressions, tokens, struct_name_index));
 
-            auto semicolon_index = value.end_token_index();
+            auto semicolon_index
+                = expressions.end_token_index(value);
             auto semicolon = tokens[semicolon_index];
             if (semicolon.is_not(TokenType::Semicolon)) {
                 TRY(errors.append_or_short({
@@ -2957,7 +3683,8 @@ ParseSingleItemResult parse_top_level_constant_or_struct(
                     "did you forget a semicolon?",
                     semicolon,
                 }));
-                return Expression::garbage(start, semicolon_index);
+                return TRY(expressions.create_garbage(
+                    semicolon_index));
             }
             // NOTE: Swallow semicolon;
             auto end = semicolon_index + 1;
@@ -2970,7 +3697,8 @@ ParseSingleItemResult parse_top_level_constant_or_struct(
                     .value = value_id,
                 }));
 
-            return Expression(constant, start, end);
+            return TRY(expressions.create_expression(constant,
+                end));
         }
     }
 
@@ -3000,7 +3728,7 @@ ParseSingleItemResult parse_top_level_constant_or_struct(
 
     auto value = TRY(parse_rvalue(errors, expressions, tokens,
         rvalue_start_index));
-    auto rvalue_end_index = value.end_token_index();
+    auto rvalue_end_index = expressions.end_token_index(value);
     auto value_id = TRY(expressions.append(value));
 
     auto semicolon_index = rvalue_end_index;
@@ -3012,7 +3740,7 @@ ParseSingleItemResult parse_top_level_constant_or_struct(
             "did you forget a semicolon?",
             rvalue,
         }));
-        return Expression::garbage(start, semicolon_index);
+        return TRY(expressions.create_garbage(semicolon_index));
     }
     // NOTE: Swallow semicolon;
     auto end = semicolon_index + 1;
@@ -3023,33 +3751,33 @@ ParseSingleItemResult parse_top_level_constant_or_struct(
             .type = type,
             .value = value_id,
         }));
-    return Expression(constant, start, end);
+    return TRY(expressions.create_expression(constant, end));
 }
 
 [[deprecated("can't parse invalid")]] //
 [[maybe_unused]] ParseSingleItemResult
-parse_invalid(ParseErrors& errors, ParsedExpressions&,
-    Tokens const& tokens, u32 start)
+parse_invalid(ParseErrors& errors,
+    ParsedExpressions& expressions, Tokens const& tokens, u32 start)
 {
     TRY(errors.append_or_short({
         "trying to parse invalid",
         nullptr,
         tokens[start],
     }));
-    return Expression::garbage(start, start);
+    return TRY(expressions.create_garbage(start));
 }
 
 [[deprecated("can't parse moved value")]] //
 [[maybe_unused]] ParseSingleItemResult
-parse_moved_value(ParseErrors& errors, ParsedExpressions&,
-    Tokens const& tokens, u32 start)
+parse_moved_value(ParseErrors& errors,
+    ParsedExpressions& expressions, Tokens const& tokens, u32 start)
 {
     TRY(errors.append_or_short({
         "trying to parse moved",
         nullptr,
         tokens[start],
     }));
-    return Expression::garbage(start, start);
+    return TRY(expressions.create_garbage(start));
 }
 
 }
@@ -3060,7 +3788,8 @@ ErrorOr<void> ParseError::show(SourceFile source) const
     auto end_index = m_offending_token.end_index(source.text);
 
     auto start = TRY(
-        Util::line_and_column_for(source.text, start_index)
+        Util::line_and_column_for(source.text, source.line_starts,
+            start_index)
             .or_else([] {
                 return Core::File::stderr()
                     .writeln(
@@ -3072,15 +3801,17 @@ ErrorOr<void> ParseError::show(SourceFile source) const
             }));
 
     auto end = TRY(
-        Util::line_and_column_for(source.text, end_index).or_else([] {
-            return Core::File::stderr()
-                .writeln(
-                    "Could not fetch line and column for error"sv)
-                .on_success(Util::LineAndColumn {
-                    .line = 0,
-                    .column = 0,
-                });
-        }));
+        Util::line_and_column_for(source.text, source.line_starts,
+            end_index)
+            .or_else([] {
+                return Core::File::stderr()
+                    .writeln(
+                        "Could not fetch line and column for error"sv)
+                    .on_success(Util::LineAndColumn {
+                        .line = 0,
+                        .column = 0,
+                    });
+            }));
 
     auto normal = "\033[0;0m"sv;
     auto red = "\033[1;31m"sv;
@@ -3104,12 +3835,13 @@ ErrorOr<void> ParseError::show(SourceFile source) const
 
     if (start.line - end.line == 0) {
         if (start.line > 0 && start.column == 0) {
-            auto line
-                = Util::fetch_line(source.text, start.line - 1);
+            auto line = Util::fetch_line(source.text,
+                source.line_starts, start.line - 1);
             TRY(out.writeln(line));
         }
 
-        auto line = Util::fetch_line(source.text, start.line);
+        auto line = Util::fetch_line(source.text,
+            source.line_starts, start.line);
         TRY(out.writeln(line));
 
         for (u32 i = 0; i < start.column; i++)
@@ -3133,7 +3865,8 @@ ErrorOr<void> ParseError::show(SourceFile source) const
     }
 
     for (u32 i = start.line; i < end.line; i++) {
-        auto line = Util::fetch_line(source.text, i);
+        auto line
+            = Util::fetch_line(source.text, source.line_starts, i);
         TRY(out.writeln(line));
     }
     for (u32 i = 0; i < end.column; i++)
@@ -3160,6 +3893,13 @@ ErrorOr<void> ParseErrors::show(SourceFile source) const
     }
 
     for (auto const& error : parse_errors.in_reverse()) {
+        // NOTE: The lexer has already reported what made these
+        //       tokens invalid.
+        auto token = error.m_offending_token;
+        if (token.is(TokenType::Invalid) && token.size(source.text))
+            continue;
+        if (error.m_follows_invalid_token)
+            continue;
         TRY(error.show(source));
         TRY(Core::File::stderr().write("\n"sv));
     }
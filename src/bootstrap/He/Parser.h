@@ -1,10 +1,12 @@
 #pragma once
 #include "Expression.h"
+#include "Interner.h"
 #include "SourceFile.h"
 #include "Token.h"
 #include "Ty/SmallVector.h"
 #include <Ty/ErrorOr.h>
 #include <Ty/Move.h>
+#include <Ty/Threads.h>
 
 namespace He {
 
@@ -52,8 +54,9 @@ struct ParseError {
     }
 
     c_string m_hint { nullptr };
-    Token m_offending_token { TokenType::Invalid, 0 };
+    Token m_offending_token { TokenType::Invalid, 0, 0 };
     Error m_error {};
+    bool m_follows_invalid_token { false };
 
     ErrorOr<void> show(SourceFile source) const;
 };
@@ -97,6 +100,21 @@ struct ParseErrors {
 };
 
 using ParseResult = ErrorOr<ParsedExpressions, ParseErrors>;
-ParseResult parse(Tokens const& tokens);
+
+// NOTE: With FunctionBodies::Skip, function bodies are jumped over
+//       using the lexer's bracket partners and recorded as
+//       ParsedExpressions::lazy_bodies instead of being parsed.
+ParseResult parse(Tokens const& tokens, Interner&& symbols,
+    FunctionBodies = FunctionBodies::Parse);
+
+// NOTE: Same as parse(), but splits large token streams at top
+//       level functions and parses the pieces on separate threads.
+ParseResult parse_in_parallel(Tokens const& tokens,
+    Interner&& symbols, FunctionBodies = FunctionBodies::Parse,
+    u32 threads = Threads::in_machine());
+
+// NOTE: Parses the bodies skipped by parse() into their blocks.
+ErrorOr<void, ParseErrors> parse_lazy_bodies(
+    ParsedExpressions& expressions, Tokens const& tokens);
 
 }
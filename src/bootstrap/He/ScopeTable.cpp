@@ -0,0 +1,115 @@
+#include "ScopeTable.h"
+
+namespace He {
+
+namespace {
+
+// NOTE: Symbol ids are dense, so a multiplicative hash spreads
+//       them well enough.
+constexpr u32 hash_of(SymbolId name)
+{
+    return name.raw() * 0x9E3779B1;
+}
+
+}
+
+ErrorOr<ScopeTable> ScopeTable::create(u32 expected_names)
+{
+    u32 slot_count = 64;
+    while (slot_count < expected_names * 2)
+        slot_count *= 2;
+    auto slots = TRY(Vector<Slot>::create(slot_count));
+    for (u32 i = 0; i < slot_count; i++)
+        slots.unchecked_append(Slot());
+    return ScopeTable {
+        TRY(Vector<SymbolId>::create(expected_names)),
+        TRY(Vector<Binding>::create(expected_names)),
+        TRY(Vector<u32>::create(expected_names)),
+        TRY(Vector<u32>::create(expected_names)),
+        TRY(Vector<u32>::create()),
+        move(slots),
+    };
+}
+
+u32 ScopeTable::slot_of(SymbolId name) const
+{
+    auto mask = m_slots.size() - 1;
+    auto slot = hash_of(name) & mask;
+    for (;; slot = (slot + 1) & mask) {
+        auto const& entry = m_slots[slot];
+        if (!entry.name.is_valid() || entry.name == name)
+            return slot;
+    }
+}
+
+void ScopeTable::exit_scope()
+{
+    auto mark = scope_marks.last();
+    scope_marks.truncate(scope_marks.size() - 1);
+    for (u32 binding = bindings.size(); binding > mark;) {
+        binding--;
+        auto& slot = m_slots[slot_of(names[binding])];
+        slot.binding = shadowed[binding];
+    }
+    names.truncate(mark);
+    bindings.truncate(mark);
+    depths.truncate(mark);
+    shadowed.truncate(mark);
+}
+
+ErrorOr<bool> ScopeTable::declare(SymbolId name, Binding binding)
+{
+    auto& slot = m_slots[slot_of(name)];
+    auto previous = slot.binding;
+    if (previous != no_binding && depths[previous] == depth())
+        return false;
+
+    slot.binding = bindings.size();
+    TRY(names.append(name));
+    TRY(bindings.append(binding));
+    TRY(depths.append(depth()));
+    TRY(shadowed.append(previous));
+    if (!slot.name.is_valid()) {
+        slot.name = name;
+        if (++m_used_slots * 2 > m_slots.size())
+            TRY(grow());
+    }
+    return true;
+}
+
+Optional<Binding> ScopeTable::find(SymbolId name) const
+{
+    auto binding = m_slots[slot_of(name)].binding;
+    if (binding == no_binding)
+        return {};
+    return bindings[binding];
+}
+
+Optional<u32> ScopeTable::find_depth(SymbolId name) const
+{
+    auto binding = m_slots[slot_of(name)].binding;
+    if (binding == no_binding)
+        return {};
+    return depths[binding];
+}
+
+ErrorOr<void> ScopeTable::grow()
+{
+    auto slot_count = m_slots.size() * 2;
+    auto slots = TRY(Vector<Slot>::create(slot_count));
+    for (u32 i = 0; i < slot_count; i++)
+        slots.unchecked_append(Slot());
+    auto mask = slot_count - 1;
+    for (auto const& entry : m_slots) {
+        if (!entry.name.is_valid())
+            continue;
+        auto slot = hash_of(entry.name) & mask;
+        while (slots[slot].name.is_valid())
+            slot = (slot + 1) & mask;
+        slots[slot] = entry;
+    }
+    m_slots = move(slots);
+    return {};
+}
+
+}
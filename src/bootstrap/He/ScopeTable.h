@@ -0,0 +1,85 @@
+#pragma once
+#include "Expression.h"
+#include "Interner.h"
+#include "TypeTable.h"
+#include <Ty/ErrorOr.h>
+#include <Ty/Optional.h>
+#include <Ty/Vector.h>
+
+namespace He {
+
+struct Binding {
+    Expression declaration;
+    TypeId type {};
+};
+
+// NOTE: Names visible at one point of a program, innermost scope
+//       first. Every binding of every open scope is pushed onto
+//       one stack, and a single open addressed table maps each
+//       name to its innermost binding, which in turn links to the
+//       one it shadows. Leaving a scope pops its bindings and
+//       restores what they shadowed, so no table is ever
+//       allocated per block.
+struct ScopeTable {
+    static ErrorOr<ScopeTable> create(u32 expected_names = 0);
+
+    ErrorOr<void> enter_scope()
+    {
+        TRY(scope_marks.append(bindings.size()));
+        return {};
+    }
+
+    void exit_scope();
+
+    // NOTE: Scope 0 is the one open before any enter_scope().
+    constexpr u32 depth() const { return scope_marks.size(); }
+
+    // NOTE: Returns false, and changes nothing, if `name` is
+    //       already bound in the innermost scope.
+    ErrorOr<bool> declare(SymbolId name, Binding binding);
+
+    Optional<Binding> find(SymbolId name) const;
+
+    // NOTE: Depth of the scope `name` is bound in.
+    Optional<u32> find_depth(SymbolId name) const;
+
+    // NOTE: One entry per binding of every open scope, oldest
+    //       first.
+    Vector<SymbolId> names;
+    Vector<Binding> bindings;
+    Vector<u32> depths;
+    Vector<u32> shadowed;
+
+    // NOTE: Size of `bindings` when each open scope was entered.
+    Vector<u32> scope_marks;
+
+    static constexpr u32 no_binding = 0xFFFFFFFF;
+
+private:
+    // NOTE: Slots are never freed, a name out of scope keeps its
+    //       slot with `binding` set to no_binding.
+    struct Slot {
+        SymbolId name;
+        u32 binding { no_binding };
+    };
+
+    ScopeTable(Vector<SymbolId>&& names, Vector<Binding>&& bindings,
+        Vector<u32>&& depths, Vector<u32>&& shadowed,
+        Vector<u32>&& scope_marks, Vector<Slot>&& slots)
+        : names(move(names))
+        , bindings(move(bindings))
+        , depths(move(depths))
+        , shadowed(move(shadowed))
+        , scope_marks(move(scope_marks))
+        , m_slots(move(slots))
+    {
+    }
+
+    u32 slot_of(SymbolId name) const;
+    ErrorOr<void> grow();
+
+    Vector<Slot> m_slots;
+    u32 m_used_slots { 0 };
+};
+
+}
@@ -1,11 +1,13 @@
 #pragma once
 #include <Ty/StringView.h>
+#include <Ty/View.h>
 
 namespace He {
 
 struct SourceFile {
     StringView file_name {};
     StringView text {};
+    View<u32 const> line_starts { nullptr, 0 };
 };
 
 }
@@ -5,16 +5,11 @@
 
 namespace He {
 
-void Token::dump(StringView source) const
+void Token::dump(SourceFile source) const
 {
-    auto text = source.sub_view(start_index, size(source));
-    auto start = *Util::line_and_column_for(source, start_index);
-    start.line += 1;
-    start.column += 1;
-    auto end
-        = *Util::line_and_column_for(source, end_index(source));
-    end.line += 1;
-    end.column += 1;
+    auto text = this->text(source.text);
+    auto start = Util::line_and_column_for(source.text,
+        source.line_starts, start_index);
     auto& out = Core::File::stderr();
     out.write("Token ["sv).ignore();
     auto name = token_type_string(type);
@@ -24,10 +19,15 @@ void Token::dump(StringView source) const
            text == "\n"sv ? "\\n"sv : text, "'"sv)
         .ignore();
 
-    out.writeln("]"sv).ignore();
+    if (!start) {
+        out.writeln("]"sv).ignore();
+        return;
+    }
+    out.writeln("] "sv, start->line + 1, ":"sv, start->column + 1)
+        .ignore();
 }
 
-ErrorOr<void> dump_tokens(StringView source,
+ErrorOr<void> dump_tokens(SourceFile source,
     View<Token const> tokens)
 {
     for (u32 i = 0; i < tokens.size(); i++) {
@@ -43,6 +43,39 @@ ErrorOr<void> dump_tokens(StringView source,
     return {};
 }
 
+// NOTE: Brackets between a bracket and its partner are either
+//       matched among themselves or have no partner, so the first
+//       bracket with a partner that is not skipped over is the one.
+u32 find_wide_partner(View<Token const> tokens, u32 index)
+{
+    if (tokens[index].is_opening()) {
+        for (u32 i = index + 1; i < tokens.size(); i++) {
+            auto token = tokens[i];
+            if (token.is_opening()) {
+                auto partner = partner_of(tokens, i);
+                if (partner != Token::no_partner)
+                    i = partner;
+                continue;
+            }
+            if (token.is_closing() && token.partner_distance() != 0)
+                return i;
+        }
+        return Token::no_partner;
+    }
+    for (u32 i = index; i-- != 0;) {
+        auto token = tokens[i];
+        if (token.is_closing()) {
+            auto partner = partner_of(tokens, i);
+            if (partner != Token::no_partner)
+                i = partner;
+            continue;
+        }
+        if (token.is_bracket() && token.partner_distance() != 0)
+            return i;
+    }
+    return Token::no_partner;
+}
+
 StringView token_type_string(TokenType type)
 {
     switch (type) {
@@ -53,9 +86,4 @@ StringView token_type_string(TokenType type)
     }
 }
 
-u32 Token::size(StringView source) const
-{
-    return relex_size(source, *this);
-}
-
 }
@@ -1,80 +1,86 @@
 #pragma once
+#include "Interner.h"
+#include "SourceFile.h"
 #include <Ty/StringView.h>
 #include <Ty/Vector.h>
 
 namespace He {
 
-#define TOKEN_TYPES                                \
-    X(OpenBracket, open_bracket)                   \
-    X(CloseBracket, close_bracket)                 \
-                                                   \
-    X(OpenParen, open_paren)                       \
-    X(CloseParen, close_paren)                     \
-                                                   \
-    X(OpenCurly, open_curly)                       \
-    X(CloseCurly, close_curly)                     \
-                                                   \
-    X(Ampersand, ampersand)                        \
-    X(Comma, comma)                                \
-    X(Assign, assign)                              \
-    X(NewLine, new_line)                           \
-    X(Number, number)                              \
-    X(Colon, colon)                                \
-    X(Semicolon, semicolon)                        \
-    X(Space, space)                                \
-    X(Hash, hash)                                  \
-    X(Underscore, underscore)                      \
-    X(QuestionMark, question_mark)                 \
-                                                   \
-    X(Minus, minus)                                \
-    X(Plus, plus)                                  \
-    X(Slash, slash)                                \
-    X(Star, star)                                  \
-                                                   \
-    X(Equals, equals)                              \
-    X(GreaterThan, greater_than)                   \
-    X(GreaterThanOrEqual, greater_than_or_equal)   \
-    X(LessThan, less_than)                         \
-    X(LessThanOrEqual, less_than_or_equal)         \
-                                                   \
-    X(Dot, dot)                                    \
-    X(Arrow, arrow)                                \
-                                                   \
-    X(Quoted, quoted)                              \
-    X(Identifier, identifier)                      \
-                                                   \
-    /* Keywords */                                 \
-                                                   \
-    X(CFn, c_fn)                                   \
-    X(Fn, fn)                                      \
-    X(If, if_token)                                \
-    X(InlineC, inline_c)                           \
-    X(InlineCBlock, inline_c_block)                \
-    X(InvalidInlineC, invalid_inline_c)            \
-    X(InvalidInlineCBlock, invalid_inline_c_block) \
-    X(Let, let_token)                              \
-    X(Pub, pub)                                    \
-    X(RefMut, ref_mut)                             \
-    X(Return, return_token)                        \
-    X(Throw, throw_token)                          \
-    X(Var, var_token)                              \
-    X(While, while_token)                          \
-                                                   \
-    X(Enum, enum_token)                            \
-    X(Struct, struct_token)                        \
-    X(Union, union_token)                          \
-    X(Variant, variant)                            \
-                                                   \
-    /* Builtin functions */                        \
-                                                   \
-    X(Embed, embed)                                \
-    X(Import, import_token)                        \
-    X(ImportC, import_c)                           \
-    X(SizeOf, size_of)                             \
-    X(Uninitialized, uninitialized)                \
-                                                   \
-    /* Garbage */                                  \
-    X(Invalid, invalid)
+// NOTE: The last column is the spelling of tokens that always look
+//       the same. Spellings starting with a letter are keywords and
+//       ones starting with '@' are builtins, both of which the
+//       lexer picks up automatically.
+#define TOKEN_TYPES                                    \
+    X(OpenBracket, open_bracket, "[")                  \
+    X(CloseBracket, close_bracket, "]")                \
+                                                       \
+    X(OpenParen, open_paren, "(")                      \
+    X(CloseParen, close_paren, ")")                    \
+                                                       \
+    X(OpenCurly, open_curly, "{")                      \
+    X(CloseCurly, close_curly, "}")                    \
+                                                       \
+    X(Ampersand, ampersand, "&")                       \
+    X(Comma, comma, ",")                               \
+    X(Assign, assign, "=")                             \
+    X(NewLine, new_line, "\n")                         \
+    X(Number, number, "")                              \
+    X(Colon, colon, ":")                               \
+    X(Semicolon, semicolon, ";")                       \
+    X(Space, space, " ")                               \
+    X(Hash, hash, "#")                                 \
+    X(Underscore, underscore, "_")                     \
+    X(QuestionMark, question_mark, "?")                \
+                                                       \
+    X(Minus, minus, "-")                               \
+    X(Plus, plus, "+")                                 \
+    X(Slash, slash, "/")                               \
+    X(Star, star, "*")                                 \
+                                                       \
+    X(Equals, equals, "==")                            \
+    X(GreaterThan, greater_than, ">")                  \
+    X(GreaterThanOrEqual, greater_than_or_equal, ">=") \
+    X(LessThan, less_than, "<")                        \
+    X(LessThanOrEqual, less_than_or_equal, "<=")       \
+                                                       \
+    X(Dot, dot, ".")                                   \
+    X(Arrow, arrow, "->")                              \
+                                                       \
+    X(Quoted, quoted, "")                              \
+    X(Identifier, identifier, "")                      \
+                                                       \
+    /* Keywords */                                     \
+                                                       \
+    X(CFn, c_fn, "c_fn")                               \
+    X(Fn, fn, "fn")                                    \
+    X(If, if_token, "if")                              \
+    X(InlineC, inline_c, "inline_c")                   \
+    X(InlineCBlock, inline_c_block, "")                \
+    X(InvalidInlineC, invalid_inline_c, "")            \
+    X(InvalidInlineCBlock, invalid_inline_c_block, "") \
+    X(Let, let_token, "let")                           \
+    X(Pub, pub, "pub")                                 \
+    X(RefMut, ref_mut, "&mut")                         \
+    X(Return, return_token, "return")                  \
+    X(Throw, throw_token, "throw")                     \
+    X(Var, var_token, "var")                           \
+    X(While, while_token, "while")                     \
+                                                       \
+    X(Enum, enum_token, "enum")                        \
+    X(Struct, struct_token, "struct")                  \
+    X(Union, union_token, "union")                     \
+    X(Variant, variant, "variant")                     \
+                                                       \
+    /* Builtin functions */                            \
+                                                       \
+    X(Embed, embed, "@embed")                          \
+    X(Import, import_token, "@import")                 \
+    X(ImportC, import_c, "@import_c")                  \
+    X(SizeOf, size_of, "@size_of")                     \
+    X(Uninitialized, uninitialized, "@uninitialized")  \
+                                                       \
+    /* Garbage */                                      \
+    X(Invalid, invalid, "")
 
 enum class TokenType : u8 {
 #define X(name, ...) name,
@@ -84,28 +90,95 @@ enum class TokenType : u8 {
 
 StringView token_type_string(TokenType type);
 
-struct [[gnu::packed]] Token {
-    constexpr Token(TokenType type, u32 start)
+// NOTE: Empty for tokens that are not always spelled the same.
+constexpr StringView token_type_spelling(TokenType type)
+{
+    switch (type) {
+#define X(variant, snake_name, spelling) \
+    case TokenType::variant: return spelling##sv;
+        TOKEN_TYPES
+#undef X
+    }
+    return ""sv;
+}
+
+u32 identifier_size(StringView source, u32 start);
+[[gnu::cold]] u32 wide_token_size(StringView source, u32 start,
+    TokenType type);
+
+// NOTE: Eight bytes hold every token of a source of up to 4 GiB.
+//       What the payload holds depends on the type: identifiers
+//       keep their symbol, whose text has their size, brackets
+//       keep how many tokens away their partner is, and the rest
+//       keep their size. Sizes and distances too large to fit are
+//       found again when asked for.
+struct Token {
+    static constexpr u32 wide = (1 << 24) - 1;
+    static constexpr u32 no_partner = 0xFFFFFFFF;
+
+    constexpr Token(TokenType type, u32 start, u32 size)
         : start_index(start)
+        , m_payload(size < wide ? size : wide)
         , type(type)
     {
     }
 
     constexpr Token() = default;
 
-    void dump(StringView source) const;
+    void dump(SourceFile source) const;
 
-    StringView text(StringView source) const
+    constexpr u32 size(StringView source) const
+    {
+        if (is_bracket())
+            return 1;
+        if (type == TokenType::Identifier)
+            return identifier_size(source, start_index);
+        if (m_payload == wide) [[unlikely]]
+            return wide_token_size(source, start_index, type);
+        return m_payload;
+    }
+
+    constexpr StringView text(StringView source) const
     {
         return { &source.data[start_index], size(source) };
     }
 
-    u32 size(StringView source) const;
-    u32 end_index(StringView source) const
+    constexpr u32 end_index(StringView source) const
     {
         return start_index + size(source);
     }
 
+    // NOTE: Only set for identifiers.
+    SymbolId symbol() const
+    {
+        if (type != TokenType::Identifier)
+            return SymbolId::invalid();
+        return SymbolId(m_payload);
+    }
+
+    // NOTE: Identifiers hold their size until the lexer interns
+    //       them, after that only their symbol knows it.
+    constexpr u32 uninterned_size(StringView source) const
+    {
+        if (m_payload == wide) [[unlikely]]
+            return identifier_size(source, start_index);
+        return m_payload;
+    }
+
+    // NOTE: The lexer never makes more than `wide` symbols.
+    void set_symbol(SymbolId symbol)
+    {
+        m_payload = symbol.raw();
+    }
+
+    // NOTE: Tokens between a bracket and its partner, zero if it
+    //       has none.
+    constexpr u32 partner_distance() const { return m_payload; }
+    constexpr void set_partner_distance(u32 distance)
+    {
+        m_payload = distance < wide ? distance : wide;
+    }
+
     constexpr bool is(TokenType type) const
     {
         return this->type == type;
@@ -116,6 +189,47 @@ struct [[gnu::packed]] Token {
         return this->type != type;
     }
 
+    // NOTE: Type of the token closing this one, or Invalid if this
+    //       does not open anything.
+    constexpr TokenType closing_type() const
+    {
+        switch (type) {
+        case TokenType::OpenParen: return TokenType::CloseParen;
+        case TokenType::OpenBracket: return TokenType::CloseBracket;
+        case TokenType::OpenCurly: return TokenType::CloseCurly;
+        // NOTE: Inline C blocks are closed by a '}' token.
+        case TokenType::InlineCBlock: return TokenType::CloseCurly;
+        default: return TokenType::Invalid;
+        }
+    }
+
+    constexpr bool is_opening() const
+    {
+        return closing_type() != TokenType::Invalid;
+    }
+
+    constexpr bool is_closing() const
+    {
+        switch (type) {
+        case TokenType::CloseParen:
+        case TokenType::CloseBracket:
+        case TokenType::CloseCurly: return true;
+        default: return false;
+        }
+    }
+
+    // NOTE: Inline C blocks keep their size, as their partner is
+    //       always the '}' right after them.
+    constexpr bool is_bracket() const
+    {
+        switch (type) {
+        case TokenType::OpenParen:
+        case TokenType::OpenBracket:
+        case TokenType::OpenCurly: return true;
+        default: return is_closing();
+        }
+    }
+
     template <u32 size>
     constexpr bool is_any_of(TokenType const (&types)[size]) const
     {
@@ -126,12 +240,42 @@ struct [[gnu::packed]] Token {
         return false;
     }
 
-    u32 start_index : 24 { 0 };
+    u32 start_index { 0 };
+
+private:
+    u32 m_payload : 24 { 0 };
+
+public:
     TokenType type { TokenType::Invalid };
 };
+static_assert(sizeof(Token) == 8);
 using Tokens = Vector<Token>;
 
-ErrorOr<void> dump_tokens(StringView source,
+[[gnu::cold]] u32 find_wide_partner(View<Token const> tokens,
+    u32 index);
+
+// NOTE: Index of the token closing the one at `index`, or of the
+//       one it closes, or Token::no_partner.
+inline u32 partner_of(View<Token const> tokens, u32 index)
+{
+    auto token = tokens[index];
+    if (token.is(TokenType::InlineCBlock)) {
+        auto next = index + 1;
+        if (next < tokens.size() && tokens[next].is_closing())
+            return next;
+        return Token::no_partner;
+    }
+    if (!token.is_bracket())
+        return Token::no_partner;
+    auto distance = token.partner_distance();
+    if (distance == 0)
+        return Token::no_partner;
+    if (distance == Token::wide) [[unlikely]]
+        return find_wide_partner(tokens, index);
+    return token.is_closing() ? index - distance : index + distance;
+}
+
+ErrorOr<void> dump_tokens(SourceFile source,
     View<Token const> tokens);
 
 }
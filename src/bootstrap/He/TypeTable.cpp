@@ -0,0 +1,269 @@
+#include "TypeTable.h"
+
+namespace He {
+
+namespace {
+
+constexpr u32 mix(u32 hash, u32 value)
+{
+    hash ^= value;
+    hash *= 0x9E3779B1;
+    return hash ^ (hash >> 15);
+}
+
+u32 hash_of(TypeKind kind, TypeOperands operands,
+    View<TypeId const> parameters)
+{
+    auto hash = mix(0x811C9DC5, (u32)kind);
+    hash = mix(hash, operands.inner);
+    hash = mix(hash, operands.size);
+    for (auto parameter : parameters)
+        hash = mix(hash, parameter.raw());
+    return hash;
+}
+
+auto const no_parameters = View<TypeId const>(nullptr, 0);
+
+template <typename T>
+ErrorOr<Vector<T>> create_filled(u32 count, T value)
+{
+    auto slots = TRY(Vector<T>::create(count));
+    for (u32 i = 0; i < count; i++)
+        slots.unchecked_append(value);
+    return slots;
+}
+
+}
+
+ErrorOr<TypeTable> TypeTable::create(u32 expected_types)
+{
+    u32 slot_count = 64;
+    while (slot_count < expected_types * 2)
+        slot_count *= 2;
+    return TypeTable {
+        TRY(Vector<TypeKind>::create(expected_types)),
+        TRY(Vector<TypeOperands>::create(expected_types)),
+        TRY(Vector<u32>::create(expected_types)),
+        TRY(Vector<TypeId>::create(expected_types)),
+        TRY(create_filled(slot_count, TypeId::invalid())),
+        TRY(create_filled(64, Assignability())),
+    };
+}
+
+ErrorOr<TypeId> TypeTable::named(SymbolId name)
+{
+    return intern(TypeKind::Named, { name.raw() },
+        no_parameters);
+}
+
+ErrorOr<TypeId> TypeTable::pointer(TypeId pointee)
+{
+    return intern(TypeKind::Pointer, { pointee.raw() },
+        no_parameters);
+}
+
+ErrorOr<TypeId> TypeTable::mutable_reference(TypeId referee)
+{
+    return intern(TypeKind::MutableReference, { referee.raw() },
+        no_parameters);
+}
+
+ErrorOr<TypeId> TypeTable::id(TypeId type)
+{
+    return intern(TypeKind::Id, { type.raw() }, no_parameters);
+}
+
+ErrorOr<TypeId> TypeTable::array(TypeId element, u32 size)
+{
+    return intern(TypeKind::Array, { element.raw(), size },
+        no_parameters);
+}
+
+ErrorOr<TypeId> TypeTable::function(TypeId return_type,
+    View<TypeId const> parameter_types)
+{
+    return intern(TypeKind::Function,
+        { return_type.raw(), (u32)parameter_types.size() },
+        parameter_types);
+}
+
+Optional<TypeId> TypeTable::find_named(SymbolId name) const
+{
+    auto name_operands = TypeOperands { name.raw() };
+    auto hash
+        = hash_of(TypeKind::Named, name_operands, no_parameters);
+    auto id = m_slots[find_slot(hash, TypeKind::Named,
+        name_operands, no_parameters)];
+    if (!id.is_valid())
+        return {};
+    return id;
+}
+
+u32 TypeTable::find_slot(u32 hash, TypeKind kind,
+    TypeOperands type_operands,
+    View<TypeId const> type_parameters) const
+{
+    auto mask = m_slots.size() - 1;
+    for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+        auto id = m_slots[slot];
+        if (!id.is_valid())
+            return slot;
+        auto raw = id.raw();
+        if (hashes[raw] != hash || kinds[raw] != kind)
+            continue;
+        auto const& existing = operands[raw];
+        if (existing.inner != type_operands.inner
+            || existing.size != type_operands.size)
+            continue;
+        if (kind != TypeKind::Function)
+            return slot;
+        auto existing_parameters = function_parameters(id);
+        bool same = true;
+        for (u32 i = 0; same && i < type_parameters.size(); i++)
+            same = existing_parameters[i] == type_parameters[i];
+        if (same)
+            return slot;
+    }
+}
+
+ErrorOr<TypeId> TypeTable::intern(TypeKind kind,
+    TypeOperands type_operands, View<TypeId const> type_parameters)
+{
+    auto hash = hash_of(kind, type_operands, type_parameters);
+    auto slot
+        = find_slot(hash, kind, type_operands, type_parameters);
+    if (m_slots[slot].is_valid())
+        return m_slots[slot];
+
+    if (kind == TypeKind::Function) {
+        // NOTE: The parameters may be those of a function already
+        //       in the table, which growing `parameters` would
+        //       move out from under us.
+        auto const* data = type_parameters.data();
+        auto count = (u32)type_parameters.size();
+        bool is_borrowed = data >= parameters.begin()
+            && data < parameters.end();
+        auto offset
+            = is_borrowed ? (u32)(data - parameters.begin()) : 0;
+        TRY(parameters.ensure_capacity(parameters.size() + count));
+        if (is_borrowed)
+            data = parameters.begin() + offset;
+        type_operands.first = parameters.size();
+        for (u32 i = 0; i < count; i++)
+            parameters.unchecked_append(data[i]);
+    }
+
+    auto id = TypeId(kinds.size());
+    TRY(kinds.append(kind));
+    TRY(operands.append(type_operands));
+    TRY(hashes.append(hash));
+    m_slots[slot] = id;
+    if (kinds.size() * 2 > m_slots.size())
+        TRY(grow());
+    return id;
+}
+
+ErrorOr<void> TypeTable::grow()
+{
+    auto slots = TRY(create_filled(m_slots.size() * 2,
+        TypeId::invalid()));
+    auto mask = slots.size() - 1;
+    for (u32 i = 0; i < hashes.size(); i++) {
+        auto slot = hashes[i] & mask;
+        while (slots[slot].is_valid())
+            slot = (slot + 1) & mask;
+        slots[slot] = TypeId(i);
+    }
+    m_slots = move(slots);
+    return {};
+}
+
+ErrorOr<bool> TypeTable::is_assignable(TypeId to, TypeId from)
+{
+    if (to == from)
+        return true;
+
+    auto hash = mix(mix(0x811C9DC5, to.raw()), from.raw());
+    auto mask = m_assignabilities.size() - 1;
+    for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+        auto const& entry = m_assignabilities[slot];
+        if (!entry.to.is_valid())
+            break;
+        if (entry.to == to && entry.from == from)
+            return entry.result;
+    }
+
+    // NOTE: Checking may memoize other pairs and grow the table, so
+    //       the slot is looked up again afterwards.
+    auto result = TRY(check_assignable(to, from));
+    if ((m_assignability_count + 1) * 2 > m_assignabilities.size())
+        TRY(grow_assignabilities());
+    mask = m_assignabilities.size() - 1;
+    auto slot = hash & mask;
+    while (m_assignabilities[slot].to.is_valid())
+        slot = (slot + 1) & mask;
+    m_assignabilities[slot] = { to, from, result };
+    m_assignability_count++;
+    return result;
+}
+
+ErrorOr<bool> TypeTable::check_assignable(TypeId to, TypeId from)
+{
+    auto to_kind = kind(to);
+    auto from_kind = kind(from);
+
+    if (to_kind == TypeKind::Pointer) {
+        auto pointee = inner(to);
+        // NOTE: `&mut x` and arrays are passed as pointers to
+        //       their contents, like in C.
+        if (from_kind == TypeKind::MutableReference
+            || from_kind == TypeKind::Array)
+            return inner(from) == pointee;
+        if (from_kind == TypeKind::Pointer
+            && kind(pointee) == TypeKind::Function
+            && kind(inner(from)) == TypeKind::Function)
+            return is_assignable(pointee, inner(from));
+        return false;
+    }
+
+    if (to_kind != TypeKind::Function || from_kind != to_kind)
+        return false;
+
+    // NOTE: A function may stand in for another if it accepts
+    //       everything the other does and returns something the
+    //       other could have.
+    if (!TRY(is_assignable(inner(to), inner(from))))
+        return false;
+    auto to_parameters = function_parameters(to);
+    auto from_parameters = function_parameters(from);
+    if (to_parameters.size() != from_parameters.size())
+        return false;
+    for (u32 i = 0; i < to_parameters.size(); i++) {
+        auto to_parameter = to_parameters[i];
+        auto from_parameter = from_parameters[i];
+        if (!TRY(is_assignable(from_parameter, to_parameter)))
+            return false;
+    }
+    return true;
+}
+
+ErrorOr<void> TypeTable::grow_assignabilities()
+{
+    auto entries = TRY(create_filled(m_assignabilities.size() * 2,
+        Assignability()));
+    auto mask = entries.size() - 1;
+    for (auto const& entry : m_assignabilities) {
+        if (!entry.to.is_valid())
+            continue;
+        auto hash = mix(mix(0x811C9DC5, entry.to.raw()),
+            entry.from.raw());
+        auto slot = hash & mask;
+        while (entries[slot].to.is_valid())
+            slot = (slot + 1) & mask;
+        entries[slot] = entry;
+    }
+    m_assignabilities = move(entries);
+    return {};
+}
+
+}
@@ -0,0 +1,156 @@
+#pragma once
+#include "Interner.h"
+#include <Ty/ErrorOr.h>
+#include <Ty/Id.h>
+#include <Ty/Optional.h>
+#include <Ty/Vector.h>
+#include <Ty/View.h>
+
+namespace He {
+
+struct Type;
+using TypeId = Id<Type>;
+
+// NOTE: What `inner` and `size` of TypeOperands hold differs by
+//       kind:
+//         Named             inner: symbol of the name
+//         Pointer           inner: pointee
+//         MutableReference  inner: referee
+//         Id                inner: type the id refers to
+//         Array             inner: element   size: element count
+//         Function          inner: return    size: parameter count
+#define TYPE_KINDS                         \
+    X(Named, named)                        \
+    X(Pointer, pointer)                    \
+    X(MutableReference, mutable_reference) \
+    X(Id, id)                              \
+    X(Array, array)                        \
+    X(Function, function)
+
+enum class TypeKind : u8 {
+#define X(T, ...) T,
+    TYPE_KINDS
+#undef X
+};
+
+constexpr StringView type_kind_string(TypeKind kind)
+{
+    switch (kind) {
+#define X(T, ...) \
+    case TypeKind::T: return #T##sv;
+        TYPE_KINDS
+#undef X
+    }
+}
+
+struct TypeOperands {
+    u32 inner { 0 };
+    u32 size { 0 };
+
+    // NOTE: Index of the first parameter of a function in
+    //       TypeTable::parameters.
+    u32 first { 0 };
+};
+
+// NOTE: Every structurally distinct type is stored exactly once,
+//       so two types are the same exactly when their ids are.
+//       Types live in parallel arrays indexed by TypeId, and are
+//       found again through an open addressed table of ids.
+struct TypeTable {
+    static ErrorOr<TypeTable> create(u32 expected_types = 0);
+
+    ErrorOr<TypeId> named(SymbolId name);
+
+    // NOTE: Never adds the type, so threads may share a table
+    //       they only look types up in.
+    Optional<TypeId> find_named(SymbolId name) const;
+
+    ErrorOr<TypeId> pointer(TypeId pointee);
+    ErrorOr<TypeId> mutable_reference(TypeId referee);
+    ErrorOr<TypeId> id(TypeId type);
+    ErrorOr<TypeId> array(TypeId element, u32 size);
+
+    // NOTE: `parameters` may point into the table itself.
+    ErrorOr<TypeId> function(TypeId return_type,
+        View<TypeId const> parameters);
+
+    constexpr TypeKind kind(TypeId type) const
+    {
+        return kinds[type.raw()];
+    }
+
+    constexpr TypeId inner(TypeId type) const
+    {
+        return TypeId(operands[type.raw()].inner);
+    }
+
+    constexpr SymbolId name(TypeId type) const
+    {
+        return SymbolId(operands[type.raw()].inner);
+    }
+
+    constexpr u32 array_size(TypeId type) const
+    {
+        return operands[type.raw()].size;
+    }
+
+    constexpr View<TypeId const> function_parameters(
+        TypeId type) const
+    {
+        auto const& function = operands[type.raw()];
+        return {
+            parameters.data() + function.first,
+            function.size,
+        };
+    }
+
+    constexpr u32 size() const { return kinds.size(); }
+
+    // NOTE: Whether a value of type `from` may be stored where
+    //       `to` is expected. Answers are memoized, so asking
+    //       again about deep function types is a table lookup.
+    ErrorOr<bool> is_assignable(TypeId to, TypeId from);
+
+    Vector<TypeKind> kinds;
+    Vector<TypeOperands> operands;
+    Vector<u32> hashes;
+    Vector<TypeId> parameters;
+
+private:
+    struct Assignability {
+        TypeId to;
+        TypeId from;
+        bool result { false };
+    };
+
+    TypeTable(Vector<TypeKind>&& kinds,
+        Vector<TypeOperands>&& operands, Vector<u32>&& hashes,
+        Vector<TypeId>&& parameters, Vector<TypeId>&& slots,
+        Vector<Assignability>&& assignabilities)
+        : kinds(move(kinds))
+        , operands(move(operands))
+        , hashes(move(hashes))
+        , parameters(move(parameters))
+        , m_slots(move(slots))
+        , m_assignabilities(move(assignabilities))
+    {
+    }
+
+    ErrorOr<TypeId> intern(TypeKind kind, TypeOperands operands,
+        View<TypeId const> parameters);
+
+    // NOTE: Slot of the type if it is in the table, or the empty
+    //       slot it would go in otherwise.
+    u32 find_slot(u32 hash, TypeKind kind, TypeOperands operands,
+        View<TypeId const> parameters) const;
+    ErrorOr<void> grow();
+
+    ErrorOr<bool> check_assignable(TypeId to, TypeId from);
+    ErrorOr<void> grow_assignabilities();
+
+    Vector<TypeId> m_slots;
+    Vector<Assignability> m_assignabilities;
+    u32 m_assignability_count { 0 };
+};
+
+}
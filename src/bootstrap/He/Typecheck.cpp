@@ -1,250 +1,999 @@
 #include "Typecheck.h"
+#include "CacheFile.h"
 #include "Context.h"
 #include "Expression.h"
 #include "Parser.h"
-#include "SourceFile.h"
+#include "ScopeTable.h"
 #include "TypecheckedExpression.h"
+#include <Core/File.h>
+#include <Core/System.h>
+#include <Core/Thread.h>
 #include <Ty/ErrorOr.h>
 
 namespace He {
 
-using TypecheckSingleItemResult
-    = ErrorOr<CheckedExpression, TypecheckError>;
-
-#define FORWARD_DECLARE_TYPECHECKER(name)                    \
-    [[maybe_unused]] static TypecheckSingleItemResult        \
-        typecheck_##name(                                    \
-            TypecheckedExpressions& typechecked_expressions, \
-            ParsedExpressions const& parsed_expressions,     \
-            u32 start)
-
-#define X(T, name, ...) FORWARD_DECLARE_TYPECHECKER(name);
-CHECKED_EXPRESSIONS
+namespace {
+
+#define FUNCTIONS                           \
+    X(PrivateCFunction, private_c_function) \
+    X(PrivateFunction, private_function)    \
+    X(PublicCFunction, public_c_function)   \
+    X(PublicFunction, public_function)
+
+#define VARIABLES                                               \
+    X(PrivateConstantDeclaration, private_constant_declaration) \
+    X(PrivateVariableDeclaration, private_variable_declaration) \
+    X(PublicConstantDeclaration, public_constant_declaration)   \
+    X(PublicVariableDeclaration, public_variable_declaration)
+
+// NOTE: What the declaration phase leaves behind. The body phase
+//       only ever reads it, so any number of threads may share it.
+struct Declarations {
+    TypecheckedExpressions output;
+    ScopeTable globals;
+
+    // NOTE: Indices into ParsedExpressions::declarations.
+    Vector<u32> functions;
+};
+
+ErrorOr<Declarations> collect_declarations(
+    ParsedExpressions const& expressions, TypecheckErrors& errors);
+
+// NOTE: Checks one function body at a time. Names are looked up
+//       in the locals first and the shared globals after.
+struct BodyChecker {
+    ParsedExpressions const& expressions;
+    Declarations const& declarations;
+    TypecheckedExpressions& output;
+    TypecheckErrors& errors;
+    ScopeTable locals;
+    bool is_full { false };
+
+    template <typename Function>
+    ErrorOr<void> function(Function const&, u32 declaration);
+
+    ErrorOr<void> block(Id<Block>);
+    ErrorOr<void> expression(Expression);
+    ErrorOr<void> expressions_in(View<Expression const>);
+    ErrorOr<void> local(Token name, Token type,
+        Id<Expression> value, Expression declaration);
+    ErrorOr<void> function_call(FunctionCall const&);
+    ErrorOr<void> variable_assignment(VariableAssignment const&);
+
+    ErrorOr<void> declare(Token name, Binding);
+    Optional<Binding> look_up(SymbolId) const;
+    TypeId named_type(Token type) const;
+    TypeId type_of(RValue const&) const;
+    void error(StringView message, Token offending_token);
+};
+
+ErrorOr<void> check_bodies(ParsedExpressions const&,
+    Declarations const&, View<u32 const> functions,
+    TypecheckedExpressions& output, TypecheckErrors& errors);
+
+struct TypecheckShard {
+    ParsedExpressions const& expressions;
+    Declarations const& declarations;
+    View<u32 const> functions;
+    Optional<TypecheckedExpressions> output {};
+    TypecheckErrors errors {};
+
+    void operator()();
+};
+
+ErrorOr<void> check_in_parallel(ParsedExpressions const&,
+    Declarations&, View<u32 const> functions, u32 threads,
+    TypecheckErrors&);
+
+// NOTE: Key of each of Declarations::functions in a
+//       TypecheckCache.
+ErrorOr<Vector<u64>> body_keys(Context const&,
+    Declarations const&, u32 threads);
+
+struct KeyShard {
+    Context const& context;
+    View<u32 const> functions;
+    u64* keys;
+
+    void operator()();
+};
+
+// NOTE: All a body is checked against of another declaration is
+//       its kind and its type, which are hashed into a signature
+//       for each symbol naming a top level declaration. Other
+//       symbols have a signature of zero.
+ErrorOr<Vector<u64>> symbol_signatures(Context const&,
+    Declarations const&);
+
+// NOTE: Marks the symbols with a signature other than the one in
+//       `cache`, and returns how many there are.
+ErrorOr<u32> find_changed_signatures(Context const&,
+    TypecheckCache const&, View<u64 const> signatures,
+    Vector<bool>& is_changed);
+
+// NOTE: Whether the function has any of `symbols` in it, whether
+//       or not a local shadows it.
+bool names_any(Context const&, u32 function,
+    View<bool const> symbols);
+
+ErrorOr<void> read_cached_body(Context const&,
+    TypecheckCache&, u32 cached, CheckedBody&, TypeTable&,
+    Vector<CheckedVariable>&);
+
+ErrorOr<void> refill_cache(Context const&,
+    TypecheckedExpressions const&, View<u64 const> signatures,
+    View<u64 const> keys, TypecheckCacheStats, TypecheckCache&);
+
+constexpr u32 token_count(ParsedExpressions const& expressions,
+    u32 declaration)
+{
+    auto range = expressions.declaration_tokens(declaration);
+    return range.end - range.start;
+}
+
+// NOTE: Fewest tokens worth handing to a thread of their own.
+constexpr u32 min_shard_tokens = 64 * 1024;
+
+constexpr bool is_constant(Expression declaration)
+{
+    auto type = declaration.type();
+    return type == ExpressionType::PrivateConstantDeclaration
+        || type == ExpressionType::PublicConstantDeclaration;
+}
+
+constexpr bool is_function(Expression declaration)
+{
+    switch (declaration.type()) {
+#define X(T, ...) case ExpressionType::T:
+        FUNCTIONS
 #undef X
-
-FORWARD_DECLARE_TYPECHECKER(expression);
-
-#undef FORWARD_DECLARE_TYPECHECKER
-
-TypecheckResult typecheck(Context&)
+        return true;
+    default: return false;
+    }
+}
+
+}
+
+TypecheckResult typecheck(Context& context)
+{
+    return typecheck_in_parallel(context, 1);
+}
+
+TypecheckResult typecheck_in_parallel(Context& context,
+    u32 threads)
+{
+    auto const& expressions = context.expressions;
+    auto errors = TypecheckErrors();
+    auto declarations
+        = TRY(collect_declarations(expressions, errors));
+    if (errors.has_error())
+        return errors;
+    auto const& functions = declarations.functions;
+    TRY(check_in_parallel(expressions, declarations,
+        functions.view(), threads, errors));
+    if (errors.has_error())
+        return errors;
+    return move(declarations.output);
+}
+
+TypecheckResult typecheck_incrementally(Context& context,
+    TypecheckCache& cache, u32 threads)
+{
+    auto const& expressions = context.expressions;
+    auto errors = TypecheckErrors();
+    auto declarations
+        = TRY(collect_declarations(expressions, errors));
+    if (errors.has_error())
+        return errors;
+    auto& output = declarations.output;
+    auto const& functions = declarations.functions;
+
+    // NOTE: A body is only taken from the cache if its source is
+    //       unchanged and it names no declaration whose signature
+    //       changed. Usually none did, and bodies are found by
+    //       their source alone. Cached bodies are read back before
+    //       any body is checked, as their types may have to be
+    //       added to the table the checkers share. Bodies that can
+    //       not be read back are checked like any other.
+    auto stats = TypecheckCacheStats();
+    TRY(cache.reset_read_types());
+    auto hash_start = TRY(Core::System::monotonic_nanoseconds());
+    auto signatures
+        = TRY(symbol_signatures(context, declarations));
+    auto is_changed = TRY(Vector<bool>::create());
+    auto changed_count = TRY(find_changed_signatures(context, cache,
+        signatures.view(), is_changed));
+    auto keys = TRY(body_keys(context, declarations, threads));
+    auto cached_bodies = TRY(Vector<CheckedBody>::create());
+    auto cached_locals = TRY(Vector<CheckedVariable>::create());
+    auto missed = TRY(Vector<u32>::create());
+    for (u32 i = 0; i < functions.size(); i++) {
+        auto function = functions[i];
+        auto tokens = token_count(expressions, function);
+        auto cached = cache.find(keys[i]);
+        auto is_stale = changed_count != 0 && cached.has_value()
+            && names_any(context, function, is_changed.view());
+        if (cached.has_value() && !is_stale) {
+            auto body = CheckedBody {
+                .declaration = function,
+                .first_local = cached_locals.size(),
+            };
+            auto read = read_cached_body(context, cache,
+                cached.value(), body, output.types, cached_locals);
+            if (!read.is_error()) {
+                TRY(cached_bodies.append(body));
+                stats.hits++;
+                stats.hit_tokens += tokens;
+                continue;
+            }
+            cached_locals.truncate(body.first_local);
+        }
+        TRY(missed.append(function));
+        stats.misses++;
+        stats.missed_tokens += tokens;
+    }
+    auto check_start = TRY(Core::System::monotonic_nanoseconds());
+    stats.hash_nanoseconds = check_start - hash_start;
+    TRY(check_in_parallel(expressions, declarations,
+        missed.view(), threads, errors));
+    auto check_end = TRY(Core::System::monotonic_nanoseconds());
+    stats.check_nanoseconds = check_end - check_start;
+    cache.last_run = stats;
+    if (errors.has_error())
+        return errors;
+
+    // NOTE: Both lists follow the order of `functions`, so taking
+    //       from whichever has the next function gives what
+    //       checking all of them would have.
+    auto bodies = TRY(
+        Vector<CheckedBody>::create(functions.size()));
+    auto locals = TRY(Vector<CheckedVariable>::create(
+        output.locals.size() + cached_locals.size()));
+    u32 next_cached = 0;
+    u32 next_checked = 0;
+    for (auto function : functions) {
+        auto from_cache = next_cached < cached_bodies.size()
+            && cached_bodies[next_cached].declaration == function;
+        auto body = from_cache ? cached_bodies[next_cached++]
+                               : output.bodies[next_checked++];
+        auto const& from
+            = from_cache ? cached_locals : output.locals;
+        auto first_local = locals.size();
+        TRY(locals.extend({
+            from.data() + body.first_local,
+            body.local_count,
+        }));
+        body.first_local = first_local;
+        TRY(bodies.append(body));
+    }
+    output.bodies = move(bodies);
+    output.locals = move(locals);
+
+    // NOTE: A cache every body was found in holds exactly these
+    //       bodies already, unless some were removed.
+    auto is_current = stats.misses == 0 && changed_count == 0
+        && cache.bodies.size() == functions.size();
+    if (!is_current) {
+        TRY(refill_cache(context, output, signatures.view(),
+            keys.view(), stats, cache));
+    }
+    return move(output);
+}
+
+namespace {
+
+ErrorOr<void> check_in_parallel(
+    ParsedExpressions const& expressions,
+    Declarations& declarations, View<u32 const> functions,
+    u32 threads, TypecheckErrors& errors)
+{
+    auto& output = declarations.output;
+
+    // NOTE: Bodies are split by the tokens they span, as that is
+    //       roughly what checking them costs.
+    u32 total_tokens = 0;
+    for (auto function : functions)
+        total_tokens += token_count(expressions, function);
+    auto shard_count = total_tokens / min_shard_tokens;
+    if (threads < shard_count)
+        shard_count = threads;
+    if (shard_count <= 1) {
+        return check_bodies(expressions, declarations, functions,
+            output, errors);
+    }
+
+    auto shards = TRY(Vector<TypecheckShard>::create(shard_count));
+    u32 first = 0;
+    u32 tokens_so_far = 0;
+    for (u32 i = 0; i < functions.size(); i++) {
+        tokens_so_far += token_count(expressions, functions[i]);
+        auto is_last = i + 1 == functions.size();
+        auto shard_end
+            = (u64)total_tokens * (shards.size() + 1) / shard_count;
+        if (!is_last && tokens_so_far < shard_end)
+            continue;
+        TRY(shards.append(TypecheckShard {
+            .expressions = expressions,
+            .declarations = declarations,
+            .functions = {
+                functions.data() + first,
+                i + 1 - first,
+            },
+        }));
+        first = i + 1;
+    }
+
+    Core::run_in_parallel(shards.view());
+
+    // NOTE: Shards cover the functions in order, so appending
+    //       their results in order gives what a single pass over
+    //       all of them would have, errors included.
+    for (auto const& shard : shards) {
+        if (!shard.errors.basic_error.is_empty())
+            return shard.errors.basic_error;
+        for (auto const& error : shard.errors.typecheck_errors) {
+            if (!errors.append(error))
+                break;
+        }
+    }
+    if (errors.has_error())
+        return {};
+    for (auto const& shard : shards) {
+        auto const& checked = shard.output.value();
+        auto local_offset = output.locals.size();
+        for (auto body : checked.bodies) {
+            body.first_local += local_offset;
+            TRY(output.bodies.append(body));
+        }
+        TRY(output.locals.extend(checked.locals.view()));
+    }
+    return {};
+}
+
+// NOTE: Types are hashed by structure and by the text of their
+//       names, as type and symbol ids change from one run to the
+//       next.
+u64 type_hash(TypeTable const& types, Interner const& symbols,
+    TypeId type)
+{
+    if (!type.is_valid())
+        return 0;
+    auto kind = types.kind(type);
+    auto hash = mix(0x65707974, (u64)kind);
+    auto inner = [&] {
+        return type_hash(types, symbols, types.inner(type));
+    };
+    switch (kind) {
+    case TypeKind::Named:
+        return mix_text(hash, symbols.text(types.name(type)));
+    case TypeKind::Pointer:
+    case TypeKind::MutableReference:
+    case TypeKind::Id: return mix(hash, inner());
+    case TypeKind::Array:
+        return mix(mix(hash, inner()), types.array_size(type));
+    case TypeKind::Function:
+        hash = mix(hash, inner());
+        for (auto parameter : types.function_parameters(type))
+            hash = mix(hash, type_hash(types, symbols, parameter));
+        return hash;
+    }
+    return hash;
+}
+
+ErrorOr<Vector<u64>> symbol_signatures(Context const& context,
+    Declarations const& declarations)
+{
+    auto const& expressions = context.expressions;
+    auto const& output = declarations.output;
+    auto const& slots = expressions.declaration_slots;
+    auto signatures = TRY(Vector<u64>::create(slots.size()));
+    for (auto declaration : slots) {
+        if (declaration == ParsedExpressions::no_declaration) {
+            signatures.unchecked_append(0);
+            continue;
+        }
+        auto type = output.declaration_types[declaration];
+        auto hash = type_hash(output.types, context.symbols, type);
+        auto kind = expressions.declarations[declaration].type();
+        signatures.unchecked_append(mix(hash, (u64)kind) | 1);
+    }
+    return signatures;
+}
+
+ErrorOr<u32> find_changed_signatures(Context const& context,
+    TypecheckCache const& cache, View<u64 const> signatures,
+    Vector<bool>& is_changed)
+{
+    auto is_cached = TRY(Vector<bool>::create(signatures.size()));
+    TRY(is_changed.ensure_capacity(signatures.size()));
+    for (u32 i = 0; i < signatures.size(); i++) {
+        is_cached.unchecked_append(false);
+        is_changed.unchecked_append(false);
+    }
+
+    // NOTE: Names the source no longer has can not be named by any
+    //       of its bodies either, so they are skipped.
+    u32 changed = 0;
+    for (auto cached : cache.signatures) {
+        auto symbol = context.symbols.find(cache.name(cached));
+        if (!symbol.has_value())
+            continue;
+        auto raw = symbol->raw();
+        if (raw >= signatures.size() || is_cached[raw])
+            continue;
+        is_cached[raw] = true;
+        if (signatures[raw] == cached.signature)
+            continue;
+        is_changed[raw] = true;
+        changed++;
+    }
+    for (u32 symbol = 0; symbol < signatures.size(); symbol++) {
+        if (signatures[symbol] == 0 || is_cached[symbol])
+            continue;
+        is_changed[symbol] = true;
+        changed++;
+    }
+    return changed;
+}
+
+bool names_any(Context const& context, u32 function,
+    View<bool const> symbols)
+{
+    auto const& expressions = context.expressions;
+    auto range = expressions.declaration_tokens(function);
+    for (auto i = range.start; i < range.end; i++) {
+        auto token = context.tokens[i];
+        if (token.is_not(TokenType::Identifier))
+            continue;
+        auto symbol = token.symbol().raw();
+        if (symbol < symbols.size() && symbols[symbol])
+            return true;
+    }
+    return false;
+}
+
+// NOTE: The source a body spans is hashed as a whole, which is far
+//       cheaper than hashing it token by token, and only misses
+//       for nothing on edits between tokens.
+u64 body_key(Context const& context, u32 function)
+{
+    auto const& expressions = context.expressions;
+    auto declaration = expressions.declarations[function];
+    auto hash = mix(0x79646f62, (u64)declaration.type());
+    auto range = expressions.declaration_tokens(function);
+    auto start = range.start;
+    auto end = range.end;
+    if (start == end)
+        return hash;
+    auto first_byte = context.tokens[start].start_index;
+    auto end_byte = context.tokens[end - 1].end_index(
+        context.source);
+    return mix_text(hash,
+        context.source.sub_view(first_byte, end_byte - first_byte));
+}
+
+void KeyShard::operator()()
+{
+    for (u32 i = 0; i < functions.size(); i++)
+        keys[i] = body_key(context, functions[i]);
+}
+
+// NOTE: Hashing is bound by how fast the source can be read, so
+//       it is split across threads like checking is.
+ErrorOr<Vector<u64>> body_keys(Context const& context,
+    Declarations const& declarations, u32 threads)
+{
+    auto const& functions = declarations.functions;
+    auto keys = TRY(Vector<u64>::create(functions.size()));
+    for (u32 i = 0; i < functions.size(); i++)
+        keys.unchecked_append(0);
+
+    u32 total_tokens = 0;
+    for (auto function : functions)
+        total_tokens += token_count(context.expressions, function);
+    auto shard_count = total_tokens / min_shard_tokens;
+    if (threads < shard_count)
+        shard_count = threads;
+    if (shard_count == 0)
+        shard_count = 1;
+    auto shards = TRY(Vector<KeyShard>::create(shard_count));
+    for (u32 i = 0; i < shard_count; i++) {
+        auto first = (u64)functions.size() * i / shard_count;
+        auto end = (u64)functions.size() * (i + 1) / shard_count;
+        shards.unchecked_append(KeyShard {
+            .context = context,
+            .functions = {
+                functions.data() + first,
+                (u32)(end - first),
+            },
+            .keys = keys.data() + first,
+        });
+    }
+    Core::run_in_parallel(shards.view());
+    return keys;
+}
+
+ErrorOr<void> read_cached_body(Context const& context,
+    TypecheckCache& cache, u32 cached, CheckedBody& body,
+    TypeTable& types, Vector<CheckedVariable>& locals)
+{
+    auto const& expressions = context.expressions;
+    auto range = expressions.declaration_tokens(body.declaration);
+    auto first_token = range.start;
+    auto end_token = range.end;
+    auto cached_body = cache.bodies[cached];
+    for (u32 i = 0; i < cached_body.local_count; i++) {
+        auto local = cache.locals[cached_body.first_local + i];
+        if (local.name >= end_token - first_token)
+            return Error::from_string_literal("corrupt cache");
+        TRY(locals.append(CheckedVariable {
+            .name = context.tokens[first_token + local.name],
+            .type = TRY(cache.type(local.type, types,
+                context.symbols)),
+        }));
+    }
+    body.local_count = cached_body.local_count;
+    return {};
+}
+
+// NOTE: Index of `token` in tokens [first, end), which has to be
+//       one of them.
+u32 token_index(View<Token const> tokens, u32 first, u32 end,
+    Token token)
+{
+    while (first < end) {
+        auto middle = first + (end - first) / 2;
+        if (tokens[middle].start_index < token.start_index)
+            first = middle + 1;
+        else
+            end = middle;
+    }
+    return first;
+}
+
+ErrorOr<void> refill_cache(Context const& context,
+    TypecheckedExpressions const& output,
+    View<u64 const> signatures, View<u64 const> keys,
+    TypecheckCacheStats stats, TypecheckCache& cache)
+{
+    auto const& expressions = context.expressions;
+    auto refilled = TRY(TypecheckCache::create());
+    if (stats.missed_tokens != 0) {
+        refilled.check_nanoseconds = stats.check_nanoseconds;
+        refilled.checked_tokens = stats.missed_tokens;
+    }
+    for (u32 symbol = 0; symbol < signatures.size(); symbol++) {
+        if (signatures[symbol] == 0)
+            continue;
+        auto name = context.symbols.text(SymbolId(symbol));
+        TRY(refilled.append_signature(name, signatures[symbol]));
+    }
+    for (u32 i = 0; i < output.bodies.size(); i++) {
+        auto body = output.bodies[i];
+        auto range = expressions.declaration_tokens(
+            body.declaration);
+        auto first_token = range.start;
+        auto end_token = range.end;
+        TRY(refilled.append_body(keys[i]));
+        for (u32 j = 0; j < body.local_count; j++) {
+            auto local = output.locals[body.first_local + j];
+            auto name = token_index(context.tokens, first_token,
+                end_token, local.name);
+            TRY(refilled.append_local(name - first_token,
+                local.type, output.types, context.symbols));
+        }
+    }
+    cache.replace_bodies(move(refilled));
+    return {};
+}
+
+ErrorOr<Declarations> collect_declarations(
+    ParsedExpressions const& expressions, TypecheckErrors& errors)
 {
     auto output = TRY(TypecheckedExpressions::create());
+    auto& types = output.types;
+
+    // NOTE: Bodies may only look types up, so every type named
+    //       anywhere in the file is added here.
+    for (auto const& parameters : expressions.parameterss) {
+        for (auto parameter : parameters) {
+            if (parameter.type.is(TokenType::Identifier))
+                TRY(types.named(parameter.type.symbol()));
+        }
+    }
+#define X(T, variant)                                     \
+    for (auto const& variable : expressions.variant##s) { \
+        if (variable.type.is(TokenType::Identifier))      \
+            TRY(types.named(variable.type.symbol()));       \
+    }
+    VARIABLES
+#undef X
 
-#if 0
-    for (u32 i = 0; i < expressions.expressions.size(); i++)
-        TRY(typecheck_expression(output, expressions, i));
-#endif
-
-    return output;
-}
-
-static TypecheckSingleItemResult typecheck_expression(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return CheckedExpression {
-        Id<CheckedInvalid>::invalid(),
-        0,
-        0,
+    auto named_type = [&](Token type) -> ErrorOr<TypeId> {
+        if (type.is_not(TokenType::Identifier))
+            return TypeId::invalid();
+        return types.named(type.symbol());
+    };
+    auto parameter_types = TRY(Vector<TypeId>::create());
+    auto function_type
+        = [&](auto const& function) -> ErrorOr<TypeId> {
+        parameter_types.truncate(0);
+        for (auto parameter : expressions[function.parameters])
+            TRY(parameter_types.append(
+                TRY(named_type(parameter.type))));
+        return types.function(TRY(named_type(function.return_type)),
+            parameter_types.view());
     };
-}
-
-static TypecheckSingleItemResult typecheck_uninitialized(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_literal(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult
-typecheck_private_constant_declaration(TypecheckedExpressions&,
-    ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult
-typecheck_private_variable_declaration(TypecheckedExpressions&,
-    ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult
-typecheck_public_constant_declaration(TypecheckedExpressions&,
-    ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult
-typecheck_public_variable_declaration(TypecheckedExpressions&,
-    ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_variable_assignment(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_struct_declaration(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_struct_initializer(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_member_access(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_array_access(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_enum_declaration(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_union_declaration(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_variant_declaration(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_lvalue(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_rvalue(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_if_statement(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_return_statement(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_while_statement(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_block(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_function_call(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_private_function(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_public_c_function(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_public_function(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_import_c(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_inline_c(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_moved_value(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
-
-static TypecheckSingleItemResult typecheck_invalid(
-    TypecheckedExpressions&, ParsedExpressions const&, u32)
-{
-    return Error::from_string_literal("unimplemented");
-}
 
-[[deprecated("can't typecheck invalid")]] //
-[[maybe_unused]] static TypecheckSingleItemResult
-parse_invalid(TypecheckedExpressions&, ParsedExpressions const&,
-    u32 index)
-{
-    return TypecheckError {
-        "trying to typecheck invalid"sv,
-        index,
+    auto const& declarations = expressions.declarations;
+    auto globals = TRY(ScopeTable::create(declarations.size()));
+    auto functions = TRY(Vector<u32>::create());
+    TRY(output.declaration_types.ensure_capacity(
+        declarations.size()));
+    for (u32 i = 0; i < declarations.size(); i++) {
+        auto declaration = declarations[i];
+        auto type = TypeId::invalid();
+        switch (declaration.type()) {
+#define X(T, variant)                                  \
+    case ExpressionType::T: {                          \
+        auto const& function                           \
+            = expressions[declaration.as_##variant()]; \
+        type = TRY(function_type(function));           \
+        TRY(functions.append(i));                      \
+        break;                                         \
+    }
+            FUNCTIONS
+#undef X
+#define X(T, variant)                                  \
+    case ExpressionType::T: {                          \
+        auto const& variable                           \
+            = expressions[declaration.as_##variant()]; \
+        type = TRY(named_type(variable.type));         \
+        break;                                         \
+    }
+            VARIABLES
+#undef X
+        default: {
+            auto name = expressions.declaration_name(declaration);
+            type = TRY(named_type(name));
+            break;
+        }
+        }
+        output.declaration_types.unchecked_append(type);
+
+        auto name = expressions.declaration_name(declaration);
+        auto binding = Binding { declaration, type };
+        if (TRY(globals.declare(name.symbol(), binding)))
+            continue;
+        if (!errors.append({ "redeclared"sv, name }))
+            break;
+    }
+
+    return Declarations {
+        .output = move(output),
+        .globals = move(globals),
+        .functions = move(functions),
     };
 }
 
-[[deprecated("can't parse moved value")]] //
-[[maybe_unused]] static TypecheckSingleItemResult
-parse_moved_value(TypecheckedExpressions&, ParsedExpressions const&,
-    u32 start)
+ErrorOr<void> check_bodies(ParsedExpressions const& expressions,
+    Declarations const& declarations, View<u32 const> functions,
+    TypecheckedExpressions& output, TypecheckErrors& errors)
 {
-    return TypecheckError {
-        "trying to typecheck moved"sv,
-        start,
+    auto checker = BodyChecker {
+        .expressions = expressions,
+        .declarations = declarations,
+        .output = output,
+        .errors = errors,
+        .locals = TRY(ScopeTable::create()),
+    };
+    for (auto function : functions) {
+        auto declaration = expressions.declarations[function];
+        switch (declaration.type()) {
+#define X(T, variant)                                            \
+    case ExpressionType::T:                                      \
+        TRY(checker.function(                                    \
+            expressions[declaration.as_##variant()], function)); \
+        break;
+            FUNCTIONS
+#undef X
+        default: break;
+        }
+        if (checker.is_full)
+            break;
+    }
+    return {};
+}
+
+void TypecheckShard::operator()()
+{
+    auto created = TypecheckedExpressions::create();
+    if (created.is_error()) {
+        errors.basic_error = created.error();
+        return;
+    }
+    auto shard = created.release_value();
+    auto checked = check_bodies(expressions, declarations,
+        functions, shard, errors);
+    if (checked.is_error()) {
+        errors.basic_error = checked.error();
+        return;
+    }
+    output = move(shard);
+}
+
+template <typename Function>
+ErrorOr<void> BodyChecker::function(Function const& function,
+    u32 declaration)
+{
+    auto body = CheckedBody {
+        .declaration = declaration,
+        .first_local = output.locals.size(),
     };
-}
 
-ErrorOr<void> TypecheckError::show(Context const&) const
-{
-    return Error::from_string_literal("unimplemented");
+    // NOTE: Parameters share a scope with the outermost block of
+    //       the body, like they do in C.
+    TRY(locals.enter_scope());
+    auto binding = Binding {
+        expressions.declarations[declaration],
+        TypeId::invalid(),
+    };
+    for (auto parameter : expressions[function.parameters]) {
+        binding.type = named_type(parameter.type);
+        TRY(declare(parameter.name, binding));
+    }
+    auto const& block = expressions[function.block];
+    TRY(expressions_in(expressions[block.expressions]));
+    locals.exit_scope();
+
+    body.local_count = output.locals.size() - body.first_local;
+    TRY(output.bodies.append(body));
+    return {};
+}
+
+ErrorOr<void> BodyChecker::block(Id<Block> id)
+{
+    TRY(locals.enter_scope());
+    TRY(expressions_in(expressions[expressions[id].expressions]));
+    locals.exit_scope();
+    return {};
+}
+
+ErrorOr<void> BodyChecker::expressions_in(
+    View<Expression const> children)
+{
+    for (auto child : children) {
+        if (is_full)
+            break;
+        TRY(expression(child));
+    }
+    return {};
+}
+
+ErrorOr<void> BodyChecker::expression(Expression expression)
+{
+    switch (expression.type()) {
+    case ExpressionType::Block:
+        return block(expression.as_block());
+#define X(T, variant)                                              \
+    case ExpressionType::T: {                                      \
+        auto const& variable                                       \
+            = expressions[expression.as_##variant()];              \
+        return local(variable.name, variable.type, variable.value, \
+            expression);                                           \
+    }
+        VARIABLES
+#undef X
+    case ExpressionType::VariableAssignment:
+        return variable_assignment(
+            expressions[expression.as_variable_assignment()]);
+    case ExpressionType::FunctionCall:
+        return function_call(
+            expressions[expression.as_function_call()]);
+    case ExpressionType::RValue: {
+        auto const& rvalue = expressions[expression.as_rvalue()];
+        return expressions_in(expressions[rvalue.expressions]);
+    }
+    case ExpressionType::BinaryOperation: {
+        auto const& operation
+            = expressions[expression.as_binary_operation()];
+        return expressions_in(
+            expressions[operation.operand_range()]);
+    }
+    case ExpressionType::UnaryOperation: {
+        auto const& operation
+            = expressions[expression.as_unary_operation()];
+        return expressions_in(
+            expressions[operation.operand_range()]);
+    }
+    case ExpressionType::If: {
+        auto const& if_ = expressions[expression.as_if_statement()];
+        auto const& condition = expressions[if_.condition];
+        TRY(expressions_in(expressions[condition.expressions]));
+        return block(if_.block);
+    }
+    case ExpressionType::While: {
+        auto const& while_
+            = expressions[expression.as_while_statement()];
+        auto const& condition = expressions[while_.condition];
+        TRY(expressions_in(expressions[condition.expressions]));
+        return block(while_.block);
+    }
+    case ExpressionType::Return: {
+        auto const& return_
+            = expressions[expression.as_return_statement()];
+        return this->expression(expressions[return_.value]);
+    }
+    default: return {};
+    }
+}
+
+ErrorOr<void> BodyChecker::local(Token name, Token type,
+    Id<Expression> value, Expression declaration)
+{
+    auto const& initializer = expressions[value];
+    TRY(expression(initializer));
+
+    auto binding = Binding { declaration, named_type(type) };
+    if (!binding.type.is_valid()
+        && initializer.type() == ExpressionType::RValue) {
+        binding.type
+            = type_of(expressions[initializer.as_rvalue()]);
+    }
+    TRY(declare(name, binding));
+    return {};
+}
+
+ErrorOr<void> BodyChecker::variable_assignment(
+    VariableAssignment const& assignment)
+{
+    auto const& value = expressions[assignment.value];
+    TRY(expressions_in(expressions[value.expressions]));
+
+    auto binding = look_up(assignment.name.symbol());
+    if (binding.has_value() && is_constant(binding->declaration))
+        error("assigned to a constant"sv, assignment.name);
+    return {};
+}
+
+ErrorOr<void> BodyChecker::function_call(FunctionCall const& call)
+{
+    TRY(expressions_in(expressions[call.arguments]));
+
+    // NOTE: Locals may hold pointers to functions of any kind, so
+    //       only calls straight to a function of this file are
+    //       checked.
+    auto symbol = call.name.symbol();
+    if (locals.find(symbol).has_value())
+        return {};
+    auto binding = declarations.globals.find(symbol);
+    if (!binding.has_value() || !is_function(binding->declaration))
+        return {};
+    auto const& types = declarations.output.types;
+    auto parameters = types.function_parameters(binding->type);
+    if (parameters.size() != call.arguments.count)
+        error("wrong number of arguments"sv, call.name);
+    return {};
+}
+
+ErrorOr<void> BodyChecker::declare(Token name, Binding binding)
+{
+    if (!TRY(locals.declare(name.symbol(), binding)))
+        error("redeclared in the same scope"sv, name);
+    TRY(output.locals.append(CheckedVariable {
+        .name = name,
+        .type = binding.type,
+    }));
+    return {};
+}
+
+Optional<Binding> BodyChecker::look_up(SymbolId symbol) const
+{
+    auto local = locals.find(symbol);
+    if (local.has_value())
+        return local.release_value();
+    return declarations.globals.find(symbol);
+}
+
+TypeId BodyChecker::named_type(Token type) const
+{
+    if (type.is_not(TokenType::Identifier))
+        return TypeId::invalid();
+    auto const& types = declarations.output.types;
+    auto named = types.find_named(type.symbol());
+    if (!named.has_value())
+        return TypeId::invalid();
+    return named.value();
+}
+
+// NOTE: Only values that are a single name or a single call of a
+//       function of this file have a type known here, the rest
+//       is left to C.
+TypeId BodyChecker::type_of(RValue const& rvalue) const
+{
+    if (rvalue.expressions.count != 1)
+        return TypeId::invalid();
+    auto value = expressions[rvalue.expressions][0];
+    if (value.type() == ExpressionType::LValue) {
+        auto const& lvalue = expressions[value.as_lvalue()];
+        auto binding = look_up(lvalue.token.symbol());
+        if (!binding.has_value())
+            return TypeId::invalid();
+        return binding->type;
+    }
+    if (value.type() == ExpressionType::FunctionCall) {
+        auto const& call = expressions[value.as_function_call()];
+        if (locals.find(call.name.symbol()).has_value())
+            return TypeId::invalid();
+        auto binding
+            = declarations.globals.find(call.name.symbol());
+        if (!binding.has_value())
+            return TypeId::invalid();
+        if (!is_function(binding->declaration))
+            return TypeId::invalid();
+        return declarations.output.types.inner(binding->type);
+    }
+    return TypeId::invalid();
+}
+
+void BodyChecker::error(StringView message, Token offending_token)
+{
+    if (!errors.append({ message, offending_token }))
+        is_full = true;
+}
+
+}
+
+ErrorOr<void> TypecheckError::show(Context const& context) const
+{
+    auto source = context.source;
+    auto start = offending_token.start_index;
+    u32 line = 0;
+    u32 line_start = 0;
+    for (u32 i = 0; i < start && i < source.size; i++) {
+        if (source[i] == '\n') {
+            line++;
+            line_start = i + 1;
+        }
+    }
+    u32 line_end = line_start;
+    while (line_end < source.size && source[line_end] != '\n')
+        line_end++;
+    auto column = start - line_start;
+
+    auto normal = "\033[0;0m"sv;
+    auto red = "\033[1;31m"sv;
+    auto yellow = "\033[1;33m"sv;
+    auto blue = "\033[0;34m"sv;
+
+    auto& out = Core::File::stderr();
+    auto name = offending_token.text(source);
+    TRY(out.writeln(red, "Error: "sv, normal, message, " ("sv, name,
+        ") ["sv, blue, context.file_name, normal, ":"sv, line + 1,
+        ":"sv, column + 1, "]"sv));
+    TRY(out.writeln(source.sub_view(line_start,
+        line_end - line_start)));
+    for (u32 i = 0; i < column; i++)
+        TRY(out.write(" "sv));
+    TRY(out.write(yellow));
+    for (u32 i = 0; i < name.size; i++)
+        TRY(out.write("^"sv));
+    TRY(out.writeln(" "sv, message, normal));
+    return {};
+}
+
+ErrorOr<void> TypecheckErrors::show(Context const& context) const
+{
+    if (typecheck_errors.is_empty()) {
+        TRY(Core::File::stderr().writeln(basic_error));
+        return {};
+    }
+
+    for (auto const& error : typecheck_errors.in_reverse()) {
+        TRY(error.show(context));
+        TRY(Core::File::stderr().write("\n"sv));
+    }
+    return {};
 }
 
 }
@@ -1,32 +1,73 @@
 #pragma once
 #include "Context.h"
 #include "Parser.h"
+#include "TypecheckCache.h"
 #include "TypecheckedExpression.h"
 #include <Ty/ErrorOr.h>
+#include <Ty/SmallVector.h>
+#include <Ty/Threads.h>
 
 namespace He {
 
 struct TypecheckError {
     StringView message {};
-    u32 offending_expression_index { 0 };
+    Token offending_token {};
 
-    TypecheckError(StringView message,
-        u32 offending_expression_index)
-        : message(message)
-        , offending_expression_index(offending_expression_index)
+    ErrorOr<void> show(Context const& context) const;
+};
+
+struct TypecheckErrors {
+    constexpr TypecheckErrors() = default;
+
+    constexpr TypecheckErrors(Error error)
+        : basic_error(error)
+    {
+    }
+
+    constexpr TypecheckErrors(TypecheckErrors&& other)
+        : basic_error(other.basic_error)
+        , typecheck_errors(move(other.typecheck_errors))
     {
     }
 
-    TypecheckError(Error error)
-        : message(error.message())
+    constexpr bool has_error() const
     {
+        return !typecheck_errors.is_empty()
+            || !basic_error.is_empty();
+    }
+
+    // NOTE: Returns false once no more errors fit, after which
+    //       checking should stop.
+    bool append(TypecheckError error)
+    {
+        return !typecheck_errors.append(error).is_error();
     }
 
     ErrorOr<void> show(Context const& context) const;
+
+    Error basic_error {};
+    SmallVector<TypecheckError> typecheck_errors {};
 };
 
 using TypecheckResult
-    = ErrorOr<TypecheckedExpressions, TypecheckError>;
+    = ErrorOr<TypecheckedExpressions, TypecheckErrors>;
+
+// NOTE: Collects the types of every top level declaration first,
+//       then checks function bodies against them one by one.
 TypecheckResult typecheck(Context& context);
 
+// NOTE: Same as typecheck(), but checks function bodies on
+//       separate threads. The result, errors included, is exactly
+//       that of typecheck().
+TypecheckResult typecheck_in_parallel(Context& context,
+    u32 threads = Threads::in_machine());
+
+// NOTE: Same as typecheck_in_parallel(), but bodies whose tokens,
+//       and the signatures of the declarations they name, are
+//       unchanged since they were put in `cache` are taken from
+//       it instead of being checked again. Once the file checks,
+//       `cache` is refilled with all of its bodies.
+TypecheckResult typecheck_incrementally(Context& context,
+    TypecheckCache& cache, u32 threads = Threads::in_machine());
+
 }
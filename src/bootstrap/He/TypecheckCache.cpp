@@ -0,0 +1,450 @@
+#include "TypecheckCache.h"
+#include "CacheFile.h"
+#include <Core/System.h>
+#include <Ty/Defer.h>
+#include <Ty/StringBuffer.h>
+
+namespace He {
+
+namespace {
+
+constexpr u64 cache_magic = 0x6b636568632d6568; // "he-check"
+
+// NOTE: Bump whenever the typechecker starts checking something
+//       new, as bodies checked by an older one would otherwise be
+//       taken as is.
+constexpr u64 cache_version = 2;
+
+struct CacheHeader {
+    u64 magic;
+    u64 fingerprint;
+    u64 check_nanoseconds;
+    u64 checked_tokens;
+    u32 signature_count;
+    u32 body_count;
+    u32 local_count;
+    u32 type_count;
+    u32 parameter_count;
+    u32 name_size;
+};
+
+constexpr u64 cache_fingerprint()
+{
+    auto hash = mix(cache_magic, cache_version);
+#define X(...) hash = mix(hash, 1);
+    TYPE_KINDS
+#undef X
+    hash = mix(hash, sizeof(CachedSignature));
+    hash = mix(hash, sizeof(CachedBody));
+    hash = mix(hash, sizeof(CachedLocal));
+    hash = mix(hash, sizeof(TypeKind));
+    hash = mix(hash, sizeof(TypeOperands));
+    return hash;
+}
+
+constexpr u32 no_body = 0xFFFFFFFF;
+
+constexpr u32 slot_hash(u64 key) { return key ^ (key >> 32); }
+
+ErrorOr<StringBuffer> cache_path(StringView directory,
+    StringView file_name)
+{
+    return He::cache_path(directory,
+        mix_text(cache_fingerprint(), file_name), ".hecheck"sv);
+}
+
+template <typename T>
+ErrorOr<Vector<T>> create_filled(u32 count, T value)
+{
+    auto vector = TRY(Vector<T>::create(count));
+    for (u32 i = 0; i < count; i++)
+        vector.unchecked_append(value);
+    return vector;
+}
+
+// NOTE: Cache files are mapped private and writable, so the
+//       vectors borrowing from them can be changed.
+template <typename T>
+Vector<T> borrow_section(StringView contents, u64& offset,
+    u32 count)
+{
+    auto* data = (T*)&contents.data[offset];
+    offset += (u64)count * sizeof(T);
+    return Vector<T>::borrow(View<T>(data, count));
+}
+
+template <typename T>
+ErrorOr<void> write_section(int fd, Vector<T> const& section)
+{
+    return write_all(fd, section.data(),
+        section.size() * sizeof(T));
+}
+
+}
+
+ErrorOr<TypecheckCache> TypecheckCache::create()
+{
+    return TypecheckCache {
+        TRY(Vector<CachedSignature>::create()),
+        TRY(Vector<CachedBody>::create()),
+        TRY(Vector<CachedLocal>::create()),
+        TRY(Vector<TypeKind>::create()),
+        TRY(Vector<TypeOperands>::create()),
+        TRY(Vector<u32>::create()),
+        TRY(Vector<char>::create()),
+        TRY(create_filled(64, no_body)),
+        TRY(Vector<u32>::create()),
+        TRY(Vector<TypeId>::create()),
+    };
+}
+
+ErrorOr<TypecheckCache> TypecheckCache::load(StringView directory,
+    StringView file_name)
+{
+    auto path = TRY(cache_path(directory, file_name));
+    auto file = TRY(Core::MappedFile::open(path.view()));
+
+    auto contents = file.view();
+    if (contents.size < sizeof(CacheHeader))
+        return Error::from_string_literal("truncated cache");
+    auto header = *(CacheHeader const*)contents.data;
+    if (header.magic != cache_magic
+        || header.fingerprint != cache_fingerprint())
+        return Error::from_string_literal("incompatible cache");
+    auto size = sizeof(CacheHeader)
+        + (u64)header.signature_count * sizeof(CachedSignature)
+        + (u64)header.body_count * sizeof(CachedBody)
+        + (u64)header.local_count * sizeof(CachedLocal)
+        + (u64)header.type_count * sizeof(TypeKind)
+        + (u64)header.type_count * sizeof(TypeOperands)
+        + (u64)header.parameter_count * sizeof(u32)
+        + header.name_size;
+    if (size != contents.size)
+        return Error::from_string_literal("corrupt cache");
+
+    // NOTE: Sections are laid out largest alignment first, so
+    //       none of them needs padding. Types are only checked
+    //       once they are read, the cache directory is trusted as
+    //       much as the compiler itself.
+    u64 offset = sizeof(CacheHeader);
+    auto signatures = borrow_section<CachedSignature>(contents,
+        offset, header.signature_count);
+    auto bodies = borrow_section<CachedBody>(contents, offset,
+        header.body_count);
+    auto locals = borrow_section<CachedLocal>(contents, offset,
+        header.local_count);
+    auto operands = borrow_section<TypeOperands>(contents, offset,
+        header.type_count);
+    auto parameters = borrow_section<u32>(contents, offset,
+        header.parameter_count);
+    auto kinds = borrow_section<TypeKind>(contents, offset,
+        header.type_count);
+    auto names = borrow_section<char>(contents, offset,
+        header.name_size);
+    for (auto body : bodies) {
+        if (body.first_local > locals.size()
+            || body.local_count > locals.size() - body.first_local)
+            return Error::from_string_literal("corrupt cache");
+    }
+
+    auto cache = TypecheckCache {
+        move(signatures),
+        move(bodies),
+        move(locals),
+        move(kinds),
+        move(operands),
+        move(parameters),
+        move(names),
+        TRY(Vector<u32>::create()),
+        TRY(Vector<u32>::create()),
+        TRY(Vector<TypeId>::create()),
+    };
+    cache.m_file = move(file);
+    cache.check_nanoseconds = header.check_nanoseconds;
+    cache.checked_tokens = header.checked_tokens;
+    TRY(cache.index_bodies());
+    return cache;
+}
+
+ErrorOr<void> TypecheckCache::store(StringView directory,
+    StringView file_name) const
+{
+    auto header = CacheHeader {
+        .magic = cache_magic,
+        .fingerprint = cache_fingerprint(),
+        .check_nanoseconds = check_nanoseconds,
+        .checked_tokens = checked_tokens,
+        .signature_count = signatures.size(),
+        .body_count = bodies.size(),
+        .local_count = locals.size(),
+        .type_count = kinds.size(),
+        .parameter_count = parameters.size(),
+        .name_size = names.size(),
+    };
+    auto write_cache = [&](int fd) -> ErrorOr<void> {
+        TRY(write_all(fd, &header, sizeof(header)));
+        TRY(write_section(fd, signatures));
+        TRY(write_section(fd, bodies));
+        TRY(write_section(fd, locals));
+        TRY(write_section(fd, operands));
+        TRY(write_section(fd, parameters));
+        TRY(write_section(fd, kinds));
+        TRY(write_section(fd, names));
+        return {};
+    };
+
+    // NOTE: Written next to where it belongs and renamed into
+    //       place, so other compilers never see a half written
+    //       cache.
+    auto directory_path
+        = TRY(StringBuffer::create_fill(directory, "\0"sv));
+    Core::System::mkdir(directory_path.data()).ignore();
+    auto path = TRY(cache_path(directory, file_name));
+    auto final_path = TRY(StringBuffer::create_fill(path.view(),
+        "\0"sv));
+    auto temporary_path = TRY(StringBuffer::create_fill(path.view(),
+        "XXXXXX\0"sv));
+    auto* temporary = temporary_path.mutable_data();
+    auto fd = TRY(Core::System::mkstemps(temporary));
+    auto should_remove = true;
+    Defer remove_temporary = [&] {
+        if (should_remove)
+            Core::System::unlink(temporary).ignore();
+    };
+    auto write_result = write_cache(fd);
+    TRY(Core::System::close(fd));
+    TRY(write_result);
+    TRY(Core::System::rename(temporary, final_path.data()));
+    should_remove = false;
+    return {};
+}
+
+Optional<u32> TypecheckCache::find(u64 key) const
+{
+    auto mask = m_slots.size() - 1;
+    for (auto slot = slot_hash(key) & mask;;
+         slot = (slot + 1) & mask) {
+        auto body = m_slots[slot];
+        if (body == no_body)
+            return {};
+        if (bodies[body].key == key)
+            return body;
+    }
+}
+
+ErrorOr<void> TypecheckCache::append_signature(StringView name,
+    u64 signature)
+{
+    TRY(signatures.append({ signature, names.size(), name.size }));
+    TRY(names.extend(View<char const>(name.data, name.size)));
+    return {};
+}
+
+StringView TypecheckCache::name(CachedSignature signature) const
+{
+    auto start = signature.name;
+    auto size = signature.name_size;
+    if (start > names.size() || size > names.size() - start)
+        return {};
+    return { names.data() + start, size };
+}
+
+ErrorOr<void> TypecheckCache::append_body(u64 key)
+{
+    auto body = bodies.size();
+    TRY(bodies.append({ key, locals.size(), 0 }));
+    if (bodies.size() * 2 > m_slots.size())
+        return index_bodies();
+    auto mask = m_slots.size() - 1;
+    auto slot = slot_hash(key) & mask;
+    while (m_slots[slot] != no_body)
+        slot = (slot + 1) & mask;
+    m_slots[slot] = body;
+    return {};
+}
+
+ErrorOr<void> TypecheckCache::append_local(u32 name, TypeId type,
+    TypeTable const& types, Interner const& symbols)
+{
+    auto cached = TRY(add_type(type, types, symbols));
+    TRY(locals.append({ name, cached }));
+    bodies.last().local_count++;
+    return {};
+}
+
+ErrorOr<u32> TypecheckCache::add_type(TypeId type,
+    TypeTable const& types, Interner const& symbols)
+{
+    if (!type.is_valid())
+        return no_type;
+    auto raw = type.raw();
+    if (raw < m_added_types.size() && m_added_types[raw] != no_type)
+        return m_added_types[raw];
+
+    // NOTE: Operands are added before the types using them, which
+    //       type() relies on to never go around in circles.
+    auto kind = types.kind(type);
+    auto cached = TypeOperands {};
+    switch (kind) {
+    case TypeKind::Named: {
+        auto text = symbols.text(types.name(type));
+        cached = { names.size(), (u32)text.size };
+        TRY(names.extend(View<char const>(text.data, text.size)));
+        break;
+    }
+    case TypeKind::Pointer:
+    case TypeKind::MutableReference:
+    case TypeKind::Id:
+        cached.inner = TRY(add_type(types.inner(type), types,
+            symbols));
+        break;
+    case TypeKind::Array:
+        cached.inner = TRY(add_type(types.inner(type), types,
+            symbols));
+        cached.size = types.array_size(type);
+        break;
+    case TypeKind::Function: {
+        auto function_parameters = types.function_parameters(type);
+        auto cached_parameters = TRY(Vector<u32>::create(
+            function_parameters.size()));
+        for (auto parameter : function_parameters) {
+            cached_parameters.unchecked_append(
+                TRY(add_type(parameter, types, symbols)));
+        }
+        cached.inner = TRY(add_type(types.inner(type), types,
+            symbols));
+        cached.size = cached_parameters.size();
+        cached.first = parameters.size();
+        TRY(parameters.extend(cached_parameters.view()));
+        break;
+    }
+    }
+
+    auto index = kinds.size();
+    TRY(kinds.append(kind));
+    TRY(operands.append(cached));
+    while (m_added_types.size() <= raw)
+        TRY(m_added_types.append(no_type));
+    m_added_types[raw] = index;
+    return index;
+}
+
+ErrorOr<TypeId> TypecheckCache::type(u32 cached,
+    TypeTable& types, Interner const& symbols)
+{
+    if (cached == no_type)
+        return TypeId::invalid();
+    if (cached >= kinds.size())
+        return Error::from_string_literal("corrupt cache");
+    if (cached >= m_read_types.size())
+        return read_type(cached, types, symbols);
+    if (m_read_types[cached].is_valid())
+        return m_read_types[cached];
+    auto type = TRY(read_type(cached, types, symbols));
+    m_read_types[cached] = type;
+    return type;
+}
+
+ErrorOr<void> TypecheckCache::reset_read_types()
+{
+    m_read_types = TRY(create_filled(kinds.size(),
+        TypeId::invalid()));
+    return {};
+}
+
+ErrorOr<TypeId> TypecheckCache::read_type(u32 cached,
+    TypeTable& types, Interner const& symbols)
+{
+
+    auto operand = [&](u32 index) -> ErrorOr<TypeId> {
+        if (index != no_type && index >= cached)
+            return Error::from_string_literal("corrupt cache");
+        return type(index, types, symbols);
+    };
+    auto cached_operands = operands[cached];
+    switch (kinds[cached]) {
+    case TypeKind::Named: {
+        auto start = cached_operands.inner;
+        auto size = cached_operands.size;
+        if (start > names.size() || size > names.size() - start)
+            return Error::from_string_literal("corrupt cache");
+        auto symbol = symbols.find({ names.data() + start, size });
+        if (!symbol.has_value())
+            return Error::from_string_literal("stale cache");
+        return types.named(symbol.release_value());
+    }
+    case TypeKind::Pointer:
+        return types.pointer(TRY(operand(cached_operands.inner)));
+    case TypeKind::MutableReference:
+        return types.mutable_reference(
+            TRY(operand(cached_operands.inner)));
+    case TypeKind::Id:
+        return types.id(TRY(operand(cached_operands.inner)));
+    case TypeKind::Array:
+        return types.array(TRY(operand(cached_operands.inner)),
+            cached_operands.size);
+    case TypeKind::Function: {
+        auto first = cached_operands.first;
+        auto count = cached_operands.size;
+        if (first > parameters.size()
+            || count > parameters.size() - first)
+            return Error::from_string_literal("corrupt cache");
+        auto parameter_types = TRY(Vector<TypeId>::create(count));
+        for (u32 i = 0; i < count; i++) {
+            parameter_types.unchecked_append(
+                TRY(operand(parameters[first + i])));
+        }
+        auto return_type = TRY(operand(cached_operands.inner));
+        return types.function(return_type, parameter_types.view());
+    }
+    }
+    return Error::from_string_literal("corrupt cache");
+}
+
+void TypecheckCache::replace_bodies(TypecheckCache&& other)
+{
+    signatures = move(other.signatures);
+    bodies = move(other.bodies);
+    locals = move(other.locals);
+    kinds = move(other.kinds);
+    operands = move(other.operands);
+    parameters = move(other.parameters);
+    names = move(other.names);
+    m_slots = move(other.m_slots);
+    m_added_types = move(other.m_added_types);
+    m_read_types = move(other.m_read_types);
+    m_has_changed = true;
+    if (other.checked_tokens != 0) {
+        check_nanoseconds = other.check_nanoseconds;
+        checked_tokens = other.checked_tokens;
+    }
+}
+
+i64 TypecheckCache::nanoseconds_saved() const
+{
+    u64 saved = 0;
+    if (checked_tokens != 0) {
+        saved = last_run.hit_tokens * check_nanoseconds
+            / checked_tokens;
+    }
+    return (i64)saved - (i64)last_run.hash_nanoseconds;
+}
+
+ErrorOr<void> TypecheckCache::index_bodies()
+{
+    u32 slot_count = 64;
+    while (slot_count < bodies.size() * 2)
+        slot_count *= 2;
+    auto slots = TRY(create_filled(slot_count, no_body));
+    auto mask = slot_count - 1;
+    for (u32 body = 0; body < bodies.size(); body++) {
+        auto slot = slot_hash(bodies[body].key) & mask;
+        while (slots[slot] != no_body)
+            slot = (slot + 1) & mask;
+        slots[slot] = body;
+    }
+    m_slots = move(slots);
+    return {};
+}
+
+}
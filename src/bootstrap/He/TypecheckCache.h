@@ -0,0 +1,156 @@
+#pragma once
+#include "Interner.h"
+#include "TypeTable.h"
+#include <Core/MappedFile.h>
+#include <Ty/ErrorOr.h>
+#include <Ty/Optional.h>
+#include <Ty/StringView.h>
+#include <Ty/Vector.h>
+
+namespace He {
+
+// NOTE: A function body that checked without errors, found again
+//       by a key hashed from its source.
+struct CachedBody {
+    u64 key { 0 };
+    u32 first_local { 0 };
+    u32 local_count { 0 };
+};
+
+// NOTE: `name` is the index of the name token counted from the
+//       first token of the function, so bodies moved around in
+//       the file are still found. `type` indexes the cached
+//       types, or is TypecheckCache::no_type.
+struct CachedLocal {
+    u32 name { 0 };
+    u32 type { 0 };
+};
+
+// NOTE: Signature of a top level declaration as the cached bodies
+//       were checked against it. `name` is an offset into
+//       TypecheckCache::names.
+struct CachedSignature {
+    u64 signature { 0 };
+    u32 name { 0 };
+    u32 name_size { 0 };
+};
+
+struct TypecheckCacheStats {
+    u32 hits { 0 };
+    u32 misses { 0 };
+    u64 hit_tokens { 0 };
+    u64 missed_tokens { 0 };
+    u64 hash_nanoseconds { 0 };
+    u64 check_nanoseconds { 0 };
+};
+
+// NOTE: Bodies of one source file as they were when it last
+//       typechecked. Types are stored the way TypeTable stores
+//       them, except that named types refer to their text in
+//       `names` rather than to a symbol, as symbol ids change
+//       from one run to the next.
+struct TypecheckCache {
+    static ErrorOr<TypecheckCache> create();
+
+    // NOTE: Anything but a cache stored for `file_name` by a
+    //       compatible compiler is an error, which callers should
+    //       treat as an empty cache.
+    static ErrorOr<TypecheckCache> load(StringView directory,
+        StringView file_name);
+
+    ErrorOr<void> store(StringView directory,
+        StringView file_name) const;
+
+    // NOTE: Index of the body stored under `key`.
+    Optional<u32> find(u64 key) const;
+
+    ErrorOr<void> append_signature(StringView name, u64 signature);
+
+    // NOTE: Empty if the signature is corrupt.
+    StringView name(CachedSignature signature) const;
+
+    ErrorOr<void> append_body(u64 key);
+    ErrorOr<void> append_local(u32 name, TypeId type,
+        TypeTable const& types, Interner const& symbols);
+
+    // NOTE: Adds the cached type to `types` if it is not there
+    //       already. Errors if it names a symbol that is not in
+    //       `symbols`, as no body referring to it can be current.
+    //       Types read are remembered until reset_read_types(),
+    //       which has to be called before reading into another
+    //       table.
+    ErrorOr<TypeId> type(u32 cached, TypeTable& types,
+        Interner const& symbols);
+    ErrorOr<void> reset_read_types();
+
+    // NOTE: Takes the bodies of `other`, keeping the check rate
+    //       of this cache unless `other` measured a new one.
+    void replace_bodies(TypecheckCache&& other);
+
+    // NOTE: Whether the bodies changed since the cache was loaded.
+    constexpr bool has_changed() const { return m_has_changed; }
+
+    // NOTE: What checking the bodies found in the cache would have
+    //       cost at the check rate measured by the last run that
+    //       checked any, less the time spent finding them. Negative
+    //       when the cache did not pay for itself.
+    i64 nanoseconds_saved() const;
+
+    Vector<CachedSignature> signatures;
+    Vector<CachedBody> bodies;
+    Vector<CachedLocal> locals;
+    Vector<TypeKind> kinds;
+    Vector<TypeOperands> operands;
+    Vector<u32> parameters;
+    Vector<char> names;
+
+    u64 check_nanoseconds { 0 };
+    u64 checked_tokens { 0 };
+
+    TypecheckCacheStats last_run {};
+
+    static constexpr u32 no_type = 0xFFFFFFFF;
+
+private:
+    TypecheckCache(Vector<CachedSignature>&& signatures,
+        Vector<CachedBody>&& bodies,
+        Vector<CachedLocal>&& locals, Vector<TypeKind>&& kinds,
+        Vector<TypeOperands>&& operands, Vector<u32>&& parameters,
+        Vector<char>&& names, Vector<u32>&& slots,
+        Vector<u32>&& added_types, Vector<TypeId>&& read_types)
+        : signatures(move(signatures))
+        , bodies(move(bodies))
+        , locals(move(locals))
+        , kinds(move(kinds))
+        , operands(move(operands))
+        , parameters(move(parameters))
+        , names(move(names))
+        , m_slots(move(slots))
+        , m_added_types(move(added_types))
+        , m_read_types(move(read_types))
+    {
+    }
+
+    ErrorOr<u32> add_type(TypeId type, TypeTable const& types,
+        Interner const& symbols);
+    ErrorOr<TypeId> read_type(u32 cached, TypeTable& types,
+        Interner const& symbols);
+    ErrorOr<void> index_bodies();
+
+    Optional<Core::MappedFile> m_file {};
+
+    // NOTE: Open addressed table of indices into `bodies`.
+    Vector<u32> m_slots;
+
+    // NOTE: Cached index of each TypeId added to this cache, or
+    //       no_type.
+    Vector<u32> m_added_types;
+
+    // NOTE: What each cached type was read back as, or an
+    //       invalid id if it has not been yet.
+    Vector<TypeId> m_read_types;
+
+    bool m_has_changed { false };
+};
+
+}
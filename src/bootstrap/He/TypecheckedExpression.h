@@ -2,6 +2,7 @@
 #include "Context.h"
 #include "Lexer.h"
 #include "Parser.h"
+#include "TypeTable.h"
 #include <Ty/Move.h>
 #include <Ty/Vector.h>
 
@@ -11,8 +12,6 @@ struct CheckedExpression;
 using CheckedExpressions = Vector<CheckedExpression>;
 struct TypecheckedExpressions;
 
-using TypeId = Id<StringView>;
-
 #define CHECKED_EXPRESSIONS                           \
     X(CheckedUninitialized, uninitialized)            \
     X(CheckedLiteral, literal)                        \
@@ -110,6 +109,15 @@ struct CheckedVariable {
     TypeId type;
 };
 
+// NOTE: Parameters and locals of one function body, in the order
+//       they are declared, as a run of
+//       TypecheckedExpressions::locals.
+struct CheckedBody {
+    u32 declaration { 0 };
+    u32 first_local { 0 };
+    u32 local_count { 0 };
+};
+
 struct CheckedParameter {
     Token name {};
     TypeId type;
@@ -391,7 +399,7 @@ private:
 
 public:
     u32 start_token_index { 0 };
-    u32 end_token_offset : 24 { 0 };
+    u32 end_token_offset { 0 };
 
     constexpr u32 end_token_index() const
     {
@@ -428,9 +436,12 @@ public:
             .parameterss = TRY(Parameterss::create()),
             .member_access_data = TRY(MemberAccessData::create()),
             .expressions = TRY(CheckedExpressions::create()),
-
-            TRY(Tokens::create()),
-            TRY(Tokens::create()),
+            .import_c_quoted_filenames = TRY(Tokens::create()),
+            .inline_c_texts = TRY(Tokens::create()),
+            .types = TRY(TypeTable::create()),
+            .declaration_types = TRY(Vector<TypeId>::create()),
+            .bodies = TRY(Vector<CheckedBody>::create()),
+            .locals = TRY(Vector<CheckedVariable>::create()),
         };
         // clang-format on
 #undef X
@@ -510,6 +521,16 @@ public:
 
     Tokens import_c_quoted_filenames;
     Tokens inline_c_texts;
+
+    TypeTable types;
+
+    // NOTE: Type of each of ParsedExpressions::declarations, or
+    //       an invalid id where it is only known to C.
+    Vector<TypeId> declaration_types;
+
+    // NOTE: One per function, in the order they are declared.
+    Vector<CheckedBody> bodies;
+    Vector<CheckedVariable> locals;
 };
 
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include <Ty/Optional.h>
 #include <Ty/StringView.h>
+#include <Ty/View.h>
 
 namespace Util {
 
@@ -9,37 +10,36 @@ struct LineAndColumn {
     u32 column;
 };
 
+// NOTE: `line_starts` is the byte offset of the first character on
+//       each line, as produced by He::lex().
 constexpr Optional<LineAndColumn> line_and_column_for(
-    StringView source, u32 index)
+    StringView source, View<u32 const> line_starts, u32 index)
 {
-    if (index >= source.size)
+    if (index >= source.size || line_starts.size() == 0)
         return {};
 
-    u32 line = 0;
-    u32 column = 0;
-    for (u32 i = 0; i < index; i++) {
-        if (source[i] == '\n') {
-            line++;
-            column = 0;
-        } else {
-            column++;
-        }
+    u32 low = 0;
+    u32 high = line_starts.size();
+    while (high - low > 1) {
+        auto middle = low + (high - low) / 2;
+        if (line_starts[middle] <= index)
+            low = middle;
+        else
+            high = middle;
     }
 
-    return LineAndColumn { line, column };
+    return LineAndColumn { low, index - line_starts[low] };
 }
 
-constexpr StringView fetch_line(StringView source, u32 line_to_find)
+constexpr StringView fetch_line(StringView source,
+    View<u32 const> line_starts, u32 line)
 {
-    u32 line = 0;
-    u32 start = 0;
-    while (start < source.size && line != line_to_find)
-        if (source[start++] == '\n')
-            line++;
-    u32 end = start;
-    while (end < source.size)
-        if (source[end++] == '\n')
-            break;
+    u32 start = source.size;
+    if (line < line_starts.size())
+        start = line_starts[line];
+    u32 end = source.size;
+    if (line + 1 < line_starts.size())
+        end = line_starts[line + 1];
     return source.sub_view(start, end - 1 - start);
 }
 
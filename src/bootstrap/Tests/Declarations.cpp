@@ -0,0 +1,142 @@
+#include "Tests.h"
+#include <He/Lexer.h>
+#include <He/Parser.h>
+#include <Ty/Formatter.h>
+
+namespace Tests {
+
+namespace {
+
+using He::ExpressionType;
+
+constexpr StringView declared = "let limit = 10;\n"
+                                "let Point = struct {\n"
+                                "    x: i32,\n"
+                                "    y: i32,\n"
+                                "};\n"
+                                "let Kind = enum {\n"
+                                "    A,\n"
+                                "    B,\n"
+                                "};\n"
+                                "pub fn area(p: Point) -> i32 {\n"
+                                "    let local = p.x;\n"
+                                "    return local;\n"
+                                "}\n"
+                                "fn area() -> i32 {\n"
+                                "    return limit;\n"
+                                "}\n"
+                                "pub c_fn main() -> c_int {\n"
+                                "    return 0;\n"
+                                "}\n"sv;
+
+// NOTE: Many small functions, so that parse_in_parallel() splits
+//       them across threads, followed by a second `f7`.
+constexpr u32 function_count = 30000;
+
+ErrorOr<Source> many_functions()
+{
+    auto text = TRY(StringBuffer::create_saturated(
+        function_count * 48));
+    for (u32 i = 0; i < function_count; i++) {
+        TRY(text.write("fn f"sv, i, "() -> i32 { return "sv, i,
+            "; }\n"sv));
+    }
+    TRY(text.write("pub fn f7() -> i32 { return 0; }\n"sv));
+    return TRY(Source::create(text.view()));
+}
+
+ErrorOr<He::ParsedExpressions> parsed(He::LexedSource& lexed,
+    u32 threads)
+{
+    auto result = He::parse_in_parallel(lexed.tokens,
+        move(lexed.symbols), He::FunctionBodies::Parse, threads);
+    if (result.is_error())
+        return Error::from_string_literal("could not parse");
+    return result.release_value();
+}
+
+// NOTE: Invalid if nothing is declared as `name`.
+ExpressionType declared_type(
+    He::ParsedExpressions const& expressions, StringView name)
+{
+    auto declaration = expressions.find_declaration(name);
+    if (!declaration.has_value())
+        return ExpressionType::Invalid;
+    return declaration->type();
+}
+
+// NOTE: Where the declaration of `name` is named in the source, or
+//       0 if there is none.
+u32 declared_at(He::ParsedExpressions const& expressions,
+    StringView name)
+{
+    auto declaration = expressions.find_declaration(name);
+    if (!declaration.has_value())
+        return 0;
+    return expressions.declaration_name(declaration.value())
+        .start_index;
+}
+
+}
+
+// NOTE: Every named top level item is found by its name, the first
+//       one if a name is declared twice, and the parallel parser
+//       finds the same ones as the serial one.
+ErrorOr<void> declarations()
+{
+    auto source = TRY(Source::create(declared));
+    auto lexed = TRY(Tests::lexed(He::lex(source.view())));
+    auto tokens = lexed.tokens.view();
+    auto expressions = TRY(parsed(lexed, 1));
+
+    EXPECT(expressions.declarations.size() == 6);
+    EXPECT(declared_type(expressions, "limit"sv)
+        == ExpressionType::PrivateConstantDeclaration);
+    EXPECT(declared_type(expressions, "Point"sv)
+        == ExpressionType::StructDeclaration);
+    EXPECT(declared_type(expressions, "Kind"sv)
+        == ExpressionType::EnumDeclaration);
+    EXPECT(declared_type(expressions, "area"sv)
+        == ExpressionType::PublicFunction);
+    EXPECT(declared_type(expressions, "main"sv)
+        == ExpressionType::PublicCFunction);
+    EXPECT(declared_type(expressions, "local"sv)
+        == ExpressionType::Invalid);
+    EXPECT(declared_type(expressions, "p"sv)
+        == ExpressionType::Invalid);
+    EXPECT(declared_type(expressions, "missing"sv)
+        == ExpressionType::Invalid);
+
+    auto name = expressions.declaration_name(
+        expressions.find_declaration("area"sv).value());
+    auto by_symbol = expressions.find_declaration(name.symbol());
+    EXPECT(by_symbol.has_value());
+    EXPECT(by_symbol->type() == ExpressionType::PublicFunction);
+
+    // NOTE: A declaration spans its `pub` through its last token.
+    auto area = expressions.declaration_tokens(3);
+    EXPECT(tokens[area.start].is(He::TokenType::Pub));
+    EXPECT(tokens[area.end - 1].is(He::TokenType::CloseCurly));
+
+    auto many = TRY(many_functions());
+    auto serial_lexed = TRY(Tests::lexed(He::lex(many.view())));
+    auto serial = TRY(parsed(serial_lexed, 1));
+    auto parallel_lexed = TRY(Tests::lexed(He::lex(many.view())));
+    auto parallel = TRY(parsed(parallel_lexed, 4));
+    EXPECT(serial.declarations.size() == function_count + 1);
+    EXPECT(parallel.declarations.size() == function_count + 1);
+
+    EXPECT(declared_type(serial, "f7"sv)
+        == ExpressionType::PrivateFunction);
+    EXPECT(declared_type(parallel, "f7"sv)
+        == ExpressionType::PrivateFunction);
+    for (u32 i = 0; i < function_count; i += 97) {
+        auto text = TRY(StringBuffer::create_fill("f"sv, i));
+        auto at = declared_at(serial, text.view());
+        EXPECT(at != 0);
+        EXPECT(declared_at(parallel, text.view()) == at);
+    }
+    return {};
+}
+
+}
@@ -0,0 +1,227 @@
+#include "Tests.h"
+#include <He/Context.h>
+#include <He/Evaluate.h>
+#include <He/Lexer.h>
+#include <He/Parser.h>
+#include <Ty/Formatter.h>
+
+namespace Tests {
+
+namespace {
+
+using He::ConstantKind;
+using He::ScalarType;
+
+constexpr StringView arithmetic_source
+    = "let sum = 2 + 3;\n"
+      "let difference = 10 - 25;\n"
+      "let quotient = 7 / 2;\n"
+      "let byte: u8 = 250 + 10;\n"
+      "let wrapped: u32 = 0 - 1;\n"
+      "let wide: i64 = 2147483647;\n"
+      "let wider = wide + 1;\n"
+      "let overflow = 2147483647 + 1;\n"
+      "let wide_overflow = 4611686018427387904 * 2;\n"
+      "let by_zero = 1 / 0;\n"
+      "let narrowed: i8 = 128;\n"sv;
+
+constexpr StringView conversion_source
+    = "let half: f64 = 1 / 2;\n"
+      "let ratio = 1.5 * 2;\n"
+      "let truncated: i32 = 2.75;\n"
+      "let negative: u8 = -1;\n"
+      "let single: f32 = 0.5;\n"
+      "let out_of_range: i8 = 300.5;\n"
+      "let below_zero: u32 = -1.5;\n"sv;
+
+constexpr StringView aggregate_source
+    = "let Kind = enum {\n"
+      "    A,\n"
+      "    B,\n"
+      "    C,\n"
+      "};\n"
+      "let Point = struct {\n"
+      "    x: i32,\n"
+      "    y: u8,\n"
+      "};\n"
+      "let Pair = struct {\n"
+      "    a: u8,\n"
+      "    b: u32,\n"
+      "    c: u16,\n"
+      "};\n"
+      "let third = Kind$C;\n"
+      "let kind: Kind = Kind$B;\n"
+      "let origin = Point {\n"
+      "    .x = 5,\n"
+      "    .y = 300,\n"
+      "};\n"
+      "let origin_x = origin.x + Kind$B;\n"
+      "let origin_y = origin.y;\n"
+      "let pair_size = @size_of(Pair);\n"
+      "let word_size = @size_of(u64);\n"sv;
+
+constexpr StringView cycle_source = "let a: i32 = b + 1;\n"
+                                    "let b: i32 = a;\n"
+                                    "let itself = itself;\n"
+                                    "let twice = twice + twice;\n"
+                                    "let after = b;\n"
+                                    "let fine = 1;\n"sv;
+
+// NOTE: Constants each taking a few steps past the one before.
+constexpr u32 chain_length = 64;
+
+struct Evaluated {
+    Source source;
+    He::ParsedExpressions expressions;
+    He::ConstantValues constants;
+
+    He::ConstantValue value(StringView name) const
+    {
+        auto const& declarations = expressions.declarations;
+        for (u32 i = 0; i < declarations.size(); i++) {
+            auto declared
+                = expressions.declaration_name(declarations[i]);
+            if (declared.text(source.view()) == name)
+                return constants.values[i];
+        }
+        return {};
+    }
+};
+
+ErrorOr<Evaluated> evaluated(StringView text,
+    u32 step_budget = He::default_step_budget)
+{
+    auto source = TRY(Source::create(text));
+    auto lexed = TRY(Tests::lexed(He::lex(source.view())));
+    auto parsed = He::parse(lexed.tokens, move(lexed.symbols));
+    if (parsed.is_error())
+        return Error::from_string_literal("could not parse");
+    auto expressions = parsed.release_value();
+    auto context = He::Context {
+        .source = source.view(),
+        .namespace_ = ""sv,
+        .expressions = expressions,
+        .symbols = expressions.symbols,
+    };
+    auto constants
+        = TRY(He::evaluate_constants(context, step_budget));
+    return Evaluated {
+        .source = move(source),
+        .expressions = move(expressions),
+        .constants = move(constants),
+    };
+}
+
+bool is_integer(He::ConstantValue value, ScalarType type,
+    i64 expected)
+{
+    return value.kind == ConstantKind::Integer && value.type == type
+        && (i64)value.integer == expected;
+}
+
+bool is_float(He::ConstantValue value, ScalarType type,
+    f64 expected)
+{
+    return value.kind == ConstantKind::Float && value.type == type
+        && value.floating == expected;
+}
+
+ErrorOr<StringBuffer> chain()
+{
+    auto text = TRY(StringBuffer::create_saturated(
+        chain_length * 64));
+    TRY(text.writeln("let link_0 = 1;"sv));
+    for (u32 i = 1; i < chain_length; i++) {
+        TRY(text.writeln("let link_"sv, i, " = link_"sv, i - 1,
+            " + 1;"sv));
+    }
+    return text;
+}
+
+}
+
+// NOTE: Constants are folded the way C would compute them, and
+//       anything C leaves to the target, or would refuse, is left
+//       without a value.
+ErrorOr<void> evaluate()
+{
+    auto arithmetic = TRY(evaluated(arithmetic_source));
+    EXPECT(!arithmetic.constants.has_errors());
+    EXPECT(is_integer(arithmetic.value("sum"sv), ScalarType::I32,
+        5));
+    EXPECT(is_integer(arithmetic.value("difference"sv),
+        ScalarType::I32, -15));
+    EXPECT(is_integer(arithmetic.value("quotient"sv),
+        ScalarType::I32, 3));
+    EXPECT(is_integer(arithmetic.value("byte"sv), ScalarType::U8,
+        4));
+    EXPECT(is_integer(arithmetic.value("wrapped"sv),
+        ScalarType::U32, 0xFFFFFFFF));
+    EXPECT(is_integer(arithmetic.value("wider"sv), ScalarType::I64,
+        2147483648));
+    EXPECT(!arithmetic.value("overflow"sv).is_known());
+    EXPECT(!arithmetic.value("wide_overflow"sv).is_known());
+    EXPECT(!arithmetic.value("by_zero"sv).is_known());
+    EXPECT(!arithmetic.value("narrowed"sv).is_known());
+
+    auto conversion = TRY(evaluated(conversion_source));
+    EXPECT(is_float(conversion.value("half"sv), ScalarType::F64,
+        0.0));
+    EXPECT(is_float(conversion.value("ratio"sv), ScalarType::F64,
+        3.0));
+    EXPECT(is_integer(conversion.value("truncated"sv),
+        ScalarType::I32, 2));
+    EXPECT(is_integer(conversion.value("negative"sv),
+        ScalarType::U8, 255));
+    EXPECT(is_float(conversion.value("single"sv), ScalarType::F32,
+        0.5));
+    EXPECT(!conversion.value("out_of_range"sv).is_known());
+    EXPECT(!conversion.value("below_zero"sv).is_known());
+
+    auto aggregate = TRY(evaluated(aggregate_source));
+    EXPECT(is_integer(aggregate.value("third"sv), ScalarType::I32,
+        2));
+    EXPECT(is_integer(aggregate.value("kind"sv), ScalarType::I32,
+        1));
+    auto origin = aggregate.value("origin"sv);
+    EXPECT(origin.kind == ConstantKind::Struct);
+    EXPECT(origin.member_count == 2);
+    EXPECT(is_integer(aggregate.value("origin_x"sv),
+        ScalarType::I32, 6));
+    EXPECT(is_integer(aggregate.value("origin_y"sv), ScalarType::U8,
+        44));
+    EXPECT(is_integer(aggregate.value("pair_size"sv),
+        ScalarType::Usize, 12));
+    EXPECT(is_integer(aggregate.value("word_size"sv),
+        ScalarType::Usize, 8));
+    EXPECT(aggregate.constants.assumes_usize);
+    EXPECT(aggregate.constants.assumed_sizes.size() == 1);
+    EXPECT(aggregate.constants.assumed_sizes[0].size == 12);
+
+    auto text = TRY(chain());
+    auto last = TRY(StringBuffer::create_fill("link_"sv,
+        chain_length - 1));
+    auto whole = TRY(evaluated(text.view()));
+    EXPECT(is_integer(whole.value(last.view()), ScalarType::I32,
+        chain_length));
+    auto budget = whole.constants.steps / 2;
+    auto cut = TRY(evaluated(text.view(), budget));
+    EXPECT(cut.constants.steps == budget);
+    EXPECT(is_integer(cut.value("link_0"sv), ScalarType::I32, 1));
+    EXPECT(!cut.value(last.view()).is_known());
+
+    auto cycle = TRY(evaluated(cycle_source));
+    auto const& cycles = cycle.constants.cycles;
+    EXPECT(cycle.constants.has_errors());
+    EXPECT(cycles.size() == 3);
+    EXPECT(cycles[0].text(cycle.source.view()) == "a"sv);
+    EXPECT(cycles[1].text(cycle.source.view()) == "itself"sv);
+    EXPECT(cycles[2].text(cycle.source.view()) == "twice"sv);
+    EXPECT(!cycle.value("a"sv).is_known());
+    EXPECT(!cycle.value("b"sv).is_known());
+    EXPECT(!cycle.value("after"sv).is_known());
+    EXPECT(is_integer(cycle.value("fine"sv), ScalarType::I32, 1));
+    return {};
+}
+
+}
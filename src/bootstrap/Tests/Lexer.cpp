@@ -0,0 +1,161 @@
+#include "Tests.h"
+#include <He/Lexer.h>
+#include <Ty/Formatter.h>
+
+namespace Tests {
+
+// NOTE: lex_in_parallel() only splits sources of a few chunks of
+//       256 KiB, and splits them at new lines it can not tell are
+//       inside an inline C block, so the sources are that large
+//       and full of those.
+ErrorOr<void> parallel_lex()
+{
+    for (u64 seed = 1; seed <= 4; seed++) {
+        auto source = TRY(random_source(seed, 2304 * 1024));
+        auto expected = TRY(lexed(He::lex(source.view())));
+        EXPECT(!expected.errors.is_empty());
+        for (u32 threads = 2; threads <= 9; threads++) {
+            auto actual = TRY(lexed(He::lex_in_parallel(
+                source.view(), threads)));
+            EXPECT(TRY(is_same_lex(source.view(), expected,
+                actual)));
+        }
+    }
+    return {};
+}
+
+namespace {
+
+// NOTE: Pieces an edit types in, picked to split and join the
+//       tokens around the edit.
+constexpr StringView typed[] = {
+    "t"sv,
+    "&"sv,
+    "mut"sv,
+    " "sv,
+    "\n"sv,
+    "{"sv,
+    "}"sv,
+    ";"sv,
+    "\""sv,
+    "inline_c {"sv,
+    "//"sv,
+    "a1"sv,
+    "`"sv,
+    "@size_of"sv,
+};
+constexpr u32 typed_count = sizeof(typed) / sizeof(typed[0]);
+
+ErrorOr<void> expect_same_relex(Vector<Source>& sources,
+    He::LexedSource& lexed, He::SourceEdit edit, StringView typed)
+{
+    auto const& old_source = sources.last();
+    auto old_text = old_source.view();
+    auto text = TRY(StringBuffer::create_fill(
+        old_text.sub_view(0, edit.start), typed,
+        old_text.sub_view(edit.old_end,
+            old_text.size - edit.old_end)));
+    edit.new_end = edit.start + typed.size;
+    auto source = TRY(Source::create(text.view()));
+    auto relexed = He::relex(lexed, old_text, source.view(), edit);
+    EXPECT(!relexed.is_error());
+    auto expected = TRY(Tests::lexed(He::lex(source.view())));
+    EXPECT(TRY(is_same_lex(source.view(), expected, lexed)));
+    // NOTE: Symbols interned from the old sources point into them.
+    TRY(sources.append(move(source)));
+    return {};
+}
+
+}
+
+// NOTE: Relexing after each edit has to give what lexing the edited
+//       source from scratch gives.
+ErrorOr<void> relex()
+{
+    {
+        auto sources = TRY(Vector<Source>::create());
+        TRY(sources.append(TRY(Source::create("f(&mu x);\n"sv))));
+        auto lexed
+            = TRY(Tests::lexed(He::lex(sources.last().view())));
+        TRY(expect_same_relex(sources, lexed, { 5, 5, 0 }, "t"sv));
+    }
+
+    for (u64 seed = 1; seed <= 8; seed++) {
+        auto sources = TRY(Vector<Source>::create());
+        TRY(sources.append(TRY(random_source(seed, 4096))));
+        auto lexed
+            = TRY(Tests::lexed(He::lex(sources.last().view())));
+        auto random = Random { seed };
+        for (u32 i = 0; i < 500; i++) {
+            auto size = sources.last().size;
+            auto start = random.below(size + 1);
+            auto removed = random.below(8);
+            if (removed > size - start)
+                removed = size - start;
+            auto typed_text = random.below(4) == 0
+                ? ""sv
+                : typed[random.below(typed_count)];
+            auto edit = He::SourceEdit {
+                start,
+                start + removed,
+                0,
+            };
+            TRY(expect_same_relex(sources, lexed, edit,
+                typed_text));
+        }
+    }
+    return {};
+}
+
+namespace {
+
+// NOTE: Reads `text` into `buffer` in pieces as given by `split`,
+//       lexing what has been read after every piece. Symbols point
+//       into `buffer`, so it has to outlive the result.
+template <typename Split>
+ErrorOr<He::LexedSource> lexed_as_stream(StringView text,
+    Source& buffer, Split split)
+{
+    auto data = buffer.buffer.mutable_data();
+    for (u32 i = 0; i < text.size; i++)
+        data[i] = '\0';
+    auto lexer = TRY(He::StreamLexer::create());
+    for (u32 read = 0; read < text.size;) {
+        auto end = split(read);
+        if (end > text.size)
+            end = text.size;
+        for (; read < end; read++)
+            data[read] = text[read];
+        TRY(lexer.lex_available({ data, read }));
+    }
+    return TRY(lexed(lexer.finish(buffer.view())));
+}
+
+}
+
+// NOTE: Lexing a source as it is read has to give what lexing all
+//       of it at once gives, wherever the reads end.
+ErrorOr<void> stream_lex()
+{
+    auto ref_mut = TRY(Source::create("g(&mut v, &mu);\n"sv));
+    auto expected = TRY(lexed(He::lex(ref_mut.view())));
+    for (u32 at = 1; at < ref_mut.size; at++) {
+        auto buffer = TRY(Source::create(ref_mut.view()));
+        auto actual = TRY(lexed_as_stream(ref_mut.view(), buffer,
+            [&](u32 read) { return read < at ? at : read + 1; }));
+        EXPECT(TRY(is_same_lex(ref_mut.view(), expected, actual)));
+    }
+
+    for (u64 seed = 1; seed <= 4; seed++) {
+        auto source = TRY(random_source(seed, 256 * 1024));
+        auto expected = TRY(lexed(He::lex(source.view())));
+        auto buffer = TRY(Source::create(source.view()));
+        auto random = Random { seed };
+        auto actual = TRY(lexed_as_stream(source.view(), buffer,
+            [&](u32 read) { return read + 1 + random.below(64); }));
+        EXPECT(TRY(is_same_lex(source.view(), expected, actual)));
+    }
+    return {};
+}
+
+}
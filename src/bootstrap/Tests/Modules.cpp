@@ -0,0 +1,166 @@
+#include "Tests.h"
+#include <Core/System.h>
+#include <He/Lexer.h>
+#include <He/ModuleGraph.h>
+#include <He/Parser.h>
+#include <Ty/Defer.h>
+
+namespace Tests {
+
+namespace {
+
+struct File {
+    StringView name;
+    StringView text;
+};
+
+constexpr u32 none = He::ModuleGraph::root_module;
+
+// NOTE: Both sides of the diamond import the same file, spelled
+//       differently, and a module importing the root leads back
+//       to it rather than loading it again.
+constexpr File files[] = {
+    { "diamond.he"sv, "@import(\"left.he\");\n"
+                      "@import(\"right.he\");\n"sv },
+    { "left.he"sv, "@import(\"bottom.he\");\n"
+                   "fn left() -> i32 {\n"
+                   "    return 1;\n"
+                   "}\n"sv },
+    { "right.he"sv, "@import(\"./bottom.he\");\n"
+                    "fn right() -> i32 {\n"
+                    "    return 2;\n"
+                    "}\n"sv },
+    { "bottom.he"sv, "fn bottom() -> i32 {\n"
+                     "    return 3;\n"
+                     "}\n"sv },
+    { "cycle.he"sv, "@import(\"first.he\");\n"sv },
+    { "first.he"sv, "@import(\"second.he\");\n"sv },
+    { "second.he"sv, "@import(\"first.he\");\n"
+                     "@import(\"cycle.he\");\n"sv },
+    { "missing.he"sv, "@import(\"nowhere.he\");\n"
+                      "@import(\"gap.he\");\n"sv },
+    { "gap.he"sv, "@import(\"nowhere.he\");\n"
+                  "fn gap() -> i32 {\n"
+                  "    return 4;\n"
+                  "}\n"sv },
+};
+
+ErrorOr<StringBuffer> path_of(StringView directory, StringView name)
+{
+    return TRY(StringBuffer::create_fill(directory, "/"sv, name,
+        "\0"sv));
+}
+
+ErrorOr<void> write_file(StringView directory, File file)
+{
+    auto path = TRY(path_of(directory, file.name));
+    auto fd = TRY(Core::System::open(path.data(),
+        O_WRONLY | O_CREAT | O_TRUNC, 0666));
+    auto write_result = Core::System::write(fd, file.text);
+    TRY(Core::System::close(fd));
+    TRY(write_result);
+    return {};
+}
+
+ErrorOr<He::ModuleGraph> loaded(StringView directory, File root)
+{
+    auto path = TRY(path_of(directory, root.name));
+    auto source = TRY(Source::create(root.text));
+    auto lexed = TRY(Tests::lexed(He::lex(source.view())));
+    auto parsed = He::parse(lexed.tokens, move(lexed.symbols));
+    if (parsed.is_error())
+        return Error::from_string_literal("could not parse");
+    auto expressions = parsed.release_value();
+    auto root_file = He::SourceFile {
+        .file_name = path.view(),
+        .text = source.view(),
+    };
+    auto graph
+        = TRY(He::ModuleGraph::load(root_file, expressions, 4));
+    // NOTE: The root file is not kept past this, only modules are.
+    graph.root = {};
+    return graph;
+}
+
+bool imports_are(Vector<u32> const& imports,
+    View<u32 const> expected)
+{
+    if (imports.size() != expected.size())
+        return false;
+    for (u32 i = 0; i < expected.size(); i++) {
+        if (imports[i] != expected[i])
+            return false;
+    }
+    return true;
+}
+
+bool is_named(He::Module const& module, StringView name)
+{
+    return module.path.view().ends_with(name);
+}
+
+}
+
+// NOTE: Imports load every file once, in the order they are
+//       linked, stop at cycles, and report files that are not
+//       there without failing to load the rest.
+ErrorOr<void> modules()
+{
+    auto directory = TRY(StringBuffer::create_fill(
+        "/tmp/helium-modules-XXXXXX"sv, "\0"sv));
+    TRY(Core::System::mkdtemp(directory.mutable_data()));
+    auto directory_view
+        = StringView::from_c_string(directory.data());
+    Defer remove_directory = [&] {
+        for (auto file : files) {
+            auto path = path_of(directory_view, file.name);
+            if (!path.is_error())
+                Core::System::unlink(path.value().data()).ignore();
+        }
+        Core::System::remove(directory.data()).ignore();
+    };
+    for (auto file : files)
+        TRY(write_file(directory_view, file));
+
+    auto diamond = TRY(loaded(directory_view, files[0]));
+    EXPECT(!diamond.has_errors());
+    EXPECT(diamond.modules.size() == 3);
+    EXPECT(is_named(diamond.modules[0], "/left.he"sv));
+    EXPECT(is_named(diamond.modules[1], "/right.he"sv));
+    EXPECT(is_named(diamond.modules[2], "/bottom.he"sv));
+    u32 const sides[] = { 0, 1 };
+    u32 const bottom[] = { 2 };
+    EXPECT(imports_are(diamond.root_imports, { sides, 2 }));
+    EXPECT(imports_are(diamond.modules[0].imports, { bottom, 1 }));
+    EXPECT(imports_are(diamond.modules[1].imports, { bottom, 1 }));
+    EXPECT(diamond.modules[2].imports.is_empty());
+    for (auto const& module : diamond.modules)
+        EXPECT(module.expressions.has_value());
+
+    auto cycle = TRY(loaded(directory_view, files[4]));
+    EXPECT(!cycle.has_errors());
+    EXPECT(cycle.modules.size() == 2);
+    EXPECT(is_named(cycle.modules[0], "/first.he"sv));
+    EXPECT(is_named(cycle.modules[1], "/second.he"sv));
+    u32 const first[] = { 0 };
+    u32 const second[] = { 1 };
+    u32 const back[] = { 0, none };
+    EXPECT(imports_are(cycle.root_imports, { first, 1 }));
+    EXPECT(imports_are(cycle.modules[0].imports, { second, 1 }));
+    EXPECT(imports_are(cycle.modules[1].imports, { back, 2 }));
+
+    auto missing = TRY(loaded(directory_view, files[7]));
+    EXPECT(missing.has_errors());
+    EXPECT(missing.root_import_errors.size() == 1);
+    EXPECT(missing.modules.size() == 1);
+    EXPECT(is_named(missing.modules[0], "/gap.he"sv));
+    u32 const gap[] = { none, 0 };
+    u32 const nowhere[] = { none };
+    EXPECT(imports_are(missing.root_imports, { gap, 2 }));
+    EXPECT(imports_are(missing.modules[0].imports, { nowhere, 1 }));
+    EXPECT(missing.modules[0].import_errors.size() == 1);
+    EXPECT(missing.modules[0].expressions.has_value());
+    return {};
+}
+
+}
@@ -0,0 +1,155 @@
+#include "Tests.h"
+#include <Core/MappedFile.h>
+#include <Core/System.h>
+#include <He/Codegen.h>
+#include <He/Context.h>
+#include <He/ParseCache.h>
+#include <He/Parser.h>
+#include <He/Typecheck.h>
+#include <Ty/Defer.h>
+
+namespace Tests {
+
+namespace {
+
+constexpr StringView cached = "let Point = struct {\n"
+                              "    x: i32,\n"
+                              "    y: i32,\n"
+                              "};\n"
+                              "let Kind = enum {\n"
+                              "    A,\n"
+                              "    B,\n"
+                              "};\n"
+                              "fn leaf(a: i32) -> i32 {\n"
+                              "    let x = a + 1;\n"
+                              "    return x;\n"
+                              "}\n"
+                              "pub c_fn main() -> c_int {\n"
+                              "    return 0;\n"
+                              "}\n"sv;
+
+constexpr StringView edited = "fn leaf(a: i32) -> i32 {\n"
+                              "    return a;\n"
+                              "}\n"sv;
+
+// NOTE: Where within a cache file truncating it is tried, in
+//       parts of its size.
+constexpr u32 truncation_steps = 64;
+
+ErrorOr<StringBuffer> generated(StringView source,
+    He::LexedSource const& lexed,
+    He::ParsedExpressions const& expressions)
+{
+    auto context = He::Context {
+        .source = source,
+        .namespace_ = ""sv,
+        .expressions = expressions,
+        .symbols = expressions.symbols,
+        .tokens = lexed.tokens.view(),
+    };
+    auto result = He::typecheck(context);
+    if (result.is_error())
+        return Error::from_string_literal("could not typecheck");
+    auto typechecked = result.release_value();
+    return TRY(He::codegen(context, typechecked));
+}
+
+ErrorOr<StringBuffer> copy_of(StringView text)
+{
+    auto copy = TRY(StringBuffer::create_saturated(text.size + 1));
+    TRY(copy.write(text));
+    return copy;
+}
+
+ErrorOr<void> write_file(StringView path, StringView contents)
+{
+    auto path_buffer
+        = TRY(StringBuffer::create_fill(path, "\0"sv));
+    auto fd = TRY(Core::System::open(path_buffer.data(),
+        O_WRONLY | O_CREAT | O_TRUNC, 0666));
+    auto write_result = Core::System::write(fd, contents);
+    TRY(Core::System::close(fd));
+    TRY(write_result);
+    return {};
+}
+
+}
+
+// NOTE: What comes out of the cache generates the same code as a
+//       fresh parse, and a cache file that is cut short or broken
+//       is refused rather than read.
+ErrorOr<void> parse_cache()
+{
+    auto directory = TRY(StringBuffer::create_fill(
+        "/tmp/helium-parse-cache-XXXXXX"sv, "\0"sv));
+    TRY(Core::System::mkdtemp(directory.mutable_data()));
+    auto directory_view
+        = StringView::from_c_string(directory.data());
+    auto path
+        = TRY(He::cached_parse_path(directory_view, cached));
+    auto path_buffer = TRY(StringBuffer::create_fill(path.view(),
+        "\0"sv));
+    Defer remove_directory = [&] {
+        Core::System::unlink(path_buffer.data()).ignore();
+        Core::System::remove(directory.data()).ignore();
+    };
+
+    auto source = TRY(Source::create(cached));
+    EXPECT(He::load_cached_parse(directory_view, source.view())
+               .is_error());
+    auto lexed = TRY(Tests::lexed(He::lex(source.view())));
+    auto parsed = He::parse(lexed.tokens, move(lexed.symbols));
+    if (parsed.is_error())
+        return Error::from_string_literal("could not parse");
+    auto expressions = parsed.release_value();
+    auto fresh = TRY(generated(source.view(), lexed, expressions));
+    TRY(He::store_cached_parse(directory_view, source.view(),
+        lexed, expressions));
+
+    auto load = [&]() -> ErrorOr<StringBuffer> {
+        auto loaded = TRY(He::load_cached_parse(directory_view,
+            source.view()));
+        EXPECT(loaded.lexed.tokens.size() == lexed.tokens.size());
+        EXPECT(loaded.lexed.line_starts.size()
+            == lexed.line_starts.size());
+        return TRY(generated(source.view(), loaded.lexed,
+            loaded.expressions));
+    };
+    EXPECT(TRY(load()).view() == fresh.view());
+
+    auto other = TRY(Source::create(edited));
+    EXPECT(He::load_cached_parse(directory_view, other.view())
+               .is_error());
+
+    auto intact = TRY(copy_of(
+        TRY(Core::MappedFile::open(path.view())).view()));
+    auto whole = intact.view();
+
+    for (u32 step = 0; step < truncation_steps; step++) {
+        auto size = (u64)whole.size * step / truncation_steps;
+        TRY(write_file(path.view(), whole.sub_view(0, (u32)size)));
+        EXPECT(load().is_error());
+    }
+    auto last = whole.sub_view(0, whole.size - 1);
+    TRY(write_file(path.view(), last));
+    EXPECT(load().is_error());
+
+    // NOTE: Sections pointing past the end of the file, the table
+    //       of them following the 32 byte header, and a header
+    //       from another kind of file.
+    auto out_of_bounds = TRY(copy_of(whole));
+    for (u32 i = 32; i < whole.size; i++)
+        out_of_bounds.mutable_data()[i] = (char)0xFF;
+    TRY(write_file(path.view(), out_of_bounds.view()));
+    EXPECT(load().is_error());
+    auto foreign = TRY(copy_of(whole));
+    foreign.mutable_data()[0] ^= 1;
+    TRY(write_file(path.view(), foreign.view()));
+    EXPECT(load().is_error());
+
+    TRY(write_file(path.view(), whole));
+    EXPECT(TRY(load()).view() == fresh.view());
+    return {};
+}
+
+}
@@ -0,0 +1,305 @@
+#include "Tests.h"
+#include <Benchmark/Generator.h>
+#include <Core/File.h>
+#include <Core/MappedFile.h>
+#include <Core/System.h>
+#include <He/Codegen.h>
+#include <He/Context.h>
+#include <He/Lexer.h>
+#include <He/Parser.h>
+#include <He/Typecheck.h>
+#include <Ty/Defer.h>
+
+namespace Tests {
+
+namespace {
+
+// NOTE: Parse errors of `text` that are shown to the user, the
+//       ones caused by lex errors are left out.
+ErrorOr<u32> shown_parse_errors(StringView text)
+{
+    auto source = TRY(Source::create(text));
+    auto lexed = TRY(Tests::lexed(He::lex(source.view())));
+    auto parsed = He::parse(lexed.tokens, move(lexed.symbols),
+        He::FunctionBodies::Parse);
+    if (!parsed.is_error())
+        return 0;
+    u32 shown = 0;
+    for (auto const& error : parsed.error().parse_errors) {
+        auto token = error.m_offending_token;
+        if (token.is(He::TokenType::Invalid))
+            continue;
+        if (error.m_follows_invalid_token)
+            continue;
+        shown++;
+    }
+    return shown;
+}
+
+ErrorOr<bool> has_parse_errors(StringView text)
+{
+    auto source = TRY(Source::create(text));
+    auto lexed = TRY(Tests::lexed(He::lex(source.view())));
+    auto parsed = He::parse(lexed.tokens, move(lexed.symbols),
+        He::FunctionBodies::Parse);
+    return parsed.is_error();
+}
+
+}
+
+ErrorOr<void> parse_errors()
+{
+    auto invalid_constant = "let a = 1 ` 2;\n"
+                            "fn g() -> i32 {\n"
+                            "    return 2;\n"
+                            "}\n"sv;
+    EXPECT(TRY(has_parse_errors(invalid_constant)));
+    EXPECT(TRY(shown_parse_errors(invalid_constant)) == 0);
+
+    auto invalid_statement = "fn f() -> i32 {\n"
+                             "    let b = 1 ` 2;\n"
+                             "    return b;\n"
+                             "}\n"
+                             "fn h( -> i32 { return 1; }\n"sv;
+    EXPECT(TRY(shown_parse_errors(invalid_statement)) == 1);
+
+    // NOTE: A statement that reported an error resumes past its
+    //       ';', so the next statement is parsed as usual.
+    auto missing_value = "fn f() -> i32 {\n"
+                         "    return 1 +;\n"
+                         "}\n"
+                         "fn g() -> i32 {\n"
+                         "    return 2;\n"
+                         "}\n"sv;
+    EXPECT(TRY(shown_parse_errors(missing_value)) == 1);
+
+    auto missing_values = "fn f() -> i32 {\n"
+                          "    return 1 +;\n"
+                          "    g(1 +);\n"
+                          "    throw 2 *;\n"
+                          "    x = 1;\n"
+                          "    return 3;\n"
+                          "}\n"sv;
+    EXPECT(TRY(shown_parse_errors(missing_values)) == 3);
+    return {};
+}
+
+namespace {
+
+// NOTE: Several times what parse_in_parallel() gives a shard.
+constexpr u32 generated_size = 2 * 1024 * 1024;
+
+constexpr Benchmark::SourceShape shapes[] = {
+#define X(T, ...) Benchmark::SourceShape::T,
+    SOURCE_SHAPES
+#undef X
+};
+
+// NOTE: What dump() writes to stderr, caught in a file.
+ErrorOr<StringBuffer> dumped(
+    He::ParsedExpressions const& expressions, StringView source)
+{
+    auto path = TRY(StringBuffer::create_fill(
+        "/tmp/helium-dump-XXXXXX"sv, "\0"sv));
+    auto fd = TRY(Core::System::mkstemps(path.mutable_data()));
+    Defer remove_file = [&] {
+        Core::System::unlink(path.data()).ignore();
+    };
+    auto& out = Core::File::stderr();
+    TRY(out.flush());
+    out = Core::File::from(fd, false);
+    expressions.dump(source);
+    auto flushed = out.flush();
+    out = Core::File::from(STDERR_FILENO, false);
+    TRY(Core::System::close(fd));
+    TRY(flushed);
+
+    auto file = TRY(Core::MappedFile::open(path.data()));
+    auto text = TRY(StringBuffer::create_saturated(
+        file.view().size + 1));
+    TRY(text.write(file.view()));
+    return text;
+}
+
+using Codegen = ErrorOr<StringBuffer> (*)(He::Context const&,
+    He::TypecheckedExpressions const&);
+
+ErrorOr<StringBuffer> generated(StringView source,
+    He::ParsedExpressions const& expressions,
+    Codegen codegen = He::codegen)
+{
+    auto context = He::Context {
+        .source = source,
+        .namespace_ = ""sv,
+        .expressions = expressions,
+        .symbols = expressions.symbols,
+    };
+    auto result = He::typecheck(context);
+    if (result.is_error())
+        return Error::from_string_literal("could not typecheck");
+    auto typechecked = result.release_value();
+    return TRY(codegen(context, typechecked));
+}
+
+ErrorOr<He::ParsedExpressions> parsed(He::LexedSource& lexed,
+    u32 threads,
+    He::FunctionBodies function_bodies = He::FunctionBodies::Parse)
+{
+    auto result = He::parse_in_parallel(lexed.tokens,
+        move(lexed.symbols), function_bodies, threads);
+    if (result.is_error())
+        return Error::from_string_literal("could not parse");
+    return result.release_value();
+}
+
+// NOTE: What went wrong and where, an error a line, so that the
+//       errors of two parses compare as text.
+ErrorOr<StringBuffer> listed(He::ParseErrors const& errors)
+{
+    auto text = TRY(StringBuffer::create_saturated(4096));
+    for (auto const& error : errors.parse_errors) {
+        auto follows = error.m_follows_invalid_token
+            ? " after an invalid token"sv
+            : ""sv;
+        TRY(text.writeln(error.message(), " at "sv,
+            error.m_offending_token.start_index, follows));
+    }
+    return text;
+}
+
+// NOTE: Bodies that are skipped over fine, but do not parse.
+constexpr StringView broken_bodies[] = {
+    "fn f() -> i32 {\n"
+    "    return g(1));\n"
+    "}\n"
+    "pub fn g(a: i32) -> i32 {\n"
+    "    return a;\n"
+    "}\n"sv,
+    "fn f() -> i32 {\n"
+    "    return g(1;\n"
+    "}\n"
+    "pub fn g(a: i32) -> i32 {\n"
+    "    return a;\n"
+    "}\n"sv,
+    "fn f() -> i32 {\n"
+    "    return 1 +;\n"
+    "}\n"
+    "fn h() -> i32 {\n"
+    "    let x = [1, 2;\n"
+    "    return x;\n"
+    "}\n"sv,
+};
+
+// NOTE: A body that is never closed cannot be skipped either.
+constexpr StringView unclosed_body = "fn f() -> i32 {\n"
+                                     "    if 1 {\n"
+                                     "        return 1;\n"
+                                     "}\n"
+                                     "pub fn g(a: i32) -> i32 {\n"
+                                     "    return a;\n"
+                                     "}\n"sv;
+
+// NOTE: Errors parsing `source` with every body, or with none of
+//       them and then parsing the skipped ones.
+ErrorOr<StringBuffer> parse_errors_of(StringView source,
+    He::FunctionBodies function_bodies)
+{
+    auto lexed = TRY(Tests::lexed(He::lex(source)));
+    auto result = He::parse(lexed.tokens, move(lexed.symbols),
+        function_bodies);
+    if (result.is_error())
+        return TRY(listed(result.error()));
+    auto expressions = result.release_value();
+    auto lazy_result = He::parse_lazy_bodies(expressions,
+        lexed.tokens);
+    if (lazy_result.is_error())
+        return TRY(listed(lazy_result.error()));
+    return StringBuffer::create();
+}
+
+}
+
+// NOTE: Splitting a source across threads gives what parsing it
+//       whole gives, down to the dumped expressions and the
+//       generated code.
+ErrorOr<void> parallel_parse()
+{
+    for (auto shape : shapes) {
+        auto text = TRY(Benchmark::generate_source(shape,
+            generated_size, 1));
+        auto source = TRY(Source::create(text.view()));
+        auto serial_lexed
+            = TRY(Tests::lexed(He::lex(source.view())));
+        auto serial = TRY(parsed(serial_lexed, 1));
+        auto expected_dump = TRY(dumped(serial, source.view()));
+        auto expected_code = TRY(generated(source.view(), serial));
+        for (u32 threads = 2; threads <= 8; threads *= 2) {
+            auto lexed = TRY(Tests::lexed(He::lex(source.view())));
+            auto parallel = TRY(parsed(lexed, threads));
+            auto dump = TRY(dumped(parallel, source.view()));
+            EXPECT(dump.view() == expected_dump.view());
+            auto code = TRY(generated(source.view(), parallel));
+            EXPECT(code.view() == expected_code.view());
+        }
+    }
+    return {};
+}
+
+// NOTE: Skipping function bodies gives the header a full parse
+//       gives, and parsing the skipped bodies later gives its code
+//       and its errors.
+ErrorOr<void> lazy_bodies()
+{
+    for (auto shape : shapes) {
+        auto text = TRY(Benchmark::generate_source(shape,
+            generated_size, 1));
+        auto source = TRY(Source::create(text.view()));
+        auto full_lexed = TRY(Tests::lexed(He::lex(source.view())));
+        auto full = TRY(parsed(full_lexed, 1));
+        auto expected_header = TRY(generated(source.view(), full,
+            He::codegen_header));
+        auto expected_code = TRY(generated(source.view(), full));
+        for (u32 threads = 1; threads <= 4; threads *= 4) {
+            auto lexed = TRY(Tests::lexed(He::lex(source.view())));
+            auto skipped = TRY(parsed(lexed, threads,
+                He::FunctionBodies::Skip));
+            EXPECT(!skipped.lazy_bodies.is_empty());
+            auto header = TRY(generated(source.view(), skipped,
+                He::codegen_header));
+            EXPECT(header.view() == expected_header.view());
+            if (He::parse_lazy_bodies(skipped, lexed.tokens)
+                    .is_error()) {
+                return Error::from_string_literal(
+                    "could not parse skipped bodies");
+            }
+            EXPECT(skipped.lazy_bodies.is_empty());
+            auto code = TRY(generated(source.view(), skipped));
+            EXPECT(code.view() == expected_code.view());
+        }
+    }
+
+    for (auto text : broken_bodies) {
+        auto source = TRY(Source::create(text));
+        auto lexed = TRY(Tests::lexed(He::lex(source.view())));
+        auto skipped = He::parse(lexed.tokens, move(lexed.symbols),
+            He::FunctionBodies::Skip);
+        EXPECT(!skipped.is_error());
+        auto expected = TRY(parse_errors_of(source.view(),
+            He::FunctionBodies::Parse));
+        EXPECT(!expected.view().is_empty());
+        auto actual = TRY(parse_errors_of(source.view(),
+            He::FunctionBodies::Skip));
+        EXPECT(actual.view() == expected.view());
+    }
+
+    auto unclosed = TRY(Source::create(unclosed_body));
+    auto expected = TRY(parse_errors_of(unclosed.view(),
+        He::FunctionBodies::Parse));
+    EXPECT(!expected.view().is_empty());
+    auto actual = TRY(parse_errors_of(unclosed.view(),
+        He::FunctionBodies::Skip));
+    EXPECT(actual.view() == expected.view());
+    return {};
+}
+
+}
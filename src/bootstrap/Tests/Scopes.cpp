@@ -0,0 +1,107 @@
+#include "Tests.h"
+#include <He/ScopeTable.h>
+
+namespace Tests {
+
+namespace {
+
+using He::Binding;
+using He::SymbolId;
+using He::TypeId;
+
+constexpr u32 global_count = 100 * 1000;
+constexpr u32 nesting = 1000;
+
+// NOTE: Bindings are told apart by the type they carry.
+Binding binding(u32 tag)
+{
+    return Binding {
+        .declaration = He::Expression::garbage(0),
+        .type = TypeId(tag),
+    };
+}
+
+bool is_bound(He::ScopeTable const& scopes, SymbolId name, u32 tag,
+    u32 depth)
+{
+    auto found = scopes.find(name);
+    if (!found.has_value() || found->type != TypeId(tag))
+        return false;
+    auto found_depth = scopes.find_depth(name);
+    return found_depth.has_value() && found_depth.value() == depth;
+}
+
+}
+
+// NOTE: A name resolves to its innermost binding, and leaving a
+//       scope brings back exactly what its bindings shadowed, also
+//       after the table has grown.
+ErrorOr<void> scopes()
+{
+    auto scopes = TRY(He::ScopeTable::create());
+    auto a = SymbolId(0);
+    auto b = SymbolId(1);
+
+    EXPECT(TRY(scopes.declare(a, binding(1))));
+    EXPECT(!TRY(scopes.declare(a, binding(2))));
+    EXPECT(is_bound(scopes, a, 1, 0));
+    EXPECT(!scopes.find(b).has_value());
+
+    TRY(scopes.enter_scope());
+    EXPECT(TRY(scopes.declare(a, binding(2))));
+    EXPECT(TRY(scopes.declare(b, binding(3))));
+    TRY(scopes.enter_scope());
+    EXPECT(is_bound(scopes, a, 2, 1));
+    EXPECT(is_bound(scopes, b, 3, 1));
+    scopes.exit_scope();
+    scopes.exit_scope();
+    EXPECT(scopes.depth() == 0);
+    EXPECT(is_bound(scopes, a, 1, 0));
+    EXPECT(!scopes.find(b).has_value());
+    EXPECT(!scopes.find_depth(b).has_value());
+
+    // NOTE: Every scope shadows one of a few names and binds one of
+    //       its own.
+    for (u32 depth = 1; depth <= nesting; depth++) {
+        TRY(scopes.enter_scope());
+        EXPECT(TRY(scopes.declare(SymbolId(depth % 7),
+            binding(depth))));
+        EXPECT(TRY(scopes.declare(SymbolId(100 + depth),
+            binding(depth))));
+    }
+    for (u32 depth = nesting; depth > 0; depth--) {
+        EXPECT(scopes.depth() == depth);
+        for (u32 name = 0; name < 7; name++) {
+            auto distance = (depth + 7 - name) % 7;
+            if (distance < depth) {
+                EXPECT(is_bound(scopes, SymbolId(name),
+                    depth - distance, depth - distance));
+            }
+        }
+        EXPECT(is_bound(scopes, SymbolId(100 + depth), depth,
+            depth));
+        scopes.exit_scope();
+        EXPECT(!scopes.find(SymbolId(100 + depth)).has_value());
+    }
+    EXPECT(is_bound(scopes, a, 1, 0));
+    EXPECT(scopes.bindings.size() == 1);
+
+    auto globals = TRY(He::ScopeTable::create());
+    for (u32 i = 0; i < global_count; i++)
+        EXPECT(TRY(globals.declare(SymbolId(i), binding(i))));
+    TRY(globals.enter_scope());
+    for (u32 i = 0; i < global_count; i += 10)
+        EXPECT(TRY(globals.declare(SymbolId(i), binding(i + 1))));
+    for (u32 i = 0; i < global_count; i++) {
+        auto shadowed = i % 10 == 0;
+        EXPECT(is_bound(globals, SymbolId(i), i + shadowed,
+            shadowed));
+    }
+    globals.exit_scope();
+    for (u32 i = 0; i < global_count; i++)
+        EXPECT(is_bound(globals, SymbolId(i), i, 0));
+    EXPECT(!globals.find(SymbolId(global_count)).has_value());
+    return {};
+}
+
+}
@@ -0,0 +1,185 @@
+#include "Tests.h"
+#include <Core/File.h>
+
+namespace Tests {
+
+namespace {
+
+// NOTE: The lexer looks at most this far past the token it is on.
+constexpr u32 padding = 64;
+
+constexpr StringView pieces[] = {
+    "let a = 1 + 2 * (3 - 4);\n"sv,
+    "pub fn f(x: i32, y: &mut u8) -> i32 {\n    return x;\n}\n"sv,
+    "// comment with \"quote\", &mut and inline_c {\n"sv,
+    "let s = \"text // not a comment {\";\n"sv,
+    "inline_c {\nstatic int f(void) {\n    return 1;\n}\n}\n"sv,
+    "inline_c {\n// }\n\"}\"\n{ { } }\n}\n"sv,
+    "inline_c {\nint a;\ninline_c}\n"sv,
+    "inline_c {\n\"\n}\n\"\n}\n"sv,
+    "inline_c int x = 0;\n"sv,
+    "@import_c(\"stdio.h\");\n"sv,
+    "let n = @size_of(Foo);\n"sv,
+    "g(&mut v, &w, &mu, &mutable, &mut\tx);\n"sv,
+    "let bad = 1 ` 2;\n"sv,
+    "@nope(1);\n"sv,
+    "let c = 'c';\n"sv,
+    "}\n"sv,
+    "\t\t\n\n"sv,
+    "let x = 0777 + 1.5;\n"sv,
+    "let p = a->b.c[1];\n"sv,
+    "while x <= 10 { x = x + 1; }\n"sv,
+    "&"sv,
+    "&mut "sv,
+    "inline_c"sv,
+    " "sv,
+};
+constexpr u32 piece_count = sizeof(pieces) / sizeof(pieces[0]);
+
+ErrorOr<void> show_token(StringView source, He::Token token)
+{
+    auto text = token.text(source);
+    TRY(Core::File::stderr().write(
+        He::token_type_string(token.type), " at "sv,
+        token.start_index, " '"sv, text == "\n"sv ? "\\n"sv : text,
+        "'"sv));
+    return {};
+}
+
+ErrorOr<bool> is_same_token(StringView source, u32 index,
+    He::LexedSource const& expected, He::LexedSource const& actual)
+{
+    auto a = expected.tokens[index];
+    auto b = actual.tokens[index];
+    auto same = a.type == b.type && a.start_index == b.start_index
+        && a.size(source) == b.size(source);
+    if (same && a.is(He::TokenType::Identifier)) {
+        same = expected.symbols.text(a.symbol())
+            == actual.symbols.text(b.symbol());
+    }
+    if (same && (a.is_opening() || a.is_closing())) {
+        same = He::partner_of(expected.tokens.view(), index)
+            == He::partner_of(actual.tokens.view(), index);
+    }
+    if (same)
+        return true;
+
+    auto& out = Core::File::stderr();
+    TRY(out.write("token "sv, index, ": expected "sv));
+    TRY(show_token(source, a));
+    TRY(out.write(", got "sv));
+    TRY(show_token(source, b));
+    TRY(out.write("\n"sv));
+    TRY(out.flush());
+    return false;
+}
+
+}
+
+ErrorOr<Source> Source::create(StringView text)
+{
+    auto buffer = TRY(StringBuffer::create_saturated(
+        text.size + padding));
+    TRY(buffer.write(text));
+    for (u32 i = 0; i < padding; i++)
+        buffer.mutable_data()[text.size + i] = '\0';
+    return Source {
+        .buffer = move(buffer),
+        .size = text.size,
+    };
+}
+
+u32 Random::next()
+{
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return (u32)((state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+ErrorOr<Source> random_source(u64 seed, u32 size)
+{
+    auto text = TRY(StringBuffer::create_saturated(size + 1024));
+    auto random = Random { seed * 2 + 1 };
+    while (text.size() < size) {
+        auto piece = pieces[random.below(piece_count)];
+        TRY(text.write(piece));
+        // NOTE: Long lines move where the parallel lexer splits
+        //       the source.
+        auto spaces = random.below(64) == 0 ? random.below(512) : 0;
+        for (u32 i = 0; i < spaces; i++)
+            TRY(text.write(" "sv));
+    }
+    return TRY(Source::create(text.view()));
+}
+
+ErrorOr<He::LexedSource> lexed(He::LexResult&& result)
+{
+    if (result.is_error()) {
+        TRY(Core::File::stderr().writeln("could not lex: "sv,
+            result.error().message));
+        return Error::from_string_literal("could not lex");
+    }
+    return result.release_value();
+}
+
+ErrorOr<bool> is_same_lex(StringView source,
+    He::LexedSource const& expected, He::LexedSource const& actual)
+{
+    auto& out = Core::File::stderr();
+    auto tokens = expected.tokens.size();
+    if (actual.tokens.size() < tokens)
+        tokens = actual.tokens.size();
+    for (u32 i = 0; i < tokens; i++) {
+        if (!TRY(is_same_token(source, i, expected, actual)))
+            return false;
+    }
+    if (expected.tokens.size() != actual.tokens.size()) {
+        TRY(out.writeln("expected "sv, expected.tokens.size(),
+            " tokens, got "sv, actual.tokens.size()));
+        return false;
+    }
+
+    auto const& expected_lines = expected.line_starts;
+    auto const& actual_lines = actual.line_starts;
+    auto same_lines = expected_lines.size() == actual_lines.size();
+    for (u32 i = 0; same_lines && i < expected_lines.size(); i++)
+        same_lines = expected_lines[i] == actual_lines[i];
+    if (!same_lines) {
+        TRY(out.writeln("line starts differ"sv));
+        return false;
+    }
+
+    auto const& expected_blocks = expected.inline_c_blocks;
+    auto const& actual_blocks = actual.inline_c_blocks;
+    auto same_blocks
+        = expected_blocks.size() == actual_blocks.size();
+    for (u32 i = 0; same_blocks && i < expected_blocks.size(); i++)
+        same_blocks = expected_blocks[i] == actual_blocks[i];
+    if (!same_blocks) {
+        TRY(out.writeln("inline C blocks differ"sv));
+        return false;
+    }
+
+    auto const& expected_errors = expected.errors.errors;
+    auto const& actual_errors = actual.errors.errors;
+    if (expected_errors.size() != actual_errors.size()) {
+        TRY(out.writeln("expected "sv, expected_errors.size(),
+            " lex errors, got "sv, actual_errors.size()));
+        return false;
+    }
+    for (u32 i = 0; i < expected_errors.size(); i++) {
+        auto a = expected_errors[i];
+        auto b = actual_errors[i];
+        if (a.message == b.message
+            && a.source_index == b.source_index)
+            continue;
+        TRY(out.writeln("lex error "sv, i, ": expected '"sv,
+            a.message, "' at "sv, a.source_index, ", got '"sv,
+            b.message, "' at "sv, b.source_index));
+        return false;
+    }
+    return true;
+}
+
+}
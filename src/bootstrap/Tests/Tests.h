@@ -0,0 +1,74 @@
+#pragma once
+#include <He/Lexer.h>
+#include <Ty/ErrorOr.h>
+#include <Ty/StringBuffer.h>
+#include <Ty/StringView.h>
+
+namespace Tests {
+
+// NOTE: Every suite is a meson test of its own, see meson.build.
+#define TEST_SUITES                             \
+    X(parallel_lex, "parallel-lex")             \
+    X(relex, "relex")                           \
+    X(stream_lex, "stream-lex")                 \
+    X(large_sources, "large-sources")           \
+    X(parse_errors, "parse-errors")             \
+    X(parallel_parse, "parallel-parse")         \
+    X(lazy_bodies, "lazy-bodies")               \
+    X(declarations, "declarations")             \
+    X(types, "types")                           \
+    X(scopes, "scopes")                         \
+    X(parallel_typecheck, "parallel-typecheck") \
+    X(typecheck_cache, "typecheck-cache")       \
+    X(parse_cache, "parse-cache")               \
+    X(modules, "modules")                       \
+    X(evaluate, "evaluate")
+
+#define X(function, name) ErrorOr<void> function();
+TEST_SUITES
+#undef X
+
+// NOTE: Fails the running suite, naming the condition and where
+//       it was checked.
+#define EXPECT(condition)                      \
+    ({                                         \
+        if (!(condition)) [[unlikely]] {       \
+            return Error::from_string_literal( \
+                "expected " #condition);       \
+        }                                      \
+    })
+
+// NOTE: Copy of `text` followed by the zero bytes the lexer may
+//       read past the end of a source.
+struct Source {
+    static ErrorOr<Source> create(StringView text);
+
+    StringView view() const { return { buffer.data(), size }; }
+
+    StringBuffer buffer;
+    u32 size;
+};
+
+// NOTE: Same numbers on every machine for the same seed.
+struct Random {
+    u64 state;
+
+    u32 next();
+    u32 below(u32 limit) { return next() % limit; }
+};
+
+// NOTE: Pastes the pieces of source together that the lexer has
+//       gotten wrong before: inline C blocks over several lines,
+//       `&mut` next to other tokens, builtins, comments and
+//       strings holding other tokens, and lex errors.
+ErrorOr<Source> random_source(u64 seed, u32 size);
+
+ErrorOr<He::LexedSource> lexed(He::LexResult&& result);
+
+// NOTE: Tokens, symbols, line starts and errors of `actual` have to
+//       be those of `expected`, both lexed from `source`. Prints
+//       the first difference.
+ErrorOr<bool> is_same_lex(StringView source,
+    He::LexedSource const& expected, He::LexedSource const& actual);
+
+}
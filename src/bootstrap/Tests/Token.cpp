@@ -0,0 +1,97 @@
+#include "Tests.h"
+#include <He/Lexer.h>
+#include <He/Parser.h>
+#include <He/Util.h>
+
+namespace Tests {
+
+namespace {
+
+constexpr u32 mib = 1024 * 1024;
+
+// NOTE: Larger than any size or partner distance a token has room
+//       for, see He::Token.
+constexpr u32 wide_size = 17 * mib;
+constexpr u32 wide_body_statements = 4400 * 1000;
+
+ErrorOr<void> write_repeated(StringBuffer& text, StringView piece,
+    u32 times)
+{
+    for (u32 i = 0; i < times; i++)
+        TRY(text.write(piece));
+    return {};
+}
+
+ErrorOr<Source> large_source()
+{
+    auto text = TRY(StringBuffer::create_saturated(72 * mib));
+    TRY(text.write("inline_c {\n"sv));
+    TRY(write_repeated(text, "int a;\n"sv, wide_size / 7));
+    TRY(text.write("};\nlet s = \""sv));
+    TRY(write_repeated(text, "x"sv, wide_size));
+    TRY(text.write("\";\nfn big() -> i32 {\n"sv));
+    TRY(write_repeated(text, "a=a;\n"sv, wide_body_statements));
+    TRY(text.write("}\n"sv));
+    while (text.size() < 64 * mib)
+        TRY(text.write("fn f() -> i32 { return 1; }\n"sv));
+    TRY(text.write("fn g( -> i32 { return 1; }\n"sv));
+    return TRY(Source::create(text.view()));
+}
+
+Optional<u32> find_first(View<He::Token const> tokens,
+    He::TokenType type)
+{
+    for (u32 i = 0; i < tokens.size(); i++) {
+        if (tokens[i].is(type))
+            return i;
+    }
+    return {};
+}
+
+}
+
+// NOTE: Sizes and partner distances too large for a token are found
+//       again from the source, the rest of the compiler should not
+//       be able to tell.
+ErrorOr<void> large_sources()
+{
+    auto source = TRY(large_source());
+    auto text = source.view();
+    auto lexed = TRY(Tests::lexed(He::lex(text)));
+    EXPECT(lexed.errors.is_empty());
+    auto tokens = lexed.tokens.view();
+
+    EXPECT(lexed.inline_c_blocks.size() == 1);
+    auto block = lexed.inline_c_blocks[0];
+    EXPECT(tokens[block].size(text) == wide_size / 7 * 7 + 1);
+    EXPECT(He::partner_of(tokens, block) == block + 1);
+    EXPECT(He::partner_of(tokens, block + 1) == block);
+
+    auto string = find_first(tokens, He::TokenType::Quoted);
+    EXPECT(string.has_value());
+    EXPECT(tokens[string.value()].size(text) == wide_size + 2);
+
+    auto open = find_first(tokens, He::TokenType::OpenCurly);
+    EXPECT(open.has_value());
+    auto close = He::partner_of(tokens, open.value());
+    EXPECT(close - open.value() == wide_body_statements * 4 + 1);
+    EXPECT(tokens[close].is(He::TokenType::CloseCurly));
+    EXPECT(He::partner_of(tokens, close) == open.value());
+
+    // NOTE: Skipping the bodies walks past the large one by its
+    //       partner, so missing it shows up as a parse error.
+    auto parsed = He::parse(lexed.tokens, move(lexed.symbols),
+        He::FunctionBodies::Skip);
+    EXPECT(parsed.is_error());
+    auto const& errors = parsed.error().parse_errors;
+    EXPECT(errors.size() == 1);
+    auto position = Util::line_and_column_for(text,
+        lexed.line_starts.view(),
+        errors[0].m_offending_token.start_index);
+    EXPECT(position.has_value());
+    EXPECT(position->line == lexed.line_starts.size() - 2);
+    EXPECT(position->column == 6);
+    return {};
+}
+
+}
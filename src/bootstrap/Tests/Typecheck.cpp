@@ -0,0 +1,134 @@
+#include "Tests.h"
+#include <Benchmark/Generator.h>
+#include <He/Codegen.h>
+#include <He/Context.h>
+#include <He/Lexer.h>
+#include <He/Parser.h>
+#include <He/Typecheck.h>
+
+namespace Tests {
+
+namespace {
+
+// NOTE: Several times what typecheck_in_parallel() gives a shard.
+constexpr u32 generated_size = 2 * 1024 * 1024;
+
+// NOTE: Functions with errors spread over a generated source, so
+//       that every shard has some.
+constexpr u32 broken_count = 12;
+
+// NOTE: Errors TypecheckErrors has room for.
+constexpr u32 kept_errors = 16;
+
+constexpr Benchmark::SourceShape shapes[] = {
+#define X(T, ...) Benchmark::SourceShape::T,
+    SOURCE_SHAPES
+#undef X
+};
+
+// NOTE: `text` with a function inserted between items every so
+//       often. Each reports one error, or with `many` every kind
+//       a body can have, more than TypecheckErrors keeps.
+ErrorOr<Source> with_errors(StringView text, bool many)
+{
+    auto out = TRY(StringBuffer::create_saturated(text.size
+        + broken_count * 256));
+    u32 written = 0;
+    for (u32 i = 0; i < broken_count; i++) {
+        auto end = (u32)((u64)text.size * (i + 1)
+            / (broken_count + 1));
+        while (end + 1 < text.size
+            && !(text[end] == '\n' && text[end + 1] == '\n'))
+            end++;
+        end += 2;
+        TRY(out.write(text.sub_view(written, end - written)));
+        written = end;
+
+        TRY(out.writeln("fn broken_"sv, i, "(x: i32) -> i32 {"sv));
+        if (many) {
+            TRY(out.writeln("    let y = 1;"sv));
+            TRY(out.writeln("    y = x;"sv));
+            TRY(out.writeln("    let y = 2;"sv));
+        }
+        TRY(out.writeln("    return broken_"sv, i, "(x, 1);"sv));
+        TRY(out.writeln("}"sv));
+        TRY(out.writeln());
+    }
+    TRY(out.write(text.sub_view(written, text.size - written)));
+    return TRY(Source::create(out.view()));
+}
+
+// NOTE: The generated code if `context` checks, its errors in the
+//       order they are kept otherwise.
+ErrorOr<StringBuffer> outcome(He::Context& context, u32 threads,
+    u32& error_count)
+{
+    auto result = threads == 1
+        ? He::typecheck(context)
+        : He::typecheck_in_parallel(context, threads);
+    if (!result.is_error()) {
+        error_count = 0;
+        auto typechecked = result.release_value();
+        return TRY(He::codegen(context, typechecked));
+    }
+    auto const& errors = result.error();
+    if (!errors.basic_error.is_empty())
+        return Error::from_string_literal("could not typecheck");
+    error_count = errors.typecheck_errors.size();
+    auto text = TRY(StringBuffer::create_saturated(4096));
+    for (auto const& error : errors.typecheck_errors) {
+        TRY(text.writeln(error.message, " "sv,
+            error.offending_token.start_index));
+    }
+    return text;
+}
+
+ErrorOr<void> expect_same_check(StringView source,
+    u32 expected_errors)
+{
+    auto lexed = TRY(Tests::lexed(He::lex(source)));
+    auto parsed = He::parse(lexed.tokens, move(lexed.symbols));
+    if (parsed.is_error())
+        return Error::from_string_literal("could not parse");
+    auto expressions = parsed.release_value();
+    auto context = He::Context {
+        .source = source,
+        .namespace_ = ""sv,
+        .expressions = expressions,
+        .symbols = expressions.symbols,
+    };
+    u32 error_count = 0;
+    auto expected = TRY(outcome(context, 1, error_count));
+    EXPECT(error_count == expected_errors);
+    for (u32 threads = 2; threads <= 8; threads *= 2) {
+        auto actual = TRY(outcome(context, threads, error_count));
+        EXPECT(error_count == expected_errors);
+        EXPECT(actual.view() == expected.view());
+    }
+    return {};
+}
+
+}
+
+// NOTE: Checking function bodies on several threads gives what
+//       checking them on one gives, the same code or the same
+//       errors in the same order.
+ErrorOr<void> parallel_typecheck()
+{
+    for (auto shape : shapes) {
+        auto text = TRY(Benchmark::generate_source(shape,
+            generated_size, 1));
+        auto source = TRY(Source::create(text.view()));
+        TRY(expect_same_check(source.view(), 0));
+    }
+
+    auto text = TRY(Benchmark::generate_source(
+        Benchmark::SourceShape::Mixed, generated_size, 2));
+    auto few = TRY(with_errors(text.view(), false));
+    TRY(expect_same_check(few.view(), broken_count));
+    auto many = TRY(with_errors(text.view(), true));
+    TRY(expect_same_check(many.view(), kept_errors));
+    return {};
+}
+
+}
@@ -0,0 +1,127 @@
+#include "Tests.h"
+#include <He/Codegen.h>
+#include <He/Context.h>
+#include <He/Lexer.h>
+#include <He/Parser.h>
+#include <He/Typecheck.h>
+
+namespace Tests {
+
+namespace {
+
+constexpr StringView first = "fn first() -> i32 {\n"
+                             "    return 1;\n"
+                             "}\n"sv;
+
+constexpr StringView leaf = "fn leaf(a: i32) -> i32 {\n"
+                            "    let x = a + 1;\n"
+                            "    return x;\n"
+                            "}\n"sv;
+
+constexpr StringView wide_leaf = "fn leaf(a: i32) -> i64 {\n"
+                                 "    let x = a + 1;\n"
+                                 "    return x;\n"
+                                 "}\n"sv;
+
+constexpr StringView caller = "fn caller() -> i32 {\n"
+                              "    let value = leaf(2);\n"
+                              "    return value;\n"
+                              "}\n"sv;
+
+constexpr StringView other = "fn other() -> i32 {\n"
+                             "    let y = 2;\n"
+                             "    return y;\n"
+                             "}\n"sv;
+
+constexpr StringView edited_other = "fn other() -> i32 {\n"
+                                    "    let y = 3;\n"
+                                    "    return y;\n"
+                                    "}\n"sv;
+
+constexpr StringView entry = "pub c_fn main() -> c_int {\n"
+                             "    return 0;\n"
+                             "}\n"sv;
+
+ErrorOr<StringBuffer> joined(View<StringView const> pieces)
+{
+    auto text = TRY(StringBuffer::create());
+    for (auto piece : pieces)
+        TRY(text.write(piece));
+    return text;
+}
+
+// NOTE: Checks the file with `cache`, or without one if it is
+//       null, and generates code from the result.
+ErrorOr<StringBuffer> checked_once(View<StringView const> pieces,
+    He::TypecheckCache* cache)
+{
+    auto text = TRY(joined(pieces));
+    auto source = TRY(Source::create(text.view()));
+    auto lexed = TRY(Tests::lexed(He::lex(source.view())));
+    auto parsed = He::parse(lexed.tokens, move(lexed.symbols));
+    if (parsed.is_error())
+        return Error::from_string_literal("could not parse");
+    auto expressions = parsed.release_value();
+    auto context = He::Context {
+        .source = source.view(),
+        .namespace_ = ""sv,
+        .expressions = expressions,
+        .symbols = expressions.symbols,
+        .tokens = lexed.tokens.view(),
+    };
+    auto result = cache
+        ? He::typecheck_incrementally(context, *cache, 2)
+        : He::typecheck(context);
+    if (result.is_error())
+        return Error::from_string_literal("could not typecheck");
+    auto typechecked = result.release_value();
+    return TRY(He::codegen(context, typechecked));
+}
+
+// NOTE: The cache has to give what checking the file gives.
+ErrorOr<He::TypecheckCacheStats> checked(
+    View<StringView const> pieces, He::TypecheckCache& cache)
+{
+    auto cached = TRY(checked_once(pieces, &cache));
+    auto fresh = TRY(checked_once(pieces, nullptr));
+    if (cached.view() != fresh.view())
+        return Error::from_string_literal("cached code differs");
+    return cache.last_run;
+}
+
+}
+
+// NOTE: Only bodies whose source changed, and those naming a
+//       declaration whose signature changed, are checked again.
+ErrorOr<void> typecheck_cache()
+{
+    auto cache = TRY(He::TypecheckCache::create());
+
+    StringView base[] = { leaf, caller, other, entry };
+    auto stats = TRY(checked({ base, 4 }, cache));
+    EXPECT(stats.hits == 0 && stats.misses == 4);
+    stats = TRY(checked({ base, 4 }, cache));
+    EXPECT(stats.hits == 4 && stats.misses == 0);
+
+    StringView edited[] = { leaf, caller, edited_other, entry };
+    stats = TRY(checked({ edited, 4 }, cache));
+    EXPECT(stats.hits == 3 && stats.misses == 1);
+
+    // NOTE: Bodies are found again wherever they moved to.
+    StringView moved[] = {
+        first, leaf, caller, edited_other, entry,
+    };
+    stats = TRY(checked({ moved, 5 }, cache));
+    EXPECT(stats.hits == 4 && stats.misses == 1);
+
+    StringView widened[] = {
+        first, wide_leaf, caller, edited_other, entry,
+    };
+    stats = TRY(checked({ widened, 5 }, cache));
+    EXPECT(stats.hits == 3 && stats.misses == 2);
+    stats = TRY(checked({ widened, 5 }, cache));
+    EXPECT(stats.hits == 5 && stats.misses == 0);
+    return {};
+}
+
+}
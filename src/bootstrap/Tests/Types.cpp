@@ -0,0 +1,96 @@
+#include "Tests.h"
+#include <He/Interner.h>
+#include <He/TypeTable.h>
+
+namespace Tests {
+
+namespace {
+
+using He::TypeId;
+
+// NOTE: More than the table starts out with room for, so that it
+//       has to grow while types are added.
+constexpr u32 array_count = 10000;
+
+}
+
+// NOTE: Types built the same way get the same id, however many
+//       types were added in between, and only those do.
+ErrorOr<void> types()
+{
+    auto symbols = TRY(He::Interner::create());
+    auto i32_name = TRY(symbols.intern("i32"sv));
+    auto u8_name = TRY(symbols.intern("u8"sv));
+    auto unused_name = TRY(symbols.intern("unused"sv));
+    auto types = TRY(He::TypeTable::create());
+
+    auto i32 = TRY(types.named(i32_name));
+    auto u8 = TRY(types.named(u8_name));
+    EXPECT(i32 != u8);
+    EXPECT(TRY(types.named(i32_name)) == i32);
+    auto found = types.find_named(i32_name);
+    EXPECT(found.has_value() && found.value() == i32);
+    EXPECT(!types.find_named(unused_name).has_value());
+    EXPECT(types.name(u8) == u8_name);
+
+    auto pointer = TRY(types.pointer(i32));
+    auto reference = TRY(types.mutable_reference(i32));
+    auto id = TRY(types.id(i32));
+    EXPECT(TRY(types.pointer(i32)) == pointer);
+    EXPECT(pointer != reference && reference != id);
+    EXPECT(pointer != id && pointer != TRY(types.pointer(u8)));
+    EXPECT(types.kind(reference) == He::TypeKind::MutableReference);
+    EXPECT(types.inner(pointer) == i32);
+
+    auto four = TRY(types.array(i32, 4));
+    EXPECT(TRY(types.array(i32, 4)) == four);
+    EXPECT(TRY(types.array(i32, 5)) != four);
+    EXPECT(TRY(types.array(u8, 4)) != four);
+    EXPECT(types.array_size(four) == 4);
+
+    TypeId parameters[] = { i32, u8 };
+    TypeId swapped[] = { u8, i32 };
+    auto function = TRY(types.function(i32, { parameters, 2 }));
+    EXPECT(TRY(types.function(i32, { parameters, 2 })) == function);
+    EXPECT(TRY(types.function(i32, { swapped, 2 })) != function);
+    EXPECT(TRY(types.function(u8, { parameters, 2 })) != function);
+    EXPECT(TRY(types.function(i32, { parameters, 1 })) != function);
+    EXPECT(TRY(types.function(i32, { parameters, 0 })) != function);
+    auto own = types.function_parameters(function);
+    EXPECT(own.size() == 2 && own[0] == i32 && own[1] == u8);
+    EXPECT(TRY(types.function(i32, own)) == function);
+
+    auto before = types.size();
+    for (u32 i = 0; i < array_count; i++) {
+        auto array = TRY(types.array(pointer, i));
+        EXPECT(array.raw() == before + i);
+    }
+    EXPECT(types.size() == before + array_count);
+    for (u32 i = 0; i < array_count; i++) {
+        auto array = TRY(types.array(pointer, i));
+        EXPECT(array.raw() == before + i);
+        EXPECT(types.array_size(array) == i);
+    }
+    EXPECT(types.size() == before + array_count);
+    EXPECT(TRY(types.named(i32_name)) == i32);
+    EXPECT(TRY(types.function(i32, { parameters, 2 })) == function);
+
+    // NOTE: Functions take parameters contravariantly and return
+    //       covariantly. Asking twice gives the memoized answer.
+    auto narrow = TRY(types.function(pointer, { &reference, 1 }));
+    auto wide = TRY(types.function(reference, { &pointer, 1 }));
+    for (u32 i = 0; i < 2; i++) {
+        EXPECT(TRY(types.is_assignable(pointer, reference)));
+        EXPECT(!TRY(types.is_assignable(reference, pointer)));
+        EXPECT(TRY(types.is_assignable(pointer, four)));
+        EXPECT(!TRY(types.is_assignable(TRY(types.pointer(u8)),
+            pointer)));
+        EXPECT(TRY(types.is_assignable(narrow, wide)));
+        EXPECT(!TRY(types.is_assignable(wide, narrow)));
+        EXPECT(TRY(types.is_assignable(TRY(types.pointer(narrow)),
+            TRY(types.pointer(wide)))));
+    }
+    return {};
+}
+
+}
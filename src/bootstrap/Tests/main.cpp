@@ -0,0 +1,66 @@
+#include "Tests.h"
+#include <CLI/ArgumentParser.h>
+#include <Core/File.h>
+#include <Main/Main.h>
+
+namespace {
+
+ErrorOr<bool> run_suite(StringView name,
+    ErrorOr<void> (*suite)());
+
+}
+
+ErrorOr<int> Main::main(int argc, c_string argv[])
+{
+    auto argument_parser = CLI::ArgumentParser();
+
+    c_string program_name = argv[0];
+    TRY(argument_parser.add_flag("--help"sv, "-h"sv,
+        "show help message"sv, [&] {
+            argument_parser.print_usage_and_exit(program_name, 0);
+        }));
+
+    c_string suite_argument = nullptr;
+    TRY(argument_parser.add_option("--suite"sv, "-s"sv, "name"sv,
+        "suite to run, all if not given"sv, [&](auto name) {
+            suite_argument = name;
+        }));
+
+    if (auto result = argument_parser.run(argc, argv);
+        result.is_error()) {
+        TRY(result.error().show());
+        return 1;
+    }
+
+    auto suite = suite_argument
+        ? StringView::from_c_string(suite_argument)
+        : ""sv;
+    auto found = false;
+    auto passed = true;
+#define X(function, name)                                    \
+    if (suite.is_empty() || suite == name##sv) {             \
+        found = true;                                        \
+        passed &= TRY(run_suite(name##sv, Tests::function)); \
+    }
+    TEST_SUITES
+#undef X
+    if (!found)
+        return Error::from_string_literal("unknown suite");
+    return passed ? 0 : 1;
+}
+
+namespace {
+
+ErrorOr<bool> run_suite(StringView name, ErrorOr<void> (*suite)())
+{
+    auto result = suite();
+    if (result.is_error()) {
+        TRY(Core::File::stderr().writeln(name, ": "sv,
+            result.error()));
+        return false;
+    }
+    TRY(Core::File::stdout().writeln(name, ": ok"sv));
+    return true;
+}
+
+}
@@ -29,19 +29,34 @@ private:
     struct Info {
         u32 cores;
         u32 threads;
-        u32 unknown;
         u32 current_thread;
 
         static Info the()
         {
             Info info;
 
+            // NOTE: Leaf 11 describes the topology one level at a
+            //       time, EAX only holds the APIC id shift width.
+            //       Sub-leaf 0 counts the threads of a core and
+            //       sub-leaf 1 the threads of the whole package.
+            u32 shift;
+            u32 level;
+            u32 threads_per_core;
             asm volatile("cpuid"
-                         : "=a"(info.threads), "=b"(info.cores),
-                         "=c"(info.unknown),
-                         "=d"(info.current_thread)
+                         : "=a"(shift), "=b"(threads_per_core),
+                         "=c"(level), "=d"(info.current_thread)
                          : "0"(11), "2"(0)
                          :);
+            asm volatile("cpuid"
+                         : "=a"(shift), "=b"(info.threads),
+                         "=c"(level), "=d"(info.current_thread)
+                         : "0"(11), "2"(1)
+                         :);
+            if (info.threads == 0)
+                info.threads = 1;
+            if (threads_per_core == 0)
+                threads_per_core = 1;
+            info.cores = info.threads / threads_per_core;
 
             return info;
         }
@@ -28,7 +28,8 @@ struct [[nodiscard]] Optional {
     constexpr Optional(Optional&& other)
         : m_has_value(other.has_value())
     {
-        new (storage()) T(other.release_value());
+        if (m_has_value)
+            new (storage()) T(other.release_value());
     }
 
     constexpr ~Optional() { clear_if_needed(); }
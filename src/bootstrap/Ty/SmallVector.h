@@ -22,6 +22,13 @@ struct SmallVector {
         other.invalidate();
     }
 
+    constexpr SmallVector& operator=(SmallVector&& other)
+    {
+        this->~SmallVector();
+        new (this) SmallVector(move(other));
+        return *this;
+    }
+
     constexpr ~SmallVector()
     {
         if (is_valid()) {
@@ -20,9 +20,6 @@ ErrorOr<Vector<StringView>> StringView::split_on(
     char character) const
 {
     auto indexes = TRY(find_all(character));
-    if (indexes.is_empty())
-        return {};
-
     auto splits = TRY(Vector<StringView>::create());
 
     u32 last_index = 0xFFFFFFFF; // Intentional overflow
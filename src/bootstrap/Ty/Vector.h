@@ -35,12 +35,26 @@ struct Vector {
     {
     }
 
+    // NOTE: Refers to `elements` without owning them, for example
+    //       in a mapped file, which must outlive the vector. They
+    //       are copied out the first time the vector grows.
+    static constexpr Vector<T> borrow(View<T> elements) requires(
+        is_trivially_copyable<T>)
+    {
+        if (elements.is_empty())
+            return Vector();
+        return Vector(elements.data(), elements.size(), 0);
+    }
+
     constexpr Vector(Vector&& other)
         : m_data(other.m_data)
         , m_size(other.m_size)
         , m_capacity(other.m_capacity)
     {
-        if (!other.is_hydrated()) {
+        // NOTE: Vectors that were moved from have nothing left to
+        //       move, but may still be moved again as part of
+        //       their parent.
+        if (!other.is_hydrated() && other.is_valid()) {
             for (u32 i = 0; i < m_size; i++) {
                 new (&inline_buffer()[i])
                     T(move(other.inline_buffer()[i]));
@@ -54,12 +68,19 @@ struct Vector {
     {
         if (is_valid()) {
             destroy_elements();
-            if (is_hydrated())
+            if (is_hydrated() && !is_borrowed())
                 free_memory(m_data);
             invalidate();
         }
     }
 
+    constexpr Vector& operator=(Vector&& other)
+    {
+        this->~Vector();
+        new (this) Vector(move(other));
+        return *this;
+    }
+
     ALWAYS_INLINE constexpr Id<T> unchecked_append(
         T&& value) requires(!is_trivially_copyable<T>)
     {
@@ -96,10 +117,54 @@ struct Vector {
         return {};
     }
 
+    // NOTE: Replaces `count` elements starting at `index` with
+    //       `values`, moving the elements after them as needed.
+    constexpr ErrorOr<void> replace(u32 index, u32 count,
+        View<T const> values) requires(is_trivially_copyable<T>)
+    {
+        u32 new_size = m_size - count + values.size();
+        TRY(ensure_capacity(new_size));
+        auto* elements = data();
+        __builtin_memmove(&elements[index + values.size()],
+            &elements[index + count],
+            (m_size - index - count) * sizeof(T));
+        __builtin_memcpy(&elements[index], values.data(),
+            values.size() * sizeof(T));
+        m_size = new_size;
+        return {};
+    }
+
+    constexpr ErrorOr<void> extend(View<T const> values) requires(
+        is_trivially_copyable<T>)
+    {
+        return replace(m_size, 0, values);
+    }
+
+    // NOTE: The new elements are left uninitialized, to be
+    //       constructed in place by the caller.
+    constexpr ErrorOr<T*> append_uninitialized(u32 count)
+    {
+        TRY(ensure_capacity(m_size + count));
+        auto* slots = current_slot();
+        m_size += count;
+        return slots;
+    }
+
+    // NOTE: Drops every element from `size` onwards.
+    constexpr void truncate(u32 size) requires(
+        is_trivially_copyable<T>)
+    {
+        if (size < m_size)
+            m_size = size;
+    }
+
     ALWAYS_INLINE constexpr ErrorOr<void> reserve(u32 elements)
     {
-        if (elements > 0)
-            TRY(expand(m_capacity + elements));
+        if (elements == 0)
+            return {};
+        // NOTE: Borrowed vectors are full, whatever their capacity.
+        auto capacity = is_borrowed() ? m_size : m_capacity;
+        TRY(expand(capacity + elements));
         return {};
     }
 
@@ -116,10 +181,10 @@ struct Vector {
         return {};
     }
 
-    FLATTEN constexpr View<T> view() { return { m_data, m_size }; }
+    FLATTEN constexpr View<T> view() { return { data(), m_size }; }
     FLATTEN constexpr View<T const> view() const
     {
-        return { m_data, m_size };
+        return { data(), m_size };
     }
 
     FLATTEN constexpr T const& at(u32 index) const
@@ -185,7 +250,7 @@ struct Vector {
 
     constexpr bool is_empty() const { return m_size == 0; }
 
-    constexpr bool is_valid() const { return m_size != 0xFFFFFF; }
+    constexpr bool is_valid() const { return m_size != 0xFFFFFFFF; }
 
 private:
     constexpr static auto inline_capacity = 8;
@@ -212,12 +277,33 @@ private:
         return m_data != nullptr;
     }
 
+    ALWAYS_INLINE constexpr bool is_borrowed() const
+    {
+        return is_hydrated() && m_capacity == 0;
+    }
+
+    ErrorOr<void> expand_borrowed(u32 capacity)
+    {
+        if (capacity < m_size)
+            capacity = m_size;
+        auto* data = (T*)TRY(allocate_memory(capacity * sizeof(T)));
+        __builtin_memcpy(data, m_data, m_size * sizeof(T));
+        m_capacity = capacity;
+        m_data = data;
+
+        return {};
+    }
+
     constexpr ErrorOr<void> expand(u32 capacity)
     {
         if (!is_hydrated()) {
             TRY(expand_hydrate(capacity));
             return {};
         }
+        if (is_borrowed()) {
+            TRY(expand_borrowed(capacity));
+            return {};
+        }
         m_data = (T*)TRY(
             reallocate_memory(m_data, capacity * sizeof(T)));
         m_capacity = capacity;
@@ -237,7 +323,10 @@ private:
     {
     }
 
-    ALWAYS_INLINE constexpr void invalidate() { m_size = 0xFFFFFF; }
+    ALWAYS_INLINE constexpr void invalidate()
+    {
+        m_size = 0xFFFFFFFF;
+    }
 
     FLATTEN constexpr T* current_slot() { return &data()[m_size]; }
 
@@ -250,6 +339,10 @@ private:
 
     constexpr ErrorOr<void> expand()
     {
+        if (is_borrowed()) {
+            TRY(expand(m_size * 1.5 + inline_capacity));
+            return {};
+        }
         TRY(expand(m_capacity * 1.5));
         return {};
     }
@@ -260,6 +353,13 @@ private:
     {
     }
 
+    constexpr Vector(T* data, u32 size, u32 capacity)
+        : m_data(data)
+        , m_size(size)
+        , m_capacity(capacity)
+    {
+    }
+
     ALWAYS_INLINE T* inline_buffer()
     {
         return reinterpret_cast<T*>(m_storage);
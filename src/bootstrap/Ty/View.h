@@ -23,6 +23,7 @@ struct View {
     constexpr T const* end() const { return &m_data[m_size]; }
 
     constexpr usize size() const { return m_size; }
+    constexpr bool is_empty() const { return m_size == 0; }
     constexpr T* data() { return m_data; }
     constexpr T const* data() const { return m_data; }
 
@@ -52,6 +53,7 @@ struct View<T> {
     constexpr T const* end() const { return &m_data[m_size]; }
 
     constexpr usize size() const { return m_size; }
+    constexpr bool is_empty() const { return m_size == 0; }
     constexpr T const* data() const { return m_data; }
 
 private:
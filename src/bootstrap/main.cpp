@@ -2,26 +2,54 @@
 #include <Core/Bench.h>
 #include <Core/File.h>
 #include <Core/MappedFile.h>
+#include <Core/StreamedFile.h>
 #include <Core/System.h>
 #include <He/Codegen.h>
 #include <He/Context.h>
+#include <He/Evaluate.h>
 #include <He/Expression.h>
 #include <He/Lexer.h>
+#include <He/ModuleGraph.h>
+#include <He/ParseCache.h>
 #include <He/Parser.h>
 #include <He/SourceFile.h>
 #include <He/Typecheck.h>
+#include <He/TypecheckCache.h>
 #include <He/TypecheckedExpression.h>
 #include <Main/Main.h>
+#include <Ty/Defer.h>
 #include <Ty/StringBuffer.h>
 
 [[nodiscard]] static ErrorOr<void> move_file(c_string to,
     c_string from);
 
-[[nodiscard]] static ErrorOr<void> compile_source(
-    c_string destination_path, c_string source_path);
+[[nodiscard]] static ErrorOr<void> compile_sources(
+    c_string destination_path, View<c_string const> source_paths);
+
+// NOTE: Generated files of the modules imported by the file being
+//       compiled, all of them temporary.
+struct ImportedModules {
+    Vector<StringBuffer> header_paths;
+    Vector<StringBuffer> source_paths;
+    Vector<StringView> root_import_headers;
+};
+
+[[nodiscard]] static ErrorOr<void> codegen_imported_modules(
+    He::ModuleGraph const& graph, He::Context const& root,
+    He::TypecheckedExpressions const& root_typechecked,
+    ImportedModules& imported);
 
 static ErrorOr<StringBuffer> namespace_from_path(StringView path);
 
+[[nodiscard]] static ErrorOr<He::LexResult> lex_stream(
+    Core::StreamedFile& file);
+
+[[nodiscard]] static ErrorOr<void> show_lex_throughput(
+    StringView source);
+
+[[nodiscard]] static ErrorOr<void> show_typecheck_cache_hits(
+    He::TypecheckCache const& cache);
+
 ErrorOr<int> Main::main(int argc, c_string argv[])
 {
     auto argument_parser = CLI::ArgumentParser();
@@ -46,6 +74,27 @@ ErrorOr<int> Main::main(int argc, c_string argv[])
             header_output_path = path;
         }));
 
+    auto header_only = false;
+    TRY(argument_parser.add_flag("--header-only"sv, "-ho"sv,
+        "only generate a header, skipping function bodies"sv, [&] {
+            header_only = true;
+        }));
+
+    auto parse_cache_directory = Optional<StringView>();
+    TRY(argument_parser.add_option("--parse-cache"sv, "-pc"sv,
+        "directory"sv, "reuse lexed and parsed sources"sv,
+        [&](auto path) {
+            parse_cache_directory = StringView::from_c_string(path);
+        }));
+
+    auto typecheck_cache_directory = Optional<StringView>();
+    TRY(argument_parser.add_option("--typecheck-cache"sv, "-tc"sv,
+        "directory"sv, "skip checking unchanged function bodies"sv,
+        [&](auto path) {
+            typecheck_cache_directory
+                = StringView::from_c_string(path);
+        }));
+
     auto should_dump_tokens = false;
     TRY(argument_parser.add_flag("--dump-tokens"sv, "-dt"sv,
         "dump tokens"sv, [&] {
@@ -73,6 +122,12 @@ ErrorOr<int> Main::main(int argc, c_string argv[])
                 = Core::BenchEnableAutoDisplay::Yes;
         }));
 
+    auto should_compare_lexers = false;
+    TRY(argument_parser.add_flag("--benchmark-lexer"sv, "-bl"sv,
+        "time every way of lexing the source"sv, [&] {
+            should_compare_lexers = true;
+        }));
+
     auto stop_after_lex = false;
     TRY(argument_parser.add_flag("--stop-after-lex"sv, "-sl"sv,
         "stop program after lexing"sv, [&] {
@@ -110,36 +165,98 @@ ErrorOr<int> Main::main(int argc, c_string argv[])
     }
     if (export_source && !output_path_set)
         output_path = "a.c";
+    if (header_only && !output_path_set)
+        output_path = "a.h";
 
     auto bench = Core::Bench(should_display_benchmark);
 
-    auto file = TRY(Core::MappedFile::open(source_file_path));
     auto source_file = He::SourceFile {
         StringView::from_c_string(source_file_path),
-        file.view(),
     };
+    auto mapped_file = Optional<Core::MappedFile>();
+    auto streamed_file = Optional<Core::StreamedFile>();
+    if (source_file.file_name == "-"sv) {
+        source_file.file_name = "<stdin>"sv;
+        streamed_file
+            = TRY(Core::StreamedFile::create(STDIN_FILENO));
+    } else {
+        mapped_file = TRY(Core::MappedFile::open(source_file_path));
+        source_file.text = mapped_file->view();
+    }
 
-    auto lex_result = bench("lex"sv, [&] {
-        return He::lex(source_file.text);
-    });
+    // NOTE: Standard input can not be mapped, so it is never
+    //       cached.
+    auto use_parse_cache = parse_cache_directory.has_value()
+        && mapped_file.has_value();
+    auto cached_parse = Optional<He::CachedParse>();
+    if (use_parse_cache) {
+        auto load_result = bench("load parse cache"sv, [&] {
+            return He::load_cached_parse(
+                parse_cache_directory.value(), source_file.text);
+        });
+        if (!load_result.is_error())
+            cached_parse = load_result.release_value();
+    }
+
+    auto lex_result = TRY(bench("lex"sv,
+        [&]() -> ErrorOr<He::LexResult> {
+            if (cached_parse.has_value())
+                return He::LexResult(move(cached_parse->lexed));
+            if (streamed_file.has_value())
+                return TRY(lex_stream(streamed_file.value()));
+            return He::lex_in_parallel(source_file.text);
+        }));
+    if (streamed_file.has_value())
+        source_file.text = streamed_file->view();
     if (lex_result.is_error()) {
         TRY(lex_result.error().show(source_file));
         return 1;
     }
-    auto tokens = lex_result.release_value();
+    auto lexed = lex_result.release_value();
+    source_file.line_starts = lexed.line_starts.view();
+    auto has_lex_errors = !lexed.errors.is_empty();
+    if (has_lex_errors)
+        TRY(lexed.errors.show(source_file));
+    // NOTE: This lexes the source several more times, so it is
+    //       kept apart from --benchmark to not skew its timings.
+    if (should_compare_lexers)
+        TRY(show_lex_throughput(source_file.text));
     if (should_dump_tokens)
-        TRY(dump_tokens(source_file.text, tokens.view()));
+        TRY(dump_tokens(source_file, lexed.tokens.view()));
     if (stop_after_lex)
-        return 0;
-
-    auto parse_result = bench("parse"sv, [&] {
-        return He::parse(tokens);
+        return has_lex_errors ? 1 : 0;
+
+    // NOTE: Headers only need declarations and signatures.
+    auto function_bodies = header_only ? He::FunctionBodies::Skip
+                                       : He::FunctionBodies::Parse;
+    auto parse_result = bench("parse"sv, [&]() -> He::ParseResult {
+        if (cached_parse.has_value())
+            return move(cached_parse->expressions);
+        return He::parse_in_parallel(lexed.tokens,
+            move(lexed.symbols), function_bodies);
     });
     if (parse_result.is_error()) {
         TRY(parse_result.error().show(source_file));
         return 1;
     }
+    if (has_lex_errors)
+        return 1;
     auto expressions = parse_result.release_value();
+    // NOTE: Skipped function bodies would be missing from later
+    //       full builds, so only complete parses are stored.
+    if (use_parse_cache && !cached_parse.has_value()
+        && function_bodies == He::FunctionBodies::Parse) {
+        auto store_result = bench("store parse cache"sv, [&] {
+            return He::store_cached_parse(
+                parse_cache_directory.value(), source_file.text,
+                lexed, expressions);
+        });
+        if (store_result.is_error()) {
+            auto error_message = store_result.error().message();
+            TRY(Core::File::stderr().writeln(
+                "could not store parse cache: "sv, error_message));
+        }
+    }
     if (should_dump_expressions) {
         expressions.dump(source_file.text);
         TRY(Core::File::stderr().flush());
@@ -147,24 +264,122 @@ ErrorOr<int> Main::main(int argc, c_string argv[])
     if (stop_after_parse)
         return 0;
 
-    auto namespace_
-        = TRY(namespace_from_path(source_file.file_name));
+    auto namespace_path = streamed_file.has_value()
+        ? "stdin"sv
+        : source_file.file_name;
+    auto namespace_ = TRY(namespace_from_path(namespace_path));
     auto context = He::Context {
-        source_file.text,
-        namespace_.view(),
-        expressions,
+        .source = source_file.text,
+        .namespace_ = namespace_.view(),
+        .expressions = expressions,
+        .symbols = expressions.symbols,
+        .file_name = source_file.file_name,
+        .tokens = lexed.tokens.view(),
     };
+
+    // NOTE: Like the parse cache, the typecheck cache is not used
+    //       for standard input, nor when bodies were skipped.
+    auto use_typecheck_cache = typecheck_cache_directory.has_value()
+        && mapped_file.has_value()
+        && function_bodies == He::FunctionBodies::Parse;
+    auto typecheck_cache = Optional<He::TypecheckCache>();
+    if (use_typecheck_cache) {
+        auto load_result = bench("load typecheck cache"sv, [&] {
+            return He::TypecheckCache::load(
+                typecheck_cache_directory.value(),
+                source_file.file_name);
+        });
+        if (load_result.is_error())
+            typecheck_cache = TRY(He::TypecheckCache::create());
+        else
+            typecheck_cache = load_result.release_value();
+    }
     auto typecheck_result = bench("typecheck"sv, [&] {
-        return He::typecheck(context);
+        if (typecheck_cache.has_value()) {
+            return He::typecheck_incrementally(context,
+                typecheck_cache.value());
+        }
+        return He::typecheck_in_parallel(context);
     });
     if (typecheck_result.is_error()) {
         TRY(typecheck_result.error().show(context));
         return 1;
     }
     auto typechecked_expressions = typecheck_result.release_value();
+    if (use_typecheck_cache && typecheck_cache->has_changed()) {
+        auto store_result = bench("store typecheck cache"sv, [&] {
+            return typecheck_cache->store(
+                typecheck_cache_directory.value(),
+                source_file.file_name);
+        });
+        if (store_result.is_error()) {
+            auto error_message = store_result.error().message();
+            TRY(Core::File::stderr().writeln(
+                "could not store typecheck cache: "sv,
+                error_message));
+        }
+    }
+    if (use_typecheck_cache
+        && should_display_benchmark
+            == Core::BenchEnableAutoDisplay::Yes)
+        TRY(show_typecheck_cache_hits(typecheck_cache.value()));
     if (stop_after_typecheck)
         return 0;
 
+    auto constants = TRY(bench("evaluate constants"sv, [&] {
+        return He::evaluate_constants(context);
+    }));
+    if (constants.has_errors()) {
+        TRY(constants.show_errors(context));
+        return 1;
+    }
+    context.constants = &constants;
+
+    if (header_only) {
+        auto header = TRY(bench("codegen_header"sv, [&] {
+            return He::codegen_header(context,
+                typechecked_expressions);
+        }));
+        auto header_file = TRY(Core::File::open_for_writing(
+            header_output_path ?: output_path));
+        TRY(bench("write header"sv, [&] {
+            return header_file.write(header);
+        }));
+        return 0;
+    }
+
+    // NOTE: Imported modules are only needed to link an
+    //       executable, exported sources include their headers.
+    //       Imports from standard input are not followed.
+    auto imported = ImportedModules {
+        TRY(Vector<StringBuffer>::create()),
+        TRY(Vector<StringBuffer>::create()),
+        TRY(Vector<StringView>::create()),
+    };
+    Defer remove_imported = [&] {
+        for (auto const& path : imported.header_paths)
+            Core::System::remove(path.data()).ignore();
+        for (auto const& path : imported.source_paths)
+            Core::System::remove(path.data()).ignore();
+    };
+    auto should_link = mapped_file.has_value() && !export_source
+        && Core::System::isatty(STDOUT_FILENO);
+    if (should_link && !expressions.import_hes.is_empty()) {
+        auto graph = TRY(bench("load imports"sv, [&] {
+            return He::ModuleGraph::load(source_file, expressions);
+        }));
+        if (graph.has_errors()) {
+            TRY(graph.show_errors());
+            return 1;
+        }
+        TRY(bench("codegen imports"sv, [&] {
+            return codegen_imported_modules(graph, context,
+                typechecked_expressions, imported);
+        }));
+        context.import_headers
+            = imported.root_import_headers.view();
+    }
+
     char temporary_file[] = "/tmp/XXXXXX.c";
     int output_file = STDOUT_FILENO;
     if (export_source || Core::System::isatty(STDOUT_FILENO)) {
@@ -188,8 +403,13 @@ ErrorOr<int> Main::main(int argc, c_string argv[])
     TRY(Core::System::close(output_file));
 
     if (!export_source) {
+        auto source_paths = TRY(Vector<c_string>::create());
+        TRY(source_paths.append(temporary_file));
+        for (auto const& path : imported.source_paths)
+            TRY(source_paths.append(path.data()));
         TRY(bench("compile_source"sv, [&] {
-            return compile_source(output_path, temporary_file);
+            return compile_sources(output_path,
+                source_paths.view());
         }));
         auto remove_result = Core::System::remove(temporary_file);
         if (remove_result.is_error()) {
@@ -230,15 +450,16 @@ ErrorOr<int> Main::main(int argc, c_string argv[])
 static ErrorOr<void> move_file(c_string to, c_string from)
 {
     auto from_file = TRY(Core::MappedFile::open(from));
-    auto to_fd = TRY(Core::System::open(to, O_WRONLY, 0666));
+    auto to_fd = TRY(Core::System::open(to,
+        O_WRONLY | O_CREAT | O_TRUNC, 0666));
     TRY(Core::System::write(to_fd, from_file));
     TRY(Core::System::close(to_fd));
     TRY(Core::System::unlink(from));
     return {};
 }
 
-[[nodiscard]] static ErrorOr<void> compile_source(
-    c_string destination_path, c_string source_path)
+[[nodiscard]] static ErrorOr<void> compile_sources(
+    c_string destination_path, View<c_string const> source_paths)
 {
     auto compiler = Core::System::getenv("CC"sv);
     if (!compiler) {
@@ -249,16 +470,16 @@ static ErrorOr<void> move_file(c_string to, c_string from)
         }
         compiler = "cc";
     }
-    c_string argv[] = {
-        compiler.release_value(),
-        "-Wno-duplicate-decl-specifier",
-        "-o",
-        destination_path,
-        source_path,
-        nullptr,
-    };
-
-    auto pid = TRY(Core::System::posix_spawnp(argv[0], argv));
+    auto argv = TRY(Vector<c_string>::create());
+    TRY(argv.append(compiler.release_value()));
+    TRY(argv.append("-Wno-duplicate-decl-specifier"));
+    TRY(argv.append("-o"));
+    TRY(argv.append(destination_path));
+    TRY(argv.extend(source_paths));
+    TRY(argv.append(nullptr));
+
+    auto pid
+        = TRY(Core::System::posix_spawnp(argv[0], argv.data()));
     auto status = TRY(Core::System::waitpid(pid));
     if (!status.did_exit() || status.exit_status() != 0)
         return Error::from_string_literal(
@@ -267,9 +488,102 @@ static ErrorOr<void> move_file(c_string to, c_string from)
     return {};
 }
 
+static ErrorOr<Core::File> create_temporary_file(
+    Vector<StringBuffer>& paths, StringView suffix)
+{
+    // NOTE: Saturated, as vectors move their elements around in
+    //       memory without their move constructor when they grow.
+    auto path = TRY(StringBuffer::create_saturated_fill(
+        "/tmp/XXXXXX"sv, suffix, "\0"sv));
+    auto fd = TRY(Core::System::mkstemps(path.mutable_data(),
+        suffix.size));
+    TRY(paths.append(move(path)));
+    return Core::File::from(fd, true);
+}
+
+static ErrorOr<void> codegen_imported_modules(
+    He::ModuleGraph const& graph, He::Context const& root,
+    He::TypecheckedExpressions const& root_typechecked,
+    ImportedModules& imported)
+{
+    // NOTE: Every header is created before any is written, so the
+    //       path of each one is known wherever it is included. The
+    //       root file gets one too, in case it is imported back.
+    auto const& modules = graph.modules;
+    auto& header_paths = imported.header_paths;
+    for (u32 i = 0; i < modules.size() + 1; i++)
+        TRY(create_temporary_file(header_paths, ".h"sv));
+    auto header_of = [&](u32 module) {
+        if (module == He::ModuleGraph::root_module)
+            module = modules.size();
+        auto const& path = header_paths[module];
+        return StringView::from_c_string(path.data());
+    };
+
+    for (u32 i = 0; i < modules.size(); i++) {
+        auto const& module = modules[i];
+        auto import_headers = TRY(Vector<StringView>::create(
+            module.imports.size()));
+        for (auto imported_module : module.imports)
+            import_headers.unchecked_append(
+                header_of(imported_module));
+
+        auto const& expressions = module.expressions.value();
+        auto namespace_
+            = TRY(namespace_from_path(module.path.view()));
+        auto context = He::Context {
+            .source = module.file.view(),
+            .namespace_ = namespace_.view(),
+            .expressions = expressions,
+            .symbols = expressions.symbols,
+            .import_headers = import_headers.view(),
+            .file_name = module.path.view(),
+        };
+        auto typecheck_result = He::typecheck(context);
+        if (typecheck_result.is_error()) {
+            TRY(typecheck_result.error().show(context));
+            return Error::from_string_literal(
+                "could not typecheck imported module");
+        }
+        auto typechecked = typecheck_result.release_value();
+        auto constants = TRY(He::evaluate_constants(context));
+        if (constants.has_errors()) {
+            TRY(constants.show_errors(context));
+            return Error::from_string_literal(
+                "could not evaluate imported module");
+        }
+        context.constants = &constants;
+
+        auto header = TRY(He::codegen_header(context, typechecked));
+        auto header_file
+            = TRY(Core::File::open_for_writing(header_of(i)));
+        TRY(header_file.write(header));
+
+        auto code = TRY(He::codegen(context, typechecked));
+        auto source_file = TRY(create_temporary_file(
+            imported.source_paths, ".c"sv));
+        TRY(source_file.write(code));
+    }
+
+    for (auto imported_module : graph.root_imports) {
+        TRY(imported.root_import_headers.append(
+            header_of(imported_module)));
+    }
+    auto root_context = root;
+    auto root_import_headers = imported.root_import_headers.view();
+    root_context.import_headers = root_import_headers;
+    auto root_header
+        = TRY(He::codegen_header(root_context, root_typechecked));
+    auto root_header_file = TRY(Core::File::open_for_writing(
+        header_of(He::ModuleGraph::root_module)));
+    TRY(root_header_file.write(root_header));
+
+    return {};
+}
+
 static ErrorOr<StringBuffer> namespace_from_path(StringView path)
 {
-    auto namespace_ = TRY(StringBuffer::create(path.size));
+    auto namespace_ = TRY(StringBuffer::create(path.size + 1));
 
     while (path.starts_with("../"sv))
         path = path.shrink_from_start("../"sv.size);
@@ -283,8 +597,104 @@ static ErrorOr<StringBuffer> namespace_from_path(StringView path)
         TRY(namespace_.write(parts[i], "$"sv));
         i++;
     }
-    TRY(namespace_.write(parts.last().shrink(".he"sv.size)));
+    auto name = parts.last();
+    if (name.ends_with(".he"sv))
+        name = name.shrink(".he"sv.size);
+    TRY(namespace_.write(name));
     namespace_.replace_all('-', '_');
 
     return namespace_;
 }
+
+static ErrorOr<He::LexResult> lex_stream(Core::StreamedFile& file)
+{
+    // NOTE: Pipes hand out a few pages at a time, so lexing after
+    //       every read would mostly relex the last unfinished
+    //       token.
+    constexpr u32 lex_interval = 1024 * 1024;
+
+    auto lexer = TRY(He::StreamLexer::create());
+    u32 lexed_until = 0;
+    while (TRY(file.read_some()) != 0) {
+        if (file.view().size - lexed_until < lex_interval)
+            continue;
+        TRY(lexer.lex_available(file.view()));
+        lexed_until = file.view().size;
+    }
+    return lexer.finish(file.view());
+}
+
+static ErrorOr<void> show_lex_throughput(StringView source)
+{
+    auto megabytes_per_second
+        = [&](auto lex, StringView name) -> ErrorOr<void> {
+        auto start = TRY(Core::System::monotonic_nanoseconds());
+        auto result = lex(source);
+        auto stop = TRY(Core::System::monotonic_nanoseconds());
+        if (result.is_error()) {
+            return Error::from_string_literal(
+                "could not lex source");
+        }
+
+        // Bytes per nanosecond is the same as megabytes per
+        // millisecond, so scale by 1000 to get per second.
+        auto elapsed = stop - start ?: 1;
+        auto throughput = (u64)source.size * 1000 / elapsed;
+        TRY(Core::File::stderr().writeln(name, ": "sv, throughput,
+            " MB/s"sv));
+        return {};
+    };
+    TRY(megabytes_per_second(He::lex_scalar, "lex (scalar)"sv));
+    TRY(megabytes_per_second(He::lex, "lex (vector)"sv));
+    auto lex_in_parallel = [](StringView source) {
+        return He::lex_in_parallel(source);
+    };
+    TRY(megabytes_per_second(lex_in_parallel, "lex (parallel)"sv));
+
+    // Simulate a keystroke in the middle of the file.
+    auto lex_result = He::lex(source);
+    if (lex_result.is_error())
+        return Error::from_string_literal("could not lex source");
+    auto lexed = lex_result.release_value();
+    auto middle = source.size / 2;
+    auto edited_buffer = TRY(StringBuffer::create_fill(
+        source.sub_view(0, middle), " "sv,
+        source.sub_view(middle, source.size - middle), "\0"sv));
+    auto edited = StringView(edited_buffer.data(), source.size + 1);
+    auto edit = He::SourceEdit {
+        .start = middle,
+        .old_end = middle,
+        .new_end = middle + 1,
+    };
+    auto start = TRY(Core::System::monotonic_nanoseconds());
+    auto result = He::relex(lexed, source, edited, edit);
+    auto stop = TRY(Core::System::monotonic_nanoseconds());
+    if (result.is_error())
+        return Error::from_string_literal("could not relex source");
+    TRY(Core::File::stderr().writeln("relex (1 byte edit): "sv,
+        (stop - start) / 1000, " us"sv));
+    return {};
+}
+
+static ErrorOr<void> show_typecheck_cache_hits(
+    He::TypecheckCache const& cache)
+{
+    auto const& run = cache.last_run;
+    auto bodies = run.hits + run.misses;
+    auto percent = bodies == 0 ? 100 : run.hits * 100 / bodies;
+    auto& out = Core::File::stderr();
+    TRY(out.writeln("typecheck cache: "sv, run.hits, " of "sv,
+        bodies, " bodies ("sv, percent, "%)"sv));
+    TRY(out.writeln("typecheck cache: found bodies in "sv,
+        run.hash_nanoseconds / 1000, " us, checked "sv, run.misses,
+        " in "sv, run.check_nanoseconds / 1000, " us"sv));
+    auto saved = cache.nanoseconds_saved();
+    if (saved < 0) {
+        TRY(out.writeln("typecheck cache: about "sv, -saved / 1000,
+            " us lost"sv));
+        return {};
+    }
+    TRY(out.writeln("typecheck cache: about "sv, saved / 1000,
+        " us saved"sv));
+    return {};
+}